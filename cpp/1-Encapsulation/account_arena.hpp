@@ -0,0 +1,189 @@
+#ifndef ACCOUNT_ARENA_HPP
+#define ACCOUNT_ARENA_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "bank_account.hpp"
+
+/**
+ * ============================================================================
+ * ACCOUNT ARENA: pooled BankAccount objects, bump-allocated holder names
+ * ============================================================================
+ *
+ * Opening and closing accounts one by one through new/delete and
+ * std::string leaves the global heap fragmented, and every allocation from
+ * many threads goes through the allocator's shared state. AccountArena
+ * keeps both kinds of memory to itself:
+ * - RECORDS: BankAccount objects live in fixed-size cells carved from
+ *   chunks of kChunkAccounts cells. A closed account's cell goes on a free
+ *   list and is reused by the next open; chunks are never returned early.
+ * - NAMES: holder names are allocated from a
+ *   std::pmr::monotonic_buffer_resource (a pointer bump). Renaming an
+ *   account leaves the old name in the arena until the next reset.
+ * - reset() closes every live account and rewinds both pools in one shot.
+ *   Record chunks are kept for the next batch; name memory is handed back
+ *   as a few large blocks. A simulation that opens millions of accounts per
+ *   round never frees them one by one.
+ *
+ * An arena is not thread-safe. Give each thread its own arena: that is
+ * what removes allocator contention when many threads open accounts.
+ *
+ * Accounts handed out by an arena must not outlive it (or a reset). Moving
+ * one out keeps its name in the arena's memory; copy it with an allocator
+ * (or a plain copy, which uses the default resource) to take it elsewhere.
+ * ============================================================================
+ */
+
+// ============================================================================
+// CLASS DEFINITION: AccountArena
+// ============================================================================
+class AccountArena {
+public:
+    static constexpr std::size_t kChunkAccounts = 1024;   // Cells per record chunk
+
+private:
+    /**
+     * Storage for one account; the account starts at the cell's address
+     */
+    struct Cell {
+        union {
+            alignas(BankAccount) unsigned char storage[sizeof(BankAccount)];
+            Cell *nextFree;   // Link while the cell is on the free list
+        };
+        std::size_t index = 0;   // Position in the arena (bit in liveMask)
+
+        Cell() {}
+    };
+
+    std::pmr::monotonic_buffer_resource names;   // Holder-name storage
+    std::vector<std::unique_ptr<Cell[]>> chunks; // Record storage
+    std::vector<std::uint64_t> liveMask;         // Bit per cell: holds a live account
+    std::size_t cellsUsed = 0;                   // Cells handed out at least once since reset
+    Cell *freeList = nullptr;                    // Closed cells ready for reuse
+    std::size_t live = 0;                        // Open accounts
+
+    Cell &cellAt(std::size_t index) {
+        return chunks[index / kChunkAccounts][index % kChunkAccounts];
+    }
+
+    void setLive(std::size_t index, bool isLive) {
+        std::uint64_t bit = std::uint64_t{1} << (index % 64);
+        if (isLive) {
+            liveMask[index / 64] |= bit;
+        } else {
+            liveMask[index / 64] &= ~bit;
+        }
+    }
+
+    /**
+     * @return A free cell for a new account
+     */
+    Cell *takeCell() {
+        if (freeList) {
+            Cell *cell = freeList;
+            freeList = cell->nextFree;
+            return cell;
+        }
+        if (cellsUsed == chunks.size() * kChunkAccounts) {
+            chunks.push_back(std::make_unique<Cell[]>(kChunkAccounts));
+            liveMask.resize(chunks.size() * kChunkAccounts / 64, 0);
+        }
+        Cell *cell = &cellAt(cellsUsed);
+        cell->index = cellsUsed++;
+        return cell;
+    }
+
+public:
+    /**
+     * @param nameBytesHint Initial size of the name arena's first block
+     * @param upstream Where the name arena gets its blocks from
+     */
+    explicit AccountArena(std::size_t nameBytesHint = 64 * 1024,
+                          std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : names(nameBytesHint, upstream) {}
+
+    AccountArena(const AccountArena &) = delete;
+    AccountArena &operator=(const AccountArena &) = delete;
+
+    ~AccountArena() { reset(); }
+
+    /**
+     * Opens an account in the arena
+     * Takes the same arguments as the BankAccount constructor.
+     *
+     * @return The new account (valid until close or reset)
+     */
+    template <class... Args>
+    BankAccount &open(Args &&...args) {
+        Cell *cell = takeCell();
+        BankAccount *account = ::new (static_cast<void *>(cell->storage))
+            BankAccount(std::allocator_arg, get_allocator(), std::forward<Args>(args)...);
+        setLive(cell->index, true);
+        ++live;
+        return *account;
+    }
+
+    /**
+     * Closes an account opened by this arena and recycles its cell
+     * @param account The account (must come from this arena and be open)
+     */
+    void close(BankAccount &account) {
+        Cell *cell = reinterpret_cast<Cell *>(reinterpret_cast<unsigned char *>(&account));
+        account.~BankAccount();
+        setLive(cell->index, false);
+        cell->nextFree = freeList;
+        freeList = cell;
+        --live;
+    }
+
+    /**
+     * Closes every open account and rewinds the arena in one shot
+     * Record chunks are kept for reuse; name memory goes back upstream.
+     */
+    void reset() {
+        for (std::size_t word = 0; word < liveMask.size(); ++word) {
+            for (std::uint64_t bits = liveMask[word]; bits != 0; bits &= bits - 1) {
+                std::size_t index = word * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+                std::launder(reinterpret_cast<BankAccount *>(cellAt(index).storage))->~BankAccount();
+            }
+            liveMask[word] = 0;
+        }
+        cellsUsed = 0;
+        freeList = nullptr;
+        live = 0;
+        names.release();
+    }
+
+    /**
+     * @return The allocator accounts in this arena use for their names
+     */
+    BankAccount::allocator_type get_allocator() {
+        return BankAccount::allocator_type(&names);
+    }
+
+    /**
+     * @return The resource backing holder names, for other pmr containers
+     */
+    std::pmr::memory_resource *getNameResource() {
+        return &names;
+    }
+
+    /**
+     * @return Number of open accounts
+     */
+    std::size_t size() const { return live; }
+
+    /**
+     * @return Accounts that fit without allocating another chunk
+     */
+    std::size_t capacity() const { return chunks.size() * kChunkAccounts; }
+};
+
+#endif // ACCOUNT_ARENA_HPP
@@ -0,0 +1,236 @@
+#ifndef ACCOUNT_ID_HPP
+#define ACCOUNT_ID_HPP
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+/**
+ * ============================================================================
+ * COMPACT ACCOUNT IDENTIFIERS
+ * ============================================================================
+ *
+ * Account numbers follow the "ACC###" scheme: a short upper-case prefix
+ * followed by digits. Instead of keeping each one in a heap-allocated
+ * std::string, AccountId packs it into a single 64-bit integer:
+ *
+ *   bits 63..49   prefix, up to 3 letters, 5 bits each (A=1 ... Z=26, 0=none)
+ *   bits 48..45   number of digits as written (keeps leading zeros: "001")
+ *   bits 44..0    numeric part (up to 13 digits)
+ *
+ * Ids are trivially copyable, compare and hash as one integer, and convert
+ * back to exactly the text they were parsed from. Packed value 0 is never a
+ * valid id, so it can mark "no account".
+ * ============================================================================
+ */
+
+// ============================================================================
+// CLASS DEFINITION: AccountIdText
+// ============================================================================
+/**
+ * Account id rendered as text in an inline buffer (no allocation)
+ */
+class AccountIdText {
+private:
+    friend class AccountId;
+
+    char chars[16] = {};     // Rendered characters (not NUL-terminated)
+    std::uint8_t length = 0;
+
+public:
+    constexpr std::string_view view() const {
+        return std::string_view(chars, length);
+    }
+};
+
+// ============================================================================
+// CLASS DEFINITION: AccountId
+// ============================================================================
+class AccountId {
+private:
+    static constexpr unsigned kPrefixLetters = 3;
+    static constexpr unsigned kLetterBits = 5;
+    static constexpr unsigned kNumberBits = 45;
+    static constexpr unsigned kWidthBits = 4;
+    static constexpr unsigned kWidthShift = kNumberBits;
+    static constexpr unsigned kPrefixShift = kNumberBits + kWidthBits;
+    static constexpr std::uint64_t kNumberMask = (std::uint64_t{1} << kNumberBits) - 1;
+    static constexpr std::uint64_t kWidthMask = (std::uint64_t{1} << kWidthBits) - 1;
+    static constexpr std::uint64_t kLetterMask = (std::uint64_t{1} << kLetterBits) - 1;
+
+    std::uint64_t packed;   // Encoded id, 0 = invalid
+
+    constexpr explicit AccountId(std::uint64_t value) : packed(value) {}
+
+public:
+    static constexpr unsigned kMaxDigits = 13;
+    static constexpr std::size_t kMaxTextLength = kPrefixLetters + kMaxDigits;
+
+    /**
+     * Creates the invalid (empty) id
+     */
+    constexpr AccountId() : packed(0) {}
+
+    /**
+     * Parses text such as "ACC001"
+     *
+     * @param text 1-3 upper-case letters followed by 1-13 digits
+     * @return The id, or std::nullopt if the text does not fit the scheme
+     */
+    static constexpr std::optional<AccountId> parse(std::string_view text) {
+        std::size_t pos = 0;
+        std::uint64_t prefix = 0;
+        while (pos < text.size() && text[pos] >= 'A' && text[pos] <= 'Z') {
+            if (pos == kPrefixLetters) {
+                return std::nullopt;
+            }
+            prefix = (prefix << kLetterBits) | static_cast<std::uint64_t>(text[pos] - 'A' + 1);
+            ++pos;
+        }
+        // Left-align shorter prefixes so "AB" and "ABC" share a layout
+        prefix <<= kLetterBits * (kPrefixLetters - pos);
+
+        std::size_t digits = text.size() - pos;
+        if (pos == 0 || digits == 0 || digits > kMaxDigits) {
+            return std::nullopt;
+        }
+
+        std::uint64_t number = 0;
+        for (; pos < text.size(); ++pos) {
+            if (text[pos] < '0' || text[pos] > '9') {
+                return std::nullopt;
+            }
+            number = number * 10 + static_cast<std::uint64_t>(text[pos] - '0');
+        }
+        return AccountId((prefix << kPrefixShift) |
+                         (static_cast<std::uint64_t>(digits) << kWidthShift) | number);
+    }
+
+    /**
+     * Builds an id from a prefix and a sequence number, e.g. ("ACC", 7) -> "ACC007"
+     *
+     * @param prefix 1-3 upper-case letters
+     * @param number The numeric part
+     * @param minDigits Zero-pad the number to at least this many digits
+     * @return The id, or std::nullopt if the parts do not fit
+     */
+    static constexpr std::optional<AccountId> make(std::string_view prefix, std::uint64_t number,
+                                                   unsigned minDigits = 3) {
+        char text[kMaxTextLength + 1] = {};
+        if (prefix.size() > kPrefixLetters) {
+            return std::nullopt;
+        }
+        unsigned digits = 1;
+        for (std::uint64_t rest = number / 10; rest != 0; rest /= 10) {
+            ++digits;
+        }
+        if (digits < minDigits) {
+            digits = minDigits;
+        }
+        if (digits > kMaxDigits) {
+            return std::nullopt;
+        }
+        std::size_t length = prefix.size() + digits;
+        for (std::size_t i = 0; i < prefix.size(); ++i) {
+            text[i] = prefix[i];
+        }
+        for (std::size_t i = length; i > prefix.size(); --i) {
+            text[i - 1] = static_cast<char>('0' + number % 10);
+            number /= 10;
+        }
+        return parse(std::string_view(text, length));
+    }
+
+    /**
+     * @param value A value previously returned by getPacked()
+     * @return The id
+     */
+    static constexpr AccountId fromPacked(std::uint64_t value) {
+        return AccountId(value);
+    }
+
+    constexpr std::uint64_t getPacked() const { return packed; }
+    constexpr bool isValid() const { return packed != 0; }
+
+    /**
+     * @return The numeric part (1 for "ACC001")
+     */
+    constexpr std::uint64_t getNumber() const {
+        return packed & kNumberMask;
+    }
+
+    /**
+     * Renders the id as text without allocating
+     * @return Inline buffer holding the text ("" for the invalid id)
+     */
+    constexpr AccountIdText text() const {
+        AccountIdText result;
+        if (!isValid()) {
+            return result;
+        }
+        std::uint8_t length = 0;
+        for (unsigned i = 0; i < kPrefixLetters; ++i) {
+            unsigned shift = kPrefixShift + kLetterBits * (kPrefixLetters - 1 - i);
+            std::uint64_t letter = (packed >> shift) & kLetterMask;
+            if (letter != 0) {
+                result.chars[length++] = static_cast<char>('A' + letter - 1);
+            }
+        }
+        unsigned digits = static_cast<unsigned>((packed >> kWidthShift) & kWidthMask);
+        std::uint64_t number = getNumber();
+        for (unsigned i = digits; i > 0; --i) {
+            result.chars[length + i - 1] = static_cast<char>('0' + number % 10);
+            number /= 10;
+        }
+        result.length = static_cast<std::uint8_t>(length + digits);
+        return result;
+    }
+
+    /**
+     * @return The id as a std::string (allocates; prefer text() in hot code)
+     */
+    std::string toString() const {
+        return std::string(text().view());
+    }
+
+    constexpr auto operator<=>(const AccountId &) const = default;
+};
+
+inline std::ostream &operator<<(std::ostream &out, AccountId id) {
+    return out << id.text().view();
+}
+
+/**
+ * Compile-time checked id literal: "ACC001"_acct
+ * A malformed literal is a compile error rather than a runtime surprise.
+ */
+consteval AccountId operator""_acct(const char *text, std::size_t length) {
+    std::optional<AccountId> id = AccountId::parse(std::string_view(text, length));
+    if (!id) {
+        throw "malformed account id literal";
+    }
+    return *id;
+}
+
+template <>
+struct std::hash<AccountId> {
+    std::size_t operator()(AccountId id) const noexcept {
+        // Fibonacci-style mix so sequential ids spread over the bucket range
+        std::uint64_t x = id.getPacked() * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(x ^ (x >> 32));
+    }
+};
+
+// Compile-time checks of the round trip
+static_assert(AccountId::parse("ACC001")->text().view() == "ACC001");
+static_assert(AccountId::make("ACC", 7)->text().view() == "ACC007");
+static_assert(AccountId::parse("AB12")->getNumber() == 12);
+static_assert(!AccountId::parse("acc1") && !AccountId::parse("ACC") && !AccountId::parse("ABCD1"));
+static_assert(AccountId::parse("ACC1") != AccountId::parse("ACC001"));
+
+#endif // ACCOUNT_ID_HPP
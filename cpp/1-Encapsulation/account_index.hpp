@@ -0,0 +1,290 @@
+#ifndef ACCOUNT_INDEX_HPP
+#define ACCOUNT_INDEX_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "account_id.hpp"
+
+/**
+ * ============================================================================
+ * FLAT HASH INDEX: packed AccountId -> store slot
+ * ============================================================================
+ *
+ * FlatAccountIndex is an open-addressing table with linear probing:
+ * - one flat array of 16-byte entries (key, slot), four per cache line; a
+ *   lookup is a multiply, a shift and usually a single cache line
+ * - no per-entry allocation; the table only allocates when it grows
+ * - the packed id 0 is never a valid AccountId, so it marks empty entries
+ * - erase uses backward-shift deletion, so there are no tombstones and
+ *   probe sequences stay short after many erases
+ * - the load factor is kept at or below 3/4
+ *
+ * CONCURRENCY: one writer, any number of readers
+ * insert and erase must be serialised by the caller (the owning store is
+ * single-writer anyway). find may run on any thread at the same time and
+ * never takes a lock:
+ * - an insert into an empty entry publishes the slot before the key, so a
+ *   reader either sees the whole entry or none of it
+ * - an erase shifts entries, so it runs inside a seqlock; a reader whose
+ *   probe overlapped an erase simply probes again
+ * - growing builds a new table and publishes it with one pointer store;
+ *   the old table is frozen and kept (retired) so readers still probing it
+ *   stay safe. reclaimRetired frees retired tables once the caller knows no
+ *   reader is inside find.
+ * ============================================================================
+ */
+
+// ============================================================================
+// CLASS DEFINITION: FlatAccountIndex
+// ============================================================================
+class FlatAccountIndex {
+public:
+    using Slot = std::uint32_t;
+
+private:
+    static constexpr std::uint64_t kEmpty = 0;
+    static constexpr std::size_t kMinCapacity = 16;
+
+    struct Entry {
+        std::atomic<std::uint64_t> key{kEmpty};   // Packed AccountId, 0 = empty
+        std::atomic<Slot> slot{0};                // Row in the store
+    };
+
+    struct Table {
+        std::unique_ptr<Entry[]> entries;
+        std::size_t capacity;   // Power of two
+        unsigned shift;         // 64 - log2(capacity), for Fibonacci hashing
+
+        explicit Table(std::size_t size)
+            : entries(new Entry[size]),
+              capacity(size),
+              shift(64u - static_cast<unsigned>(std::countr_zero(size))) {}
+
+        std::size_t home(std::uint64_t key) const {
+            // Fibonacci hashing spreads consecutive account numbers apart
+            return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
+        }
+
+        std::size_t next(std::size_t i) const { return (i + 1) & (capacity - 1); }
+    };
+
+    std::atomic<Table *> current;                  // Table readers probe
+    std::vector<std::unique_ptr<Table>> tables;    // current (last) plus retired tables
+    std::atomic<std::uint64_t> version{0};         // Seqlock: odd while an erase shifts entries
+    std::size_t count = 0;                         // Keys stored (writer only)
+
+    /**
+     * Stores a key known to be absent (writer only, no seqlock needed)
+     */
+    static void place(Table &table, std::uint64_t key, Slot slot) {
+        std::size_t i = table.home(key);
+        while (table.entries[i].key.load(std::memory_order_relaxed) != kEmpty) {
+            i = table.next(i);
+        }
+        table.entries[i].slot.store(slot, std::memory_order_relaxed);
+        table.entries[i].key.store(key, std::memory_order_release);
+    }
+
+    /**
+     * Replaces the table with one of newCapacity entries
+     */
+    void rehash(std::size_t newCapacity) {
+        Table &old = *current.load(std::memory_order_relaxed);
+        auto grown = std::make_unique<Table>(newCapacity);
+        for (std::size_t i = 0; i < old.capacity; ++i) {
+            std::uint64_t key = old.entries[i].key.load(std::memory_order_relaxed);
+            if (key != kEmpty) {
+                place(*grown, key, old.entries[i].slot.load(std::memory_order_relaxed));
+            }
+        }
+        current.store(grown.get(), std::memory_order_release);
+        tables.push_back(std::move(grown));
+    }
+
+    static std::size_t capacityFor(std::size_t keys) {
+        // Smallest power of two keeping keys at or below 3/4 load
+        return std::bit_ceil(std::max(kMinCapacity, keys + keys / 3 + 1));
+    }
+
+public:
+    /**
+     * @param expected Number of keys to size the first table for
+     */
+    explicit FlatAccountIndex(std::size_t expected = 0) {
+        tables.push_back(std::make_unique<Table>(capacityFor(expected)));
+        current.store(tables.back().get(), std::memory_order_relaxed);
+    }
+
+    FlatAccountIndex(const FlatAccountIndex &) = delete;
+    FlatAccountIndex &operator=(const FlatAccountIndex &) = delete;
+
+    /**
+     * Looks up an account; safe to call concurrently with the writer
+     *
+     * @param id The account number
+     * @return Its slot, or nullopt if the id is not indexed
+     */
+    std::optional<Slot> find(AccountId id) const {
+        const std::uint64_t key = id.getPacked();
+        if (key == kEmpty) {
+            return std::nullopt;
+        }
+        for (;;) {
+            std::uint64_t before = version.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;   // An erase is shifting entries
+            }
+            const Table &table = *current.load(std::memory_order_acquire);
+            std::optional<Slot> found;
+            for (std::size_t i = table.home(key);; i = table.next(i)) {
+                std::uint64_t stored = table.entries[i].key.load(std::memory_order_acquire);
+                if (stored == key) {
+                    found = table.entries[i].slot.load(std::memory_order_relaxed);
+                    break;
+                }
+                if (stored == kEmpty) {
+                    break;
+                }
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version.load(std::memory_order_relaxed) == before) {
+                return found;
+            }
+        }
+    }
+
+    /**
+     * @return true if the id is indexed
+     */
+    bool contains(AccountId id) const {
+        return find(id).has_value();
+    }
+
+    /**
+     * Adds an id (writer only)
+     *
+     * @param id The account number (must be valid)
+     * @param slot Its row in the store
+     * @return false if the id is invalid or already present
+     */
+    bool insert(AccountId id, Slot slot) {
+        const std::uint64_t key = id.getPacked();
+        if (key == kEmpty) {
+            return false;
+        }
+        Table *table = current.load(std::memory_order_relaxed);
+        std::size_t i = table->home(key);
+        for (;; i = table->next(i)) {
+            std::uint64_t stored = table->entries[i].key.load(std::memory_order_relaxed);
+            if (stored == key) {
+                return false;
+            }
+            if (stored == kEmpty) {
+                break;
+            }
+        }
+        if ((count + 1) * 4 > table->capacity * 3) {
+            rehash(table->capacity * 2);
+            place(*current.load(std::memory_order_relaxed), key, slot);
+        } else {
+            table->entries[i].slot.store(slot, std::memory_order_relaxed);
+            table->entries[i].key.store(key, std::memory_order_release);
+        }
+        ++count;
+        return true;
+    }
+
+    /**
+     * Removes an id (writer only), shifting later entries of its probe run
+     * back so that no tombstone is left behind
+     *
+     * @param id The account number
+     * @return false if the id was not present
+     */
+    bool erase(AccountId id) {
+        const std::uint64_t key = id.getPacked();
+        if (key == kEmpty) {
+            return false;
+        }
+        Table &table = *current.load(std::memory_order_relaxed);
+        std::size_t hole = table.home(key);
+        for (;; hole = table.next(hole)) {
+            std::uint64_t stored = table.entries[hole].key.load(std::memory_order_relaxed);
+            if (stored == key) {
+                break;
+            }
+            if (stored == kEmpty) {
+                return false;
+            }
+        }
+
+        std::uint64_t v = version.load(std::memory_order_relaxed);
+        version.store(v + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (std::size_t j = table.next(hole);; j = table.next(j)) {
+            std::uint64_t moving = table.entries[j].key.load(std::memory_order_relaxed);
+            if (moving == kEmpty) {
+                break;
+            }
+            // An entry may fill the hole only if its home is not in (hole, j]
+            std::size_t home = table.home(moving);
+            bool homeInRange = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+            if (!homeInRange) {
+                table.entries[hole].slot.store(table.entries[j].slot.load(std::memory_order_relaxed),
+                                               std::memory_order_relaxed);
+                table.entries[hole].key.store(moving, std::memory_order_relaxed);
+                hole = j;
+            }
+        }
+        table.entries[hole].key.store(kEmpty, std::memory_order_relaxed);
+        --count;
+
+        version.store(v + 2, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Grows the table so that expected keys fit without another rehash
+     * (writer only)
+     */
+    void reserve(std::size_t expected) {
+        std::size_t wanted = capacityFor(expected);
+        if (wanted > current.load(std::memory_order_relaxed)->capacity) {
+            rehash(wanted);
+        }
+    }
+
+    /**
+     * Removes every key (writer only; readers see a fresh, empty table)
+     */
+    void clear() {
+        auto empty = std::make_unique<Table>(kMinCapacity);
+        current.store(empty.get(), std::memory_order_release);
+        tables.push_back(std::move(empty));
+        count = 0;
+    }
+
+    /**
+     * Frees tables replaced by growth or clear
+     * Only call when no thread can be inside find.
+     */
+    void reclaimRetired() {
+        std::unique_ptr<Table> live = std::move(tables.back());
+        tables.clear();
+        tables.push_back(std::move(live));
+    }
+
+    std::size_t size() const { return count; }
+
+    std::size_t capacity() const { return current.load(std::memory_order_relaxed)->capacity; }
+};
+
+#endif // ACCOUNT_INDEX_HPP
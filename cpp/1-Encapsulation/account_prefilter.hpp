@@ -0,0 +1,383 @@
+#ifndef ACCOUNT_PREFILTER_HPP
+#define ACCOUNT_PREFILTER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "account_id.hpp"
+#include "account_status.hpp"
+#include "transaction.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define ACCOUNT_PREFILTER_HAS_AVX2 1
+#endif
+
+/**
+ * ============================================================================
+ * ACCOUNT PREFILTER: rejecting bad requests before touching the account
+ * ============================================================================
+ *
+ * A transfer naming an account that does not exist, or one that is frozen,
+ * still costs an index probe, a mailbox lock (ShardedAccountStore) or a
+ * queue slot before anything says no. AccountPrefilter answers "does this
+ * account exist, and does its status allow the money movement" from a few
+ * bytes, so such requests fail in a few nanoseconds (tens when the line
+ * has to come from memory), before any lookup or lock on the account
+ * itself.
+ *
+ * DENSE IDS: accounts numbered from one first id on, all written with the
+ * same number of digits (AccountId::make(prefix, n, digits)), are kept in
+ * a bitmap with 4 bits per id: exists, debits blocked, credits blocked.
+ * Answers for them are exact, and a million ids take 512 KiB.
+ *
+ * SPARSE IDS: every other id goes into a split-block Bloom filter (eight
+ * bits set in one 32-byte half of a 64-byte block). A miss means the
+ * account certainly does not exist; a hit means it may. The other half of
+ * the same block marks ids that were ever given a blocking status, so one
+ * cache line answers both questions, and only ids marked there look their
+ * status up in an exact table. The filters only grow: accounts are never
+ * removed, and an id that is unblocked again just costs that table lookup
+ * on later screens.
+ *
+ * A screen therefore never rejects a valid request, and passes only a
+ * small fraction of the bad ones (Bloom false positives, about 0.5% at the
+ * default 12 bits per sparse id) on to the store, which checks them again.
+ *
+ * AccountStore::setPrefilter keeps a prefilter current as accounts are
+ * opened, change status or are restored from a snapshot. Any number of
+ * threads may screen while the stores feeding it record, so one prefilter
+ * can serve every shard of a ShardedAccountStore. A screen racing a status
+ * change sees the status from before or after it; the store's own check
+ * settles the race.
+ * ============================================================================
+ */
+
+/**
+ * Sizing of an AccountPrefilter
+ */
+struct PrefilterOptions {
+    AccountId denseFirst;               // First dense id (invalid id = no dense range)
+    std::uint64_t denseCount = 0;       // Ids from denseFirst on kept in the bitmap
+    std::size_t expectedSparse = 0;     // Other ids expected (sizes the Bloom filters)
+    unsigned bitsPerSparseId = 12;      // Bloom filter bits per expected sparse id
+};
+
+namespace prefilter_detail {
+
+/**
+ * @return A well-mixed 64-bit hash of a packed account id (murmur3 finalizer)
+ */
+constexpr std::uint64_t mixId(std::uint64_t packed) {
+    packed ^= packed >> 33;
+    packed *= 0xFF51AFD7ED558CCDull;
+    packed ^= packed >> 33;
+    packed *= 0xC4CEB9FE1A85EC53ull;
+    packed ^= packed >> 33;
+    return packed;
+}
+
+// ============================================================================
+// CLASS DEFINITION: SparseIdFilter
+// ============================================================================
+/**
+ * Two insert-only split-block Bloom filters sharing one 64-byte block per
+ * key: the first half says "this id exists", the second "this id was
+ * blocked at some point". Both halves get the same eight bits (one per
+ * 32-bit word), so a probe reads a single cache line. Words are written
+ * with atomic ORs, so the filter may be written and read concurrently; a
+ * probe racing an insert may miss that insert's bits.
+ *
+ * On x86-64 CPUs with AVX2 (checked at runtime) a probe derives all eight
+ * bits and tests both halves with a handful of vector instructions.
+ */
+class SparseIdFilter {
+private:
+    struct alignas(64) Block {
+        std::uint32_t known[8];
+        std::uint32_t blocked[8];
+    };
+
+    // Odd multipliers picking one bit per word from the low half of the hash
+    alignas(32) static constexpr std::uint32_t kSalts[8] = {0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du,
+                                                            0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u};
+
+    std::unique_ptr<Block[]> blocks;
+    std::uint64_t blockCount = 0;
+    bool vectorProbe = false;   // Probe with AVX2
+
+    std::size_t blockOf(std::uint64_t hash) const {
+        return static_cast<std::size_t>(((hash >> 32) * blockCount) >> 32);
+    }
+
+    static std::uint32_t bitOf(std::uint64_t hash, unsigned word) {
+        return std::uint32_t{1} << ((static_cast<std::uint32_t>(hash) * kSalts[word]) >> 27);
+    }
+
+    static void insert(std::uint32_t (&words)[8], std::uint64_t hash) {
+        for (unsigned word = 0; word < 8; ++word) {
+            std::atomic_ref<std::uint32_t>(words[word]).fetch_or(bitOf(hash, word), std::memory_order_relaxed);
+        }
+    }
+
+    static bool mayContain(const std::uint32_t (&words)[8], std::uint64_t hash) {
+        std::uint32_t missing = 0;
+        for (unsigned word = 0; word < 8; ++word) {
+            const std::uint32_t bits =
+                std::atomic_ref<std::uint32_t>(const_cast<std::uint32_t &>(words[word])).load(std::memory_order_relaxed);
+            missing |= ~bits & bitOf(hash, word);
+        }
+        return missing == 0;
+    }
+
+#if defined(ACCOUNT_PREFILTER_HAS_AVX2)
+    /**
+     * @return Bit 0: the key's bits are all in the known half, bit 1: all
+     *         in the blocked half
+     */
+    __attribute__((target("avx2"))) static unsigned probeAvx2(const Block &block, std::uint64_t hash) {
+        const __m256i salts = _mm256_load_si256(reinterpret_cast<const __m256i *>(kSalts));
+        const __m256i key = _mm256_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(hash)));
+        const __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(key, salts), 27);
+        const __m256i bits = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+        // Word-wise relaxed loads keep the read race-free against insert()
+        alignas(32) std::uint32_t words[16];
+        for (unsigned word = 0; word < 8; ++word) {
+            words[word] = std::atomic_ref<std::uint32_t>(const_cast<std::uint32_t &>(block.known[word]))
+                              .load(std::memory_order_relaxed);
+            words[8 + word] = std::atomic_ref<std::uint32_t>(const_cast<std::uint32_t &>(block.blocked[word]))
+                                  .load(std::memory_order_relaxed);
+        }
+        const __m256i known = _mm256_load_si256(reinterpret_cast<const __m256i *>(words));
+        const __m256i blocked = _mm256_load_si256(reinterpret_cast<const __m256i *>(words + 8));
+        // testc(a, b) is 1 when every bit of b is set in a
+        return static_cast<unsigned>(_mm256_testc_si256(known, bits)) |
+               static_cast<unsigned>(_mm256_testc_si256(blocked, bits)) << 1;
+    }
+#endif
+
+public:
+    /**
+     * @param keys Keys expected
+     * @param bitsPerKey Bits of the "exists" half per expected key
+     */
+    SparseIdFilter(std::size_t keys, unsigned bitsPerKey) {
+        std::uint64_t bits = static_cast<std::uint64_t>(keys) * bitsPerKey;
+        blockCount = std::max<std::uint64_t>(1, std::min<std::uint64_t>((bits + 255) / 256, 0xFFFFFFFFu));
+        blocks = std::make_unique<Block[]>(static_cast<std::size_t>(blockCount));
+#if defined(ACCOUNT_PREFILTER_HAS_AVX2)
+        vectorProbe = __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    void insertKnown(std::uint64_t hash) {
+        insert(blocks[blockOf(hash)].known, hash);
+    }
+
+    void insertBlocked(std::uint64_t hash) {
+        insert(blocks[blockOf(hash)].blocked, hash);
+    }
+
+    /**
+     * @return true if the key may have been inserted as blocked
+     */
+    bool mayBeBlocked(std::uint64_t hash) const {
+        return mayContain(blocks[blockOf(hash)].blocked, hash);
+    }
+
+    /**
+     * @param blocked Set to whether the key may have been inserted as blocked
+     * @return false if the key was certainly never inserted
+     */
+    bool mayBeKnown(std::uint64_t hash, bool &blocked) const {
+        const Block &block = blocks[blockOf(hash)];
+#if defined(ACCOUNT_PREFILTER_HAS_AVX2)
+        if (vectorProbe) {
+            const unsigned found = probeAvx2(block, hash);
+            blocked = (found & 2) != 0;
+            return (found & 1) != 0;
+        }
+#endif
+        if (!mayContain(block.known, hash)) {
+            return false;
+        }
+        blocked = mayContain(block.blocked, hash);
+        return true;
+    }
+
+    std::size_t getBytes() const {
+        return static_cast<std::size_t>(blockCount) * sizeof(Block);
+    }
+};
+
+} // namespace prefilter_detail
+
+// ============================================================================
+// CLASS DEFINITION: AccountPrefilter
+// ============================================================================
+class AccountPrefilter {
+private:
+    // Per-id state: the two AccountStatus bits shifted up, plus "exists"
+    static constexpr std::uint8_t kExists = 1;
+    static constexpr std::uint8_t kDebitsBlocked = account_status::kDebitsBlockedBit << 1;
+    static constexpr std::uint8_t kCreditsBlocked = account_status::kCreditsBlockedBit << 1;
+    static constexpr unsigned kDenseBits = 4;
+    static constexpr unsigned kDensePerWord = 64 / kDenseBits;
+
+    // DENSE RANGE - packed ids [denseFirst, denseFirst + denseCount)
+    std::uint64_t denseFirst;
+    std::uint64_t denseCount;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> denseWords;
+
+    // SPARSE IDS
+    prefilter_detail::SparseIdFilter sparse;   // Every sparse id recorded, and those ever blocked
+    mutable std::shared_mutex restrictedMutex;
+    std::unordered_map<AccountId, AccountStatus> restrictedStatus;   // Sparse ids blocked now
+
+    static constexpr std::uint8_t stateOf(AccountStatus status) {
+        return static_cast<std::uint8_t>(kExists | (static_cast<std::uint8_t>(status) << 1));
+    }
+
+    /**
+     * @return State bits of an id; kExists may be a Bloom false positive,
+     *         the blocked bits never are
+     */
+    std::uint8_t lookup(AccountId id) const {
+        const std::uint64_t offset = id.getPacked() - denseFirst;
+        if (offset < denseCount) {
+            const std::uint64_t word = denseWords[offset / kDensePerWord].load(std::memory_order_relaxed);
+            return static_cast<std::uint8_t>((word >> (offset % kDensePerWord * kDenseBits)) & 0xF);
+        }
+        const std::uint64_t hash = prefilter_detail::mixId(id.getPacked());
+        bool mayBeBlocked = false;
+        if (!sparse.mayBeKnown(hash, mayBeBlocked)) {
+            return 0;
+        }
+        if (!mayBeBlocked) {
+            return kExists;
+        }
+        std::shared_lock<std::shared_mutex> lock(restrictedMutex);
+        auto it = restrictedStatus.find(id);
+        return stateOf(it == restrictedStatus.end() ? AccountStatus::Active : it->second);
+    }
+
+    static TransactionStatus verdict(std::uint8_t state, std::uint8_t blockedBit) {
+        if ((state & kExists) == 0) {
+            return TransactionStatus::AccountNotFound;
+        }
+        return (state & blockedBit) != 0 ? TransactionStatus::AccountFrozen : TransactionStatus::Success;
+    }
+
+public:
+    /**
+     * @param options Dense range and sparse sizing
+     */
+    explicit AccountPrefilter(const PrefilterOptions &options)
+        : denseFirst(options.denseFirst.getPacked()),
+          denseCount(options.denseFirst.isValid() ? options.denseCount : 0),
+          sparse(options.expectedSparse, options.bitsPerSparseId) {
+        denseWords = std::make_unique<std::atomic<std::uint64_t>[]>(
+            static_cast<std::size_t>((denseCount + kDensePerWord - 1) / kDensePerWord));
+    }
+
+    AccountPrefilter(const AccountPrefilter &) = delete;
+    AccountPrefilter &operator=(const AccountPrefilter &) = delete;
+
+    /**
+     * Records that an account exists with a status (repeating it is harmless)
+     * Called by the AccountStores the prefilter is attached to.
+     *
+     * @param id The account number
+     * @param status Its current status
+     */
+    void record(AccountId id, AccountStatus status) {
+        const std::uint64_t offset = id.getPacked() - denseFirst;
+        if (offset < denseCount) {
+            std::atomic<std::uint64_t> &word = denseWords[offset / kDensePerWord];
+            const unsigned shift = static_cast<unsigned>(offset % kDensePerWord * kDenseBits);
+            const std::uint64_t bits = static_cast<std::uint64_t>(stateOf(status)) << shift;
+            std::uint64_t current = word.load(std::memory_order_relaxed);
+            // Replace the nibble in one step, so readers never see the id missing
+            while (!word.compare_exchange_weak(current, (current & ~(std::uint64_t{0xF} << shift)) | bits,
+                                               std::memory_order_relaxed)) {
+            }
+            return;
+        }
+        const std::uint64_t hash = prefilter_detail::mixId(id.getPacked());
+        std::unique_lock<std::shared_mutex> lock(restrictedMutex, std::defer_lock);
+        if (status != AccountStatus::Active) {
+            lock.lock();
+            restrictedStatus.insert_or_assign(id, status);
+            sparse.insertBlocked(hash);
+        } else if (sparse.mayBeBlocked(hash)) {
+            lock.lock();
+            restrictedStatus.erase(id);
+        }
+        sparse.insertKnown(hash);
+    }
+
+    // ========================================================================
+    // SCREENS (any thread, any time)
+    // ========================================================================
+
+    /**
+     * @return false if the account certainly does not exist
+     */
+    bool mayExist(AccountId id) const {
+        return (lookup(id) & kExists) != 0;
+    }
+
+    /**
+     * @return AccountNotFound, AccountFrozen (credits blocked), or Success
+     *         if the store has to decide
+     */
+    TransactionStatus screenDeposit(AccountId id) const {
+        return verdict(lookup(id), kCreditsBlocked);
+    }
+
+    /**
+     * @return AccountNotFound, AccountFrozen (debits blocked), or Success
+     *         if the store has to decide
+     */
+    TransactionStatus screenWithdraw(AccountId id) const {
+        return verdict(lookup(id), kDebitsBlocked);
+    }
+
+    /**
+     * Screens both ends of a transfer
+     *
+     * @param from The account debited
+     * @param to The account credited
+     * @return AccountNotFound if either end certainly does not exist,
+     *         AccountFrozen if the source blocks debits or the destination
+     *         blocks credits, otherwise Success (the store decides)
+     */
+    TransactionStatus screenTransfer(AccountId from, AccountId to) const {
+        const std::uint8_t source = lookup(from);
+        const std::uint8_t destination = lookup(to);
+        if ((source & destination & kExists) == 0) {
+            return TransactionStatus::AccountNotFound;
+        }
+        if ((source & kDebitsBlocked) != 0 || (destination & kCreditsBlocked) != 0) {
+            return TransactionStatus::AccountFrozen;
+        }
+        return TransactionStatus::Success;
+    }
+
+    /**
+     * @return Bytes held by the bitmap and the Bloom filters
+     */
+    std::size_t getMemoryBytes() const {
+        return static_cast<std::size_t>((denseCount + kDensePerWord - 1) / kDensePerWord) *
+                   sizeof(std::uint64_t) +
+               sparse.getBytes();
+    }
+};
+
+#endif // ACCOUNT_PREFILTER_HPP
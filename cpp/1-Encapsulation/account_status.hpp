@@ -0,0 +1,80 @@
+#ifndef ACCOUNT_STATUS_HPP
+#define ACCOUNT_STATUS_HPP
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string_view>
+
+// ============================================================================
+// ENUM DEFINITION: AccountStatus
+// ============================================================================
+/**
+ * Which kinds of money movement an account currently accepts
+ * Two flag bits (bit 0 = debits blocked, bit 1 = credits blocked), so every
+ * combination is a valid value and the status fits a one-byte column.
+ * Interest keeps accruing whatever the status: a freeze stops the customer
+ * moving money, not the bank paying what it owes.
+ */
+enum class AccountStatus : std::uint8_t {
+    Active = 0,           // Everything allowed
+    DebitsBlocked = 1,    // No withdrawals or outgoing transfers
+    CreditsBlocked = 2,   // No deposits or incoming transfers
+    Frozen = 3            // Neither
+};
+
+namespace account_status {
+
+constexpr std::uint8_t kDebitsBlockedBit = 1;
+constexpr std::uint8_t kCreditsBlockedBit = 2;
+
+/**
+ * @return true if money may not leave an account with this status
+ */
+constexpr bool blocksDebits(AccountStatus status) {
+    return (static_cast<std::uint8_t>(status) & kDebitsBlockedBit) != 0;
+}
+
+/**
+ * @return true if money may not enter an account with this status
+ */
+constexpr bool blocksCredits(AccountStatus status) {
+    return (static_cast<std::uint8_t>(status) & kCreditsBlockedBit) != 0;
+}
+
+/**
+ * @param bits A raw status byte (from a journal record or a file)
+ * @return The status, or std::nullopt if the byte has unknown bits set
+ */
+constexpr std::optional<AccountStatus> fromBits(std::uint64_t bits) {
+    if (bits > static_cast<std::uint8_t>(AccountStatus::Frozen)) {
+        return std::nullopt;
+    }
+    return static_cast<AccountStatus>(bits);
+}
+
+} // namespace account_status
+
+/**
+ * @param status The account status
+ * @return Display name of the status ("Active", "Frozen", ...)
+ */
+constexpr std::string_view toString(AccountStatus status) {
+    switch (status) {
+    case AccountStatus::Active:
+        return "Active";
+    case AccountStatus::DebitsBlocked:
+        return "DebitsBlocked";
+    case AccountStatus::CreditsBlocked:
+        return "CreditsBlocked";
+    case AccountStatus::Frozen:
+        return "Frozen";
+    }
+    return "Unknown";
+}
+
+inline std::ostream &operator<<(std::ostream &out, AccountStatus status) {
+    return out << toString(status);
+}
+
+#endif // ACCOUNT_STATUS_HPP
@@ -0,0 +1,848 @@
+#ifndef ACCOUNT_STORE_HPP
+#define ACCOUNT_STORE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "account_id.hpp"
+#include "account_index.hpp"
+#include "account_prefilter.hpp"
+#include "account_status.hpp"
+#include "account_type.hpp"
+#include "journal_record.hpp"
+#include "money.hpp"
+#include "operation_metrics.hpp"
+#include "store_aggregates.hpp"
+#include "store_column.hpp"
+#include "transaction.hpp"
+
+/**
+ * ============================================================================
+ * STRUCT-OF-ARRAYS ACCOUNT STORAGE
+ * ============================================================================
+ *
+ * BankAccount keeps every field of one account together in one object. That
+ * is the natural OOP layout, but a scan over millions of balances then pulls
+ * the strings sitting next to each balance through the cache as well.
+ *
+ * AccountStore keeps the same data column by column instead:
+ * - HOT columns (balance, rate, type) are contiguous arrays, so a scan reads
+ *   nothing but the values it needs, in order.
+ * - COLD fields (holder name) sit in a separate side table that balance
+ *   scans never touch. Account numbers are packed 8-byte AccountIds kept in
+ *   their own column.
+ *
+ * Account numbers are unique within a store. A FlatAccountIndex
+ * (account_index.hpp) maps each one to its slot, so find is O(1) and open
+ * rejects duplicates.
+ *
+ * Columns are Column<T> arrays (store_column.hpp), so a store can also be
+ * restored from a memory-mapped snapshot and use it in place (snapshot.hpp).
+ *
+ * Encapsulation is kept at the API level: callers never see the columns as
+ * writable arrays, they get an AccountRef handle (store pointer + slot index)
+ * with the same deposit/withdraw/transfer methods as BankAccount.
+ *
+ * AGGREGATES:
+ * Every mutator also adjusts the store's running totals (balance per type,
+ * account and zero-balance counts, interest this period; see
+ * store_aggregates.hpp). totals() reads them in O(1) from any thread, so
+ * dashboards never need a scan.
+ *
+ * LAZY ACCRUAL:
+ * By default interest reaches the balances only when something applies it
+ * (AccountRef::applyInterest, InterestEngine), which means sweeping every
+ * account once per period even if most of them are dormant. With
+ * setLazyAccrual(true) the store keeps, per account, the accrual period it
+ * was last brought up to date in. advanceAccrualPeriod is then O(1): an
+ * account compounds the periods it missed the next time it is read or
+ * mutated (AccountRef, BatchPoster, TransferBatch, InterestEngine) and
+ * when a snapshot is written. Balances are the same, cent for cent, as
+ * applying interest to every account every period. Column scans and
+ * totals() only see interest already settled; settleInterest() settles
+ * every account first. In this mode reading a balance may write it.
+ *
+ * JOURNALING:
+ * With a RecordSink attached (setRecordSink), every successful mutation -
+ * through AccountRef, InterestEngine or BatchPoster - is also handed to the
+ * sink as a JournalRecord (see journal.hpp). Without one, nothing is
+ * recorded and the mutators cost one extra pointer test. A transfer into
+ * another store is journaled as a Withdraw to this store's sink and a
+ * Deposit to the other store's, so each journal replays without the other.
+ *
+ * STATUS:
+ * Each account has an AccountStatus (account_status.hpp). A status that
+ * blocks debits makes withdraw, transfer from the account, BatchPoster
+ * withdrawals and TransferBatch legs out of it fail with AccountFrozen;
+ * blocking credits does the same for money coming in. Interest still
+ * accrues. While every account is Active (the store counts the others)
+ * the mutators do not even read the status column. setPrefilter attaches
+ * an AccountPrefilter that the store keeps current, for callers that want
+ * to turn bad requests away before they reach the store.
+ *
+ * VERSIONS:
+ * Every mutator also flags the page of kVersionPageAccounts slots it
+ * wrote. StoreVersions (store_versions.hpp) uses the flags to publish
+ * point-in-time copies of the hot columns that other threads can scan
+ * while this store keeps being written, copying only the pages that
+ * changed since the previous version.
+ *
+ * The store is not thread-safe; synchronise externally or give each thread
+ * its own store.
+ * ============================================================================
+ */
+
+// Index of an account inside an AccountStore
+using AccountSlot = std::uint32_t;
+
+// Accounts per page of the change flags (and of a StoreVersions page)
+constexpr unsigned kVersionPageShift = 10;
+constexpr std::size_t kVersionPageAccounts = std::size_t{1} << kVersionPageShift;
+
+class AccountStore;
+class ShardedAccountStore;
+
+// ============================================================================
+// CLASS DEFINITION: AccountRef
+// ============================================================================
+/**
+ * Lightweight handle to one account in an AccountStore
+ * Copying it is as cheap as copying a pointer; it stays valid as long as
+ * the store is alive (slots are never reused or moved).
+ */
+class AccountRef {
+private:
+    friend class ShardedAccountStore;
+
+    AccountStore *store;   // Store that owns the account
+    AccountSlot slot;      // Row of the account in every column
+
+    TransactionResult debit(Money amount);
+    TransactionResult withdrawHeld(Money amount);
+
+public:
+    AccountRef(AccountStore &owner, AccountSlot index) : store(&owner), slot(index) {}
+
+    AccountSlot getSlot() const { return slot; }
+
+    AccountId getAccountNumber() const;
+    std::string_view getAccountHolder() const;
+    AccountType getAccountType() const;
+    Money getBalance() const;
+    InterestRate getInterestRate() const;
+    AccountStatus getStatus() const;
+
+    TransactionStatus setInterestRate(InterestRate rate);
+    TransactionStatus setAccountHolder(std::string newHolder);
+    void setStatus(AccountStatus status);
+
+    TransactionResult deposit(Money amount);
+    TransactionResult withdraw(Money amount);
+    TransactionResult transfer(AccountRef toAccount, Money amount);
+    TransactionResult applyInterest(RoundingMode mode = RoundingMode::HalfEven);
+    TransactionResult creditInterest(Money interest);
+
+    bool operator==(const AccountRef &) const = default;
+};
+
+// ============================================================================
+// CLASS DEFINITION: AccountStore
+// ============================================================================
+class AccountStore {
+private:
+    friend class AccountRef;
+    friend class BatchPoster;
+    friend class InterestEngine;
+    friend class MappedSnapshot;
+    friend class SnapshotWriter;
+    friend class StoreVersions;
+    friend class TransferBatch;
+
+    // HOT COLUMNS - one entry per account, indexed by AccountSlot
+    Column<std::int64_t> balances;   // Balance in cents
+    Column<std::int32_t> rates;      // Interest rate in basis points
+    Column<AccountType> types;       // Product type
+    Column<AccountId> accountNumbers;   // Packed account ids
+    Column<AccountStatus> statuses;     // Which money movements are blocked
+
+    // COLD SIDE TABLE - only read when an individual account is inspected
+    HolderColumn holders;
+
+    // LOOKUP - account number -> slot for slots [0, indexedSlots)
+    FlatAccountIndex index;
+    std::size_t indexedSlots = 0;   // Rows restored from a snapshot are indexed on first lookup
+
+    RecordSink *recordSink = nullptr;   // Journal for mutations (nullptr = none)
+
+    std::size_t restrictedAccounts = 0;     // Accounts whose status is not Active
+    AccountPrefilter *prefilter = nullptr;  // Kept current with every id and status (nullptr = none)
+
+    StoreAggregates aggregates;         // Running totals, adjusted by every mutator
+
+    // LAZY ACCRUAL - lastAccrual is empty unless lazyAccrual is set
+    bool lazyAccrual = false;
+    RoundingMode accrualRounding = RoundingMode::HalfEven;
+    std::uint32_t accrualPeriod = 0;       // Current period of the accrual clock
+    Column<std::uint32_t> lastAccrual;     // Period each account is accrued through
+
+    // VERSIONS - one flag per page of kVersionPageAccounts slots, set when
+    // any hot column of the page is written, cleared by StoreVersions
+    Column<std::uint8_t> changedPages;
+
+    /**
+     * Flags the page of a slot as changed
+     * A relaxed atomic byte store, so month-end workers writing neighbouring
+     * ranges may flag the same page at once.
+     */
+    void markChanged(std::size_t slot) {
+        std::atomic_ref<std::uint8_t> flag(changedPages[slot >> kVersionPageShift]);
+        flag.store(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Flags every page overlapping the slots [begin, end)
+     */
+    void markChangedRange(std::size_t begin, std::size_t end) {
+        if (begin == end) {
+            return;
+        }
+        for (std::size_t page = begin >> kVersionPageShift; page <= (end - 1) >> kVersionPageShift; ++page) {
+            std::atomic_ref<std::uint8_t>(changedPages[page]).store(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Sizes the flags for the current columns and flags every page (after
+     * the columns were replaced wholesale)
+     */
+    void markAllChanged() {
+        changedPages.clear();
+        changedPages.resize((balances.size() + kVersionPageAccounts - 1) >> kVersionPageShift, 1);
+    }
+
+    /**
+     * Indexes any rows that are not in the index yet
+     */
+    void catchUpIndex() {
+        if (indexedSlots == accountNumbers.size()) {
+            return;
+        }
+        index.reserve(accountNumbers.size());
+        for (; indexedSlots < accountNumbers.size(); ++indexedSlots) {
+            index.insert(accountNumbers[indexedSlots], static_cast<AccountSlot>(indexedSlots));
+        }
+    }
+
+    /**
+     * @return true if the status of a slot refuses withdrawals
+     */
+    bool blocksDebits(AccountSlot slot) const {
+        return restrictedAccounts != 0 && account_status::blocksDebits(statuses[slot]);
+    }
+
+    /**
+     * @return true if the status of a slot refuses deposits
+     */
+    bool blocksCredits(AccountSlot slot) const {
+        return restrictedAccounts != 0 && account_status::blocksCredits(statuses[slot]);
+    }
+
+    /**
+     * Records every account and its status in the prefilter, if one is attached
+     */
+    void feedPrefilter() {
+        if (!prefilter) {
+            return;
+        }
+        for (std::size_t i = 0; i < statuses.size(); ++i) {
+            prefilter->record(accountNumbers[i], statuses[i]);
+        }
+    }
+
+    /**
+     * Recounts the restricted accounts and refills the prefilter with one
+     * scan (after the columns were replaced wholesale)
+     */
+    void recomputeStatuses() {
+        restrictedAccounts = 0;
+        for (AccountStatus status : statuses) {
+            restrictedAccounts += status != AccountStatus::Active;
+        }
+        feedPrefilter();
+    }
+
+    /**
+     * Recomputes the running totals with one scan (after the columns were
+     * replaced wholesale)
+     */
+    void recomputeAggregates() {
+        StoreTotals totals;
+        std::array<std::int64_t, kAccountTypeCount> byType{};
+        for (std::size_t i = 0; i < balances.size(); ++i) {
+            byType[static_cast<std::size_t>(types[i])] += balances[i];
+            totals.zeroBalanceAccounts += balances[i] == 0;
+        }
+        for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+            totals.byType[t] = Money::fromMinorUnits(byType[t]);
+        }
+        totals.accounts = balances.size();
+        aggregates.reset(totals);
+    }
+
+    /**
+     * Brings one account's interest up to the current accrual period
+     * Costs one branch unless the store accrues lazily.
+     */
+    void settle(AccountSlot slot) {
+        if (lazyAccrual && lastAccrual[slot] != accrualPeriod) {
+            settleMissedPeriods(slot);
+        }
+    }
+
+    /**
+     * Compounds the periods an account missed, one period at a time (the
+     * same rounding as applying them one by one), and journals the sum as
+     * one Interest record
+     */
+    void settleMissedPeriods(AccountSlot slot) {
+        std::uint32_t missed = accrualPeriod - lastAccrual[slot];
+        lastAccrual[slot] = accrualPeriod;
+        markChanged(slot);
+        std::int64_t &balance = balances[slot];
+        InterestRate rate = InterestRate::fromBasisPoints(rates[slot]);
+        std::int64_t credited = 0;
+        for (std::uint32_t p = 0; p < missed; ++p) {
+            Money interest = computeInterest(Money::fromMinorUnits(balance), rate, accrualRounding);
+            if (interest.isZero()) {
+                break;   // The balance did not move, so no later period credits anything either
+            }
+            balance += interest.getMinorUnits();
+            credited += interest.getMinorUnits();
+        }
+        if (credited != 0) {
+            aggregates.onInterest(types[slot], credited);
+            emit(journal::makeRecord(JournalOp::Interest, accountNumbers[slot],
+                                     Money::fromMinorUnits(credited), Money::fromMinorUnits(balance)));
+        }
+    }
+
+    /**
+     * Settles the slots [begin, end)
+     */
+    void settleRange(std::size_t begin, std::size_t end) {
+        if (!lazyAccrual) {
+            return;
+        }
+        for (std::size_t i = begin; i < end; ++i) {
+            settle(static_cast<AccountSlot>(i));
+        }
+    }
+
+    /**
+     * Hands a record to the sink, if one is attached
+     */
+    void emit(const JournalRecord &record) {
+        if (recordSink) {
+            recordSink->append(record);
+        }
+    }
+
+public:
+    /**
+     * Pre-allocates every column for a known number of accounts
+     * @param count Number of accounts expected
+     */
+    void reserve(std::size_t count) {
+        balances.reserve(count);
+        rates.reserve(count);
+        types.reserve(count);
+        accountNumbers.reserve(count);
+        statuses.reserve(count);
+        holders.reserve(count);
+        index.reserve(count);
+        if (lazyAccrual) {
+            lastAccrual.reserve(count);
+        }
+    }
+
+    /**
+     * Adds an account to the store
+     * Unlike the BankAccount constructor this does no I/O.
+     *
+     * @param accNum The account number (must be valid and not in the store)
+     * @param holder The name of account holder
+     * @param initialBalance Initial amount in the account
+     * @param type Type of account
+     * @param rate Interest rate
+     * @return Handle to the new account, or nullopt if the number is invalid
+     *         or already taken
+     */
+    std::optional<AccountRef> open(AccountId accNum, std::string holder, Money initialBalance,
+                                   AccountType type = AccountType::Savings,
+                                   InterestRate rate = InterestRate()) {
+        catchUpIndex();
+        AccountSlot slot = static_cast<AccountSlot>(balances.size());
+        if (!index.insert(accNum, slot)) {
+            return std::nullopt;
+        }
+        ++indexedSlots;
+        balances.push_back(initialBalance.getMinorUnits());
+        rates.push_back(rate.getBasisPoints());
+        types.push_back(type);
+        accountNumbers.push_back(accNum);
+        statuses.push_back(AccountStatus::Active);
+        holders.push_back(std::move(holder));
+        if (lazyAccrual) {
+            lastAccrual.push_back(accrualPeriod);
+        }
+        if ((slot >> kVersionPageShift) == changedPages.size()) {
+            changedPages.push_back(1);   // First account of a new page
+        } else {
+            markChanged(slot);
+        }
+        aggregates.onOpen(type, initialBalance.getMinorUnits());
+        if (prefilter) {
+            prefilter->record(accNum, AccountStatus::Active);
+        }
+        if (recordSink) {
+            recordSink->append(journal::makeOpen(accNum, type, rate, initialBalance));
+            recordSink->appendHolderName(accNum, holders[slot]);
+        }
+        return AccountRef(*this, slot);
+    }
+
+    /**
+     * Closes every account; the record sink, prefilter and accrual settings
+     * stay, and nothing is journaled
+     * An attached prefilter keeps the ids and statuses it was given: a
+     * request for a closed id may pass it (the store then refuses it) or
+     * be refused as frozen, never treated as an existing account.
+     * Like any writer call that invalidates slots, it must not overlap
+     * lookups through lookupIndex(); the index tables it replaces are freed.
+     */
+    void clear() {
+        balances.clear();
+        rates.clear();
+        types.clear();
+        accountNumbers.clear();
+        statuses.clear();
+        holders.clear();
+        lastAccrual.clear();
+        index.clear();
+        index.reclaimRetired();
+        indexedSlots = 0;
+        restrictedAccounts = 0;
+        markAllChanged();
+        aggregates.reset();
+    }
+
+    /**
+     * Looks an account up by number
+     *
+     * @param accNum The account number
+     * @return Handle to the account, or nullopt if it is not in the store
+     */
+    std::optional<AccountRef> find(AccountId accNum) {
+        catchUpIndex();
+        std::optional<AccountSlot> slot = index.find(accNum);
+        if (!slot) {
+            return std::nullopt;
+        }
+        return AccountRef(*this, *slot);
+    }
+
+    /**
+     * Returns the index for lock-free lookups from other threads
+     * FlatAccountIndex::find may run concurrently with this store's writer
+     * (open); it sees every account opened before the call.
+     *
+     * @return The account number -> slot index, brought up to date
+     */
+    const FlatAccountIndex &lookupIndex() {
+        catchUpIndex();
+        return index;
+    }
+
+    /**
+     * Frees the index tables retired as the index grew
+     * Readers from lookupIndex() may still be probing a retired table, so
+     * call this only when none of them is inside find (e.g. after a bulk
+     * import's threads have joined). clear and restores reclaim on their own.
+     */
+    void reclaimIndexMemory() {
+        index.reclaimRetired();
+    }
+
+    /**
+     * Attaches (or detaches, with nullptr) the sink that journals mutations
+     * @param sink The sink; must outlive its attachment to the store
+     */
+    void setRecordSink(RecordSink *sink) {
+        recordSink = sink;
+    }
+
+    RecordSink *getRecordSink() const {
+        return recordSink;
+    }
+
+    /**
+     * Attaches (or detaches, with nullptr) a prefilter to keep current
+     * Every account already in the store is recorded in it first (one
+     * scan); afterwards open, setStatus and snapshot restores update it.
+     * Several stores may feed one prefilter.
+     *
+     * @param filter The prefilter; must outlive its attachment to the store
+     */
+    void setPrefilter(AccountPrefilter *filter) {
+        prefilter = filter;
+        feedPrefilter();
+    }
+
+    AccountPrefilter *getPrefilter() const {
+        return prefilter;
+    }
+
+    /**
+     * @return Number of accounts whose status is not Active
+     */
+    std::size_t getRestrictedCount() const {
+        return restrictedAccounts;
+    }
+
+    /**
+     * @return Number of accounts in the store
+     */
+    std::size_t size() const {
+        return balances.size();
+    }
+
+    /**
+     * @param slot Index of the account (must be < size())
+     * @return Handle to the account
+     */
+    AccountRef at(AccountSlot slot) {
+        return AccountRef(*this, slot);
+    }
+
+    // ========================================================================
+    // READ-ONLY COLUMN ACCESS (for scans)
+    // ========================================================================
+    std::span<const std::int64_t> balanceColumn() const { return balances; }
+    std::span<const std::int32_t> rateColumn() const { return rates; }
+    std::span<const AccountType> typeColumn() const { return types; }
+    std::span<const AccountId> accountNumberColumn() const { return accountNumbers; }
+    std::span<const AccountStatus> statusColumn() const { return statuses; }
+
+    /**
+     * Reads the running totals without scanning
+     * Safe to call from any thread, also while the store is being written.
+     *
+     * @return Balance per type, account counts and interest this period
+     */
+    StoreTotals totals() const {
+        return aggregates.read();
+    }
+
+    /**
+     * Starts a new interest period
+     * @return Interest credited during the period that just ended
+     */
+    Money closeInterestPeriod() {
+        return aggregates.closeInterestPeriod();
+    }
+
+    // ========================================================================
+    // LAZY ACCRUAL
+    // ========================================================================
+
+    /**
+     * Switches between eager and lazy interest accrual
+     * Enabling starts every account at the current accrual period; disabling
+     * settles every account first.
+     *
+     * @param enabled true to accrue lazily
+     * @param mode Rounding used for lazily accrued interest
+     */
+    void setLazyAccrual(bool enabled, RoundingMode mode = RoundingMode::HalfEven) {
+        if (enabled == lazyAccrual) {
+            accrualRounding = mode;
+            return;
+        }
+        if (enabled) {
+            lastAccrual.clear();
+            lastAccrual.resize(balances.size(), accrualPeriod);
+        } else {
+            settleInterest();
+            lastAccrual.clear();
+        }
+        lazyAccrual = enabled;
+        accrualRounding = mode;
+    }
+
+    bool isLazyAccrual() const {
+        return lazyAccrual;
+    }
+
+    /**
+     * Moves the accrual clock forward without touching any account
+     * A lazy store credits the elapsed periods to each account when it is
+     * next used; an eager store ignores the clock.
+     *
+     * @param periods Number of interest periods that elapsed
+     */
+    void advanceAccrualPeriod(std::uint32_t periods = 1) {
+        accrualPeriod += periods;
+    }
+
+    std::uint32_t getAccrualPeriod() const {
+        return accrualPeriod;
+    }
+
+    /**
+     * Credits all pending lazy interest (one pass over the store)
+     * Afterwards the columns and totals() include every elapsed period.
+     */
+    void settleInterest() {
+        settleRange(0, balances.size());
+    }
+
+    /**
+     * Sums every balance with one sequential pass over the balance column
+     * (totals().total() gives the same figure without the scan); pending
+     * lazy interest is not included
+     * @return Total money held in the store
+     */
+    Money totalBalance() const {
+        std::int64_t total = 0;
+        for (std::int64_t cents : balances) {
+            total += cents;
+        }
+        return Money::fromMinorUnits(total);
+    }
+};
+
+// ============================================================================
+// AccountRef MEMBER FUNCTIONS
+// ============================================================================
+inline AccountId AccountRef::getAccountNumber() const {
+    return store->accountNumbers[slot];
+}
+
+inline std::string_view AccountRef::getAccountHolder() const {
+    return store->holders[slot];
+}
+
+inline AccountType AccountRef::getAccountType() const {
+    return store->types[slot];
+}
+
+inline Money AccountRef::getBalance() const {
+    store->settle(slot);
+    return Money::fromMinorUnits(store->balances[slot]);
+}
+
+inline InterestRate AccountRef::getInterestRate() const {
+    return InterestRate::fromBasisPoints(store->rates[slot]);
+}
+
+inline AccountStatus AccountRef::getStatus() const {
+    return store->statuses[slot];
+}
+
+inline TransactionStatus AccountRef::setInterestRate(InterestRate rate) {
+    metrics::OperationTimer timer(metrics::Operation::SetInterestRate);
+    if (!account_rules::isValidRate(rate)) {
+        return timer.finish(TransactionStatus::InvalidRate);
+    }
+    store->settle(slot);   // Periods already elapsed accrue at the old rate
+    store->rates[slot] = rate.getBasisPoints();
+    store->markChanged(slot);
+    store->emit(journal::makeRateChange(getAccountNumber(), rate, getBalance()));
+    return timer.finish(TransactionStatus::Success);
+}
+
+inline TransactionStatus AccountRef::setAccountHolder(std::string newHolder) {
+    metrics::OperationTimer timer(metrics::Operation::SetAccountHolder);
+    if (newHolder.empty()) {
+        return timer.finish(TransactionStatus::InvalidHolderName);
+    }
+    store->holders.set(slot, std::move(newHolder));
+    if (store->recordSink) {
+        store->recordSink->appendHolderName(getAccountNumber(), store->holders[slot]);
+    }
+    return timer.finish(TransactionStatus::Success);
+}
+
+/**
+ * Changes which money movements the account accepts (journaled when it
+ * changes anything)
+ */
+inline void AccountRef::setStatus(AccountStatus status) {
+    AccountStatus &current = store->statuses[slot];
+    if (current == status) {
+        return;
+    }
+    if (current == AccountStatus::Active) {
+        ++store->restrictedAccounts;
+    } else if (status == AccountStatus::Active) {
+        --store->restrictedAccounts;
+    }
+    current = status;
+    if (store->prefilter) {
+        store->prefilter->record(getAccountNumber(), status);
+    }
+    store->emit(journal::makeStatusChange(getAccountNumber(), status, getBalance()));
+}
+
+inline TransactionResult AccountRef::deposit(Money amount) {
+    metrics::OperationTimer timer(metrics::Operation::Deposit);
+    store->settle(slot);
+    std::int64_t &balance = store->balances[slot];
+    if (store->blocksCredits(slot)) {
+        return timer.finish(
+            TransactionResult{TransactionStatus::AccountFrozen, amount, Money::fromMinorUnits(balance)});
+    }
+    std::int64_t after;
+    // A credit the balance cannot hold is refused like any other bad amount
+    if (!account_rules::isValidAmount(amount) ||
+        __builtin_add_overflow(balance, amount.getMinorUnits(), &after)) {
+        return timer.finish(
+            TransactionResult{TransactionStatus::InvalidAmount, amount, Money::fromMinorUnits(balance)});
+    }
+    store->aggregates.onBalanceChange(getAccountType(), balance, after);
+    balance = after;
+    store->markChanged(slot);
+    store->emit(journal::makeRecord(JournalOp::Deposit, getAccountNumber(), amount,
+                                       Money::fromMinorUnits(balance)));
+    return timer.finish(
+        TransactionResult{TransactionStatus::Success, amount, Money::fromMinorUnits(balance)});
+}
+
+/**
+ * Withdraws without looking at the status (the caller has checked it)
+ */
+inline TransactionResult AccountRef::debit(Money amount) {
+    store->settle(slot);
+    std::int64_t &balance = store->balances[slot];
+    TransactionStatus status = account_rules::checkDebit(Money::fromMinorUnits(balance), amount);
+    if (status == TransactionStatus::Success) {
+        store->aggregates.onBalanceChange(getAccountType(), balance, balance - amount.getMinorUnits());
+        balance -= amount.getMinorUnits();
+        store->markChanged(slot);
+        store->emit(journal::makeRecord(JournalOp::Withdraw, getAccountNumber(), amount,
+                                           Money::fromMinorUnits(balance)));
+    }
+    return TransactionResult{status, amount, Money::fromMinorUnits(balance)};
+}
+
+inline TransactionResult AccountRef::withdraw(Money amount) {
+    metrics::OperationTimer timer(metrics::Operation::Withdraw);
+    if (store->blocksDebits(slot)) {
+        return timer.finish(TransactionResult{TransactionStatus::AccountFrozen, amount, getBalance()});
+    }
+    return timer.finish(debit(amount));
+}
+
+/**
+ * Withdraws funds a cross-shard transfer already holds, even if the
+ * account was frozen after the hold was granted (the credit has happened)
+ */
+inline TransactionResult AccountRef::withdrawHeld(Money amount) {
+    metrics::OperationTimer timer(metrics::Operation::Withdraw);
+    return timer.finish(debit(amount));
+}
+
+inline TransactionResult AccountRef::transfer(AccountRef toAccount, Money amount) {
+    metrics::OperationTimer timer(metrics::Operation::Transfer);
+    store->settle(slot);
+    toAccount.store->settle(toAccount.slot);
+    std::int64_t &balance = store->balances[slot];
+    std::int64_t &toBalance = toAccount.store->balances[toAccount.slot];
+    TransactionStatus status = store->blocksDebits(slot) || toAccount.store->blocksCredits(toAccount.slot)
+                                   ? TransactionStatus::AccountFrozen
+                                   : account_rules::checkDebit(Money::fromMinorUnits(balance), amount);
+    if (status == TransactionStatus::Success && toAccount == *this) {
+        // Debit and credit cancel out (balance and toBalance are the same
+        // cents); only the rules are checked
+        store->emit(journal::makeTransfer(getAccountNumber(), getAccountNumber(), amount,
+                                             Money::fromMinorUnits(balance)));
+        return timer.finish(TransactionResult{status, amount, Money::fromMinorUnits(balance)});
+    }
+    std::int64_t toAfter;
+    if (status == TransactionStatus::Success &&
+        __builtin_add_overflow(toBalance, amount.getMinorUnits(), &toAfter)) {
+        status = TransactionStatus::InvalidAmount;
+    }
+    if (status == TransactionStatus::Success) {
+        store->aggregates.onBalanceChange(getAccountType(), balance, balance - amount.getMinorUnits());
+        balance -= amount.getMinorUnits();
+        toAccount.store->aggregates.onBalanceChange(toAccount.getAccountType(), toBalance, toAfter);
+        toBalance = toAfter;
+        store->markChanged(slot);
+        toAccount.store->markChanged(toAccount.slot);
+        if (toAccount.store == store) {
+            store->emit(journal::makeTransfer(getAccountNumber(), toAccount.getAccountNumber(), amount,
+                                                 Money::fromMinorUnits(balance)));
+        } else {
+            // Each store's journal must replay on its own, so each journals its leg
+            store->emit(journal::makeRecord(JournalOp::Withdraw, getAccountNumber(), amount,
+                                               Money::fromMinorUnits(balance)));
+            toAccount.store->emit(journal::makeRecord(JournalOp::Deposit, toAccount.getAccountNumber(), amount,
+                                                         Money::fromMinorUnits(toBalance)));
+        }
+    }
+    return timer.finish(TransactionResult{status, amount, Money::fromMinorUnits(balance)});
+}
+
+inline TransactionResult AccountRef::applyInterest(RoundingMode mode) {
+    metrics::OperationTimer timer(metrics::Operation::ApplyInterest);
+    store->settle(slot);
+    std::int64_t &balance = store->balances[slot];
+    Money interest = computeInterest(Money::fromMinorUnits(balance), getInterestRate(), mode);
+    balance += interest.getMinorUnits();
+    if (!interest.isZero()) {
+        store->markChanged(slot);
+        store->aggregates.onInterest(getAccountType(), interest.getMinorUnits());
+        store->emit(journal::makeRecord(JournalOp::Interest, getAccountNumber(), interest,
+                                           Money::fromMinorUnits(balance)));
+    }
+    return timer.finish(
+        TransactionResult{TransactionStatus::Success, interest, Money::fromMinorUnits(balance)});
+}
+
+/**
+ * Credits interest computed elsewhere (journal replay, replicas)
+ * Like applyInterest, and unlike deposit, a status never blocks it.
+ */
+inline TransactionResult AccountRef::creditInterest(Money interest) {
+    metrics::OperationTimer timer(metrics::Operation::ApplyInterest);
+    store->settle(slot);
+    std::int64_t &balance = store->balances[slot];
+    std::int64_t after;
+    if (!account_rules::isValidAmount(interest) ||
+        __builtin_add_overflow(balance, interest.getMinorUnits(), &after)) {
+        return timer.finish(
+            TransactionResult{TransactionStatus::InvalidAmount, interest, Money::fromMinorUnits(balance)});
+    }
+    if (balance == 0) {
+        // Only a replay that already diverged credits interest to an empty account
+        store->aggregates.onBalanceChange(getAccountType(), 0, interest.getMinorUnits());
+    } else {
+        store->aggregates.onInterest(getAccountType(), interest.getMinorUnits());
+    }
+    balance = after;
+    store->markChanged(slot);
+    store->emit(journal::makeRecord(JournalOp::Interest, getAccountNumber(), interest,
+                                       Money::fromMinorUnits(balance)));
+    return timer.finish(
+        TransactionResult{TransactionStatus::Success, interest, Money::fromMinorUnits(balance)});
+}
+
+#endif // ACCOUNT_STORE_HPP
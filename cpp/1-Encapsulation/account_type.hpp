@@ -0,0 +1,57 @@
+#ifndef ACCOUNT_TYPE_HPP
+#define ACCOUNT_TYPE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string_view>
+
+// ============================================================================
+// ENUM DEFINITION: AccountType
+// ============================================================================
+/**
+ * The kind of product an account is
+ * One byte per account, so it can live in a hot column next to the balance.
+ */
+enum class AccountType : std::uint8_t {
+    Savings,
+    Checking
+};
+
+// Number of AccountType values, for per-type tables
+constexpr std::size_t kAccountTypeCount = 2;
+
+/**
+ * @param type The account type
+ * @return Display name of the type ("Savings", "Checking")
+ */
+constexpr std::string_view toString(AccountType type) {
+    switch (type) {
+    case AccountType::Savings:
+        return "Savings";
+    case AccountType::Checking:
+        return "Checking";
+    }
+    return "Unknown";
+}
+
+/**
+ * @param text Display name of a type ("Savings", "Checking")
+ * @return The type, or std::nullopt if the name is not recognised
+ */
+constexpr std::optional<AccountType> parseAccountType(std::string_view text) {
+    if (text == "Savings") {
+        return AccountType::Savings;
+    }
+    if (text == "Checking") {
+        return AccountType::Checking;
+    }
+    return std::nullopt;
+}
+
+inline std::ostream &operator<<(std::ostream &out, AccountType type) {
+    return out << toString(type);
+}
+
+#endif // ACCOUNT_TYPE_HPP
@@ -0,0 +1,399 @@
+#ifndef ASYNC_PIPELINE_HPP
+#define ASYNC_PIPELINE_HPP
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <utility>
+#include <vector>
+
+#include "account_store.hpp"
+#include "journal.hpp"
+#include "journal_record.hpp"
+#include "money.hpp"
+#include "transaction.hpp"
+
+/**
+ * ============================================================================
+ * ASYNC PIPELINE: coroutine front end for AccountStore operations
+ * ============================================================================
+ *
+ * Client code is written as coroutines that co_await account operations:
+ *
+ *     PipelineTask pay(AsyncAccount from, AsyncAccount to) {
+ *         TransactionResult r = co_await from.transfer(to, 25_usd);
+ *         if (r) { ... }
+ *     }
+ *
+ * Awaiting an operation does not run it. The request is queued on its
+ * shard (slot % shard count) and the coroutine is suspended. The service
+ * loop (runOnce / runUntilIdle) then takes up to maxBatch requests from
+ * every shard and pushes each batch through four stages:
+ * 1. VALIDATE - amount and account checks that need no balance
+ * 2. APPLY    - the operation itself, with the same rules as AccountRef,
+ *               in submission order within the shard
+ * 3. JOURNAL  - the records for the whole batch go to the store's
+ *               RecordSink in one go; with a durable JournalWriter the
+ *               batch waits for a single group commit
+ * 4. NOTIFY   - every coroutine of the batch is resumed with its result
+ *
+ * A request lives inside the awaiting coroutine's frame, so queuing it
+ * allocates nothing. One service thread can keep thousands of clients in
+ * flight: each costs a coroutine frame, not a thread.
+ *
+ * THREADING: the pipeline is single-threaded. Client coroutines must be
+ * started, and the service loop run, on the same thread. The pipeline is
+ * the store's only writer while requests are queued.
+ * ============================================================================
+ */
+
+/**
+ * Tuning knobs for AccountPipeline
+ */
+struct PipelineOptions {
+    std::size_t shards = 4;       // Request queues (accounts map by slot % shards)
+    std::size_t maxBatch = 256;   // Requests taken from a shard per pass
+};
+
+// ============================================================================
+// CLASS DEFINITION: PipelineTask
+// ============================================================================
+/**
+ * Coroutine type for pipeline clients
+ * The coroutine starts running as soon as it is called and stays alive
+ * (suspended at the end) until the task object is destroyed.
+ */
+class PipelineTask {
+public:
+    struct promise_type {
+        std::exception_ptr failure;   // Exception that ended the coroutine, if any
+
+        PipelineTask get_return_object() {
+            return PipelineTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { failure = std::current_exception(); }
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit PipelineTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+public:
+    PipelineTask(PipelineTask &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    PipelineTask &operator=(PipelineTask &&other) noexcept {
+        if (this != &other) {
+            if (handle) {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    PipelineTask(const PipelineTask &) = delete;
+    PipelineTask &operator=(const PipelineTask &) = delete;
+
+    /**
+     * Destroys the coroutine; must not happen while it awaits a request
+     */
+    ~PipelineTask() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    /**
+     * @return true once the coroutine has run to completion
+     */
+    bool done() const { return !handle || handle.done(); }
+
+    /**
+     * Rethrows the exception that ended the coroutine, if there was one
+     */
+    void rethrowIfFailed() const {
+        if (handle && handle.promise().failure) {
+            std::rethrow_exception(handle.promise().failure);
+        }
+    }
+};
+
+class AccountPipeline;
+
+/**
+ * Operations the pipeline understands
+ */
+enum class PipelineOp : std::uint8_t {
+    Deposit,
+    Withdraw,
+    Transfer
+};
+
+// ============================================================================
+// CLASS DEFINITION: PipelineRequest
+// ============================================================================
+/**
+ * Awaitable for one queued operation
+ * Returned by AccountPipeline/AsyncAccount; co_await it right away.
+ */
+class PipelineRequest {
+private:
+    friend class AccountPipeline;
+
+    AccountPipeline *pipeline;
+    PipelineOp op;
+    AccountSlot slot;                        // Account operated on (transfer: source)
+    AccountSlot toSlot;                      // Transfer destination
+    Money amount;
+    TransactionResult result{TransactionStatus::Success, Money(), Money()};
+    std::coroutine_handle<> waiter;          // Coroutine to resume with the result
+
+    PipelineRequest(AccountPipeline &owner, PipelineOp operation, AccountSlot account,
+                    AccountSlot destination, Money value)
+        : pipeline(&owner), op(operation), slot(account), toSlot(destination), amount(value) {}
+
+public:
+    bool await_ready() const noexcept { return false; }
+
+    inline void await_suspend(std::coroutine_handle<> coroutine);
+
+    TransactionResult await_resume() const noexcept { return result; }
+};
+
+// ============================================================================
+// CLASS DEFINITION: AccountPipeline
+// ============================================================================
+class AccountPipeline {
+private:
+    friend class PipelineRequest;
+
+    /**
+     * Collects the records the store emits during a pass
+     */
+    class PassSink : public RecordSink {
+    private:
+        std::vector<JournalRecord> &records;
+
+    public:
+        explicit PassSink(std::vector<JournalRecord> &pass) : records(pass) {}
+
+        /**
+         * @return Position in the pass (the journal assigns the sequence on forwarding)
+         */
+        std::uint64_t append(const JournalRecord &record) override {
+            records.push_back(record);
+            return records.size();
+        }
+    };
+
+    AccountStore &store;                          // Accounts the requests operate on
+    PipelineOptions options;
+    std::vector<std::deque<PipelineRequest *>> queues;   // One per shard
+    std::size_t pending = 0;                      // Queued, not yet completed
+    JournalWriter *durableJournal = nullptr;      // Batch waits for this writer's sync
+
+    std::vector<PipelineRequest *> batch;         // Requests of the current pass
+    std::vector<JournalRecord> records;           // Records of the current pass
+    PassSink passSink{records};                   // The store's sink during a pass
+    std::uint64_t batches = 0;                    // Passes that processed requests
+
+    void enqueue(PipelineRequest &request) {
+        queues[request.slot % queues.size()].push_back(&request);
+        ++pending;
+    }
+
+    /**
+     * Stage 1: checks that do not depend on balances
+     * @return false (and sets the result) if the request is rejected
+     */
+    bool validate(PipelineRequest &request) {
+        const std::size_t accounts = store.size();
+        const bool known = request.slot < accounts &&
+                           (request.op != PipelineOp::Transfer || request.toSlot < accounts);
+        if (!known || !account_rules::isValidAmount(request.amount)) {
+            Money balance = request.slot < accounts ? store.at(request.slot).getBalance() : Money();
+            request.result = {TransactionStatus::InvalidAmount, request.amount, balance};
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Stage 2: runs the operation; the store journals it into the pass
+     */
+    void apply(PipelineRequest &request) {
+        AccountRef account = store.at(request.slot);
+        switch (request.op) {
+        case PipelineOp::Deposit:
+            request.result = account.deposit(request.amount);
+            break;
+        case PipelineOp::Withdraw:
+            request.result = account.withdraw(request.amount);
+            break;
+        case PipelineOp::Transfer:
+            request.result = account.transfer(store.at(request.toSlot), request.amount);
+            break;
+        }
+    }
+
+public:
+    /**
+     * @param target The store to operate on
+     * @param config Shard count and batch size
+     */
+    explicit AccountPipeline(AccountStore &target, PipelineOptions config = {})
+        : store(target), options(config), queues(config.shards > 0 ? config.shards : 1) {
+        if (options.maxBatch == 0) {
+            options.maxBatch = 1;
+        }
+    }
+
+    AccountPipeline(const AccountPipeline &) = delete;
+    AccountPipeline &operator=(const AccountPipeline &) = delete;
+
+    /**
+     * Makes every batch wait for its records to be durable before its
+     * coroutines are resumed (one group commit per pass)
+     *
+     * @param writer The journal the store's RecordSink writes to (nullptr = don't wait)
+     */
+    void setDurableJournal(JournalWriter *writer) {
+        durableJournal = writer;
+    }
+
+    PipelineRequest deposit(AccountRef account, Money amount) {
+        return PipelineRequest(*this, PipelineOp::Deposit, account.getSlot(), account.getSlot(), amount);
+    }
+
+    PipelineRequest withdraw(AccountRef account, Money amount) {
+        return PipelineRequest(*this, PipelineOp::Withdraw, account.getSlot(), account.getSlot(), amount);
+    }
+
+    PipelineRequest transfer(AccountRef from, AccountRef to, Money amount) {
+        return PipelineRequest(*this, PipelineOp::Transfer, from.getSlot(), to.getSlot(), amount);
+    }
+
+    /**
+     * Runs one pass: up to maxBatch requests from every shard go through
+     * validate, apply, journal and notify
+     *
+     * @return Number of requests completed
+     */
+    std::size_t runOnce() {
+        batch.clear();
+        for (std::deque<PipelineRequest *> &queue : queues) {
+            std::size_t take = std::min(queue.size(), options.maxBatch);
+            batch.insert(batch.end(), queue.begin(), queue.begin() + static_cast<std::ptrdiff_t>(take));
+            queue.erase(queue.begin(), queue.begin() + static_cast<std::ptrdiff_t>(take));
+        }
+        if (batch.empty()) {
+            return 0;
+        }
+
+        // Journaling is its own stage: the store's records (including
+        // interest settled on the way) are collected and forwarded afterwards
+        RecordSink *sink = store.getRecordSink();
+        records.clear();
+        store.setRecordSink(&passSink);
+        for (PipelineRequest *request : batch) {
+            if (validate(*request)) {
+                apply(*request);
+            }
+        }
+        store.setRecordSink(sink);
+
+        if (sink && !records.empty()) {
+            for (const JournalRecord &record : records) {
+                sink->append(record);
+            }
+            if (durableJournal) {
+                durableJournal->sync();
+            }
+        }
+
+        // Resumed coroutines may queue new requests; they wait for the next pass
+        pending -= batch.size();
+        ++batches;
+        for (PipelineRequest *request : batch) {
+            request->waiter.resume();
+        }
+        return batch.size();
+    }
+
+    /**
+     * Runs passes until no request is queued
+     * @return Number of requests completed
+     */
+    std::size_t runUntilIdle() {
+        std::size_t completed = 0;
+        while (pending > 0) {
+            completed += runOnce();
+        }
+        return completed;
+    }
+
+    /**
+     * @return Requests queued and not yet completed
+     */
+    std::size_t getPending() const { return pending; }
+
+    /**
+     * @return Passes that processed at least one request
+     */
+    std::uint64_t getBatches() const { return batches; }
+
+    AccountStore &getStore() { return store; }
+};
+
+inline void PipelineRequest::await_suspend(std::coroutine_handle<> coroutine) {
+    waiter = coroutine;
+    pipeline->enqueue(*this);
+}
+
+// ============================================================================
+// CLASS DEFINITION: AsyncAccount
+// ============================================================================
+/**
+ * An AccountRef whose operations go through a pipeline
+ * Cheap to copy; pass it into client coroutines by value.
+ */
+class AsyncAccount {
+private:
+    AccountPipeline *pipeline;
+    AccountRef account;
+
+public:
+    AsyncAccount(AccountPipeline &owner, AccountRef ref) : pipeline(&owner), account(ref) {}
+
+    AccountRef getRef() const { return account; }
+
+    /**
+     * @return Awaitable that resolves to the deposit's result
+     */
+    PipelineRequest deposit(Money amount) {
+        return pipeline->deposit(account, amount);
+    }
+
+    /**
+     * @return Awaitable that resolves to the withdrawal's result
+     */
+    PipelineRequest withdraw(Money amount) {
+        return pipeline->withdraw(account, amount);
+    }
+
+    /**
+     * @return Awaitable that resolves to the transfer's result
+     */
+    PipelineRequest transfer(AsyncAccount to, Money amount) {
+        return pipeline->transfer(account, to.account, amount);
+    }
+};
+
+#endif // ASYNC_PIPELINE_HPP
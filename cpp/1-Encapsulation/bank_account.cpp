@@ -1,8 +1,15 @@
 #include <iostream>
 #include <string>
 #include <iomanip>
+#include <optional>
+
+#include "account_store.hpp"
+#include "bank_account.hpp"
+#include "console_account_printer.hpp"
+#include "interest_engine.hpp"
 
 using namespace std;
+using namespace money_literals;
 
 /**
  * ============================================================================
@@ -24,293 +31,19 @@ using namespace std;
  * - Flexibility: Can change internal implementation without affecting external code
  * - Maintainability: Easier to maintain and debug code
  * - Reusability: Encapsulated classes are more reusable
+ *
+ * FILES:
+ * - bank_account.hpp             The BankAccount class itself
+ * - console_account_printer.hpp  Optional observer that prints account events
+ * - money.hpp, account_id.hpp    Value types used for balances and ids
+ * - account_store.hpp            Column storage for many accounts
+ * - interest_engine.hpp          Interest accrual over a whole store
+ *
+ * BUILD:
+ *   g++ -std=c++20 -O2 bank_account.cpp -o bank_account
  * ============================================================================
  */
 
-// ============================================================================
-// CLASS DEFINITION: BankAccount
-// ============================================================================
-class BankAccount {
-private:
-    // PRIVATE DATA MEMBERS - Hidden from direct access
-    // These are the sensitive attributes that need protection
-    
-    string accountNumber;      // Unique identifier for the account
-    string accountHolder;      // Name of the account holder
-    double balance;            // Current balance in the account
-    string accountType;        // Type of account (Savings, Checking, etc.)
-    double interestRate;       // Interest rate for the account (for savings accounts)
-    
-    // Private helper method - for internal use only
-    // This method is not exposed to the outside world
-    /**
-     * Validates if the transaction amount is valid
-     * @param amount The amount to validate
-     * @return true if amount is valid (positive), false otherwise
-     */
-    bool isValidAmount(double amount) const {
-        return amount > 0;
-    }
-
-public:
-    // ========================================================================
-    // CONSTRUCTOR
-    // ========================================================================
-    /**
-     * Constructor to initialize a BankAccount object
-     * 
-     * @param accNum The account number
-     * @param holder The name of account holder
-     * @param initialBalance Initial amount in the account
-     * @param type Type of account (Savings/Checking)
-     * @param rate Interest rate (default 0.0)
-     */
-    BankAccount(string accNum, string holder, double initialBalance, 
-                string type = "Savings", double rate = 0.0) {
-        accountNumber = accNum;
-        accountHolder = holder;
-        balance = initialBalance;
-        accountType = type;
-        interestRate = rate;
-        
-        cout << "✓ Account created successfully!" << endl;
-    }
-
-    // ========================================================================
-    // PUBLIC GETTER METHODS (Read-Only Access)
-    // ========================================================================
-    /**
-     * Returns the account number
-     * This is a CONST method because it doesn't modify object state
-     * 
-     * @return Account number as a string
-     */
-    string getAccountNumber() const {
-        return accountNumber;
-    }
-
-    /**
-     * Returns the account holder's name
-     * 
-     * @return Account holder name as a string
-     */
-    string getAccountHolder() const {
-        return accountHolder;
-    }
-
-    /**
-     * Returns the current balance
-     * NOTE: This returns the actual balance. In a real system,
-     * you might want to format this differently or apply fees first.
-     * 
-     * @return Current balance as a double
-     */
-    double getBalance() const {
-        return balance;
-    }
-
-    /**
-     * Returns the account type
-     * 
-     * @return Account type as a string
-     */
-    string getAccountType() const {
-        return accountType;
-    }
-
-    /**
-     * Returns the interest rate
-     * 
-     * @return Interest rate as a double
-     */
-    double getInterestRate() const {
-        return interestRate;
-    }
-
-    // ========================================================================
-    // PUBLIC SETTER METHODS (Controlled Write Access)
-    // ========================================================================
-    /**
-     * Sets the interest rate with validation
-     * ENCAPSULATION BENEFIT: Only valid interest rates can be set
-     * 
-     * @param rate The new interest rate
-     * @return true if set successfully, false if invalid
-     */
-    bool setInterestRate(double rate) {
-        // Validation: Interest rate should be reasonable (0-50%)
-        if (rate >= 0 && rate <= 50.0) {
-            interestRate = rate;
-            cout << "✓ Interest rate updated to " << fixed << setprecision(2) 
-                 << rate << "%" << endl;
-            return true;
-        } else {
-            cout << "✗ Invalid interest rate! Rate must be between 0 and 50%" << endl;
-            return false;
-        }
-    }
-
-    /**
-     * Sets the account holder's name with validation
-     * ENCAPSULATION BENEFIT: Ensures account holder name is not empty
-     * 
-     * @param newHolder The new account holder name
-     * @return true if set successfully, false if invalid
-     */
-    bool setAccountHolder(string newHolder) {
-        // Validation: Name should not be empty
-        if (!newHolder.empty()) {
-            accountHolder = newHolder;
-            cout << "✓ Account holder updated to: " << accountHolder << endl;
-            return true;
-        } else {
-            cout << "✗ Invalid name! Account holder name cannot be empty" << endl;
-            return false;
-        }
-    }
-
-    // ========================================================================
-    // PUBLIC BUSINESS LOGIC METHODS
-    // ========================================================================
-    /**
-     * Deposits money into the account
-     * ENCAPSULATION BENEFIT: Only valid deposits are allowed
-     * The internal balance update logic is hidden from the user
-     * 
-     * @param amount The amount to deposit
-     * @return true if deposit successful, false otherwise
-     */
-    bool deposit(double amount) {
-        // Validation: Amount must be positive
-        if (!isValidAmount(amount)) {
-            cout << "✗ Invalid amount! Deposit amount must be positive" << endl;
-            return false;
-        }
-        
-        // Update balance
-        balance += amount;
-        
-        cout << "✓ Deposit Successful!" << endl;
-        cout << "  Amount Deposited: $" << fixed << setprecision(2) << amount << endl;
-        cout << "  New Balance: $" << balance << endl;
-        
-        return true;
-    }
-
-    /**
-     * Withdraws money from the account
-     * ENCAPSULATION BENEFIT: Prevents overdraft and invalid withdrawals
-     * 
-     * @param amount The amount to withdraw
-     * @return true if withdrawal successful, false otherwise
-     */
-    bool withdraw(double amount) {
-        // Validation 1: Amount must be positive
-        if (!isValidAmount(amount)) {
-            cout << "✗ Invalid amount! Withdrawal amount must be positive" << endl;
-            return false;
-        }
-        
-        // Validation 2: Prevent overdraft - check if sufficient balance exists
-        if (amount > balance) {
-            cout << "✗ Insufficient funds!" << endl;
-            cout << "  Requested: $" << fixed << setprecision(2) << amount << endl;
-            cout << "  Available: $" << balance << endl;
-            return false;
-        }
-        
-        // Update balance
-        balance -= amount;
-        
-        cout << "✓ Withdrawal Successful!" << endl;
-        cout << "  Amount Withdrawn: $" << fixed << setprecision(2) << amount << endl;
-        cout << "  New Balance: $" << balance << endl;
-        
-        return true;
-    }
-
-    /**
-     * Transfers money from this account to another account
-     * ENCAPSULATION BENEFIT: Encapsulates complex transfer logic
-     * 
-     * @param toAccount Reference to the destination account
-     * @param amount Amount to transfer
-     * @return true if transfer successful, false otherwise
-     */
-    bool transfer(BankAccount &toAccount, double amount) {
-        // Validation: Amount must be positive
-        if (!isValidAmount(amount)) {
-            cout << "✗ Invalid transfer amount! Must be positive" << endl;
-            return false;
-        }
-        
-        // Validation: Sufficient balance
-        if (amount > balance) {
-            cout << "✗ Insufficient funds for transfer!" << endl;
-            cout << "  Requested: $" << fixed << setprecision(2) << amount << endl;
-            cout << "  Available: $" << balance << endl;
-            return false;
-        }
-        
-        // Perform transfer: Withdraw from this account, Deposit to other
-        this->balance -= amount;
-        toAccount.balance += amount;
-        
-        cout << "✓ Transfer Successful!" << endl;
-        cout << "  From: " << this->accountHolder << " (" << this->accountNumber << ")" << endl;
-        cout << "  To: " << toAccount.accountHolder << " (" << toAccount.accountNumber << ")" << endl;
-        cout << "  Amount: $" << fixed << setprecision(2) << amount << endl;
-        
-        return true;
-    }
-
-    /**
-     * Applies interest to the account balance
-     * ENCAPSULATION BENEFIT: Complex calculation is hidden from user
-     * 
-     * @return The interest amount added
-     */
-    double applyInterest() {
-        double interestAmount = (balance * interestRate) / 100.0;
-        balance += interestAmount;
-        
-        cout << "✓ Interest Applied!" << endl;
-        cout << "  Interest Rate: " << fixed << setprecision(2) << interestRate << "%" << endl;
-        cout << "  Interest Added: $" << interestAmount << endl;
-        cout << "  New Balance: $" << balance << endl;
-        
-        return interestAmount;
-    }
-
-    /**
-     * Displays all account information in a formatted manner
-     * ENCAPSULATION BENEFIT: Presentation logic is encapsulated
-     */
-    void displayAccountInfo() const {
-        cout << "\n" << string(60, '=') << endl;
-        cout << "ACCOUNT INFORMATION" << endl;
-        cout << string(60, '=') << endl;
-        cout << left;
-        cout << setw(25) << "Account Number:" << accountNumber << endl;
-        cout << setw(25) << "Account Holder:" << accountHolder << endl;
-        cout << setw(25) << "Account Type:" << accountType << endl;
-        cout << setw(25) << "Balance:" << "$" << fixed << setprecision(2) << balance << endl;
-        cout << setw(25) << "Interest Rate:" << interestRate << "%" << endl;
-        cout << string(60, '=') << "\n" << endl;
-    }
-
-    // ========================================================================
-    // DESTRUCTOR
-    // ========================================================================
-    /**
-     * Destructor called when the object is destroyed
-     * Used for cleanup if needed (not necessary here as we don't use dynamic memory)
-     */
-    ~BankAccount() {
-        cout << "Account " << accountNumber << " has been closed." << endl;
-    }
-};
-
 // ============================================================================
 // MAIN FUNCTION - DEMONSTRATION
 // ============================================================================
@@ -319,11 +52,16 @@ int main() {
     cout << "# C++ ENCAPSULATION EXAMPLE: Bank Account System" << endl;
     cout << string(70, '#') << "\n" << endl;
 
+    // The printer observer turns account events into console messages.
+    // Accounts created without it are silent and only return result codes.
+    // It is declared first so it outlives the accounts that report to it.
+    ConsoleAccountPrinter printer;
+
     // Create bank accounts using the constructor
     // The constructor encapsulates the initialization logic
     cout << "--- Creating Bank Accounts ---\n" << endl;
-    BankAccount account1("ACC001", "John Doe", 5000, "Savings", 3.5);
-    BankAccount account2("ACC002", "Jane Smith", 10000, "Checking", 1.0);
+    BankAccount account1("ACC001"_acct, "John Doe", 5000_usd, AccountType::Savings, 3.5_pct, &printer);
+    BankAccount account2("ACC002"_acct, "Jane Smith", 10000_usd, AccountType::Checking, 1.0_pct, &printer);
 
     // Display account information
     // The displayAccountInfo method encapsulates the presentation logic
@@ -337,7 +75,7 @@ int main() {
     
     cout << "\n--- Testing Encapsulation: Getter Methods ---" << endl;
     cout << "Account 1 Holder: " << account1.getAccountHolder() << endl;
-    cout << "Account 1 Balance: $" << fixed << setprecision(2) << account1.getBalance() << endl;
+    cout << "Account 1 Balance: $" << account1.getBalance() << endl;
     cout << "Account 1 Interest Rate: " << account1.getInterestRate() << "%\n" << endl;
 
     // ========================================================================
@@ -351,11 +89,11 @@ int main() {
     
     // Try to set valid interest rate
     cout << "Attempting to set interest rate to 4.5%:" << endl;
-    account1.setInterestRate(4.5);
+    account1.setInterestRate(4.5_pct);
     
     // Try to set invalid interest rate (too high)
     cout << "\nAttempting to set interest rate to 75% (invalid):" << endl;
-    account1.setInterestRate(75.0);
+    account1.setInterestRate(75_pct);
     
     // Try to update account holder
     cout << "\nAttempting to update account holder to 'John Smith':" << endl;
@@ -368,19 +106,19 @@ int main() {
     
     // Valid deposit
     cout << "Depositing $2000 to Account 1:" << endl;
-    account1.deposit(2000);
+    account1.deposit(2000_usd);
     
     // Invalid deposit (negative amount)
     cout << "\nAttempting to deposit -$1000 (invalid):" << endl;
-    account1.deposit(-1000);
+    account1.deposit(-1000_usd);
     
     // Valid withdrawal
     cout << "\nWithdrawing $3000 from Account 1:" << endl;
-    account1.withdraw(3000);
+    account1.withdraw(3000_usd);
     
     // Invalid withdrawal (insufficient funds)
     cout << "\nAttempting to withdraw $100000 (insufficient funds):" << endl;
-    account1.withdraw(100000);
+    account1.withdraw(100000_usd);
 
     // ========================================================================
     // DEMONSTRATE COMPLEX ENCAPSULATED OPERATIONS
@@ -393,11 +131,54 @@ int main() {
     
     // Transfer money between accounts
     cout << "\nTransferring $500 from Account 1 to Account 2:" << endl;
-    account1.transfer(account2, 500);
+    account1.transfer(account2, 500_usd);
     
     // Try invalid transfer
     cout << "\nAttempting to transfer $50000 (insufficient funds):" << endl;
-    account1.transfer(account2, 50000);
+    account1.transfer(account2, 50000_usd);
+
+    // ========================================================================
+    // DEMONSTRATE SILENT MODE (NO OBSERVER)
+    // ========================================================================
+    cout << "\n--- Testing Encapsulation: Silent Mode Result Codes ---\n" << endl;
+
+    // No observer is attached, so these calls print nothing themselves;
+    // the caller inspects the returned result instead
+    BankAccount ledger("ACC003"_acct, "Ledger Replay", 100_usd, AccountType::Checking);
+    ledger.deposit(50_usd);
+    TransactionResult rejected = ledger.withdraw(250_usd);
+    if (rejected.status == TransactionStatus::InsufficientFunds) {
+        cout << "Silent withdrawal rejected: requested $" << rejected.amount
+             << ", available $" << rejected.balance << endl;
+    }
+
+    // ========================================================================
+    // DEMONSTRATE COLUMN STORAGE (AccountStore)
+    // ========================================================================
+    cout << "\n--- Testing Encapsulation: Account Store ---\n" << endl;
+
+    // The store keeps balances in one contiguous column; AccountRef handles
+    // still offer the same validated deposit/withdraw interface
+    AccountStore store;
+    AccountRef savings = *store.open("ACC101"_acct, "Alice Brown", 1200_usd, AccountType::Savings, 2.0_pct);
+    AccountRef checking = *store.open("ACC102"_acct, "Bob White", 800_usd, AccountType::Checking);
+
+    // Account numbers are unique within a store and looked up through its index
+    bool duplicateOpened = store.open("ACC101"_acct, "Someone Else", 1_usd).has_value();
+    cout << "Second ACC101 opened: " << (duplicateOpened ? "yes" : "no (number taken)") << endl;
+    if (std::optional<AccountRef> found = store.find("ACC102"_acct)) {
+        cout << "Found ACC102: " << found->getAccountHolder() << endl;
+    }
+
+    savings.transfer(checking, 200_usd);
+    checking.withdraw(5000_usd);   // Rejected: insufficient funds
+    cout << "Accounts in store: " << store.size() << endl;
+    cout << "Total held in store: $" << store.totalBalance() << endl;
+
+    // One silent pass accrues interest for every account in the store
+    InterestTotals accrued = InterestEngine().applyAll(store);
+    cout << "Interest accrued on " << accrued.accountsCredited << " account(s): $"
+         << accrued.interest << endl;
 
     // ========================================================================
     // DISPLAY FINAL ACCOUNT STATE
@@ -447,7 +228,10 @@ int main() {
  * 4. Setter Method Tests: Shows validation in action
  * 5. Deposit/Withdraw Tests: Demonstrates transaction validation
  * 6. Interest & Transfer Tests: Shows complex encapsulated operations
- * 7. Final State: Updated account information
+ * 7. Silent Mode: An account without an observer reports only result codes
+ * 8. Account Store: Accounts kept as columns, looked up by number and
+ *    used through AccountRef
+ * 9. Final State: Updated account information
  * 
  * KEY TAKEAWAY:
  * Encapsulation ensures that the BankAccount class maintains its internal
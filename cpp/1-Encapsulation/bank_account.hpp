@@ -0,0 +1,466 @@
+#ifndef BANK_ACCOUNT_HPP
+#define BANK_ACCOUNT_HPP
+
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "account_id.hpp"
+#include "account_type.hpp"
+#include "money.hpp"
+#include "operation_metrics.hpp"
+#include "statement_renderer.hpp"
+#include "transaction.hpp"
+
+/**
+ * ============================================================================
+ * BankAccount: the encapsulated single-account class
+ * ============================================================================
+ *
+ * See bank_account.cpp for the walkthrough of the encapsulation principles
+ * this class demonstrates.
+ *
+ * MEMORY:
+ * The holder name is a std::pmr::string. BankAccount is allocator-aware
+ * (allocator_type + std::allocator_arg constructors), so the name can be
+ * placed in any std::pmr::memory_resource: a std::pmr::vector<BankAccount>
+ * passes its resource down, and AccountArena (account_arena.hpp) pools the
+ * account objects and bump-allocates their names. By default names come
+ * from the global heap, as before.
+ * ============================================================================
+ */
+
+class BankAccount;
+
+// ============================================================================
+// OBSERVER INTERFACE: AccountObserver
+// ============================================================================
+/**
+ * Optional listener that is told about every account event
+ * 
+ * BankAccount does no I/O itself. Printing, logging or auditing is done by
+ * an observer attached to the account; without one, every operation is
+ * silent and costs only the validation and the arithmetic.
+ * All callbacks default to doing nothing, so an observer only overrides
+ * the events it cares about.
+ */
+class AccountObserver {
+public:
+    virtual ~AccountObserver() = default;
+
+    virtual void onAccountOpened(const BankAccount &) {}
+    virtual void onAccountClosed(const BankAccount &) {}
+    virtual void onDeposit(const BankAccount &, const TransactionResult &) {}
+    virtual void onWithdraw(const BankAccount &, const TransactionResult &) {}
+    virtual void onTransfer(const BankAccount &, const BankAccount &, const TransactionResult &) {}
+    virtual void onInterestApplied(const BankAccount &, const TransactionResult &) {}
+    virtual void onInterestRateChanged(const BankAccount &, InterestRate, TransactionStatus) {}
+    virtual void onAccountHolderChanged(const BankAccount &, std::string_view, TransactionStatus) {}
+};
+
+// ============================================================================
+// CLASS DEFINITION: BankAccount
+// ============================================================================
+class BankAccount {
+private:
+    // PRIVATE DATA MEMBERS - Hidden from direct access
+    // These are the sensitive attributes that need protection
+    
+    AccountId accountNumber;   // Unique identifier for the account (packed "ACC###")
+    std::pmr::string accountHolder; // Name of the account holder
+    Money balance;             // Current balance in the account (in cents)
+    AccountType accountType;   // Type of account (Savings, Checking)
+    InterestRate interestRate; // Interest rate for the account (for savings accounts)
+    AccountObserver *observer; // Optional listener for account events (nullptr = silent)
+    
+    // Private helper method - for internal use only
+    // This method is not exposed to the outside world
+    /**
+     * Validates if the transaction amount is valid
+     * @param amount The amount to validate
+     * @return true if amount is valid (positive), false otherwise
+     */
+    bool isValidAmount(Money amount) const {
+        return account_rules::isValidAmount(amount);
+    }
+
+    /**
+     * Builds a result carrying the current balance
+     * @param status Outcome of the operation
+     * @param amount The amount involved in the operation
+     * @return The filled-in result
+     */
+    TransactionResult makeResult(TransactionStatus status, Money amount) const {
+        return TransactionResult{status, amount, balance};
+    }
+
+public:
+    // ========================================================================
+    // CONSTRUCTOR
+    // ========================================================================
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    /**
+     * Constructor to initialize a BankAccount object
+     * The holder name is copied into the account's own storage (the global
+     * heap, or the memory resource given to the allocator-extended form).
+     * 
+     * @param accNum The account number
+     * @param holder The name of account holder
+     * @param initialBalance Initial amount in the account
+     * @param type Type of account (Savings/Checking)
+     * @param rate Interest rate (default 0%)
+     * @param listener Observer notified of account events (default: none, silent)
+     */
+    BankAccount(AccountId accNum, std::string_view holder, Money initialBalance, 
+                AccountType type = AccountType::Savings, InterestRate rate = InterestRate(),
+                AccountObserver *listener = nullptr)
+        : BankAccount(std::allocator_arg, allocator_type(), accNum, holder, initialBalance, type,
+                      rate, listener) {}
+
+    /**
+     * Allocator-extended constructor: the holder name is allocated from alloc
+     * 
+     * @param alloc Allocator (memory resource) for the holder name
+     * @see BankAccount(AccountId, std::string_view, Money, AccountType, InterestRate, AccountObserver *)
+     */
+    BankAccount(std::allocator_arg_t, const allocator_type &alloc, AccountId accNum,
+                std::string_view holder, Money initialBalance,
+                AccountType type = AccountType::Savings, InterestRate rate = InterestRate(),
+                AccountObserver *listener = nullptr)
+        : accountNumber(accNum),
+          accountHolder(holder, alloc),
+          balance(initialBalance),
+          accountType(type),
+          interestRate(rate),
+          observer(listener) {
+        if (observer) {
+            observer->onAccountOpened(*this);
+        }
+    }
+
+    // ========================================================================
+    // COPY AND MOVE
+    // ========================================================================
+    // Copies are independent accounts reporting to the same observer. A copy
+    // allocates its name from the default resource unless given an allocator.
+    BankAccount(const BankAccount &) = default;
+    BankAccount &operator=(const BankAccount &) = default;
+
+    BankAccount(std::allocator_arg_t, const allocator_type &alloc, const BankAccount &other)
+        : accountNumber(other.accountNumber),
+          accountHolder(other.accountHolder, alloc),
+          balance(other.balance),
+          accountType(other.accountType),
+          interestRate(other.interestRate),
+          observer(other.observer) {}
+
+    /**
+     * Move constructor: steals the holder string instead of copying it
+     * (the new account keeps the source's memory resource).
+     * The moved-from object is detached from the observer so that only the
+     * live account reports being closed.
+     */
+    BankAccount(BankAccount &&other) noexcept
+        : accountNumber(other.accountNumber),
+          accountHolder(std::move(other.accountHolder)),
+          balance(other.balance),
+          accountType(other.accountType),
+          interestRate(other.interestRate),
+          observer(std::exchange(other.observer, nullptr)) {}
+
+    /**
+     * Allocator-extended move: steals the name if alloc matches the
+     * source's resource, copies it into alloc otherwise
+     */
+    BankAccount(std::allocator_arg_t, const allocator_type &alloc, BankAccount &&other)
+        : accountNumber(other.accountNumber),
+          accountHolder(std::move(other.accountHolder), alloc),
+          balance(other.balance),
+          accountType(other.accountType),
+          interestRate(other.interestRate),
+          observer(std::exchange(other.observer, nullptr)) {}
+
+    BankAccount &operator=(BankAccount &&other) noexcept {
+        accountNumber = other.accountNumber;
+        accountHolder = std::move(other.accountHolder);
+        balance = other.balance;
+        accountType = other.accountType;
+        interestRate = other.interestRate;
+        observer = std::exchange(other.observer, nullptr);
+        return *this;
+    }
+
+    /**
+     * @return The allocator the holder name lives in
+     */
+    allocator_type get_allocator() const {
+        return accountHolder.get_allocator();
+    }
+
+    // ========================================================================
+    // PUBLIC GETTER METHODS (Read-Only Access)
+    // ========================================================================
+    /**
+     * Returns the account number
+     * This is a CONST method because it doesn't modify object state
+     * The id is an 8-byte value, so returning it copies no strings.
+     * 
+     * @return Account number as a packed AccountId
+     */
+    AccountId getAccountNumber() const {
+        return accountNumber;
+    }
+
+    /**
+     * Returns the account holder's name
+     * The view refers to this account's storage; it is valid until the
+     * holder is changed or the account is destroyed.
+     * 
+     * @return Account holder name as a read-only view
+     */
+    std::string_view getAccountHolder() const {
+        return accountHolder;
+    }
+
+    /**
+     * Returns the current balance
+     * NOTE: This returns the actual balance. In a real system,
+     * you might want to format this differently or apply fees first.
+     * 
+     * @return Current balance as an exact Money amount
+     */
+    Money getBalance() const {
+        return balance;
+    }
+
+    /**
+     * Returns the account type
+     * 
+     * @return Account type (use toString() for its name)
+     */
+    AccountType getAccountType() const {
+        return accountType;
+    }
+
+    /**
+     * Returns the interest rate
+     * 
+     * @return Interest rate in basis points
+     */
+    InterestRate getInterestRate() const {
+        return interestRate;
+    }
+
+    /**
+     * Returns the observer attached to this account
+     * 
+     * @return The observer, or nullptr when the account is silent
+     */
+    AccountObserver *getObserver() const {
+        return observer;
+    }
+
+    // ========================================================================
+    // PUBLIC SETTER METHODS (Controlled Write Access)
+    // ========================================================================
+    /**
+     * Attaches (or detaches, with nullptr) the observer for account events
+     * 
+     * @param listener The new observer, or nullptr for silent mode
+     */
+    void setObserver(AccountObserver *listener) {
+        observer = listener;
+    }
+
+    /**
+     * Sets the interest rate with validation
+     * ENCAPSULATION BENEFIT: Only valid interest rates can be set
+     * 
+     * @param rate The new interest rate
+     * @return Success, or InvalidRate if the rate is outside 0-50%
+     */
+    TransactionStatus setInterestRate(InterestRate rate) {
+        metrics::OperationTimer timer(metrics::Operation::SetInterestRate);
+        TransactionStatus status = TransactionStatus::InvalidRate;
+
+        // Validation: Interest rate should be reasonable (0-50%)
+        if (account_rules::isValidRate(rate)) {
+            interestRate = rate;
+            status = TransactionStatus::Success;
+        }
+        timer.finish(status);
+
+        if (observer) {
+            observer->onInterestRateChanged(*this, rate, status);
+        }
+        return status;
+    }
+
+    /**
+     * Sets the account holder's name with validation
+     * ENCAPSULATION BENEFIT: Ensures account holder name is not empty
+     * The name is copied into the existing buffer, so a name that fits the
+     * current capacity costs no allocation.
+     * 
+     * @param newHolder The new account holder name
+     * @return Success, or InvalidHolderName if the name is empty
+     */
+    TransactionStatus setAccountHolder(std::string_view newHolder) {
+        metrics::OperationTimer timer(metrics::Operation::SetAccountHolder);
+        TransactionStatus status = TransactionStatus::InvalidHolderName;
+
+        // Validation: Name should not be empty
+        if (!newHolder.empty()) {
+            accountHolder.assign(newHolder);
+            status = TransactionStatus::Success;
+        }
+        timer.finish(status);
+
+        if (observer) {
+            observer->onAccountHolderChanged(
+                *this, status == TransactionStatus::Success ? std::string_view(accountHolder) : newHolder,
+                status);
+        }
+        return status;
+    }
+
+    // ========================================================================
+    // PUBLIC BUSINESS LOGIC METHODS
+    // ========================================================================
+    /**
+     * Deposits money into the account
+     * ENCAPSULATION BENEFIT: Only valid deposits are allowed
+     * The internal balance update logic is hidden from the user
+     * 
+     * @param amount The amount to deposit
+     * @return Success with the new balance, or InvalidAmount (also when
+     *         the balance cannot hold the amount)
+     */
+    TransactionResult deposit(Money amount) {
+        metrics::OperationTimer timer(metrics::Operation::Deposit);
+        TransactionStatus status = TransactionStatus::InvalidAmount;
+
+        // Validation: Amount must be positive and fit in the balance
+        std::int64_t after;
+        if (isValidAmount(amount) &&
+            !__builtin_add_overflow(balance.getMinorUnits(), amount.getMinorUnits(), &after)) {
+            // Update balance
+            balance = Money::fromMinorUnits(after);
+            status = TransactionStatus::Success;
+        }
+
+        TransactionResult result = timer.finish(makeResult(status, amount));
+        if (observer) {
+            observer->onDeposit(*this, result);
+        }
+        return result;
+    }
+
+    /**
+     * Withdraws money from the account
+     * ENCAPSULATION BENEFIT: Prevents overdraft and invalid withdrawals
+     * 
+     * @param amount The amount to withdraw
+     * @return Success with the new balance, InvalidAmount, or
+     *         InsufficientFunds with the balance that was available
+     */
+    TransactionResult withdraw(Money amount) {
+        metrics::OperationTimer timer(metrics::Operation::Withdraw);
+        // Validation 1: Amount must be positive
+        // Validation 2: Prevent overdraft - check if sufficient balance exists
+        TransactionStatus status = account_rules::checkDebit(balance, amount);
+        if (status == TransactionStatus::Success) {
+            // Update balance
+            balance -= amount;
+        }
+
+        TransactionResult result = timer.finish(makeResult(status, amount));
+        if (observer) {
+            observer->onWithdraw(*this, result);
+        }
+        return result;
+    }
+
+    /**
+     * Transfers money from this account to another account
+     * ENCAPSULATION BENEFIT: Encapsulates complex transfer logic
+     * 
+     * @param toAccount Reference to the destination account
+     * @param amount Amount to transfer
+     * @return Result for the source account (balance is this account's
+     *         balance); InvalidAmount if the destination cannot hold it
+     */
+    TransactionResult transfer(BankAccount &toAccount, Money amount) {
+        metrics::OperationTimer timer(metrics::Operation::Transfer);
+        // Validation: Amount must be positive, and sufficient balance
+        TransactionStatus status = account_rules::checkDebit(balance, amount);
+        std::int64_t toAfter;
+        if (status == TransactionStatus::Success && &toAccount != this &&
+            __builtin_add_overflow(toAccount.balance.getMinorUnits(), amount.getMinorUnits(), &toAfter)) {
+            status = TransactionStatus::InvalidAmount;
+        }
+        if (status == TransactionStatus::Success) {
+            // Perform transfer: Withdraw from this account, Deposit to other
+            this->balance -= amount;
+            toAccount.balance += amount;
+        }
+
+        TransactionResult result = timer.finish(makeResult(status, amount));
+        if (observer) {
+            observer->onTransfer(*this, toAccount, result);
+        }
+        return result;
+    }
+
+    /**
+     * Applies interest to the account balance
+     * ENCAPSULATION BENEFIT: Complex calculation is hidden from user
+     * The interest is computed exactly in cents; only the final fraction
+     * of a cent is rounded, the way the caller asks.
+     * 
+     * @param mode How to round the fractional cent (default banker's rounding)
+     * @return Success, with amount set to the interest added
+     */
+    TransactionResult applyInterest(RoundingMode mode = RoundingMode::HalfEven) {
+        metrics::OperationTimer timer(metrics::Operation::ApplyInterest);
+        Money interestAmount = computeInterest(balance, interestRate, mode);
+        balance += interestAmount;
+
+        TransactionResult result = timer.finish(makeResult(TransactionStatus::Success, interestAmount));
+        if (observer) {
+            observer->onInterestApplied(*this, result);
+        }
+        return result;
+    }
+
+    /**
+     * Displays all account information in a formatted manner
+     * ENCAPSULATION BENEFIT: Presentation logic is encapsulated
+     * The block is formatted by StatementRenderer and written with one call,
+     * so std::cout is neither flushed per line nor left with changed flags.
+     */
+    void displayAccountInfo() const {
+        StatementRenderer renderer(StatementLayout::Card, 0);
+        renderer.append(*this);
+        renderer.writeTo(std::cout);
+    }
+
+    // ========================================================================
+    // DESTRUCTOR
+    // ========================================================================
+    /**
+     * Destructor called when the object is destroyed
+     * Used for cleanup if needed (not necessary here as we don't use dynamic memory)
+     */
+    ~BankAccount() {
+        if (observer) {
+            observer->onAccountClosed(*this);
+        }
+    }
+};
+
+#endif // BANK_ACCOUNT_HPP
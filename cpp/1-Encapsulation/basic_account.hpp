@@ -0,0 +1,350 @@
+#ifndef BASIC_ACCOUNT_HPP
+#define BASIC_ACCOUNT_HPP
+
+#include <concepts>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "account_id.hpp"
+#include "account_type.hpp"
+#include "journal_record.hpp"
+#include "money.hpp"
+#include "transaction.hpp"
+
+/**
+ * ============================================================================
+ * BasicAccount<Policy>: product rules fixed at compile time
+ * ============================================================================
+ *
+ * BankAccount checks the same rules for every account at run time: no
+ * overdraft, rates within 0-50%, an optional observer to notify. Products
+ * differ, though - a checking account may go into overdraft and pay a fee
+ * per withdrawal, a savings account may not, and most accounts are never
+ * logged. BasicAccount takes those rules from a policy type instead:
+ * - kType           the AccountType (not stored per account)
+ * - kOverdraftLimit how far below zero a debit may take the balance
+ * - kMinRate/kMaxRate the rates setInterestRate accepts
+ * - kEarnsInterest  whether applyInterest/setInterestRate exist at all
+ * - Fees            the fee charged on top of each withdrawal/transfer
+ * - Logging         what is told about each operation (NoLogging: nothing)
+ *
+ * Everything the policy fixes is a constant, so each product's deposit and
+ * withdraw compile to the arithmetic plus the checks that product needs: a
+ * zero overdraft limit is the plain balance check, NoFees adds nothing,
+ * NoLogging is an empty member ([[no_unique_address]]) whose calls inline
+ * away. Calling applyInterest on a product that earns none is a compile
+ * error rather than a run-time no-op.
+ *
+ * SavingsAccount and CheckingAccount are the two standard products; new
+ * ones are a new policy struct. Accounts of different products can transfer
+ * to each other. The getters match BankAccount, so StatementRenderer and
+ * other generic code accept BasicAccount as well.
+ * ============================================================================
+ */
+
+// ============================================================================
+// FEE POLICIES
+// ============================================================================
+/**
+ * No fee on any operation
+ */
+struct NoFees {
+    static constexpr Money withdrawalFee(Money) { return Money(); }
+};
+
+/**
+ * The same fee, in cents, on every withdrawal and outgoing transfer
+ */
+template <std::int64_t Cents>
+struct FlatWithdrawalFee {
+    static_assert(Cents >= 0, "a fee cannot be negative");
+    static constexpr Money withdrawalFee(Money) { return Money::fromMinorUnits(Cents); }
+};
+
+// ============================================================================
+// LOGGING POLICIES
+// ============================================================================
+/**
+ * Logs nothing (an empty type, so it takes no space in the account)
+ */
+struct NoLogging {
+    template <class Account>
+    void record(const Account &, JournalOp, TransactionStatus, Money) const {}
+};
+
+/**
+ * Writes one line per operation to a stream
+ */
+class StreamLogging {
+private:
+    std::ostream *out = nullptr;   // Destination (nullptr = silent)
+
+public:
+    StreamLogging() = default;
+    explicit StreamLogging(std::ostream &stream) : out(&stream) {}
+
+    template <class Account>
+    void record(const Account &account, JournalOp op, TransactionStatus status, Money amount) const {
+        if (!out) {
+            return;
+        }
+        static constexpr std::string_view kNames[] = {"?",        "open",     "deposit",     "withdraw",
+                                                      "transfer", "interest", "rate-change", "holder"};
+        *out << account.getAccountNumber() << ' ' << kNames[static_cast<std::size_t>(op)] << ' ' << amount
+             << (status == TransactionStatus::Success ? " ok, balance " : " rejected, balance ")
+             << account.getBalance() << '\n';
+    }
+};
+
+// ============================================================================
+// PRODUCT POLICIES
+// ============================================================================
+/**
+ * What a type must provide to be used as BasicAccount's policy
+ */
+template <class P>
+concept AccountPolicy = requires(Money amount) {
+    { P::kType } -> std::convertible_to<AccountType>;
+    { P::kOverdraftLimit } -> std::convertible_to<Money>;
+    { P::kMinRate } -> std::convertible_to<InterestRate>;
+    { P::kMaxRate } -> std::convertible_to<InterestRate>;
+    { P::kEarnsInterest } -> std::convertible_to<bool>;
+    { P::Fees::withdrawalFee(amount) } -> std::same_as<Money>;
+    typename P::Logging;
+} && (!P::kOverdraftLimit.isNegative()) && (P::kMinRate <= P::kMaxRate);
+
+/**
+ * Savings: no overdraft, no fees, interest within the usual 0-50%
+ */
+struct SavingsPolicy {
+    static constexpr AccountType kType = AccountType::Savings;
+    static constexpr Money kOverdraftLimit = Money();
+    static constexpr InterestRate kMinRate = account_rules::kMinInterestRate;
+    static constexpr InterestRate kMaxRate = account_rules::kMaxInterestRate;
+    static constexpr bool kEarnsInterest = true;
+    using Fees = NoFees;
+    using Logging = NoLogging;
+};
+
+/**
+ * Checking: $500 overdraft, 25 cents per withdrawal, no interest
+ */
+struct CheckingPolicy {
+    static constexpr AccountType kType = AccountType::Checking;
+    static constexpr Money kOverdraftLimit = Money::fromMajorUnits(500);
+    static constexpr InterestRate kMinRate = InterestRate();
+    static constexpr InterestRate kMaxRate = InterestRate();
+    static constexpr bool kEarnsInterest = false;
+    using Fees = FlatWithdrawalFee<25>;
+    using Logging = NoLogging;
+};
+
+/**
+ * Any product with its Logging replaced, e.g. WithLogging<SavingsPolicy, StreamLogging>
+ */
+template <AccountPolicy Base, class Log>
+struct WithLogging : Base {
+    using Logging = Log;
+};
+
+// ============================================================================
+// CLASS DEFINITION: BasicAccount
+// ============================================================================
+template <AccountPolicy Policy>
+class BasicAccount {
+private:
+    template <AccountPolicy Other>
+    friend class BasicAccount;
+
+    using Logging = typename Policy::Logging;
+
+    AccountId accountNumber;                     // Unique identifier for the account
+    std::string accountHolder;                   // Name of the account holder
+    Money balance;                               // Current balance (may go down to -kOverdraftLimit)
+    InterestRate interestRate;                   // Only meaningful if the product earns interest
+    [[no_unique_address]] Logging logging;       // Empty for NoLogging
+
+    /**
+     * Validates a debit against this product's overdraft limit
+     * @param total Amount plus fee
+     */
+    constexpr TransactionStatus checkDebit(Money amount, Money total) const {
+        if (!account_rules::isValidAmount(amount)) {
+            return TransactionStatus::InvalidAmount;
+        }
+        if constexpr (Policy::kOverdraftLimit.isZero()) {
+            return total > balance ? TransactionStatus::InsufficientFunds : TransactionStatus::Success;
+        } else {
+            return total > balance + Policy::kOverdraftLimit ? TransactionStatus::InsufficientFunds
+                                                             : TransactionStatus::Success;
+        }
+    }
+
+    TransactionResult finish(JournalOp op, TransactionStatus status, Money amount) const {
+        logging.record(*this, op, status, amount);
+        return TransactionResult{status, amount, balance};
+    }
+
+public:
+    using PolicyType = Policy;
+
+    /**
+     * @param accNum The account number
+     * @param holder The name of account holder
+     * @param initialBalance Initial amount in the account
+     * @param rate Interest rate (clamped into the product's bounds)
+     * @param log The logging policy instance (e.g. StreamLogging(std::clog))
+     */
+    BasicAccount(AccountId accNum, std::string_view holder, Money initialBalance,
+                 InterestRate rate = Policy::kMinRate, Logging log = Logging())
+        : accountNumber(accNum),
+          accountHolder(holder),
+          balance(initialBalance),
+          interestRate(rate < Policy::kMinRate   ? Policy::kMinRate
+                       : rate > Policy::kMaxRate ? Policy::kMaxRate
+                                                 : rate),
+          logging(std::move(log)) {}
+
+    // ========================================================================
+    // GETTERS (same names as BankAccount)
+    // ========================================================================
+    AccountId getAccountNumber() const { return accountNumber; }
+    std::string_view getAccountHolder() const { return accountHolder; }
+    Money getBalance() const { return balance; }
+    static constexpr AccountType getAccountType() { return Policy::kType; }
+    InterestRate getInterestRate() const { return interestRate; }
+
+    /**
+     * @return Lowest balance a debit may leave (minus the overdraft limit)
+     */
+    static constexpr Money getBalanceFloor() { return -Policy::kOverdraftLimit; }
+
+    // ========================================================================
+    // SETTERS
+    // ========================================================================
+    /**
+     * @param newHolder The new account holder name
+     * @return Success, or InvalidHolderName if the name is empty
+     */
+    TransactionStatus setAccountHolder(std::string_view newHolder) {
+        if (newHolder.empty()) {
+            return TransactionStatus::InvalidHolderName;
+        }
+        accountHolder.assign(newHolder);
+        return TransactionStatus::Success;
+    }
+
+    /**
+     * @param rate The new interest rate
+     * @return Success, or InvalidRate if outside [kMinRate, kMaxRate]
+     */
+    TransactionStatus setInterestRate(InterestRate rate)
+        requires(Policy::kEarnsInterest)
+    {
+        TransactionStatus status = rate >= Policy::kMinRate && rate <= Policy::kMaxRate
+                                       ? TransactionStatus::Success
+                                       : TransactionStatus::InvalidRate;
+        if (status == TransactionStatus::Success) {
+            interestRate = rate;
+        }
+        logging.record(*this, JournalOp::RateChange, status, Money());
+        return status;
+    }
+
+    // ========================================================================
+    // BUSINESS LOGIC
+    // ========================================================================
+    /**
+     * @param amount The amount to deposit
+     * @return Success with the new balance, or InvalidAmount (also when
+     *         the balance cannot hold the amount)
+     */
+    TransactionResult deposit(Money amount) {
+        TransactionStatus status = TransactionStatus::InvalidAmount;
+        std::int64_t after;
+        if (account_rules::isValidAmount(amount) &&
+            !__builtin_add_overflow(balance.getMinorUnits(), amount.getMinorUnits(), &after)) {
+            balance = Money::fromMinorUnits(after);
+            status = TransactionStatus::Success;
+        }
+        return finish(JournalOp::Deposit, status, amount);
+    }
+
+    /**
+     * Withdraws amount plus the product's fee
+     *
+     * @param amount The amount to withdraw
+     * @return Success with the new balance, InvalidAmount, or
+     *         InsufficientFunds if amount + fee would pass the overdraft limit
+     */
+    TransactionResult withdraw(Money amount) {
+        const Money total = amount + Policy::Fees::withdrawalFee(amount);
+        TransactionStatus status = checkDebit(amount, total);
+        if (status == TransactionStatus::Success) {
+            balance -= total;
+        }
+        return finish(JournalOp::Withdraw, status, amount);
+    }
+
+    /**
+     * Transfers to an account of any product; this account pays its fee
+     *
+     * @param toAccount Destination account
+     * @param amount Amount to transfer
+     * @return Result for the source account; InvalidAmount if the
+     *         destination cannot hold the amount
+     */
+    template <AccountPolicy Other>
+    TransactionResult transfer(BasicAccount<Other> &toAccount, Money amount) {
+        const Money total = amount + Policy::Fees::withdrawalFee(amount);
+        TransactionStatus status = checkDebit(amount, total);
+        // To itself the credit follows the debit, so only other accounts can overflow
+        const bool self = static_cast<const void *>(&toAccount) == static_cast<const void *>(this);
+        std::int64_t toAfter;
+        if (status == TransactionStatus::Success && !self &&
+            __builtin_add_overflow(toAccount.balance.getMinorUnits(), amount.getMinorUnits(), &toAfter)) {
+            status = TransactionStatus::InvalidAmount;
+        }
+        if (status == TransactionStatus::Success) {
+            balance -= total;
+            toAccount.balance += amount;
+        }
+        return finish(JournalOp::Transfer, status, amount);
+    }
+
+    /**
+     * Applies one period of interest
+     *
+     * @param mode How to round the fractional cent
+     * @return Success, with amount set to the interest added
+     */
+    TransactionResult applyInterest(RoundingMode mode = RoundingMode::HalfEven)
+        requires(Policy::kEarnsInterest)
+    {
+        Money interest = computeInterest(balance, interestRate, mode);
+        balance += interest;
+        return finish(JournalOp::Interest, TransactionStatus::Success, interest);
+    }
+};
+
+using SavingsAccount = BasicAccount<SavingsPolicy>;
+using CheckingAccount = BasicAccount<CheckingPolicy>;
+
+namespace basic_account_detail {
+// Same members as BasicAccount minus the logging policy
+struct SilentLayout {
+    AccountId accountNumber;
+    std::string accountHolder;
+    Money balance;
+    InterestRate interestRate;
+};
+} // namespace basic_account_detail
+
+// A silent product costs no space for its logging policy
+static_assert(sizeof(SavingsAccount) == sizeof(basic_account_detail::SilentLayout), "NoLogging should take no space");
+static_assert(sizeof(CheckingAccount) == sizeof(basic_account_detail::SilentLayout), "NoLogging should take no space");
+
+#endif // BASIC_ACCOUNT_HPP
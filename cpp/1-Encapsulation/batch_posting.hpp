@@ -0,0 +1,491 @@
+#ifndef BATCH_POSTING_HPP
+#define BATCH_POSTING_HPP
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "account_store.hpp"
+#include "journal_record.hpp"
+#include "money.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define BATCH_POSTING_HAS_AVX2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BATCH_POSTING_HAS_NEON 1
+#endif
+
+/**
+ * ============================================================================
+ * BATCH POSTING: many deposits and withdrawals in one call
+ * ============================================================================
+ *
+ * A posting is (account slot, signed amount in cents): a positive amount is
+ * a deposit, a negative one a withdrawal. BatchPoster applies a whole array
+ * of postings to an AccountStore with the same rules as deposit/withdraw:
+ * - the amount must not be zero (isValidAmount) and the slot must exist
+ * - a deposit must not take the balance past INT64_MAX (reported as invalid)
+ * - a withdrawal must not overdraw the account
+ * - the account's status must not block that direction (AccountStatus);
+ *   while any account of the store is blocked, such postings are pointed
+ *   at a slot that does not exist before the kernels run, and reported as
+ *   frozen
+ *
+ * Instead of one unpredictable branch per posting, the checks are computed
+ * as compare masks and the balance is updated with a select, so rejected
+ * postings cost the same as accepted ones. The result is a rejection
+ * bitmask (bit i = posting i was rejected) plus counts per reason.
+ *
+ * KERNELS:
+ * - AVX2 (x86-64, chosen at runtime when the CPU supports it): 4 postings
+ *   per step using gathered balances and 64-bit compares
+ * - NEON (AArch64): 2 postings per step
+ * - Scalar: branch-free fallback, used for tails and everywhere else
+ *
+ * Postings are applied in array order, exactly as if deposit/withdraw were
+ * called one by one. When several postings in one SIMD step hit the same
+ * account, that step is run through the scalar kernel so each posting sees
+ * the balance left by the previous one.
+ *
+ * The store's running totals are adjusted once per batch, from the net
+ * amount per account type and the zero-balance transitions the kernels
+ * count as they go. On a lazily accruing store the accounts a batch names
+ * are settled before the kernels run.
+ *
+ * When the store has a RecordSink attached, every applied posting is
+ * journaled (as a Deposit or Withdraw record) after the kernels have run.
+ * ============================================================================
+ */
+
+/**
+ * Outcome of a BatchPoster::post call
+ */
+struct PostingReport {
+    std::vector<std::uint64_t> rejectMask;   // Bit i set = posting i was rejected
+    std::size_t applied = 0;                 // Postings applied
+    std::size_t invalid = 0;                 // Rejected: zero amount, unknown slot or overflow
+    std::size_t insufficientFunds = 0;       // Rejected: withdrawal would overdraw
+    std::size_t frozen = 0;                  // Rejected: the account's status blocks it
+    Money netPosted;                         // Sum of all applied amounts
+
+    /**
+     * @param index Position of the posting in the batch
+     * @return true if that posting was rejected
+     */
+    bool isRejected(std::size_t index) const {
+        return (rejectMask[index / 64] >> (index % 64)) & 1;
+    }
+};
+
+/**
+ * Which kernel BatchPoster uses
+ */
+enum class PostingKernel {
+    Auto,     // Best kernel available on this CPU
+    Scalar,   // Portable branch-free loop
+    Simd      // AVX2 or NEON (falls back to Scalar when neither is available)
+};
+
+namespace posting_kernels {
+
+/**
+ * Running counters shared by the kernels
+ * The sums of applied amounts wrap, as the SIMD lanes and the store's
+ * atomic totals do, so every kernel arrives at the same Tally.
+ */
+struct Tally {
+    std::size_t invalid = 0;
+    std::size_t insufficient = 0;
+    std::int64_t net = 0;
+    std::int64_t zeroDelta = 0;   // Change in the number of zero-balance accounts
+    std::array<std::int64_t, kAccountTypeCount> typeNet{};   // Net applied per AccountType
+};
+
+/**
+ * @return sum + amount, wrapping instead of overflowing
+ */
+inline std::int64_t wrappingAdd(std::int64_t sum, std::int64_t amount) {
+    return static_cast<std::int64_t>(static_cast<std::uint64_t>(sum) + static_cast<std::uint64_t>(amount));
+}
+
+/**
+ * Applies postings [begin, end) one at a time without branching on the outcome
+ */
+inline void postScalar(std::int64_t *balances, const AccountType *types, std::size_t accountCount,
+                       const AccountSlot *slots, const std::int64_t *amounts, std::size_t begin,
+                       std::size_t end, std::uint64_t *rejectMask, Tally &tally) {
+    for (std::size_t i = begin; i < end; ++i) {
+        const bool inRange = slots[i] < accountCount;
+        const std::int64_t amount = amounts[i];
+        // Unknown slots read (and write back) account 0 unchanged
+        std::int64_t &balance = balances[inRange ? slots[i] : 0];
+        const std::int64_t before = balance;
+        const std::int64_t after = wrappingAdd(before, amount);
+
+        const bool overflow = (amount > 0) & (after < before);
+        const bool invalid = !inRange | (amount == 0) | overflow;
+        const bool overdraft = inRange & (amount < 0) & (after < 0);
+        const bool ok = !invalid & !overdraft;
+
+        balance = ok ? after : before;
+        rejectMask[i / 64] |= static_cast<std::uint64_t>(!ok) << (i % 64);
+        tally.invalid += invalid;
+        tally.insufficient += overdraft;
+        tally.net = wrappingAdd(tally.net, ok ? amount : 0);
+        tally.zeroDelta += static_cast<std::int64_t>(ok & (after == 0)) -
+                           static_cast<std::int64_t>(ok & (before == 0));
+        std::int64_t &typeNet = tally.typeNet[static_cast<std::size_t>(types[inRange ? slots[i] : 0])];
+        typeNet = wrappingAdd(typeNet, ok ? amount : 0);
+    }
+}
+
+#if defined(BATCH_POSTING_HAS_AVX2)
+/**
+ * @return true if the CPU running this code supports AVX2
+ */
+inline bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+/**
+ * Applies postings four at a time with AVX2
+ * Requires 0 < accountCount <= INT32_MAX (gather offsets are signed 32-bit).
+ * @return Index of the first posting not processed (the scalar tail)
+ */
+__attribute__((target("avx2"))) inline std::size_t
+postAvx2(std::int64_t *balances, const AccountType *types, std::size_t accountCount, const AccountSlot *slots,
+         const std::int64_t *amounts, std::size_t count, std::uint64_t *rejectMask, Tally &tally) {
+    const __m256i zero = _mm256_setzero_si256();
+    // Unsigned 32-bit compare via the sign-flip trick
+    const __m128i signFlip = _mm_set1_epi32(static_cast<int>(0x80000000u));
+    const __m128i limit = _mm_xor_si128(
+        _mm_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(accountCount))), signFlip);
+    __m256i net = zero;
+    __m256i typeNet[kAccountTypeCount];
+    for (__m256i &lanes : typeNet) {
+        lanes = zero;
+    }
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i *>(slots + i));
+
+        // Any two lanes naming the same account? Then keep strict ordering.
+        const __m128i rot1 = _mm_shuffle_epi32(index, _MM_SHUFFLE(0, 3, 2, 1));
+        const __m128i rot2 = _mm_shuffle_epi32(index, _MM_SHUFFLE(1, 0, 3, 2));
+        const __m128i same = _mm_or_si128(_mm_cmpeq_epi32(index, rot1), _mm_cmpeq_epi32(index, rot2));
+        if (_mm_movemask_epi8(same) != 0) {
+            postScalar(balances, types, accountCount, slots, amounts, i, i + 4, rejectMask, tally);
+            continue;
+        }
+
+        const __m128i inRange32 = _mm_cmpgt_epi32(limit, _mm_xor_si128(index, signFlip));
+        const __m256i inRange = _mm256_cvtepi32_epi64(inRange32);
+        const __m256i before = _mm256_mask_i32gather_epi64(
+            zero, reinterpret_cast<const long long *>(balances), index, inRange, 8);
+        const __m256i amount = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(amounts + i));
+        const __m256i after = _mm256_add_epi64(before, amount);
+
+        const __m256i isZero = _mm256_cmpeq_epi64(amount, zero);
+        const __m256i isDebit = _mm256_cmpgt_epi64(zero, amount);
+        const __m256i wouldOverdraw = _mm256_and_si256(isDebit, _mm256_cmpgt_epi64(zero, after));
+        // A deposit that wrapped: amount > 0 && after < before
+        const __m256i overflow =
+            _mm256_and_si256(_mm256_cmpgt_epi64(amount, zero), _mm256_cmpgt_epi64(before, after));
+        const __m256i invalid = _mm256_or_si256(_mm256_or_si256(isZero, overflow),
+                                                _mm256_andnot_si256(inRange, _mm256_set1_epi64x(-1)));
+        const __m256i overdraft = _mm256_and_si256(wouldOverdraw, inRange);
+        const __m256i ok = _mm256_andnot_si256(_mm256_or_si256(invalid, overdraft), _mm256_set1_epi64x(-1));
+
+        const __m256i result = _mm256_blendv_epi8(before, after, ok);
+        const __m256i applied = _mm256_and_si256(amount, ok);
+        net = _mm256_add_epi64(net, applied);
+
+        // Split the applied amounts by the type of their account
+        const __m128i typeSlots = _mm_and_si128(index, inRange32);
+        const __m256i type = _mm256_set_epi64x(
+            static_cast<std::int64_t>(types[static_cast<AccountSlot>(_mm_extract_epi32(typeSlots, 3))]),
+            static_cast<std::int64_t>(types[static_cast<AccountSlot>(_mm_extract_epi32(typeSlots, 2))]),
+            static_cast<std::int64_t>(types[static_cast<AccountSlot>(_mm_extract_epi32(typeSlots, 1))]),
+            static_cast<std::int64_t>(types[static_cast<AccountSlot>(_mm_extract_epi32(typeSlots, 0))]));
+        for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+            const __m256i isType = _mm256_cmpeq_epi64(type, _mm256_set1_epi64x(static_cast<std::int64_t>(t)));
+            typeNet[t] = _mm256_add_epi64(typeNet[t], _mm256_and_si256(applied, isType));
+        }
+
+        alignas(32) std::int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), result);
+        const unsigned inRangeBits = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(inRange)));
+        for (unsigned lane = 0; lane < 4; ++lane) {
+            if (inRangeBits & (1u << lane)) {
+                balances[slots[i + lane]] = lanes[lane];
+            }
+        }
+
+        const unsigned okBits = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(ok)));
+        const unsigned invalidBits = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(invalid)));
+        const unsigned overdraftBits = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(overdraft)));
+        const unsigned wasZeroBits = static_cast<unsigned>(
+            _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(before, zero))));
+        const unsigned isZeroBits = static_cast<unsigned>(
+            _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(after, zero))));
+        rejectMask[i / 64] |= static_cast<std::uint64_t>(~okBits & 0xFu) << (i % 64);
+        tally.invalid += static_cast<std::size_t>(std::popcount(invalidBits));
+        tally.insufficient += static_cast<std::size_t>(std::popcount(overdraftBits));
+        tally.zeroDelta += std::popcount(isZeroBits & okBits) - std::popcount(wasZeroBits & okBits);
+    }
+
+    alignas(32) std::int64_t netLanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(netLanes), net);
+    for (std::int64_t lane : netLanes) {
+        tally.net = wrappingAdd(tally.net, lane);
+    }
+    for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+        _mm256_store_si256(reinterpret_cast<__m256i *>(netLanes), typeNet[t]);
+        for (std::int64_t lane : netLanes) {
+            tally.typeNet[t] = wrappingAdd(tally.typeNet[t], lane);
+        }
+    }
+    return i;
+}
+#endif
+
+#if defined(BATCH_POSTING_HAS_NEON)
+/**
+ * Bitwise NOT of a 64-bit lane mask (NEON only provides it on 32-bit lanes)
+ */
+inline uint64x2_t notMask(uint64x2_t mask) {
+    return vreinterpretq_u64_u32(vmvnq_u32(vreinterpretq_u32_u64(mask)));
+}
+
+/**
+ * Applies postings two at a time with NEON (AArch64 has no gather, so the
+ * two balances are loaded individually and checked together)
+ * @return Index of the first posting not processed (the scalar tail)
+ */
+inline std::size_t postNeon(std::int64_t *balances, const AccountType *types, std::size_t accountCount,
+                            const AccountSlot *slots,
+                            const std::int64_t *amounts, std::size_t count,
+                            std::uint64_t *rejectMask, Tally &tally) {
+    const int64x2_t zero = vdupq_n_s64(0);
+    int64x2_t net = zero;
+    std::array<std::int64_t, kAccountTypeCount> typeNet{};
+
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const AccountSlot s0 = slots[i];
+        const AccountSlot s1 = slots[i + 1];
+        const bool in0 = s0 < accountCount;
+        const bool in1 = s1 < accountCount;
+        if (s0 == s1) {
+            postScalar(balances, types, accountCount, slots, amounts, i, i + 2, rejectMask, tally);
+            continue;
+        }
+
+        const std::int64_t laneBalances[2] = {in0 ? balances[s0] : 0, in1 ? balances[s1] : 0};
+        const std::uint64_t laneInRange[2] = {in0 ? ~0ull : 0ull, in1 ? ~0ull : 0ull};
+        const int64x2_t before = vld1q_s64(laneBalances);
+        const uint64x2_t inRange = vld1q_u64(laneInRange);
+        const int64x2_t amount = vld1q_s64(amounts + i);
+        const int64x2_t after = vreinterpretq_s64_u64(
+            vaddq_u64(vreinterpretq_u64_s64(before), vreinterpretq_u64_s64(amount)));
+
+        const uint64x2_t isZero = vceqzq_s64(amount);
+        const uint64x2_t wouldOverdraw = vandq_u64(vcltzq_s64(amount), vcltzq_s64(after));
+        // A deposit that wrapped: amount > 0 && after < before
+        const uint64x2_t overflow = vandq_u64(vcgtzq_s64(amount), vcltq_s64(after, before));
+        const uint64x2_t invalid = vorrq_u64(vorrq_u64(isZero, overflow), notMask(inRange));
+        const uint64x2_t overdraft = vandq_u64(wouldOverdraw, inRange);
+        const uint64x2_t ok = notMask(vorrq_u64(invalid, overdraft));
+
+        const int64x2_t result = vbslq_s64(ok, after, before);
+        net = vaddq_s64(net, vandq_s64(amount, vreinterpretq_s64_u64(ok)));
+        if (in0) {
+            balances[s0] = vgetq_lane_s64(result, 0);
+        }
+        if (in1) {
+            balances[s1] = vgetq_lane_s64(result, 1);
+        }
+
+        const std::uint64_t rejected = (vgetq_lane_u64(ok, 0) ? 0u : 1u) | (vgetq_lane_u64(ok, 1) ? 0u : 2u);
+        rejectMask[i / 64] |= rejected << (i % 64);
+        tally.invalid += (vgetq_lane_u64(invalid, 0) & 1) + (vgetq_lane_u64(invalid, 1) & 1);
+        tally.insufficient += (vgetq_lane_u64(overdraft, 0) & 1) + (vgetq_lane_u64(overdraft, 1) & 1);
+        const uint64x2_t becameZero = vandq_u64(vceqzq_s64(after), ok);
+        const uint64x2_t wasZero = vandq_u64(vceqzq_s64(before), ok);
+        tally.zeroDelta += static_cast<std::int64_t>((vgetq_lane_u64(becameZero, 0) & 1) +
+                                                     (vgetq_lane_u64(becameZero, 1) & 1)) -
+                           static_cast<std::int64_t>((vgetq_lane_u64(wasZero, 0) & 1) +
+                                                     (vgetq_lane_u64(wasZero, 1) & 1));
+        // Split the applied amounts by the type of their account
+        const std::int64_t applied0 = amounts[i] & static_cast<std::int64_t>(vgetq_lane_u64(ok, 0));
+        const std::int64_t applied1 = amounts[i + 1] & static_cast<std::int64_t>(vgetq_lane_u64(ok, 1));
+        std::int64_t &typeNet0 = typeNet[static_cast<std::size_t>(types[in0 ? s0 : 0])];
+        typeNet0 = wrappingAdd(typeNet0, applied0);
+        std::int64_t &typeNet1 = typeNet[static_cast<std::size_t>(types[in1 ? s1 : 0])];
+        typeNet1 = wrappingAdd(typeNet1, applied1);
+    }
+    tally.net = wrappingAdd(wrappingAdd(tally.net, vgetq_lane_s64(net, 0)), vgetq_lane_s64(net, 1));
+    for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+        tally.typeNet[t] = wrappingAdd(tally.typeNet[t], typeNet[t]);
+    }
+    return i;
+}
+#endif
+
+} // namespace posting_kernels
+
+// ============================================================================
+// CLASS DEFINITION: BatchPoster
+// ============================================================================
+class BatchPoster {
+private:
+    // Stands in for the slot of a blocked posting (a store never grows this large)
+    static constexpr AccountSlot kBlockedSlot = ~AccountSlot{0};
+
+    PostingKernel kernel;   // Kernel selection
+
+    /**
+     * Journals the applied postings of a finished batch, in batch order
+     * Balances after each posting are recovered by walking the batch
+     * backwards from the final balances.
+     */
+    static void journalPostings(AccountStore &store, std::span<const AccountSlot> slots,
+                                std::span<const std::int64_t> amounts, const PostingReport &report) {
+        std::vector<JournalRecord> records(slots.size());
+        std::unordered_map<AccountSlot, std::int64_t> balanceAfter;
+        for (std::size_t i = slots.size(); i-- > 0;) {
+            if (report.isRejected(i)) {
+                continue;
+            }
+            auto it = balanceAfter.try_emplace(slots[i], store.balances[slots[i]]).first;
+            std::int64_t cents = amounts[i];
+            records[i] = journal::makeRecord(cents > 0 ? JournalOp::Deposit : JournalOp::Withdraw,
+                                             store.accountNumbers[slots[i]],
+                                             Money::fromMinorUnits(cents < 0 ? -cents : cents),
+                                             Money::fromMinorUnits(it->second));
+            it->second -= cents;
+        }
+        for (std::size_t i = 0; i < slots.size(); ++i) {
+            if (!report.isRejected(i)) {
+                store.recordSink->append(records[i]);
+            }
+        }
+    }
+
+public:
+    explicit BatchPoster(PostingKernel choice = PostingKernel::Auto) : kernel(choice) {}
+
+    /**
+     * @return true if a SIMD kernel will actually be used
+     */
+    bool usesSimd() const {
+        if (kernel == PostingKernel::Scalar) {
+            return false;
+        }
+#if defined(BATCH_POSTING_HAS_AVX2)
+        return posting_kernels::cpuHasAvx2();
+#elif defined(BATCH_POSTING_HAS_NEON)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Applies postings in order, reusing the report's storage
+     *
+     * @param store The accounts to post to
+     * @param slots Account slot of each posting
+     * @param amounts Signed amount in cents of each posting (same length)
+     * @param report Receives the rejection mask and counts (overwritten)
+     */
+    void post(AccountStore &store, std::span<const AccountSlot> slots,
+              std::span<const std::int64_t> amounts, PostingReport &report) const {
+        assert(slots.size() == amounts.size());
+        const std::size_t count = slots.size();
+        report.rejectMask.assign((count + 63) / 64, 0);
+
+        const std::size_t accountCount = store.size();
+        std::size_t frozen = 0;
+        std::vector<AccountSlot> screened;
+        if (store.restrictedAccounts != 0) {
+            // Blocked postings go to a slot past the end, so the kernels reject them
+            screened.assign(slots.begin(), slots.end());
+            for (std::size_t i = 0; i < count; ++i) {
+                const AccountSlot slot = slots[i];
+                if (slot < accountCount &&
+                    (amounts[i] < 0 ? store.blocksDebits(slot) : amounts[i] > 0 && store.blocksCredits(slot))) {
+                    screened[i] = kBlockedSlot;
+                    ++frozen;
+                }
+            }
+            slots = screened;
+        }
+        // Flag the pages the kernels may write; a lazy store also settles
+        // every named account first, since the kernels read raw balances
+        for (AccountSlot slot : slots) {
+            if (slot < accountCount) {
+                store.settle(slot);
+                store.markChanged(slot);
+            }
+        }
+        std::int64_t *balances = store.balances.data();
+        const AccountType *types = store.types.data();
+        posting_kernels::Tally tally;
+        std::size_t done = 0;
+
+        // Gather offsets are signed 32-bit, so huge stores stay on the scalar path
+        if (usesSimd() && accountCount > 0 && accountCount <= 0x7FFFFFFFu) {
+#if defined(BATCH_POSTING_HAS_AVX2)
+            done = posting_kernels::postAvx2(balances, types, accountCount, slots.data(), amounts.data(),
+                                             count, report.rejectMask.data(), tally);
+#elif defined(BATCH_POSTING_HAS_NEON)
+            done = posting_kernels::postNeon(balances, types, accountCount, slots.data(), amounts.data(),
+                                             count, report.rejectMask.data(), tally);
+#endif
+        }
+        if (accountCount > 0) {
+            posting_kernels::postScalar(balances, types, accountCount, slots.data(), amounts.data(), done,
+                                        count, report.rejectMask.data(), tally);
+        } else {
+            // Nothing to post to: every posting names an unknown slot
+            for (std::size_t i = 0; i < count; ++i) {
+                report.rejectMask[i / 64] |= std::uint64_t{1} << (i % 64);
+            }
+            tally.invalid = count;
+        }
+
+        report.invalid = tally.invalid - frozen;
+        report.frozen = frozen;
+        report.insufficientFunds = tally.insufficient;
+        report.applied = count - tally.invalid - tally.insufficient;
+        report.netPosted = Money::fromMinorUnits(tally.net);
+        store.aggregates.onBatch(tally.typeNet, tally.zeroDelta);
+
+        if (store.recordSink && report.applied > 0) {
+            journalPostings(store, slots, amounts, report);
+        }
+    }
+
+    /**
+     * Applies postings in order
+     * @return The rejection mask and counts
+     */
+    PostingReport post(AccountStore &store, std::span<const AccountSlot> slots,
+                       std::span<const std::int64_t> amounts) const {
+        PostingReport report;
+        post(store, slots, amounts, report);
+        return report;
+    }
+};
+
+#endif // BATCH_POSTING_HPP
@@ -0,0 +1,226 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../account_arena.hpp"
+#include "../account_store.hpp"
+#include "../bank_account.hpp"
+
+/**
+ * ============================================================================
+ * ALLOCATION BENCHMARK: account construction and getters
+ * ============================================================================
+ *
+ * Replaces the global operator new with a counting version and reports how
+ * many heap allocations happen per account while bulk-loading accounts and
+ * while reading them back through the getters.
+ *
+ * Expected result:
+ * - short names: 0 allocations per account (they fit the small buffer)
+ * - long names on the global heap: 1 allocation per account (the name is
+ *   copied into the account's own memory resource)
+ * - AccountArena: well under 0.01 allocations per account for any name
+ *   length (one chunk per 1024 accounts plus a few name blocks), and none
+ *   at all for the records after a reset
+ * - the threaded rows open accounts from every hardware thread at once,
+ *   first through the global heap, then with one arena per thread
+ *
+ * BUILD:
+ *   g++ -std=c++20 -O2 allocation_bench.cpp -o allocation_bench
+ * ============================================================================
+ */
+
+static std::atomic<std::size_t> allocationCount{0};
+
+void *operator new(std::size_t size) {
+    ++allocationCount;
+    if (void *memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+// std::pmr::new_delete_resource allocates through the aligned overloads
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    ++allocationCount;
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (void *memory = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+constexpr std::size_t kAccounts = 100000;
+
+/**
+ * Prints one result row
+ * @param label What was measured
+ * @param allocations Allocations counted during the measurement
+ * @param start When the measurement began
+ */
+void report(const char *label, std::size_t allocations,
+            std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    std::printf("%-44s %10.3f allocs/account %10.1f ns/account\n", label,
+                static_cast<double>(allocations) / kAccounts, elapsed.count() / kAccounts);
+}
+
+/**
+ * Constructs kAccounts BankAccounts into pre-reserved storage
+ * @param names Holder names, one per account
+ * @param label Row label for the report
+ */
+void benchConstruction(std::vector<std::string> &names, const char *label) {
+    std::vector<BankAccount> accounts;
+    accounts.reserve(kAccounts);
+
+    std::size_t before = allocationCount;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kAccounts; ++i) {
+        accounts.emplace_back(*AccountId::make("ACC", i), names[i],
+                              Money::fromMajorUnits(100), AccountType::Savings,
+                              InterestRate::fromBasisPoints(350));
+    }
+    report(label, allocationCount - before, start);
+
+    before = allocationCount;
+    start = std::chrono::steady_clock::now();
+    std::size_t checksum = 0;
+    for (const BankAccount &account : accounts) {
+        checksum += account.getAccountHolder().size();
+        checksum += account.getAccountNumber().text().view().size();
+        checksum += toString(account.getAccountType()).size();
+        checksum += static_cast<std::size_t>(account.getBalance().getMinorUnits());
+    }
+    report("  getters (holder, number, type, balance)", allocationCount - before, start);
+    std::printf("  (checksum %zu)\n", checksum);
+}
+
+/**
+ * Opens kAccounts rows in a pre-reserved AccountStore
+ * @param names Holder names, one per account (moved from)
+ */
+void benchStore(std::vector<std::string> &names) {
+    AccountStore store;
+    store.reserve(kAccounts);
+
+    std::size_t before = allocationCount;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kAccounts; ++i) {
+        store.open(*AccountId::make("ACC", i), std::move(names[i]), Money::fromMajorUnits(100));
+    }
+    report("AccountStore::open, short names", allocationCount - before, start);
+}
+
+/**
+ * Opens kAccounts accounts in an arena, twice, with a reset in between
+ * @param names Holder names, one per account
+ * @param label Row label for the report
+ */
+void benchArena(const std::vector<std::string> &names, const char *label) {
+    AccountArena arena;
+    for (int round = 0; round < 2; ++round) {
+        std::size_t before = allocationCount;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < kAccounts; ++i) {
+            arena.open(*AccountId::make("ACC", i), names[i], Money::fromMajorUnits(100),
+                       AccountType::Savings, InterestRate::fromBasisPoints(350));
+        }
+        report(round == 0 ? label : "  same arena after reset()", allocationCount - before, start);
+        arena.reset();
+    }
+}
+
+/**
+ * Opens and closes kAccounts accounts on every hardware thread at once
+ * @param useArena Give each thread its own AccountArena instead of the heap
+ */
+void benchThreads(const std::vector<std::string> &names, bool useArena) {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t before = allocationCount;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&names, useArena] {
+            if (useArena) {
+                AccountArena arena;
+                for (std::size_t i = 0; i < kAccounts; ++i) {
+                    arena.open(*AccountId::make("ACC", i), names[i], Money::fromMajorUnits(100));
+                }
+            } else {
+                std::vector<std::unique_ptr<BankAccount>> accounts;
+                accounts.reserve(kAccounts);
+                for (std::size_t i = 0; i < kAccounts; ++i) {
+                    accounts.push_back(std::make_unique<BankAccount>(*AccountId::make("ACC", i), names[i],
+                                                                     Money::fromMajorUnits(100)));
+                }
+            }
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    char label[64];
+    std::snprintf(label, sizeof label, "%u threads, %s, long names", threads,
+                  useArena ? "arena per thread" : "global heap");
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    std::printf("%-44s %10.3f allocs/account %10.1f ns/account\n", label,
+                static_cast<double>(allocationCount - before) / (kAccounts * threads),
+                elapsed.count() / (kAccounts * threads));
+}
+
+/**
+ * @param length Length of every generated name
+ * @return kAccounts holder names built before any measurement starts
+ */
+std::vector<std::string> makeNames(std::size_t length) {
+    std::vector<std::string> names;
+    names.reserve(kAccounts);
+    for (std::size_t i = 0; i < kAccounts; ++i) {
+        names.emplace_back(length, static_cast<char>('a' + i % 26));
+    }
+    return names;
+}
+
+} // namespace
+
+int main() {
+    std::printf("Accounts per run: %zu\n\n", kAccounts);
+
+    std::vector<std::string> shortNames = makeNames(8);
+    benchConstruction(shortNames, "BankAccount construction, short names");
+
+    std::vector<std::string> longNames = makeNames(40);
+    benchConstruction(longNames, "BankAccount construction, long names");
+    benchArena(longNames, "AccountArena::open, long names");
+    benchThreads(longNames, false);
+    benchThreads(longNames, true);
+
+    std::vector<std::string> storeNames = makeNames(8);
+    benchStore(storeNames);
+    return 0;
+}
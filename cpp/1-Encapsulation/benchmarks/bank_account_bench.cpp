@@ -0,0 +1,495 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../account_index.hpp"
+#include "../bank_account.hpp"
+#include "../basic_account.hpp"
+#include "../cache_line.hpp"
+#include "../concurrent_account.hpp"
+#include "../console_account_printer.hpp"
+#include "../striped_account.hpp"
+
+/**
+ * ============================================================================
+ * BENCHMARK SUITE: BankAccount hot paths
+ * ============================================================================
+ *
+ * Covers construction, the getters, deposit, withdraw, transfer and
+ * applyInterest, plus account-number lookup (FlatAccountIndex against
+ * std::unordered_map):
+ * - <true>  variants run in VERBOSE mode (ConsoleAccountPrinter attached,
+ *           writing to /dev/null so the cost is formatting plus the stream)
+ * - <false> variants run in SILENT mode (no observer)
+ * - BM_Policy* run the same loops on BasicAccount products (SavingsAccount,
+ *   CheckingAccount), whose rules are compile-time policies
+ * - BM_Neighbour* and BM_Hot* show scaling with the number of threads:
+ *   one account per thread packed next to each other vs padded to cache
+ *   lines, and one hot merchant account as ConcurrentAccount vs
+ *   StripedAccount
+ * - every benchmark is run for 1K, 10K, 100K, 1M and 10M accounts and for
+ *   1, 2, 4, ... threads up to the number of hardware threads
+ *
+ * BankAccount is not thread-safe, so in the multi-threaded runs each thread
+ * works on its own share of the accounts (count / threads). The
+ * ConcurrentAccount benchmarks share one set of accounts between all
+ * threads, to show contention.
+ *
+ * BUILD:
+ *   g++ -std=c++20 -O2 bank_account_bench.cpp -o bank_account_bench -lbenchmark -pthread
+ *   add -DBANK_ENABLE_METRICS to measure the cost of operation_metrics.hpp
+ *
+ * RUN (JSON results for regression tracking):
+ *   ./bank_account_bench --benchmark_out=bank_account_bench.json --benchmark_out_format=json
+ *   ./bank_account_bench --benchmark_filter='Deposit<false>'   # one benchmark family
+ * ============================================================================
+ */
+
+namespace {
+
+constexpr std::int64_t kMinAccounts = 1'000;
+constexpr std::int64_t kMaxAccounts = 10'000'000;
+
+// Large enough that withdrawals and transfers never run out of money
+constexpr Money kOpeningBalance = Money::fromMajorUnits(1'000'000'000);
+constexpr Money kAmount = Money::fromMinorUnits(1'25);
+
+/**
+ * Accounts used by one benchmark thread, optionally with a printer attached
+ */
+class AccountSet {
+private:
+    std::ofstream sink;                               // Discards verbose output
+    std::unique_ptr<ConsoleAccountPrinter> printer;   // nullptr in silent mode
+    std::vector<BankAccount> accounts;
+
+public:
+    /**
+     * @param count Number of accounts to open
+     * @param verbose Attach a ConsoleAccountPrinter once they are open
+     */
+    AccountSet(std::size_t count, bool verbose) {
+        if (verbose) {
+            sink.open("/dev/null");
+            printer = std::make_unique<ConsoleAccountPrinter>(sink);
+        }
+        accounts.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            accounts.emplace_back(AccountId::fromPacked(i + 1), "Benchmark Holder", kOpeningBalance,
+                                  i % 2 ? AccountType::Checking : AccountType::Savings,
+                                  InterestRate::fromBasisPoints(1));
+            accounts.back().setObserver(printer.get());
+        }
+    }
+
+    ~AccountSet() {
+        // Closing messages are not part of any measurement
+        for (BankAccount &account : accounts) {
+            account.setObserver(nullptr);
+        }
+    }
+
+    std::size_t size() const { return accounts.size(); }
+    BankAccount &operator[](std::size_t i) { return accounts[i]; }
+};
+
+/**
+ * @return This thread's share of the benchmark's account count (at least 1)
+ */
+std::size_t accountsPerThread(const benchmark::State &state) {
+    return static_cast<std::size_t>(std::max<std::int64_t>(1, state.range(0) / state.threads()));
+}
+
+/**
+ * Runs every benchmark over the account counts and thread counts
+ */
+void accountCountsAndThreads(benchmark::internal::Benchmark *b) {
+    b->RangeMultiplier(10)->Range(kMinAccounts, kMaxAccounts)->UseRealTime();
+    int maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        b->Threads(threads);
+    }
+}
+
+// ============================================================================
+// BankAccount BENCHMARKS
+// ============================================================================
+template <bool Verbose>
+void BM_Construct(benchmark::State &state) {
+    const std::size_t count = accountsPerThread(state);
+    std::ofstream sink("/dev/null");
+    ConsoleAccountPrinter printer(sink);
+    AccountObserver *observer = Verbose ? &printer : nullptr;
+    std::vector<BankAccount> accounts;
+    accounts.reserve(count);
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < count; ++i) {
+            accounts.emplace_back(AccountId::fromPacked(i + 1), "Benchmark Holder", kOpeningBalance,
+                                  AccountType::Savings, InterestRate::fromBasisPoints(1), observer);
+        }
+        state.PauseTiming();
+        for (BankAccount &account : accounts) {
+            account.setObserver(nullptr);
+        }
+        accounts.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+
+template <bool Verbose>
+void BM_Getters(benchmark::State &state) {
+    AccountSet accounts(accountsPerThread(state), Verbose);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        BankAccount &account = accounts[i];
+        benchmark::DoNotOptimize(account.getAccountNumber());
+        benchmark::DoNotOptimize(account.getAccountHolder());
+        benchmark::DoNotOptimize(account.getAccountType());
+        benchmark::DoNotOptimize(account.getBalance());
+        benchmark::DoNotOptimize(account.getInterestRate());
+        if (++i == accounts.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <bool Verbose>
+void BM_Deposit(benchmark::State &state) {
+    AccountSet accounts(accountsPerThread(state), Verbose);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(accounts[i].deposit(kAmount));
+        if (++i == accounts.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <bool Verbose>
+void BM_Withdraw(benchmark::State &state) {
+    AccountSet accounts(accountsPerThread(state), Verbose);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(accounts[i].withdraw(kAmount));
+        if (++i == accounts.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <bool Verbose>
+void BM_Transfer(benchmark::State &state) {
+    AccountSet accounts(accountsPerThread(state), Verbose);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        std::size_t next = i + 1 == accounts.size() ? 0 : i + 1;
+        benchmark::DoNotOptimize(accounts[i].transfer(accounts[next], kAmount));
+        i = next;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <bool Verbose>
+void BM_ApplyInterest(benchmark::State &state) {
+    AccountSet accounts(accountsPerThread(state), Verbose);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(accounts[i].applyInterest());
+        if (++i == accounts.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_Construct, true)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_Construct, false)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_Getters, true)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_Getters, false)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_Deposit, true)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_Deposit, false)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_Withdraw, true)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_Withdraw, false)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_Transfer, true)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_Transfer, false)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_ApplyInterest, true)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_ApplyInterest, false)->Apply(accountCountsAndThreads);
+
+// ============================================================================
+// BasicAccount BENCHMARKS (compile-time product policies, silent)
+// ============================================================================
+template <class Account>
+std::vector<Account> openPolicyAccounts(std::size_t count) {
+    std::vector<Account> accounts;
+    accounts.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        accounts.emplace_back(AccountId::fromPacked(i + 1), "Benchmark Holder", kOpeningBalance);
+    }
+    return accounts;
+}
+
+template <class Account>
+void BM_PolicyDeposit(benchmark::State &state) {
+    std::vector<Account> accounts = openPolicyAccounts<Account>(accountsPerThread(state));
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(accounts[i].deposit(kAmount));
+        if (++i == accounts.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <class Account>
+void BM_PolicyWithdraw(benchmark::State &state) {
+    std::vector<Account> accounts = openPolicyAccounts<Account>(accountsPerThread(state));
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(accounts[i].withdraw(kAmount));
+        if (++i == accounts.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_PolicyDeposit, SavingsAccount)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_PolicyDeposit, CheckingAccount)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_PolicyWithdraw, SavingsAccount)->Apply(accountCountsAndThreads);
+BENCHMARK_TEMPLATE(BM_PolicyWithdraw, CheckingAccount)->Apply(accountCountsAndThreads);
+
+// ============================================================================
+// ConcurrentAccount BENCHMARKS (accounts shared by all threads)
+// ============================================================================
+/**
+ * One set of ConcurrentAccounts shared by every thread of a benchmark run
+ * The first thread to ask for a new size rebuilds it; the others wait.
+ */
+class SharedAccounts {
+private:
+    static inline std::mutex mutex;
+    static inline std::deque<ConcurrentAccount> accounts;
+
+public:
+    static std::deque<ConcurrentAccount> &get(std::size_t count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (accounts.size() != count) {
+            accounts.clear();
+            for (std::size_t i = 0; i < count; ++i) {
+                accounts.emplace_back(AccountId::fromPacked(i + 1), "Shared Holder", kOpeningBalance,
+                                      AccountType::Checking, InterestRate::fromBasisPoints(1));
+            }
+        }
+        return accounts;
+    }
+};
+
+/**
+ * @return Start offset that spreads the threads over the shared accounts
+ */
+std::size_t threadStart(const benchmark::State &state, std::size_t count) {
+    return static_cast<std::size_t>(state.thread_index()) * count /
+           static_cast<std::size_t>(state.threads());
+}
+
+void BM_ConcurrentDeposit(benchmark::State &state) {
+    std::deque<ConcurrentAccount> &accounts = SharedAccounts::get(static_cast<std::size_t>(state.range(0)));
+    std::size_t i = threadStart(state, accounts.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(accounts[i].deposit(kAmount));
+        if (++i == accounts.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ConcurrentWithdraw(benchmark::State &state) {
+    std::deque<ConcurrentAccount> &accounts = SharedAccounts::get(static_cast<std::size_t>(state.range(0)));
+    std::size_t i = threadStart(state, accounts.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(accounts[i].withdraw(kAmount));
+        if (++i == accounts.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ConcurrentTransfer(benchmark::State &state) {
+    std::deque<ConcurrentAccount> &accounts = SharedAccounts::get(static_cast<std::size_t>(state.range(0)));
+    std::size_t i = threadStart(state, accounts.size());
+    for (auto _ : state) {
+        std::size_t next = i + 1 == accounts.size() ? 0 : i + 1;
+        benchmark::DoNotOptimize(transfer(accounts[i], accounts[next], kAmount));
+        i = next;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ConcurrentDeposit)->Apply(accountCountsAndThreads);
+BENCHMARK(BM_ConcurrentWithdraw)->Apply(accountCountsAndThreads);
+BENCHMARK(BM_ConcurrentTransfer)->Apply(accountCountsAndThreads);
+
+// ============================================================================
+// HOT ACCOUNT BENCHMARKS (false sharing, one hot merchant account)
+// ============================================================================
+/**
+ * Runs a benchmark for 1, 2, 4, ... threads up to the number of hardware threads
+ */
+void threadCounts(benchmark::internal::Benchmark *b) {
+    b->UseRealTime();
+    int maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        b->Threads(threads);
+    }
+}
+
+/**
+ * One account per thread, stored next to each other (a deque keeps small
+ * elements in contiguous blocks), shared by every thread of a run
+ * Slot = ConcurrentAccount packs neighbours into the same cache lines;
+ * Slot = CacheLinePadded<ConcurrentAccount> gives each its own.
+ */
+template <class Slot>
+std::deque<Slot> &neighbourAccounts(std::size_t count) {
+    static std::mutex mutex;
+    static std::deque<Slot> accounts;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (accounts.size() != count) {
+        accounts.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            accounts.emplace_back(AccountId::fromPacked(i + 1), "Neighbour Holder", kOpeningBalance);
+        }
+    }
+    return accounts;
+}
+
+ConcurrentAccount &account(ConcurrentAccount &slot) { return slot; }
+ConcurrentAccount &account(CacheLinePadded<ConcurrentAccount> &slot) { return *slot; }
+
+template <class Slot>
+void BM_NeighbourDeposit(benchmark::State &state) {
+    std::deque<Slot> &accounts = neighbourAccounts<Slot>(static_cast<std::size_t>(state.threads()));
+    ConcurrentAccount &mine = account(accounts[static_cast<std::size_t>(state.thread_index())]);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mine.deposit(kAmount));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * The merchant account every thread pays into (opened empty, so its
+ * payouts rely on the money deposited)
+ */
+template <class Account>
+Account &hotAccount() {
+    static Account merchant(AccountId::fromPacked(1), "Merchant", Money());
+    return merchant;
+}
+
+template <class Account>
+void BM_HotDeposit(benchmark::State &state) {
+    Account &merchant = hotAccount<Account>();
+    std::uint64_t i = 0;
+    for (auto _ : state) {
+        if ((++i & 255) == 0) {
+            benchmark::DoNotOptimize(merchant.withdraw(kAmount));   // An occasional checked payout
+        } else {
+            benchmark::DoNotOptimize(merchant.deposit(kAmount));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_NeighbourDeposit, ConcurrentAccount)->Apply(threadCounts);
+BENCHMARK_TEMPLATE(BM_NeighbourDeposit, CacheLinePadded<ConcurrentAccount>)->Apply(threadCounts);
+BENCHMARK_TEMPLATE(BM_HotDeposit, ConcurrentAccount)->Apply(threadCounts);
+BENCHMARK_TEMPLATE(BM_HotDeposit, StripedAccount)->Apply(threadCounts);
+
+// ============================================================================
+// ACCOUNT LOOKUP BENCHMARKS (random ids, shared read-only index)
+// ============================================================================
+/**
+ * @return Account ids to look up, in random order (all present)
+ */
+std::vector<AccountId> lookupKeys(std::size_t count) {
+    std::vector<AccountId> keys(count);
+    std::mt19937_64 rng(42);
+    for (AccountId &key : keys) {
+        key = AccountId::fromPacked(rng() % count + 1);
+    }
+    return keys;
+}
+
+void BM_FlatIndexFind(benchmark::State &state) {
+    static std::mutex mutex;
+    static std::unique_ptr<FlatAccountIndex> index;
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!index || index->size() != count) {
+            index = std::make_unique<FlatAccountIndex>(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                index->insert(AccountId::fromPacked(i + 1), static_cast<FlatAccountIndex::Slot>(i));
+            }
+        }
+    }
+    std::vector<AccountId> keys = lookupKeys(std::min<std::size_t>(count, 1 << 20));
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index->find(keys[i]));
+        if (++i == keys.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_UnorderedMapFind(benchmark::State &state) {
+    static std::mutex mutex;
+    static std::unordered_map<AccountId, std::uint32_t> index;
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (index.size() != count) {
+            index.clear();
+            index.reserve(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                index.emplace(AccountId::fromPacked(i + 1), static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+    std::vector<AccountId> keys = lookupKeys(std::min<std::size_t>(count, 1 << 20));
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.find(keys[i]));
+        if (++i == keys.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_FlatIndexFind)->Apply(accountCountsAndThreads);
+BENCHMARK(BM_UnorderedMapFind)->Apply(accountCountsAndThreads);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,834 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../account_store.hpp"
+#include "../bank_account.hpp"
+#include "../cache_line.hpp"
+#include "../concurrent_account.hpp"
+#include "../journal.hpp"
+#include "../operation_metrics.hpp"
+#include "../sharded_store.hpp"
+
+/**
+ * ============================================================================
+ * LOAD GENERATOR: reproducible mixed workloads and journal replay
+ * ============================================================================
+ *
+ * Opens N accounts (log-normal opening balances around a median, a chosen
+ * share of Savings accounts) and drives a mix of deposits, withdrawals,
+ * transfers and interest postings from T threads against each engine:
+ * - object:     std::vector<BankAccount>, the single-object path; with more
+ *               than one thread every account is guarded by one of 1024
+ *               striped mutexes
+ * - concurrent: ConcurrentAccount (atomic balances, seqlock transfers)
+ * - store:      AccountStore through AccountRef; one mutex around the store
+ *               when more than one thread runs
+ * - sharded:    ShardedAccountStore; every operation waits for its reply
+ *
+ * Accounts are picked with Zipfian skew (YCSB's generator; theta 0 is
+ * uniform) over a seeded permutation, so the hot accounts are scattered
+ * over the store instead of sitting in its first cache lines. All random
+ * numbers come from SplitMix64 rather than the <random> distributions,
+ * whose output differs between standard libraries: the same seed gives the
+ * same accounts and the same operation streams on every platform. Each
+ * thread's stream is generated before the clock starts.
+ *
+ * Every operation is timed on its own (the clock cost printed in the header
+ * is included). The report shows throughput, p50/p99/p999 overall and per
+ * operation, and the speedup over the object engine. With one thread the
+ * engines see identical histories, so their success counts and final
+ * totals must agree; a difference is a bug in one of them.
+ *
+ * --capture journals the store engine's run (JournalWriter on the store);
+ * --replay re-applies a captured journal to an AccountStore and to a map of
+ * BankAccount and reports records per second and balance mismatches.
+ *
+ * Expected result: store close to or faster than object on one thread
+ * (no per-object indirection), concurrent and sharded ahead of object and
+ * store once several threads contend, sharded paying a queue round trip
+ * per operation in latency.
+ *
+ * BUILD:
+ *   g++ -std=c++20 -O2 -pthread load_generator.cpp -o load_generator
+ * RUN:
+ *   ./load_generator --accounts=100000 --threads=4 --ops=1000000 --zipf=0.99
+ *   ./load_generator --engines=store --capture=load.journal
+ *   ./load_generator --replay=load.journal
+ *   ./load_generator --help                      # every option
+ * ============================================================================
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// ============================================================================
+// OPTIONS
+// ============================================================================
+/**
+ * Workload description (all settable from the command line)
+ */
+struct LoadOptions {
+    std::size_t accounts = 100'000;
+    std::size_t threads = 1;
+    std::size_t opsPerThread = 1'000'000;
+    std::uint64_t seed = 42;
+    double zipfTheta = 0.99;          // 0 = uniform, must stay below 1
+    unsigned depositWeight = 40;      // Operation mix (relative weights)
+    unsigned withdrawWeight = 30;
+    unsigned transferWeight = 25;
+    unsigned interestWeight = 5;
+    double savingsShare = 0.5;        // Share of Savings accounts
+    std::int64_t medianBalance = 1'000;   // Dollars
+    double balanceSigma = 1.0;        // Log-normal spread (0 = every account at the median)
+    std::int64_t maxAmount = 200;     // Largest deposit/withdraw/transfer, dollars
+    std::int32_t savingsRateBp = 2;   // Per interest posting
+    std::int32_t checkingRateBp = 0;
+    std::size_t shards = 0;           // ShardedAccountStore shards (0 = one per core)
+    std::string engines = "object,concurrent,store,sharded";
+    std::string capturePath;
+    std::string replayPath;
+};
+
+void printUsage() {
+    std::printf(
+        "usage: load_generator [--option=value ...]\n"
+        "  --accounts=N          accounts to open (100000)\n"
+        "  --threads=T           client threads (1)\n"
+        "  --ops=M               operations per thread (1000000)\n"
+        "  --seed=S              RNG seed (42)\n"
+        "  --zipf=THETA          account skew in [0, 1), 0 = uniform (0.99)\n"
+        "  --mix=D,W,T,I         deposit,withdraw,transfer,interest weights (40,30,25,5)\n"
+        "  --savings=F           share of Savings accounts (0.5)\n"
+        "  --balance=MEDIAN      median opening balance in dollars (1000)\n"
+        "  --sigma=S             log-normal spread of opening balances (1.0)\n"
+        "  --amount=MAX          largest operation amount in dollars (200)\n"
+        "  --rates=SAV,CHK       interest per posting in basis points (2,0)\n"
+        "  --shards=N            shards for the sharded engine (one per core)\n"
+        "  --engines=LIST        any of object,concurrent,store,sharded (all)\n"
+        "  --capture=FILE        journal the store engine's run to FILE\n"
+        "  --replay=FILE         replay FILE instead of generating load\n");
+}
+
+/**
+ * Parses "a,b,c" into numbers
+ * @return false if there are not exactly count numbers
+ */
+template <class T>
+bool parseList(std::string_view text, T *out, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t comma = text.find(',');
+        std::string item(text.substr(0, comma));
+        char *end = nullptr;
+        out[i] = static_cast<T>(std::strtoll(item.c_str(), &end, 10));
+        if (item.empty() || *end != '\0' || (comma == std::string_view::npos) != (i + 1 == count)) {
+            return false;
+        }
+        text.remove_prefix(comma == std::string_view::npos ? text.size() : comma + 1);
+    }
+    return true;
+}
+
+/**
+ * @return false (after printing why) if an argument is unknown or malformed
+ */
+bool parseOptions(int argc, char **argv, LoadOptions &options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        std::size_t equals = arg.find('=');
+        std::string_view name = arg.substr(0, equals);
+        std::string value(equals == std::string_view::npos ? std::string_view() : arg.substr(equals + 1));
+        const char *text = value.c_str();
+        bool ok = true;
+        if (name == "--accounts") {
+            options.accounts = std::strtoull(text, nullptr, 10);
+        } else if (name == "--threads") {
+            options.threads = std::strtoull(text, nullptr, 10);
+        } else if (name == "--ops") {
+            options.opsPerThread = std::strtoull(text, nullptr, 10);
+        } else if (name == "--seed") {
+            options.seed = std::strtoull(text, nullptr, 10);
+        } else if (name == "--zipf") {
+            options.zipfTheta = std::strtod(text, nullptr);
+            ok = options.zipfTheta >= 0.0 && options.zipfTheta < 1.0;
+        } else if (name == "--mix") {
+            unsigned weights[4];
+            ok = parseList(value, weights, 4) && weights[0] + weights[1] + weights[2] + weights[3] > 0;
+            if (ok) {
+                options.depositWeight = weights[0];
+                options.withdrawWeight = weights[1];
+                options.transferWeight = weights[2];
+                options.interestWeight = weights[3];
+            }
+        } else if (name == "--savings") {
+            options.savingsShare = std::strtod(text, nullptr);
+        } else if (name == "--balance") {
+            options.medianBalance = std::strtoll(text, nullptr, 10);
+        } else if (name == "--sigma") {
+            options.balanceSigma = std::strtod(text, nullptr);
+        } else if (name == "--amount") {
+            options.maxAmount = std::strtoll(text, nullptr, 10);
+            ok = options.maxAmount > 0;
+        } else if (name == "--rates") {
+            std::int32_t rates[2];
+            ok = parseList(value, rates, 2);
+            if (ok) {
+                options.savingsRateBp = rates[0];
+                options.checkingRateBp = rates[1];
+            }
+        } else if (name == "--shards") {
+            options.shards = std::strtoull(text, nullptr, 10);
+        } else if (name == "--engines") {
+            options.engines = value;
+        } else if (name == "--capture") {
+            options.capturePath = value;
+        } else if (name == "--replay") {
+            options.replayPath = value;
+        } else {
+            if (name != "--help") {
+                std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+            }
+            return false;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "bad value: %s\n", argv[i]);
+            return false;
+        }
+    }
+    if (options.accounts < 2 || options.threads == 0) {
+        std::fprintf(stderr, "need at least 2 accounts and 1 thread\n");
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// DETERMINISTIC RANDOM NUMBERS
+// ============================================================================
+/**
+ * SplitMix64: tiny, fast and specified bit for bit
+ */
+class SplitMix64 {
+private:
+    std::uint64_t state;
+
+public:
+    explicit SplitMix64(std::uint64_t seed) : state(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @return Uniform in [0, 1)
+     */
+    double nextDouble() {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    /**
+     * @return Uniform in [0, bound)
+     */
+    std::uint64_t nextBelow(std::uint64_t bound) {
+        return static_cast<std::uint64_t>((static_cast<WideInt>(next()) * bound) >> 64);
+    }
+};
+
+/**
+ * Zipfian ranks in [0, n) (Gray et al., as used by YCSB)
+ * Rank 0 is the most popular; theta 0 degenerates to uniform.
+ */
+class ZipfianGenerator {
+private:
+    std::uint64_t n;
+    double theta;
+    double alpha = 0.0;
+    double zetaN = 0.0;
+    double eta = 0.0;
+    double halfPowTheta = 0.0;
+
+    static double zeta(std::uint64_t count, double theta) {
+        double sum = 0.0;
+        for (std::uint64_t i = 1; i <= count; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        return sum;
+    }
+
+public:
+    /**
+     * @param count Number of items (O(count) to set up)
+     * @param skew Theta in [0, 1)
+     */
+    ZipfianGenerator(std::uint64_t count, double skew) : n(count), theta(skew) {
+        if (theta == 0.0) {
+            return;
+        }
+        alpha = 1.0 / (1.0 - theta);
+        zetaN = zeta(n, theta);
+        eta = (1.0 - std::pow(2.0 / static_cast<double>(n), 1.0 - theta)) / (1.0 - zeta(2, theta) / zetaN);
+        halfPowTheta = std::pow(0.5, theta);
+    }
+
+    std::uint64_t next(SplitMix64 &rng) const {
+        if (theta == 0.0) {
+            return rng.nextBelow(n);
+        }
+        double u = rng.nextDouble();
+        double uz = u * zetaN;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < 1.0 + halfPowTheta) {
+            return 1;
+        }
+        auto rank = static_cast<std::uint64_t>(static_cast<double>(n) * std::pow(eta * u - eta + 1.0, alpha));
+        return std::min(rank, n - 1);
+    }
+};
+
+// ============================================================================
+// POPULATION AND OPERATION STREAMS
+// ============================================================================
+/**
+ * The accounts every engine opens (index i is account number i + 1)
+ */
+struct Population {
+    std::vector<AccountId> ids;
+    std::vector<std::string> holders;
+    std::vector<Money> balances;
+    std::vector<AccountType> types;
+    std::vector<InterestRate> rates;
+};
+
+Population makePopulation(const LoadOptions &options) {
+    SplitMix64 rng(options.seed);
+    Population population;
+    population.ids.reserve(options.accounts);
+    population.holders.reserve(options.accounts);
+    population.balances.reserve(options.accounts);
+    population.types.reserve(options.accounts);
+    population.rates.reserve(options.accounts);
+    for (std::size_t i = 0; i < options.accounts; ++i) {
+        population.ids.push_back(*AccountId::make("ACC", i + 1, 7));
+        population.holders.push_back("Holder " + std::to_string(i + 1));
+
+        // Box-Muller: one standard normal from two uniforms
+        double u1 = 1.0 - rng.nextDouble();
+        double u2 = rng.nextDouble();
+        double normal = std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+        double dollars = static_cast<double>(options.medianBalance) * std::exp(options.balanceSigma * normal);
+        population.balances.push_back(Money::fromMinorUnits(static_cast<std::int64_t>(std::min(dollars, 1e9) * 100.0)));
+
+        bool savings = rng.nextDouble() < options.savingsShare;
+        population.types.push_back(savings ? AccountType::Savings : AccountType::Checking);
+        population.rates.push_back(
+            InterestRate::fromBasisPoints(savings ? options.savingsRateBp : options.checkingRateBp));
+    }
+    return population;
+}
+
+enum class OpKind : std::uint8_t { Deposit, Withdraw, Transfer, Interest };
+
+constexpr std::size_t kOpKinds = 4;
+constexpr const char *kOpNames[kOpKinds] = {"deposit", "withdraw", "transfer", "interest"};
+
+/**
+ * One generated operation (accounts are population indexes)
+ */
+struct Op {
+    OpKind kind;
+    std::uint32_t account;
+    std::uint32_t other;   // Transfer destination
+    Money amount;
+};
+
+/**
+ * Generates every thread's operations
+ * Thread t's stream depends only on the seed and t.
+ */
+std::vector<std::vector<Op>> makeStreams(const LoadOptions &options) {
+    ZipfianGenerator zipf(options.accounts, options.zipfTheta);
+
+    // Rank -> account, so popularity is not tied to the account's position
+    std::vector<std::uint32_t> byRank(options.accounts);
+    SplitMix64 shuffle(options.seed ^ 0x5DEECE66Dull);
+    for (std::size_t i = 0; i < byRank.size(); ++i) {
+        byRank[i] = static_cast<std::uint32_t>(i);
+    }
+    for (std::size_t i = byRank.size() - 1; i > 0; --i) {
+        std::swap(byRank[i], byRank[shuffle.nextBelow(i + 1)]);
+    }
+
+    const unsigned mixTotal =
+        options.depositWeight + options.withdrawWeight + options.transferWeight + options.interestWeight;
+    const auto maxCents = static_cast<std::uint64_t>(options.maxAmount) * 100;
+
+    std::vector<std::vector<Op>> streams(options.threads);
+    for (std::size_t t = 0; t < options.threads; ++t) {
+        SplitMix64 rng(options.seed + 0x632BE59BD9B4E019ull * (t + 1));
+        std::vector<Op> &ops = streams[t];
+        ops.reserve(options.opsPerThread);
+        for (std::size_t i = 0; i < options.opsPerThread; ++i) {
+            Op op;
+            auto pick = static_cast<unsigned>(rng.nextBelow(mixTotal));
+            op.kind = pick < options.depositWeight ? OpKind::Deposit
+                      : pick < options.depositWeight + options.withdrawWeight ? OpKind::Withdraw
+                      : pick < mixTotal - options.interestWeight ? OpKind::Transfer
+                                                                 : OpKind::Interest;
+            op.account = byRank[zipf.next(rng)];
+            op.other = byRank[zipf.next(rng)];
+            if (op.other == op.account) {
+                op.other = static_cast<std::uint32_t>((op.account + 1) % options.accounts);
+            }
+            op.amount = Money::fromMinorUnits(static_cast<std::int64_t>(1 + rng.nextBelow(maxCents)));
+            ops.push_back(op);
+        }
+    }
+    return streams;
+}
+
+// ============================================================================
+// ENGINES
+// ============================================================================
+// Each engine opens the population in its constructor (not timed) and
+// offers execute(op) -> succeeded, totalBalance() and its name.
+
+/**
+ * BankAccount objects, striped mutexes when shared between threads
+ */
+class ObjectEngine {
+private:
+    static constexpr std::size_t kStripes = 1024;
+
+    std::vector<BankAccount> accounts;
+    std::unique_ptr<CacheLinePadded<std::mutex>[]> stripes;
+    bool locking;
+
+    std::mutex &stripeOf(std::uint32_t account) { return *stripes[account % kStripes]; }
+
+    TransactionResult apply(const Op &op) {
+        BankAccount &account = accounts[op.account];
+        switch (op.kind) {
+        case OpKind::Deposit:
+            return account.deposit(op.amount);
+        case OpKind::Withdraw:
+            return account.withdraw(op.amount);
+        case OpKind::Transfer:
+            return account.transfer(accounts[op.other], op.amount);
+        case OpKind::Interest:
+            return account.applyInterest();
+        }
+        return {};
+    }
+
+public:
+    static constexpr const char *kName = "object";
+
+    ObjectEngine(const Population &population, const LoadOptions &options)
+        : stripes(std::make_unique<CacheLinePadded<std::mutex>[]>(kStripes)), locking(options.threads > 1) {
+        accounts.reserve(population.ids.size());
+        for (std::size_t i = 0; i < population.ids.size(); ++i) {
+            accounts.emplace_back(population.ids[i], population.holders[i], population.balances[i],
+                                  population.types[i], population.rates[i]);
+        }
+    }
+
+    bool execute(const Op &op) {
+        if (!locking) {
+            return apply(op).ok();
+        }
+        if (op.kind != OpKind::Transfer || op.account % kStripes == op.other % kStripes) {
+            std::lock_guard<std::mutex> lock(stripeOf(op.account));
+            return apply(op).ok();
+        }
+        // Lower stripe first, so two opposite transfers cannot deadlock
+        std::uint32_t first = std::min(op.account % kStripes, op.other % kStripes);
+        std::uint32_t second = std::max(op.account % kStripes, op.other % kStripes);
+        std::scoped_lock lock(*stripes[first], *stripes[second]);
+        return apply(op).ok();
+    }
+
+    Money totalBalance() {
+        Money total;
+        for (const BankAccount &account : accounts) {
+            total += account.getBalance();
+        }
+        return total;
+    }
+};
+
+/**
+ * ConcurrentAccount objects shared without locks
+ */
+class ConcurrentEngine {
+private:
+    std::deque<ConcurrentAccount> accounts;   // Not movable; a deque never relocates them
+
+public:
+    static constexpr const char *kName = "concurrent";
+
+    ConcurrentEngine(const Population &population, const LoadOptions &) {
+        for (std::size_t i = 0; i < population.ids.size(); ++i) {
+            accounts.emplace_back(population.ids[i], population.holders[i], population.balances[i],
+                                  population.types[i], population.rates[i]);
+        }
+    }
+
+    bool execute(const Op &op) {
+        ConcurrentAccount &account = accounts[op.account];
+        switch (op.kind) {
+        case OpKind::Deposit:
+            return account.deposit(op.amount).ok();
+        case OpKind::Withdraw:
+            return account.withdraw(op.amount).ok();
+        case OpKind::Transfer:
+            return transfer(account, accounts[op.other], op.amount).ok();
+        case OpKind::Interest:
+            return account.applyInterest().ok();
+        }
+        return false;
+    }
+
+    Money totalBalance() {
+        Money total;
+        for (const ConcurrentAccount &account : accounts) {
+            total += account.getBalance();
+        }
+        return total;
+    }
+};
+
+/**
+ * One AccountStore, behind a single mutex when shared between threads
+ * Population index i is store slot i (accounts are opened in order).
+ */
+class StoreEngine {
+private:
+    AccountStore store;
+    std::mutex mutex;
+    bool locking;
+    std::unique_ptr<JournalWriter> journal;
+
+    bool apply(const Op &op) {
+        AccountRef account = store.at(op.account);
+        switch (op.kind) {
+        case OpKind::Deposit:
+            return account.deposit(op.amount).ok();
+        case OpKind::Withdraw:
+            return account.withdraw(op.amount).ok();
+        case OpKind::Transfer:
+            return account.transfer(store.at(op.other), op.amount).ok();
+        case OpKind::Interest:
+            return account.applyInterest().ok();
+        }
+        return false;
+    }
+
+public:
+    static constexpr const char *kName = "store";
+
+    StoreEngine(const Population &population, const LoadOptions &options) : locking(options.threads > 1) {
+        if (!options.capturePath.empty()) {
+            journal = std::make_unique<JournalWriter>(options.capturePath);
+            if (!journal->ok()) {
+                std::fprintf(stderr, "cannot open journal %s\n", options.capturePath.c_str());
+            }
+            store.setRecordSink(journal.get());
+        }
+        store.reserve(population.ids.size());
+        for (std::size_t i = 0; i < population.ids.size(); ++i) {
+            store.open(population.ids[i], population.holders[i], population.balances[i], population.types[i],
+                       population.rates[i]);
+        }
+    }
+
+    ~StoreEngine() {
+        store.setRecordSink(nullptr);
+    }
+
+    bool execute(const Op &op) {
+        if (!locking) {
+            return apply(op);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        return apply(op);
+    }
+
+    Money totalBalance() {
+        return store.totalBalance();
+    }
+};
+
+/**
+ * ShardedAccountStore, waiting for each reply
+ */
+class ShardedEngine {
+private:
+    const std::vector<AccountId> &ids;
+    ShardedAccountStore store;
+
+    static ShardedStoreOptions shardOptions(const LoadOptions &options) {
+        ShardedStoreOptions shardOptions;
+        shardOptions.shards = options.shards;
+        return shardOptions;
+    }
+
+public:
+    static constexpr const char *kName = "sharded";
+
+    ShardedEngine(const Population &population, const LoadOptions &options)
+        : ids(population.ids), store(shardOptions(options)) {
+        std::vector<std::future<bool>> opened;
+        opened.reserve(population.ids.size());
+        for (std::size_t i = 0; i < population.ids.size(); ++i) {
+            opened.push_back(store.open(population.ids[i], population.holders[i], population.balances[i],
+                                        population.types[i], population.rates[i]));
+        }
+        for (std::future<bool> &done : opened) {
+            done.get();
+        }
+    }
+
+    bool execute(const Op &op) {
+        AccountId account = ids[op.account];
+        switch (op.kind) {
+        case OpKind::Deposit:
+            return store.deposit(account, op.amount).get().ok();
+        case OpKind::Withdraw:
+            return store.withdraw(account, op.amount).get().ok();
+        case OpKind::Transfer:
+            return store.transfer(account, ids[op.other], op.amount).get().ok();
+        case OpKind::Interest: {
+            // No interest message; run it on the owning shard
+            bool applied = false;
+            store.runOn(store.getShardOf(account), [&](AccountStore &shard) {
+                std::optional<AccountRef> ref = shard.find(account);
+                applied = ref && ref->applyInterest().ok();
+            });
+            return applied;
+        }
+        }
+        return false;
+    }
+
+    Money totalBalance() {
+        return store.totalBalance();
+    }
+};
+
+// ============================================================================
+// RUNNER
+// ============================================================================
+/**
+ * What one client thread measured
+ */
+struct ThreadResult {
+    metrics::HistogramSnapshot latency[kOpKinds];
+    std::uint64_t succeeded[kOpKinds] = {};
+};
+
+/**
+ * @return Nanoseconds one steady_clock::now() costs, roughly
+ */
+double clockOverheadNanos() {
+    constexpr int kSamples = 1'000'000;
+    Clock::time_point start = Clock::now();
+    Clock::time_point last = start;
+    for (int i = 0; i < kSamples; ++i) {
+        last = Clock::now();
+    }
+    return std::chrono::duration<double, std::nano>(last - start).count() / kSamples;
+}
+
+/**
+ * Throughput of each engine that has run, for the speedup column
+ */
+struct Baseline {
+    double objectOpsPerSecond = 0.0;
+};
+
+template <class Engine>
+void runEngine(const Population &population, const std::vector<std::vector<Op>> &streams,
+               const LoadOptions &options, Baseline &baseline) {
+    Engine engine(population, options);
+    const Money before = engine.totalBalance();
+
+    std::vector<ThreadResult> results(streams.size());
+    std::vector<std::thread> clients;
+    std::latch ready(static_cast<std::ptrdiff_t>(streams.size() + 1));
+    std::latch go(1);
+    for (std::size_t t = 0; t < streams.size(); ++t) {
+        clients.emplace_back([&, t] {
+            ThreadResult &mine = results[t];
+            ready.count_down();
+            go.wait();
+            for (const Op &op : streams[t]) {
+                Clock::time_point start = Clock::now();
+                bool succeeded = engine.execute(op);
+                auto nanos = static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+                const auto kind = static_cast<std::size_t>(op.kind);
+                mine.latency[kind].add(metrics::histogram_layout::bucketIndex(nanos), 1);
+                mine.latency[kind].addSum(nanos);
+                mine.succeeded[kind] += succeeded ? 1 : 0;
+            }
+        });
+    }
+    ready.arrive_and_wait();
+    Clock::time_point start = Clock::now();
+    go.count_down();
+    for (std::thread &client : clients) {
+        client.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    metrics::HistogramSnapshot all;
+    metrics::HistogramSnapshot byKind[kOpKinds];
+    std::uint64_t succeeded[kOpKinds] = {};
+    std::uint64_t totalSucceeded = 0;
+    for (const ThreadResult &result : results) {
+        for (std::size_t kind = 0; kind < kOpKinds; ++kind) {
+            byKind[kind].merge(result.latency[kind]);
+            all.merge(result.latency[kind]);
+            succeeded[kind] += result.succeeded[kind];
+            totalSucceeded += result.succeeded[kind];
+        }
+    }
+
+    const double opsPerSecond = static_cast<double>(all.getCount()) / seconds;
+    if (std::string_view(Engine::kName) == ObjectEngine::kName) {
+        baseline.objectOpsPerSecond = opsPerSecond;
+    }
+    std::printf("%-10s %9.1f ms %10.3f Mops/s", Engine::kName, seconds * 1e3, opsPerSecond / 1e6);
+    if (baseline.objectOpsPerSecond > 0.0) {
+        std::printf("  x%-5.2f", opsPerSecond / baseline.objectOpsPerSecond);
+    } else {
+        std::printf("  %-6s", "-");
+    }
+    std::printf("  p50 %6llu  p99 %7llu  p999 %8llu ns  ok %llu  total $",
+                static_cast<unsigned long long>(all.valueAtQuantile(0.50)),
+                static_cast<unsigned long long>(all.valueAtQuantile(0.99)),
+                static_cast<unsigned long long>(all.valueAtQuantile(0.999)),
+                static_cast<unsigned long long>(totalSucceeded));
+    std::cout << engine.totalBalance() << " (opened with $" << before << ")\n";
+    for (std::size_t kind = 0; kind < kOpKinds; ++kind) {
+        if (byKind[kind].getCount() == 0) {
+            continue;
+        }
+        std::printf("    %-9s %9llu ops  %9llu ok  mean %8.1f  p50 %6llu  p99 %7llu  p999 %8llu ns\n",
+                    kOpNames[kind], static_cast<unsigned long long>(byKind[kind].getCount()),
+                    static_cast<unsigned long long>(succeeded[kind]), byKind[kind].getMeanNanos(),
+                    static_cast<unsigned long long>(byKind[kind].valueAtQuantile(0.50)),
+                    static_cast<unsigned long long>(byKind[kind].valueAtQuantile(0.99)),
+                    static_cast<unsigned long long>(byKind[kind].valueAtQuantile(0.999)));
+    }
+}
+
+/**
+ * Replays a journal onto both replay targets and verifies they agree
+ * @return Process exit code
+ */
+int runReplay(const std::string &path) {
+    auto timed = [](auto &&replay) {
+        Clock::time_point start = Clock::now();
+        ReplayStats stats = replay();
+        return std::make_pair(stats, std::chrono::duration<double>(Clock::now() - start).count());
+    };
+    auto report = [](const char *target, const ReplayStats &stats, double seconds, Money total) {
+        std::printf("%-12s %9.1f ms %10.3f Mrecords/s  applied %zu  skipped %zu  mismatches %zu  total $",
+                    target, seconds * 1e3, static_cast<double>(stats.applied + stats.skipped) / seconds / 1e6,
+                    stats.applied, stats.skipped, stats.mismatches);
+        std::cout << total << '\n';
+    };
+
+    AccountStore store;
+    auto [storeStats, storeSeconds] = timed([&] { return replayJournal(path, store); });
+    if (storeStats.scan.status == JournalReadStatus::BadHeader ||
+        storeStats.scan.status == JournalReadStatus::CannotOpen) {
+        std::fprintf(stderr, "cannot read journal %s\n", path.c_str());
+        return 1;
+    }
+    std::printf("journal: %s, %llu records up to sequence %llu%s\n", path.c_str(),
+                static_cast<unsigned long long>(storeStats.scan.records),
+                static_cast<unsigned long long>(storeStats.scan.lastSequence),
+                storeStats.scan.status == JournalReadStatus::TornTail ? " (torn tail ignored)" : "");
+    report("store", storeStats, storeSeconds, store.totalBalance());
+
+    std::unordered_map<AccountId, BankAccount> objects;
+    auto [objectStats, objectSeconds] = timed([&] { return replayJournal(path, objects); });
+    Money objectTotal;
+    for (const auto &[id, account] : objects) {
+        objectTotal += account.getBalance();
+    }
+    report("object", objectStats, objectSeconds, objectTotal);
+
+    bool agree = storeStats.mismatches == 0 && objectStats.mismatches == 0 && objectTotal == store.totalBalance();
+    std::printf("%s\n", agree ? "replays agree with the journal" : "REPLAY MISMATCH");
+    return agree ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    LoadOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+    if (!options.replayPath.empty()) {
+        return runReplay(options.replayPath);
+    }
+
+    Population population = makePopulation(options);
+    std::vector<std::vector<Op>> streams = makeStreams(options);
+    std::printf("accounts %zu, threads %zu, ops/thread %zu, seed %llu, zipf %.2f, mix %u/%u/%u/%u, "
+                "clock %.1f ns/sample\n",
+                options.accounts, options.threads, options.opsPerThread,
+                static_cast<unsigned long long>(options.seed), options.zipfTheta, options.depositWeight,
+                options.withdrawWeight, options.transferWeight, options.interestWeight, clockOverheadNanos());
+
+    Baseline baseline;
+    std::string_view engines = options.engines;
+    auto wanted = [&](std::string_view name) {
+        for (std::string_view rest = engines; !rest.empty();) {
+            std::size_t comma = rest.find(',');
+            if (rest.substr(0, comma) == name) {
+                return true;
+            }
+            rest.remove_prefix(comma == std::string_view::npos ? rest.size() : comma + 1);
+        }
+        return false;
+    };
+    if (wanted(ObjectEngine::kName)) {
+        runEngine<ObjectEngine>(population, streams, options, baseline);
+    }
+    if (wanted(ConcurrentEngine::kName)) {
+        runEngine<ConcurrentEngine>(population, streams, options, baseline);
+    }
+    if (wanted(StoreEngine::kName)) {
+        runEngine<StoreEngine>(population, streams, options, baseline);
+    }
+    if (wanted(ShardedEngine::kName)) {
+        runEngine<ShardedEngine>(population, streams, options, baseline);
+    }
+    return 0;
+}
@@ -0,0 +1,720 @@
+#ifndef BULK_IMPORTER_HPP
+#define BULK_IMPORTER_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "account_id.hpp"
+#include "account_store.hpp"
+#include "account_type.hpp"
+#include "batch_posting.hpp"
+#include "money.hpp"
+
+/**
+ * ============================================================================
+ * BULK IMPORT: accounts and postings straight from files
+ * ============================================================================
+ *
+ * BulkImporter loads large files into an AccountStore without a constructor
+ * or deposit/withdraw call per record:
+ * - the file is memory-mapped (MADV_SEQUENTIAL, plus MADV_WILLNEED on the
+ *   chunks about to be parsed), so the kernel reads ahead while we parse
+ * - it is cut into chunks of about ImportOptions::chunkBytes, ending on a
+ *   record boundary
+ * - parser threads turn chunks into batches: fields are string_views into
+ *   the mapping, numbers are parsed in place, account numbers are resolved
+ *   to slots through the store's index; nothing is allocated per field
+ * - the calling thread applies finished batches in file order (postings
+ *   through BatchPoster, accounts through AccountStore::open) while the
+ *   parsers work on the following chunks
+ *
+ * Batches are recycled through a small ring (two per parser), so memory use
+ * is bounded by the chunk size, not the file size.
+ *
+ * FORMATS:
+ * - Accounts CSV: account_number,holder,type,balance,interest_rate - the
+ *   StatementRenderer Csv layout; balance in dollars ("1234.56"), rate in
+ *   percent ("3.50")
+ * - Postings CSV: account_number,amount - signed dollars ("-12.05" is a
+ *   withdrawal)
+ * - Postings binary: BinaryPosting records (16 bytes, native byte order)
+ * CSV fields may be quoted (RFC 4180), but a record must not contain a
+ * line break. Lines may end in "\n" or "\r\n".
+ *
+ * Records that cannot be parsed are skipped and counted (with the byte
+ * offset of the first one); postings are otherwise applied exactly as
+ * BatchPoster would apply them.
+ *
+ * Nothing else may write to the store during an import.
+ * ============================================================================
+ */
+
+/**
+ * One record of a binary postings file
+ */
+struct BinaryPosting {
+    std::uint64_t account;   // AccountId::getPacked()
+    std::int64_t cents;      // Signed amount
+};
+static_assert(sizeof(BinaryPosting) == 16);
+
+/**
+ * Outcome of opening the input file
+ */
+enum class ImportStatus {
+    Ok,
+    CannotOpen   // The file does not exist or cannot be read/mapped
+};
+
+/**
+ * Configuration for BulkImporter
+ */
+struct ImportOptions {
+    std::size_t chunkBytes = 4 << 20;              // Target bytes per chunk (one batch each)
+    std::size_t parserThreads = 0;                 // 0 = one per spare core (at least 1)
+    bool hasHeader = true;                         // CSV: skip the first line
+    PostingKernel kernel = PostingKernel::Auto;    // Kernel used to apply postings
+};
+
+/**
+ * Outcome of an import
+ */
+struct ImportReport {
+    ImportStatus status = ImportStatus::Ok;
+    std::size_t records = 0;                 // Records read (header excluded)
+    std::size_t malformed = 0;               // Records that could not be parsed (skipped)
+    std::uint64_t firstMalformedOffset = 0;  // Byte offset of the first one (if malformed > 0)
+    std::size_t applied = 0;                 // Postings applied / accounts opened
+    std::size_t unknownAccounts = 0;         // Postings naming an account not in the store
+    std::size_t duplicates = 0;              // Account rows whose number is already taken
+    std::size_t invalid = 0;                 // Postings rejected as invalid (zero amount)
+    std::size_t insufficientFunds = 0;       // Postings rejected: withdrawal would overdraw
+    std::size_t frozen = 0;                  // Postings rejected: the account's status blocks them
+    Money netPosted;                         // Sum of the applied postings
+    std::size_t chunks = 0;                  // Batches the file was cut into
+
+    bool ok() const {
+        return status == ImportStatus::Ok;
+    }
+};
+
+namespace import_parse {
+
+inline std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+/**
+ * @return The line without the '\r' of a "\r\n" line ending
+ */
+inline std::string_view chompCarriageReturn(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+/**
+ * Parses a signed decimal with at most two fraction digits ("-12.5",
+ * "3.50", "+7") into hundredths
+ * @return The value times 100, or nullopt if malformed or out of range
+ */
+inline std::optional<std::int64_t> parseHundredths(std::string_view text) {
+    text = trim(text);
+    bool negative = false;
+    if (!text.empty() && (text.front() == '-' || text.front() == '+')) {
+        negative = text.front() == '-';
+        text.remove_prefix(1);
+    }
+    std::int64_t value = 0;
+    std::size_t digits = 0;
+    std::size_t i = 0;
+    for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++digits) {
+        if (__builtin_mul_overflow(value, 10, &value) ||
+            __builtin_add_overflow(value, text[i] - '0', &value)) {
+            return std::nullopt;
+        }
+    }
+    int fraction = 0;
+    std::size_t fractionDigits = 0;
+    if (i < text.size() && text[i] == '.') {
+        for (++i; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++fractionDigits) {
+            if (fractionDigits == 2) {
+                return std::nullopt;   // Sub-cent precision is not representable
+            }
+            fraction = fraction * 10 + (text[i] - '0');
+        }
+    }
+    if (i != text.size() || digits + fractionDigits == 0) {
+        return std::nullopt;
+    }
+    fraction *= fractionDigits == 1 ? 10 : 1;
+    if (__builtin_mul_overflow(value, 100, &value) || __builtin_add_overflow(value, fraction, &value)) {
+        return std::nullopt;
+    }
+    return negative ? -value : value;
+}
+
+/**
+ * Splits one CSV record into fields (RFC 4180 quoting, no line breaks)
+ */
+class CsvFields {
+private:
+    std::string_view rest;
+    bool done = false;
+
+public:
+    explicit CsvFields(std::string_view line) : rest(line) {}
+
+    /**
+     * @param field Receives the field text (inside the quotes, with any ""
+     *              pairs still doubled)
+     * @param quoted Receives whether the field was quoted
+     * @return false if there is no field left or the quoting is broken
+     */
+    bool next(std::string_view &field, bool &quoted) {
+        if (done) {
+            return false;
+        }
+        quoted = !rest.empty() && rest.front() == '"';
+        if (!quoted) {
+            std::size_t comma = rest.find(',');
+            field = rest.substr(0, comma);
+            done = comma == std::string_view::npos;
+            rest.remove_prefix(done ? rest.size() : comma + 1);
+            return true;
+        }
+        std::size_t i = 1;
+        for (;; ++i) {
+            std::size_t quote = rest.find('"', i);
+            if (quote == std::string_view::npos) {
+                return false;
+            }
+            if (quote + 1 < rest.size() && rest[quote + 1] == '"') {
+                i = quote + 1;   // Escaped quote
+                continue;
+            }
+            field = rest.substr(1, quote - 1);
+            i = quote + 1;
+            break;
+        }
+        if (i == rest.size()) {
+            done = true;
+        } else if (rest[i] != ',') {
+            return false;
+        }
+        rest.remove_prefix(std::min(rest.size(), i + 1));
+        return true;
+    }
+
+    /**
+     * @return true if every field was consumed
+     */
+    bool atEnd() const {
+        return done;
+    }
+};
+
+/**
+ * @return A quoted field's text with "" pairs collapsed
+ */
+inline std::string unquote(std::string_view field) {
+    std::string text;
+    text.reserve(field.size());
+    for (std::size_t i = 0; i < field.size(); ++i) {
+        text.push_back(field[i]);
+        i += field[i] == '"';
+    }
+    return text;
+}
+
+} // namespace import_parse
+
+// ============================================================================
+// CLASS DEFINITION: BulkImporter
+// ============================================================================
+class BulkImporter {
+private:
+    /**
+     * Read-only mapping of the input file
+     */
+    class MappedInput {
+    private:
+        void *base = MAP_FAILED;
+        std::size_t length = 0;
+
+    public:
+        MappedInput() = default;
+        MappedInput(const MappedInput &) = delete;
+        MappedInput &operator=(const MappedInput &) = delete;
+
+        ~MappedInput() {
+            if (base != MAP_FAILED) {
+                ::munmap(base, length);
+            }
+        }
+
+        bool open(const std::string &path) {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                return false;
+            }
+            struct stat info;
+            bool ok = ::fstat(fd, &info) == 0;
+            length = ok ? static_cast<std::size_t>(info.st_size) : 0;
+            if (ok && length > 0) {
+                base = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                ok = base != MAP_FAILED;
+                if (ok) {
+                    ::madvise(base, length, MADV_SEQUENTIAL);
+                }
+            }
+            ::close(fd);
+            return ok;
+        }
+
+        std::string_view bytes() const {
+            return length == 0 ? std::string_view() : std::string_view(static_cast<const char *>(base), length);
+        }
+
+        /**
+         * Asks the kernel to start reading a range now
+         */
+        void prefetch(std::size_t offset, std::size_t bytes) const {
+            if (base == MAP_FAILED || offset >= length) {
+                return;
+            }
+            const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            std::size_t start = offset / page * page;
+            std::size_t end = std::min(length, offset + bytes);
+            ::madvise(static_cast<char *>(base) + start, end - start, MADV_WILLNEED);
+        }
+    };
+
+    /**
+     * Byte range [begin, end) of the input parsed as one batch
+     */
+    struct Chunk {
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    struct PostingBatch {
+        std::vector<AccountId> ids;           // Parsed account numbers, resolved into slots
+        std::vector<AccountSlot> slots;
+        std::vector<std::int64_t> amounts;
+        std::size_t records = 0;
+        std::size_t malformed = 0;
+        std::uint64_t firstMalformedOffset = 0;
+        std::size_t unknownAccounts = 0;
+
+        void clear() {
+            ids.clear();
+            slots.clear();
+            amounts.clear();
+            records = malformed = unknownAccounts = 0;
+        }
+
+        void markMalformed(std::uint64_t offset) {
+            if (malformed++ == 0) {
+                firstMalformedOffset = offset;
+            }
+        }
+    };
+
+    struct ParsedAccount {
+        AccountId id;
+        std::string_view holder;   // Points into the mapping
+        bool quotedHolder;         // Holder still has doubled quotes
+        AccountType type;
+        std::int64_t balance;
+        std::int32_t rate;
+    };
+
+    struct AccountBatch {
+        std::vector<ParsedAccount> accounts;
+        std::size_t records = 0;
+        std::size_t malformed = 0;
+        std::uint64_t firstMalformedOffset = 0;
+
+        void clear() {
+            accounts.clear();
+            records = malformed = 0;
+        }
+
+        void markMalformed(std::uint64_t offset) {
+            if (malformed++ == 0) {
+                firstMalformedOffset = offset;
+            }
+        }
+    };
+
+    static constexpr std::size_t kFree = static_cast<std::size_t>(-1);
+
+    /**
+     * One batch of the parse/apply ring
+     */
+    template <class Batch>
+    struct RingSlot {
+        Batch batch;
+        std::size_t chunk = kFree;   // Chunk being parsed into / held by the slot
+        bool ready = false;          // Parsed, waiting to be applied
+    };
+
+    AccountStore &store;
+    ImportOptions options;
+
+    std::size_t parserCount() const {
+        if (options.parserThreads > 0) {
+            return options.parserThreads;
+        }
+        unsigned cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 1;
+    }
+
+    /**
+     * Cuts the input into chunks that end right after a '\n'
+     * @param skipFirstLine Start after the header line
+     */
+    std::vector<Chunk> splitLines(std::string_view input, bool skipFirstLine) const {
+        std::vector<Chunk> chunks;
+        std::size_t begin = 0;
+        if (skipFirstLine) {
+            std::size_t newline = input.find('\n');
+            begin = newline == std::string_view::npos ? input.size() : newline + 1;
+        }
+        const std::size_t target = std::max<std::size_t>(options.chunkBytes, 1);
+        while (begin < input.size()) {
+            std::size_t end = std::min(input.size(), begin + target);
+            if (end < input.size()) {
+                std::size_t newline = input.find('\n', end - 1);
+                end = newline == std::string_view::npos ? input.size() : newline + 1;
+            }
+            chunks.push_back({begin, end});
+            begin = end;
+        }
+        return chunks;
+    }
+
+    /**
+     * Cuts the input into chunks of whole BinaryPosting records (a partial
+     * record at the end gets a chunk of its own)
+     */
+    std::vector<Chunk> splitRecords(std::size_t bytes) const {
+        std::vector<Chunk> chunks;
+        const std::size_t target =
+            std::max<std::size_t>(options.chunkBytes / sizeof(BinaryPosting), 1) * sizeof(BinaryPosting);
+        for (std::size_t begin = 0; begin < bytes; begin += target) {
+            chunks.push_back({begin, std::min(bytes, begin + target)});
+        }
+        return chunks;
+    }
+
+    /**
+     * Parses chunks on parser threads and applies the batches in order on
+     * the calling thread
+     *
+     * Chunk i is parsed by parser i % parsers into ring slot i % ring; a
+     * parser waits for its slot to be released, the applier waits for it to
+     * be filled. Since the ring is a multiple of the parser count, the slot
+     * a parser waits for was filled by that same parser earlier, so the
+     * pipeline cannot deadlock.
+     */
+    template <class Batch, class Parse, class Apply>
+    void runPipeline(const MappedInput &input, const std::vector<Chunk> &chunks, Parse parse, Apply apply) {
+        if (chunks.empty()) {
+            return;
+        }
+        const std::size_t parsers = std::min(parserCount(), chunks.size());
+        const std::size_t ring = 2 * parsers;
+        std::vector<RingSlot<Batch>> slots(ring);
+        std::mutex mutex;
+        std::condition_variable changed;
+
+        std::vector<std::thread> workers;
+        workers.reserve(parsers);
+        for (std::size_t p = 0; p < parsers; ++p) {
+            workers.emplace_back([&, p] {
+                for (std::size_t i = p; i < chunks.size(); i += parsers) {
+                    RingSlot<Batch> &slot = slots[i % ring];
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        changed.wait(lock, [&] { return slot.chunk == kFree; });
+                        slot.chunk = i;
+                    }
+                    if (i + parsers < chunks.size()) {
+                        const Chunk &ahead = chunks[i + parsers];
+                        input.prefetch(ahead.begin, ahead.end - ahead.begin);
+                    }
+                    slot.batch.clear();
+                    parse(chunks[i], slot.batch);
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        slot.ready = true;
+                    }
+                    changed.notify_all();
+                }
+            });
+        }
+
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            RingSlot<Batch> &slot = slots[i % ring];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return slot.ready && slot.chunk == i; });
+            }
+            apply(slot.batch);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slot.ready = false;
+                slot.chunk = kFree;
+            }
+            changed.notify_all();
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * Queues one parsed posting (or counts it as malformed)
+     */
+    static void addPosting(std::optional<AccountId> id, std::optional<std::int64_t> cents, std::uint64_t offset,
+                           PostingBatch &batch) {
+        ++batch.records;
+        if (!id || !cents) {
+            batch.markMalformed(offset);
+            return;
+        }
+        batch.ids.push_back(*id);
+        batch.amounts.push_back(*cents);
+    }
+
+    /**
+     * Turns the batch's account numbers into slots, dropping postings for
+     * unknown accounts
+     * Done for the whole batch after parsing, in a loop with no other work,
+     * so the index lookups (mostly cache misses) overlap each other.
+     */
+    static void resolveSlots(const FlatAccountIndex &index, PostingBatch &batch) {
+        batch.slots.resize(batch.ids.size());
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < batch.ids.size(); ++i) {
+            std::optional<AccountSlot> slot = index.find(batch.ids[i]);
+            batch.slots[kept] = slot.value_or(0);
+            batch.amounts[kept] = batch.amounts[i];
+            kept += slot.has_value();
+        }
+        batch.unknownAccounts += batch.ids.size() - kept;
+        batch.slots.resize(kept);
+        batch.amounts.resize(kept);
+    }
+
+    /**
+     * Runs a postings import over prepared chunks
+     */
+    template <class Parse>
+    ImportReport importPostings(const MappedInput &input, const std::vector<Chunk> &chunks, Parse parse) {
+        ImportReport report;
+        report.chunks = chunks.size();
+        const BatchPoster poster(options.kernel);
+        const FlatAccountIndex &index = store.lookupIndex();
+        PostingReport posted;
+
+        auto parseAndResolve = [&parse, &index](const Chunk &chunk, PostingBatch &batch) {
+            parse(chunk, batch);
+            resolveSlots(index, batch);
+        };
+        runPipeline<PostingBatch>(input, chunks, parseAndResolve, [&](PostingBatch &batch) {
+            poster.post(store, batch.slots, batch.amounts, posted);
+            report.records += batch.records;
+            if (batch.malformed > 0 && report.malformed == 0) {
+                report.firstMalformedOffset = batch.firstMalformedOffset;
+            }
+            report.malformed += batch.malformed;
+            report.unknownAccounts += batch.unknownAccounts;
+            report.applied += posted.applied;
+            report.invalid += posted.invalid;
+            report.insufficientFunds += posted.insufficientFunds;
+            report.frozen += posted.frozen;
+            report.netPosted += posted.netPosted;
+        });
+        return report;
+    }
+
+public:
+    /**
+     * @param target The store to import into
+     * @param config Chunk size, parser threads, header handling
+     */
+    explicit BulkImporter(AccountStore &target, ImportOptions config = {})
+        : store(target), options(config) {}
+
+    /**
+     * Opens every account listed in an accounts CSV file
+     * Rows whose account number is already in the store are skipped.
+     *
+     * @param path The file
+     * @return Counts of records, accounts opened, duplicates and malformed rows
+     */
+    ImportReport importAccountsCsv(const std::string &path) {
+        ImportReport report;
+        MappedInput input;
+        if (!input.open(path)) {
+            report.status = ImportStatus::CannotOpen;
+            return report;
+        }
+        const std::string_view bytes = input.bytes();
+        std::vector<Chunk> chunks = splitLines(bytes, options.hasHeader);
+        report.chunks = chunks.size();
+        if (!chunks.empty()) {
+            store.reserve(store.size() + bytes.size() / 48);   // Rough guess: ~48 bytes per row
+        }
+
+        auto parse = [bytes](const Chunk &chunk, AccountBatch &batch) {
+            for (std::size_t at = chunk.begin; at < chunk.end;) {
+                std::size_t newline = bytes.find('\n', at);
+                std::size_t lineEnd = std::min(newline == std::string_view::npos ? chunk.end : newline, chunk.end);
+                std::string_view line = import_parse::chompCarriageReturn(bytes.substr(at, lineEnd - at));
+                const std::uint64_t offset = at;
+                at = lineEnd + 1;
+                if (import_parse::trim(line).empty()) {
+                    continue;
+                }
+                ++batch.records;
+
+                import_parse::CsvFields fields(line);
+                std::string_view number, holder, type, balance, rate;
+                bool quotedHolder = false;
+                bool quoted = false;
+                bool complete = fields.next(number, quoted) && fields.next(holder, quotedHolder) &&
+                                fields.next(type, quoted) && fields.next(balance, quoted) &&
+                                fields.next(rate, quoted) && fields.atEnd();
+                std::optional<AccountId> id = complete ? AccountId::parse(import_parse::trim(number)) : std::nullopt;
+                std::optional<AccountType> accountType = parseAccountType(import_parse::trim(type));
+                std::optional<std::int64_t> cents = import_parse::parseHundredths(balance);
+                std::optional<std::int64_t> points = import_parse::parseHundredths(rate);
+                bool rateOk = points && *points >= 0 && *points <= std::numeric_limits<std::int32_t>::max() &&
+                              account_rules::isValidRate(
+                                  InterestRate::fromBasisPoints(static_cast<std::int32_t>(*points)));
+                if (!id || !accountType || !cents || !rateOk || holder.empty()) {
+                    batch.markMalformed(offset);
+                    continue;
+                }
+                batch.accounts.push_back({*id, holder, quotedHolder, *accountType, *cents,
+                                          static_cast<std::int32_t>(*points)});
+            }
+        };
+
+        runPipeline<AccountBatch>(input, chunks, parse, [&](AccountBatch &batch) {
+            report.records += batch.records;
+            if (batch.malformed > 0 && report.malformed == 0) {
+                report.firstMalformedOffset = batch.firstMalformedOffset;
+            }
+            report.malformed += batch.malformed;
+            for (const ParsedAccount &row : batch.accounts) {
+                std::string holder = row.quotedHolder ? import_parse::unquote(row.holder) : std::string(row.holder);
+                bool opened = store.open(row.id, std::move(holder), Money::fromMinorUnits(row.balance), row.type,
+                                         InterestRate::fromBasisPoints(row.rate))
+                                  .has_value();
+                ++(opened ? report.applied : report.duplicates);
+            }
+        });
+        return report;
+    }
+
+    /**
+     * Applies every posting of a postings CSV file, in file order
+     *
+     * @param path The file
+     * @return Counts of records, postings applied and rejected, malformed rows
+     */
+    ImportReport importPostingsCsv(const std::string &path) {
+        MappedInput input;
+        if (!input.open(path)) {
+            ImportReport report;
+            report.status = ImportStatus::CannotOpen;
+            return report;
+        }
+        const std::string_view bytes = input.bytes();
+
+        auto parse = [bytes](const Chunk &chunk, PostingBatch &batch) {
+            for (std::size_t at = chunk.begin; at < chunk.end;) {
+                std::size_t newline = bytes.find('\n', at);
+                std::size_t lineEnd = std::min(newline == std::string_view::npos ? chunk.end : newline, chunk.end);
+                std::string_view line = import_parse::chompCarriageReturn(bytes.substr(at, lineEnd - at));
+                const std::uint64_t offset = at;
+                at = lineEnd + 1;
+                if (import_parse::trim(line).empty()) {
+                    continue;
+                }
+
+                import_parse::CsvFields fields(line);
+                std::string_view number, amount;
+                bool quoted = false;
+                bool complete = fields.next(number, quoted) && fields.next(amount, quoted) && fields.atEnd();
+                addPosting(complete ? AccountId::parse(import_parse::trim(number)) : std::nullopt,
+                           complete ? import_parse::parseHundredths(amount) : std::nullopt, offset, batch);
+            }
+        };
+        return importPostings(input, splitLines(bytes, options.hasHeader), parse);
+    }
+
+    /**
+     * Applies every posting of a binary postings file, in file order
+     * A trailing partial record counts as one malformed record.
+     *
+     * @param path The file (a sequence of BinaryPosting)
+     * @return Counts of records, postings applied and rejected, malformed records
+     */
+    ImportReport importPostingsBinary(const std::string &path) {
+        MappedInput input;
+        if (!input.open(path)) {
+            ImportReport report;
+            report.status = ImportStatus::CannotOpen;
+            return report;
+        }
+        const std::string_view bytes = input.bytes();
+
+        auto parse = [bytes](const Chunk &chunk, PostingBatch &batch) {
+            std::size_t at = chunk.begin;
+            for (; at + sizeof(BinaryPosting) <= chunk.end; at += sizeof(BinaryPosting)) {
+                BinaryPosting record;
+                std::memcpy(&record, bytes.data() + at, sizeof record);
+                // Packed value 0 is never a valid AccountId
+                addPosting(record.account != 0 ? std::optional<AccountId>(AccountId::fromPacked(record.account))
+                                               : std::nullopt,
+                           record.cents, at, batch);
+            }
+            if (at < chunk.end) {
+                ++batch.records;
+                batch.markMalformed(at);
+            }
+        };
+        return importPostings(input, splitRecords(bytes.size()), parse);
+    }
+};
+
+#endif // BULK_IMPORTER_HPP
@@ -0,0 +1,57 @@
+#ifndef CACHE_LINE_HPP
+#define CACHE_LINE_HPP
+
+#include <cstddef>
+#include <utility>
+
+/**
+ * ============================================================================
+ * CACHE LINES: keeping independently written data on separate lines
+ * ============================================================================
+ *
+ * Two accounts next to each other in an array usually share a 64-byte
+ * cache line. If different threads update them, every write invalidates
+ * the line in the other core's cache and the line ping-pongs between the
+ * cores ("false sharing"), even though the threads never touch the same
+ * account. CacheLinePadded<T> gives each element a whole number of lines
+ * of its own:
+ *     std::deque<CacheLinePadded<ConcurrentAccount>> accounts;
+ *     accounts.emplace_back(id, "Holder", opening)->deposit(amount);
+ * It costs memory (a ConcurrentAccount grows from 80 to 128 bytes), so use
+ * it for accounts that are written by many threads, not for cold ones.
+ * ============================================================================
+ */
+
+// Size of a cache line on the x86-64 and AArch64 cores we run on
+inline constexpr std::size_t kCacheLineSize = 64;
+
+// ============================================================================
+// CLASS DEFINITION: CacheLinePadded
+// ============================================================================
+/**
+ * A T aligned to, and padded out to, whole cache lines
+ */
+template <class T>
+class alignas(kCacheLineSize) CacheLinePadded {
+private:
+    T value;
+
+public:
+    /**
+     * Constructs the wrapped value in place
+     * @param args Arguments for T's constructor
+     */
+    template <class... Args>
+    explicit CacheLinePadded(Args &&...args) : value(std::forward<Args>(args)...) {}
+
+    T &get() { return value; }
+    const T &get() const { return value; }
+
+    T *operator->() { return &value; }
+    const T *operator->() const { return &value; }
+
+    T &operator*() { return value; }
+    const T &operator*() const { return value; }
+};
+
+#endif // CACHE_LINE_HPP
@@ -0,0 +1,344 @@
+#ifndef CONCURRENT_ACCOUNT_HPP
+#define CONCURRENT_ACCOUNT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "account_id.hpp"
+#include "account_type.hpp"
+#include "money.hpp"
+#include "operation_metrics.hpp"
+#include "transaction.hpp"
+
+/**
+ * ============================================================================
+ * ConcurrentAccount: a BankAccount that many threads may post to at once
+ * ============================================================================
+ *
+ * BankAccount has no synchronization: two threads calling deposit race on
+ * "balance += amount". ConcurrentAccount keeps the balance in a single
+ * std::atomic<int64_t> holding cents (see money.hpp) and never takes a lock:
+ * - deposit is a compare-and-swap loop too, refusing (InvalidAmount) an
+ *   amount the balance cannot hold; it retries only when another thread
+ *   changed the balance in between
+ * - withdraw is a compare-and-swap loop that re-checks the no-overdraft rule
+ *   against the latest balance on every attempt, so concurrent withdrawals
+ *   can never take the balance below zero
+ * - applyInterest is a CAS loop as well, computing interest on the balance
+ *   it actually replaces
+ *
+ * Every failed CAS attempt is counted. A high retry count means many threads
+ * are fighting over the same account (a "hot" account).
+ *
+ * The id, type and holder name are fixed at construction and may be read
+ * from any thread without synchronization.
+ *
+ * TRANSFERS:
+ * transfer(from, to, amount) moves money between two accounts. Each account
+ * has a version word used as a tiny seqlock: a transfer makes both versions
+ * odd, moves the money, then makes them even again. The two accounts are
+ * always claimed in account-number order, so A->B and B->A transfers can
+ * never deadlock. Deposits and withdrawals on either account keep running
+ * lock-free while a transfer is in flight.
+ *
+ * readBalances(a, b) retries until it sees both versions even and unchanged,
+ * so it never observes a transfer that has debited one side but not yet
+ * credited the other.
+ * ============================================================================
+ */
+class ConcurrentAccount {
+private:
+    const AccountId accountNumber;          // Unique identifier for the account
+    const std::string accountHolder;        // Name of the account holder
+    const AccountType accountType;          // Type of account (Savings, Checking)
+    std::atomic<std::int32_t> interestRate; // Interest rate in basis points
+    std::atomic<std::int64_t> balance;      // Current balance in cents
+    std::atomic<std::uint64_t> casRetries;  // Failed CAS attempts (contention)
+    std::atomic<std::uint64_t> version;     // Transfer seqlock: odd = transfer in progress
+    std::atomic<std::uint64_t> lockSpins;   // Waits for another transfer to finish
+
+    friend TransactionResult transfer(ConcurrentAccount &from, ConcurrentAccount &to, Money amount);
+    friend std::pair<Money, Money> readBalances(const ConcurrentAccount &first,
+                                                const ConcurrentAccount &second);
+
+    /**
+     * Claims the account for a transfer (version even -> odd)
+     */
+    void lockForTransfer() {
+        unsigned spins = 0;
+        std::uint64_t current = version.load(std::memory_order_relaxed);
+        for (;;) {
+            if ((current & 1) == 0 &&
+                version.compare_exchange_weak(current, current + 1, std::memory_order_acquire,
+                                              std::memory_order_relaxed)) {
+                return;
+            }
+            lockSpins.fetch_add(1, std::memory_order_relaxed);
+            if (++spins > 64) {
+                std::this_thread::yield();
+            }
+            current = version.load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Releases the account after a transfer (version odd -> even)
+     */
+    void unlockAfterTransfer() {
+        version.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * Debits the balance without ever overdrawing, using a CAS loop
+     * Shared by withdraw and transfer (which record their own metrics).
+     */
+    TransactionResult debit(Money amount) {
+        std::int64_t current = balance.load(std::memory_order_acquire);
+        for (;;) {
+            TransactionStatus status = account_rules::checkDebit(Money::fromMinorUnits(current), amount);
+            if (status != TransactionStatus::Success) {
+                return TransactionResult{status, amount, Money::fromMinorUnits(current)};
+            }
+            std::int64_t next = current - amount.getMinorUnits();
+            if (balance.compare_exchange_weak(current, next, std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+                return TransactionResult{status, amount, Money::fromMinorUnits(next)};
+            }
+            // current now holds the newer balance; check the rule again
+            casRetries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Credits the balance unless it would pass INT64_MAX cents, using a CAS loop
+     * Shared by deposit and transfer (which record their own metrics).
+     */
+    TransactionResult credit(Money amount) {
+        std::int64_t current = balance.load(std::memory_order_acquire);
+        for (;;) {
+            std::int64_t next;
+            if (__builtin_add_overflow(current, amount.getMinorUnits(), &next)) {
+                return TransactionResult{TransactionStatus::InvalidAmount, amount, Money::fromMinorUnits(current)};
+            }
+            if (balance.compare_exchange_weak(current, next, std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+                return TransactionResult{TransactionStatus::Success, amount, Money::fromMinorUnits(next)};
+            }
+            casRetries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    /**
+     * @param accNum The account number
+     * @param holder The name of account holder
+     * @param initialBalance Initial amount in the account
+     * @param type Type of account
+     * @param rate Interest rate
+     */
+    ConcurrentAccount(AccountId accNum, std::string holder, Money initialBalance,
+                      AccountType type = AccountType::Savings, InterestRate rate = InterestRate())
+        : accountNumber(accNum),
+          accountHolder(std::move(holder)),
+          accountType(type),
+          interestRate(rate.getBasisPoints()),
+          balance(initialBalance.getMinorUnits()),
+          casRetries(0),
+          version(0),
+          lockSpins(0) {}
+
+    // Atomics cannot be copied; an account has exactly one live balance
+    ConcurrentAccount(const ConcurrentAccount &) = delete;
+    ConcurrentAccount &operator=(const ConcurrentAccount &) = delete;
+
+    // ========================================================================
+    // GETTERS
+    // ========================================================================
+    AccountId getAccountNumber() const { return accountNumber; }
+    std::string_view getAccountHolder() const { return accountHolder; }
+    AccountType getAccountType() const { return accountType; }
+
+    /**
+     * @return The balance at some instant during the call
+     */
+    Money getBalance() const {
+        return Money::fromMinorUnits(balance.load(std::memory_order_acquire));
+    }
+
+    InterestRate getInterestRate() const {
+        return InterestRate::fromBasisPoints(interestRate.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @return Number of CAS attempts that had to be retried because another
+     *         thread changed the balance first
+     */
+    std::uint64_t getCasRetries() const {
+        return casRetries.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return Number of times a transfer had to wait for another transfer
+     *         holding this account
+     */
+    std::uint64_t getLockSpins() const {
+        return lockSpins.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Starts a new contention measurement window
+     */
+    void resetCasRetries() {
+        casRetries.store(0, std::memory_order_relaxed);
+        lockSpins.store(0, std::memory_order_relaxed);
+    }
+
+    // ========================================================================
+    // MUTATORS (safe to call from any number of threads)
+    // ========================================================================
+    /**
+     * @param rate The new interest rate
+     * @return Success, or InvalidRate if the rate is outside 0-50%
+     */
+    TransactionStatus setInterestRate(InterestRate rate) {
+        metrics::OperationTimer timer(metrics::Operation::SetInterestRate);
+        if (!account_rules::isValidRate(rate)) {
+            return timer.finish(TransactionStatus::InvalidRate);
+        }
+        interestRate.store(rate.getBasisPoints(), std::memory_order_relaxed);
+        return timer.finish(TransactionStatus::Success);
+    }
+
+    /**
+     * Deposits money with a CAS loop that never lets the balance wrap
+     *
+     * @param amount The amount to deposit
+     * @return Success with the balance right after this deposit, or
+     *         InvalidAmount (also when the balance cannot hold the amount)
+     */
+    TransactionResult deposit(Money amount) {
+        metrics::OperationTimer timer(metrics::Operation::Deposit);
+        if (!account_rules::isValidAmount(amount)) {
+            return timer.finish(TransactionResult{TransactionStatus::InvalidAmount, amount, getBalance()});
+        }
+        return timer.finish(credit(amount));
+    }
+
+    /**
+     * Withdraws money without ever overdrawing
+     *
+     * @param amount The amount to withdraw
+     * @return Success with the balance right after this withdrawal,
+     *         InvalidAmount, or InsufficientFunds with the balance seen
+     */
+    TransactionResult withdraw(Money amount) {
+        metrics::OperationTimer timer(metrics::Operation::Withdraw);
+        return timer.finish(debit(amount));
+    }
+
+    /**
+     * Applies one period of interest atomically
+     *
+     * @param mode How to round the fractional cent
+     * @return Success, with amount set to the interest added
+     */
+    TransactionResult applyInterest(RoundingMode mode = RoundingMode::HalfEven) {
+        metrics::OperationTimer timer(metrics::Operation::ApplyInterest);
+        std::int64_t current = balance.load(std::memory_order_acquire);
+        for (;;) {
+            Money interest = computeInterest(Money::fromMinorUnits(current), getInterestRate(), mode);
+            std::int64_t next = current + interest.getMinorUnits();
+            if (balance.compare_exchange_weak(current, next, std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+                return timer.finish(
+                    TransactionResult{TransactionStatus::Success, interest, Money::fromMinorUnits(next)});
+            }
+            casRetries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+// ============================================================================
+// MULTI-ACCOUNT OPERATIONS
+// ============================================================================
+/**
+ * @return true if a must be claimed before b (account number, then address)
+ */
+inline bool claimsBefore(const ConcurrentAccount &a, const ConcurrentAccount &b) {
+    if (a.getAccountNumber() != b.getAccountNumber()) {
+        return a.getAccountNumber() < b.getAccountNumber();
+    }
+    return std::less<const ConcurrentAccount *>()(&a, &b);
+}
+
+/**
+ * Moves money between two accounts as one step for consistent readers
+ * Never deadlocks: both accounts are claimed in claimsBefore order.
+ *
+ * @param from The account to debit
+ * @param to The account to credit
+ * @param amount Amount to transfer
+ * @return Result for the source account (balance is the source's balance);
+ *         InvalidAmount if the destination cannot hold the amount
+ */
+inline TransactionResult transfer(ConcurrentAccount &from, ConcurrentAccount &to, Money amount) {
+    metrics::OperationTimer timer(metrics::Operation::Transfer);
+    if (&from == &to) {
+        // Debit and credit cancel out; only the rules are checked
+        Money current = from.getBalance();
+        return timer.finish(TransactionResult{account_rules::checkDebit(current, amount), amount, current});
+    }
+
+    ConcurrentAccount &first = claimsBefore(from, to) ? from : to;
+    ConcurrentAccount &second = claimsBefore(from, to) ? to : from;
+    first.lockForTransfer();
+    second.lockForTransfer();
+
+    TransactionResult result = from.debit(amount);
+    if (result.ok() && !to.credit(amount).ok()) {
+        // The destination cannot hold it: give the source its cents back.
+        // Both accounts are still claimed, so readBalances sees neither
+        // step; only deposits of nearly INT64_MAX cents racing into the
+        // source in this window could leave the refund no room.
+        from.balance.fetch_add(amount.getMinorUnits(), std::memory_order_acq_rel);
+        result = TransactionResult{TransactionStatus::InvalidAmount, amount, from.getBalance()};
+    }
+
+    second.unlockAfterTransfer();
+    first.unlockAfterTransfer();
+    return timer.finish(result);
+}
+
+/**
+ * Reads two balances as of one instant with respect to transfers
+ * Never blocks transfers; retries while one is in flight.
+ *
+ * @param first One account
+ * @param second Another account
+ * @return The two balances, never showing a half-finished transfer
+ */
+inline std::pair<Money, Money> readBalances(const ConcurrentAccount &first,
+                                            const ConcurrentAccount &second) {
+    for (;;) {
+        std::uint64_t v1 = first.version.load(std::memory_order_acquire);
+        std::uint64_t v2 = second.version.load(std::memory_order_acquire);
+        if ((v1 & 1) != 0 || (v2 & 1) != 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        Money a = first.getBalance();
+        Money b = second.getBalance();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (first.version.load(std::memory_order_relaxed) == v1 &&
+            second.version.load(std::memory_order_relaxed) == v2) {
+            return {a, b};
+        }
+    }
+}
+
+#endif // CONCURRENT_ACCOUNT_HPP
@@ -0,0 +1,120 @@
+#ifndef CONSOLE_ACCOUNT_PRINTER_HPP
+#define CONSOLE_ACCOUNT_PRINTER_HPP
+
+#include <iostream>
+#include <string_view>
+
+#include "bank_account.hpp"
+
+// ============================================================================
+// CLASS DEFINITION: ConsoleAccountPrinter
+// ============================================================================
+/**
+ * Observer that prints a human-readable line for every account event
+ * 
+ * This is the narrative output the demo shows. Attach it to an account to
+ * get the messages; leave it off (silent mode) when replaying ledgers or
+ * running anything performance sensitive. Lines end with '\n' rather than
+ * std::endl, so the stream decides when to flush.
+ */
+class ConsoleAccountPrinter : public AccountObserver {
+private:
+    std::ostream &out;   // Destination stream for the messages
+
+    /**
+     * Prints the requested/available lines shown for an overdraft attempt
+     * @param result The rejected result
+     */
+    void printInsufficientFunds(const TransactionResult &result) {
+        out << "  Requested: $" << result.amount << '\n';
+        out << "  Available: $" << result.balance << '\n';
+    }
+
+public:
+    /**
+     * Constructor
+     * @param stream Stream to print to (default std::cout)
+     */
+    explicit ConsoleAccountPrinter(std::ostream &stream = std::cout) : out(stream) {}
+
+    void onAccountOpened(const BankAccount &) override {
+        out << "✓ Account created successfully!" << '\n';
+    }
+
+    void onAccountClosed(const BankAccount &account) override {
+        out << "Account " << account.getAccountNumber() << " has been closed." << '\n';
+    }
+
+    void onDeposit(const BankAccount &, const TransactionResult &result) override {
+        if (!result) {
+            out << "✗ Invalid amount! Deposit amount must be positive" << '\n';
+            return;
+        }
+        out << "✓ Deposit Successful!" << '\n';
+        out << "  Amount Deposited: $" << result.amount << '\n';
+        out << "  New Balance: $" << result.balance << '\n';
+    }
+
+    void onWithdraw(const BankAccount &, const TransactionResult &result) override {
+        switch (result.status) {
+        case TransactionStatus::InvalidAmount:
+            out << "✗ Invalid amount! Withdrawal amount must be positive" << '\n';
+            return;
+        case TransactionStatus::InsufficientFunds:
+            out << "✗ Insufficient funds!" << '\n';
+            printInsufficientFunds(result);
+            return;
+        default:
+            break;
+        }
+        out << "✓ Withdrawal Successful!" << '\n';
+        out << "  Amount Withdrawn: $" << result.amount << '\n';
+        out << "  New Balance: $" << result.balance << '\n';
+    }
+
+    void onTransfer(const BankAccount &from, const BankAccount &to,
+                    const TransactionResult &result) override {
+        switch (result.status) {
+        case TransactionStatus::InvalidAmount:
+            out << "✗ Invalid transfer amount! Must be positive" << '\n';
+            return;
+        case TransactionStatus::InsufficientFunds:
+            out << "✗ Insufficient funds for transfer!" << '\n';
+            printInsufficientFunds(result);
+            return;
+        default:
+            break;
+        }
+        out << "✓ Transfer Successful!" << '\n';
+        out << "  From: " << from.getAccountHolder() << " (" << from.getAccountNumber() << ")" << '\n';
+        out << "  To: " << to.getAccountHolder() << " (" << to.getAccountNumber() << ")" << '\n';
+        out << "  Amount: $" << result.amount << '\n';
+    }
+
+    void onInterestApplied(const BankAccount &account, const TransactionResult &result) override {
+        out << "✓ Interest Applied!" << '\n';
+        out << "  Interest Rate: " << account.getInterestRate() << "%" << '\n';
+        out << "  Interest Added: $" << result.amount << '\n';
+        out << "  New Balance: $" << result.balance << '\n';
+    }
+
+    void onInterestRateChanged(const BankAccount &, InterestRate rate,
+                               TransactionStatus status) override {
+        if (status == TransactionStatus::Success) {
+            out << "✓ Interest rate updated to " << rate << "%" << '\n';
+        } else {
+            out << "✗ Invalid interest rate! Rate must be between 0 and 50%" << '\n';
+        }
+    }
+
+    void onAccountHolderChanged(const BankAccount &account, std::string_view,
+                                TransactionStatus status) override {
+        if (status == TransactionStatus::Success) {
+            out << "✓ Account holder updated to: " << account.getAccountHolder() << '\n';
+        } else {
+            out << "✗ Invalid name! Account holder name cannot be empty" << '\n';
+        }
+    }
+};
+
+#endif // CONSOLE_ACCOUNT_PRINTER_HPP
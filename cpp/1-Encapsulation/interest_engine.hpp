@@ -0,0 +1,268 @@
+#ifndef INTEREST_ENGINE_HPP
+#define INTEREST_ENGINE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "account_store.hpp"
+#include "journal_record.hpp"
+#include "money.hpp"
+
+/**
+ * ============================================================================
+ * BATCHED INTEREST ACCRUAL
+ * ============================================================================
+ *
+ * BankAccount::applyInterest works on one account per call. InterestEngine
+ * accrues interest for a whole AccountStore in one pass over the balance
+ * and rate columns:
+ * - no I/O, no virtual calls, no per-account function call
+ * - the rounding mode is resolved once, outside the loop
+ * - blocks whose balance * rate products provably fit in 64 bits use a
+ *   branch-free 64-bit kernel the compiler can unroll and pipeline; only
+ *   blocks holding extreme values fall back to 128-bit arithmetic
+ *
+ * The result is the same, cent for cent, as calling applyInterest on every
+ * account with the same rounding mode.
+ *
+ * The store's running totals (interest and balance per account type) are
+ * adjusted once per run, from per-type sums the kernels keep as they go.
+ *
+ * On a lazily accruing store the range is settled first, so the pass
+ * credits one period on top of every period already elapsed.
+ *
+ * When the store has a RecordSink attached, one Interest record per
+ * credited account is journaled after the pass (the kernels stay free of
+ * calls; the per-account interest is captured as deltas and journaled from
+ * there).
+ * ============================================================================
+ */
+
+/**
+ * Aggregate outcome of one accrual run
+ */
+struct InterestTotals {
+    Money interest;                     // Total interest credited
+    std::size_t accountsCredited = 0;   // Accounts whose interest was non-zero
+};
+
+// ============================================================================
+// CLASS DEFINITION: InterestEngine
+// ============================================================================
+class InterestEngine {
+private:
+    static constexpr std::size_t kBlockSize = 4096;   // Accounts per overflow check
+
+    using TypeTotals = std::array<std::int64_t, kAccountTypeCount>;   // Cents per AccountType
+
+    RoundingMode rounding;   // How fractional cents are rounded
+
+    /**
+     * Accrues one block with 64-bit arithmetic
+     * Requires every |balance * rate| in the block to fit in int64.
+     */
+    template <RoundingMode Mode, bool WithDeltas>
+    static void accrueNarrow(std::int64_t *balances, const std::int32_t *rates, const AccountType *types,
+                             std::size_t count, Money *deltas, std::int64_t &total, std::size_t &credited,
+                             TypeTotals &byType) {
+        std::int64_t blockTotal = 0;
+        std::size_t blockCredited = 0;
+        TypeTotals blockByType{};
+        for (std::size_t i = 0; i < count; ++i) {
+            std::int64_t interest = divideRoundedNarrow<Mode>(
+                balances[i] * rates[i], InterestRate::kBasisPointsPerUnit);
+            balances[i] += interest;
+            blockTotal += interest;
+            blockCredited += static_cast<std::size_t>(interest != 0);
+            blockByType[static_cast<std::size_t>(types[i])] += interest;
+            if constexpr (WithDeltas) {
+                deltas[i] = Money::fromMinorUnits(interest);
+            }
+        }
+        total += blockTotal;
+        credited += blockCredited;
+        for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+            byType[t] += blockByType[t];
+        }
+    }
+
+    /**
+     * Accrues one block with 128-bit intermediates (any balance, any rate)
+     */
+    static void accrueWide(std::int64_t *balances, const std::int32_t *rates, const AccountType *types,
+                           std::size_t count, Money *deltas, RoundingMode mode, std::int64_t &total,
+                           std::size_t &credited, TypeTotals &byType) {
+        for (std::size_t i = 0; i < count; ++i) {
+            Money interest = computeInterest(Money::fromMinorUnits(balances[i]),
+                                             InterestRate::fromBasisPoints(rates[i]), mode);
+            balances[i] += interest.getMinorUnits();
+            total += interest.getMinorUnits();
+            byType[static_cast<std::size_t>(types[i])] += interest.getMinorUnits();
+            credited += static_cast<std::size_t>(!interest.isZero());
+            if (deltas) {
+                deltas[i] = interest;
+            }
+        }
+    }
+
+    /**
+     * @return true if every balance * rate product in the block fits in int64
+     */
+    static bool fitsNarrow(const std::int64_t *balances, const std::int32_t *rates,
+                           std::size_t count) {
+        std::uint64_t maxBalance = 0;
+        std::uint64_t maxRate = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            std::uint64_t b = balances[i] < 0 ? 0 - static_cast<std::uint64_t>(balances[i])
+                                              : static_cast<std::uint64_t>(balances[i]);
+            std::uint64_t r = rates[i] < 0 ? 0 - static_cast<std::uint64_t>(rates[i])
+                                           : static_cast<std::uint64_t>(rates[i]);
+            maxBalance = std::max(maxBalance, b);
+            maxRate = std::max(maxRate, r);
+        }
+        constexpr std::uint64_t kLimit = std::numeric_limits<std::int64_t>::max();
+        return maxRate == 0 || maxBalance <= kLimit / maxRate;
+    }
+
+    template <RoundingMode Mode>
+    static void accrueBlock(std::int64_t *balances, const std::int32_t *rates, const AccountType *types,
+                            std::size_t count, Money *deltas, std::int64_t &total, std::size_t &credited,
+                            TypeTotals &byType) {
+        if (!fitsNarrow(balances, rates, count)) {
+            accrueWide(balances, rates, types, count, deltas, Mode, total, credited, byType);
+        } else if (deltas) {
+            accrueNarrow<Mode, true>(balances, rates, types, count, deltas, total, credited, byType);
+        } else {
+            accrueNarrow<Mode, false>(balances, rates, types, count, nullptr, total, credited, byType);
+        }
+    }
+
+    template <RoundingMode Mode>
+    static InterestTotals accrueAll(std::int64_t *balances, const std::int32_t *rates,
+                                    const AccountType *types, std::size_t count, Money *deltas,
+                                    TypeTotals &byType) {
+        std::int64_t total = 0;
+        std::size_t credited = 0;
+        for (std::size_t start = 0; start < count; start += kBlockSize) {
+            std::size_t length = std::min(kBlockSize, count - start);
+            accrueBlock<Mode>(balances + start, rates + start, types + start, length,
+                              deltas ? deltas + start : nullptr, total, credited, byType);
+        }
+        return InterestTotals{Money::fromMinorUnits(total), credited};
+    }
+
+public:
+    /**
+     * @param mode How to round the fractional cent of every accrual
+     */
+    explicit InterestEngine(RoundingMode mode = RoundingMode::HalfEven) : rounding(mode) {}
+
+    RoundingMode getRoundingMode() const { return rounding; }
+
+    /**
+     * Applies one period of interest to every account in the store
+     *
+     * @param store The accounts to accrue
+     * @param deltas Optional output, either empty or at least store.size()
+     *               entries; receives the interest credited to each slot
+     * @return Total interest and the number of accounts credited
+     */
+    InterestTotals applyAll(AccountStore &store, std::span<Money> deltas = {}) const {
+        return applyRange(store, 0, store.size(), deltas);
+    }
+
+    /**
+     * Applies one period of interest to the slots [begin, end) of a store
+     * Disjoint ranges of one store may be accrued from different threads at
+     * the same time, provided the store's RecordSink (if any) is thread-safe.
+     *
+     * @param store The accounts to accrue
+     * @param begin First slot
+     * @param end One past the last slot (at most store.size())
+     * @param deltas Optional output, either empty or at least end - begin
+     *               entries; entry i receives the interest of slot begin + i
+     * @return Total interest and the number of accounts credited
+     */
+    InterestTotals applyRange(AccountStore &store, std::size_t begin, std::size_t end,
+                              std::span<Money> deltas = {}) const {
+        assert(begin <= end && end <= store.size());
+        std::size_t count = end - begin;
+        assert(deltas.empty() || deltas.size() >= count);
+        store.settleRange(begin, end);   // A lazy store first catches up on missed periods
+        store.markChangedRange(begin, end);
+        std::int64_t *balances = store.balances.data() + begin;
+        const std::int32_t *rates = store.rates.data() + begin;
+        const AccountType *types = store.types.data() + begin;
+        TypeTotals byType{};
+
+        // Journaling needs the per-account interest even if the caller does not
+        std::vector<Money> journalDeltas;
+        if (store.recordSink && deltas.empty()) {
+            journalDeltas.resize(count);
+            deltas = journalDeltas;
+        }
+        Money *out = deltas.empty() ? nullptr : deltas.data();
+
+        InterestTotals totals;
+        switch (rounding) {
+        case RoundingMode::HalfEven:
+            totals = accrueAll<RoundingMode::HalfEven>(balances, rates, types, count, out, byType);
+            break;
+        case RoundingMode::HalfUp:
+            totals = accrueAll<RoundingMode::HalfUp>(balances, rates, types, count, out, byType);
+            break;
+        case RoundingMode::TowardZero:
+            totals = accrueAll<RoundingMode::TowardZero>(balances, rates, types, count, out, byType);
+            break;
+        case RoundingMode::Floor:
+            totals = accrueAll<RoundingMode::Floor>(balances, rates, types, count, out, byType);
+            break;
+        case RoundingMode::Ceiling:
+            totals = accrueAll<RoundingMode::Ceiling>(balances, rates, types, count, out, byType);
+            break;
+        }
+        store.aggregates.onBatch(byType, 0, totals.interest.getMinorUnits());
+
+        if (store.recordSink) {
+            for (std::size_t i = 0; i < count; ++i) {
+                if (!deltas[i].isZero()) {
+                    store.recordSink->append(journal::makeRecord(
+                        JournalOp::Interest, store.accountNumbers[begin + i], deltas[i],
+                        Money::fromMinorUnits(balances[i])));
+                }
+            }
+        }
+        return totals;
+    }
+
+    /**
+     * Applies one period of interest to a selection of accounts
+     * Suited to sparse selections; use the store overload for whole stores.
+     *
+     * @param accounts The accounts to accrue (may come from different stores)
+     * @param deltas Optional output, either empty or at least accounts.size()
+     *               entries; receives the interest credited to each account
+     * @return Total interest and the number of accounts credited
+     */
+    InterestTotals applyAll(std::span<AccountRef> accounts, std::span<Money> deltas = {}) const {
+        assert(deltas.empty() || deltas.size() >= accounts.size());
+        InterestTotals totals;
+        for (std::size_t i = 0; i < accounts.size(); ++i) {
+            Money interest = accounts[i].applyInterest(rounding).amount;
+            totals.interest += interest;
+            totals.accountsCredited += static_cast<std::size_t>(!interest.isZero());
+            if (!deltas.empty()) {
+                deltas[i] = interest;
+            }
+        }
+        return totals;
+    }
+};
+
+#endif // INTEREST_ENGINE_HPP
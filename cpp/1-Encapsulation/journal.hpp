@@ -0,0 +1,728 @@
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "account_store.hpp"
+#include "bank_account.hpp"
+#include "journal_record.hpp"
+
+/**
+ * ============================================================================
+ * APPEND-ONLY TRANSACTION JOURNAL WITH GROUP COMMIT
+ * ============================================================================
+ *
+ * FILE FORMAT:
+ *   JournalFileHeader (16 bytes: magic "BANKJNL1", version, record size)
+ *   JournalRecord, JournalRecord, ... (48 bytes each, see journal_record.hpp)
+ * Records are only ever appended. Sequence numbers start at 1 and increase
+ * by exactly one per record, so a gap or a bad checksum marks the end of the
+ * valid journal (a write torn by a crash).
+ *
+ * GROUP COMMIT:
+ * Calling fdatasync after every transaction would cap throughput at the
+ * device's sync rate. JournalWriter::append only copies the record into a
+ * ring buffer; a background flusher writes everything pending with one
+ * write and one fdatasync as soon as either
+ * - maxBatch records are pending, or
+ * - maxDelay has passed since the first pending record arrived.
+ * A crash can therefore lose at most the last group. Callers that need a
+ * record on disk before they continue (e.g. before acknowledging a payment)
+ * call sync(), which forces the current group out and waits for it.
+ *
+ * PRODUCERS:
+ * - BankAccount: attach a JournalingObserver (it can forward to a printer)
+ * - AccountStore: setRecordSink (covers AccountRef, InterestEngine and
+ *   BatchPoster)
+ *
+ * REPLAY:
+ * replayJournal rebuilds accounts (an AccountStore or a map of BankAccount)
+ * by re-applying every record through the normal mutators, and checks the
+ * resulting balance against the balance the record says it left behind.
+ * ============================================================================
+ */
+
+/**
+ * First bytes of every journal file
+ */
+struct JournalFileHeader {
+    char magic[8] = {'B', 'A', 'N', 'K', 'J', 'N', 'L', '1'};
+    std::uint32_t version = 1;
+    std::uint32_t recordSize = sizeof(JournalRecord);
+
+    /**
+     * @return true if this header was written by a compatible writer
+     */
+    bool isValid() const {
+        JournalFileHeader expected;
+        return std::memcmp(magic, expected.magic, sizeof magic) == 0 &&
+               version == expected.version && recordSize == expected.recordSize;
+    }
+};
+
+static_assert(sizeof(JournalFileHeader) == 16);
+
+/**
+ * Outcome of reading a journal file
+ */
+enum class JournalReadStatus {
+    Ok,           // Every byte after the header was a valid record
+    TornTail,     // Valid prefix followed by an incomplete or corrupt record
+    CannotOpen,   // The file does not exist or cannot be read
+    BadHeader     // Not a journal, or written by an incompatible version
+};
+
+/**
+ * Summary of the valid part of a journal file
+ */
+struct JournalScan {
+    JournalReadStatus status = JournalReadStatus::Ok;
+    std::size_t records = 0;          // Valid records read
+    std::uint64_t lastSequence = 0;   // Sequence of the last valid record (0 = none)
+
+    /**
+     * @return Size in bytes of the header plus the valid records
+     */
+    std::uint64_t validBytes() const {
+        return sizeof(JournalFileHeader) + records * sizeof(JournalRecord);
+    }
+};
+
+namespace journal {
+
+/**
+ * Reads the records of an open journal in order and passes each valid one
+ * to visit. Stops at the first record that is incomplete, fails its
+ * checksum or breaks the sequence.
+ *
+ * @param fd File positioned anywhere (read from offset 0 with pread)
+ * @param visit Called as visit(const JournalRecord &)
+ */
+template <class Visitor>
+JournalScan scan(int fd, Visitor &&visit) {
+    JournalScan result;
+    JournalFileHeader header;
+    if (::pread(fd, &header, sizeof header, 0) != static_cast<ssize_t>(sizeof header) ||
+        !header.isValid()) {
+        result.status = JournalReadStatus::BadHeader;
+        return result;
+    }
+
+    constexpr std::size_t kChunkRecords = 4096;
+    std::vector<JournalRecord> chunk(kChunkRecords);
+    off_t offset = sizeof header;
+    for (;;) {
+        ssize_t bytes = ::pread(fd, chunk.data(), kChunkRecords * sizeof(JournalRecord), offset);
+        if (bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes <= 0) {
+            if (bytes < 0) {
+                result.status = JournalReadStatus::TornTail;
+            }
+            return result;
+        }
+        std::size_t whole = static_cast<std::size_t>(bytes) / sizeof(JournalRecord);
+        for (std::size_t i = 0; i < whole; ++i) {
+            const JournalRecord &record = chunk[i];
+            if (!isIntact(record) || record.sequence != result.lastSequence + 1 ||
+                (result.records == 0 && record.sequence == 0)) {
+                result.status = JournalReadStatus::TornTail;
+                return result;
+            }
+            visit(record);
+            result.lastSequence = record.sequence;
+            ++result.records;
+        }
+        if (whole * sizeof(JournalRecord) != static_cast<std::size_t>(bytes)) {
+            // Trailing partial record; it is never followed by more
+            result.status = JournalReadStatus::TornTail;
+            return result;
+        }
+        offset += static_cast<off_t>(bytes);
+    }
+}
+
+} // namespace journal
+
+/**
+ * Reads a journal file from the start
+ *
+ * @param path The journal file
+ * @param visit Called as visit(const JournalRecord &) for every valid record
+ * @return How much of the file was valid
+ */
+template <class Visitor>
+JournalScan readJournal(const std::string &path, Visitor &&visit) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        JournalScan result;
+        result.status = JournalReadStatus::CannotOpen;
+        return result;
+    }
+    JournalScan result = journal::scan(fd, visit);
+    ::close(fd);
+    return result;
+}
+
+/**
+ * When the flusher writes a group to disk
+ */
+struct GroupCommitPolicy {
+    std::size_t maxBatch = 256;                     // Flush once this many records are pending
+    std::chrono::microseconds maxDelay{1000};       // ... or once the oldest has waited this long
+    std::size_t ringCapacity = 65536;               // Records buffered before append blocks
+};
+
+// ============================================================================
+// CLASS DEFINITION: JournalWriter
+// ============================================================================
+/**
+ * RecordSink that appends records to a journal file with group commit
+ * append is thread-safe. Opening an existing journal continues its sequence
+ * after cutting off any torn tail left by a crash.
+ */
+class JournalWriter : public RecordSink {
+private:
+    int fd = -1;                           // Journal file (O_APPEND)
+    GroupCommitPolicy policy;              // Flush thresholds
+    std::vector<JournalRecord> ring;       // Records not yet durable
+
+    mutable std::mutex mutex;
+    std::condition_variable flushNeeded;   // Wakes the flusher
+    std::condition_variable progress;      // Wakes appenders and sync callers
+
+    std::uint64_t firstSequence = 1;       // Sequence of ring record number 0
+    std::uint64_t appended = 0;            // Records handed to append (ever)
+    std::uint64_t durable = 0;             // Records written and synced (ever)
+    std::uint64_t groupCommits = 0;        // fdatasync calls made
+    std::size_t syncWaiters = 0;           // Threads blocked in sync()
+    bool stopping = false;                 // Destructor is draining the ring
+    bool failed = false;                   // Open, write or sync failed
+
+    std::thread flusher;                   // Runs flushLoop
+
+    /**
+     * Writes all of [data, data + bytes), retrying short writes
+     */
+    bool writeAll(const void *data, std::size_t bytes) {
+        const char *cursor = static_cast<const char *>(data);
+        while (bytes > 0) {
+            ssize_t written = ::write(fd, cursor, bytes);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            cursor += written;
+            bytes -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    /**
+     * Writes ring records [begin, end) and syncs them (called unlocked;
+     * appenders never touch these slots until durable moves past them)
+     */
+    bool commitGroup(std::uint64_t begin, std::uint64_t end) {
+        const std::size_t capacity = ring.size();
+        std::size_t first = static_cast<std::size_t>(begin % capacity);
+        std::size_t count = static_cast<std::size_t>(end - begin);
+        std::size_t untilWrap = std::min(count, capacity - first);
+        if (!writeAll(ring.data() + first, untilWrap * sizeof(JournalRecord)) ||
+            !writeAll(ring.data(), (count - untilWrap) * sizeof(JournalRecord))) {
+            return false;
+        }
+        return ::fdatasync(fd) == 0;
+    }
+
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            flushNeeded.wait(lock, [this] { return stopping || appended > durable; });
+            if (appended == durable) {
+                return;   // Stopping with nothing left to write
+            }
+            // Let the group fill up, unless someone is waiting for it
+            flushNeeded.wait_for(lock, policy.maxDelay, [this] {
+                return stopping || syncWaiters > 0 || appended - durable >= policy.maxBatch;
+            });
+
+            std::uint64_t begin = durable;
+            std::uint64_t end = appended;
+            lock.unlock();
+            bool written = commitGroup(begin, end);
+            lock.lock();
+
+            if (!written) {
+                failed = true;
+                progress.notify_all();
+                return;
+            }
+            durable = end;
+            ++groupCommits;
+            progress.notify_all();
+        }
+    }
+
+    /**
+     * Opens or creates the journal and positions it after its valid records
+     */
+    bool openFile(const std::string &path) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            return false;
+        }
+        if (info.st_size == 0) {
+            JournalFileHeader header;
+            return writeAll(&header, sizeof header) && ::fdatasync(fd) == 0;
+        }
+
+        JournalScan existing = journal::scan(fd, [](const JournalRecord &) {});
+        if (existing.status == JournalReadStatus::BadHeader) {
+            return false;
+        }
+        if (existing.status == JournalReadStatus::TornTail &&
+            ::ftruncate(fd, static_cast<off_t>(existing.validBytes())) != 0) {
+            return false;
+        }
+        firstSequence = existing.lastSequence + 1;
+        return true;
+    }
+
+public:
+    /**
+     * Opens (or creates) a journal for appending
+     * Check ok() afterwards; a writer that failed to open drops every record.
+     *
+     * @param path The journal file
+     * @param commitPolicy When groups are flushed
+     */
+    explicit JournalWriter(const std::string &path, GroupCommitPolicy commitPolicy = {})
+        : policy(commitPolicy),
+          ring(commitPolicy.ringCapacity > 0 ? commitPolicy.ringCapacity : 1) {
+        if (policy.maxBatch == 0) {
+            policy.maxBatch = 1;
+        }
+        if (!openFile(path)) {
+            failed = true;
+            return;
+        }
+        flusher = std::thread([this] { flushLoop(); });
+    }
+
+    JournalWriter(const JournalWriter &) = delete;
+    JournalWriter &operator=(const JournalWriter &) = delete;
+
+    /**
+     * Writes and syncs every pending record, then closes the file
+     */
+    ~JournalWriter() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        flushNeeded.notify_one();
+        if (flusher.joinable()) {
+            flusher.join();
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    /**
+     * Queues a record for the next group commit
+     * Blocks only when ringCapacity records are already waiting for the disk.
+     *
+     * @param record The record (sequence and checksum are filled in here)
+     * @return Its sequence number, or 0 if the journal has failed
+     */
+    std::uint64_t append(const JournalRecord &record) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        progress.wait(lock, [this] { return failed || appended - durable < ring.size(); });
+        if (failed) {
+            return 0;
+        }
+        std::uint64_t sequence = firstSequence + appended;
+        JournalRecord &slot = ring[static_cast<std::size_t>(appended % ring.size())];
+        slot = record;
+        journal::seal(slot, sequence);
+        ++appended;
+
+        std::uint64_t pending = appended - durable;
+        if (pending == 1 || pending == policy.maxBatch) {
+            flushNeeded.notify_one();
+        }
+        return sequence;
+    }
+
+    /**
+     * Forces the current group to disk and waits for it
+     * @return true if every record appended so far is durable
+     */
+    bool sync() {
+        std::unique_lock<std::mutex> lock(mutex);
+        std::uint64_t target = appended;
+        ++syncWaiters;
+        flushNeeded.notify_one();
+        progress.wait(lock, [&] { return failed || durable >= target; });
+        --syncWaiters;
+        return !failed;
+    }
+
+    /**
+     * @return false once opening, writing or syncing the file has failed
+     */
+    bool ok() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !failed;
+    }
+
+    /**
+     * @return Sequence of the last record known to be on disk (0 = none)
+     */
+    std::uint64_t getDurableSequence() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return firstSequence + durable - 1;
+    }
+
+    /**
+     * @return Sequence of the last record appended (0 = none)
+     */
+    std::uint64_t getLastSequence() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return firstSequence + appended - 1;
+    }
+
+    /**
+     * @return Number of group commits (fdatasync calls) so far
+     */
+    std::uint64_t getGroupCommits() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return groupCommits;
+    }
+};
+
+// ============================================================================
+// CLASS DEFINITION: JournalingObserver
+// ============================================================================
+/**
+ * AccountObserver that journals every successful BankAccount mutation
+ * Optionally forwards every event to another observer (e.g. a printer),
+ * since an account has only one observer slot.
+ */
+class JournalingObserver : public AccountObserver {
+private:
+    RecordSink &sink;         // Where records go
+    AccountObserver *next;    // Observer that also sees every event (or nullptr)
+
+public:
+    /**
+     * @param recordSink Receives the records
+     * @param forwardTo Optional observer to pass every event on to
+     */
+    explicit JournalingObserver(RecordSink &recordSink, AccountObserver *forwardTo = nullptr)
+        : sink(recordSink), next(forwardTo) {}
+
+    void onAccountOpened(const BankAccount &account) override {
+        sink.append(journal::makeOpen(account.getAccountNumber(), account.getAccountType(),
+                                      account.getInterestRate(), account.getBalance()));
+        sink.appendHolderName(account.getAccountNumber(), account.getAccountHolder());
+        if (next) {
+            next->onAccountOpened(account);
+        }
+    }
+
+    void onAccountClosed(const BankAccount &account) override {
+        // Destroying the object does not close the account; nothing to journal
+        if (next) {
+            next->onAccountClosed(account);
+        }
+    }
+
+    void onDeposit(const BankAccount &account, const TransactionResult &result) override {
+        if (result.ok()) {
+            sink.append(journal::makeRecord(JournalOp::Deposit, account.getAccountNumber(),
+                                            result.amount, result.balance));
+        }
+        if (next) {
+            next->onDeposit(account, result);
+        }
+    }
+
+    void onWithdraw(const BankAccount &account, const TransactionResult &result) override {
+        if (result.ok()) {
+            sink.append(journal::makeRecord(JournalOp::Withdraw, account.getAccountNumber(),
+                                            result.amount, result.balance));
+        }
+        if (next) {
+            next->onWithdraw(account, result);
+        }
+    }
+
+    void onTransfer(const BankAccount &from, const BankAccount &to,
+                    const TransactionResult &result) override {
+        if (result.ok()) {
+            sink.append(journal::makeTransfer(from.getAccountNumber(), to.getAccountNumber(),
+                                              result.amount, result.balance));
+        }
+        if (next) {
+            next->onTransfer(from, to, result);
+        }
+    }
+
+    void onInterestApplied(const BankAccount &account, const TransactionResult &result) override {
+        if (result.ok() && !result.amount.isZero()) {
+            sink.append(journal::makeRecord(JournalOp::Interest, account.getAccountNumber(),
+                                            result.amount, result.balance));
+        }
+        if (next) {
+            next->onInterestApplied(account, result);
+        }
+    }
+
+    void onInterestRateChanged(const BankAccount &account, InterestRate rate,
+                               TransactionStatus status) override {
+        if (status == TransactionStatus::Success) {
+            sink.append(journal::makeRateChange(account.getAccountNumber(), rate, account.getBalance()));
+        }
+        if (next) {
+            next->onInterestRateChanged(account, rate, status);
+        }
+    }
+
+    void onAccountHolderChanged(const BankAccount &account, std::string_view previous,
+                                TransactionStatus status) override {
+        if (status == TransactionStatus::Success) {
+            sink.appendHolderName(account.getAccountNumber(), account.getAccountHolder());
+        }
+        if (next) {
+            next->onAccountHolderChanged(account, previous, status);
+        }
+    }
+};
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+/**
+ * Outcome of replaying a journal
+ */
+struct ReplayStats {
+    JournalScan scan;             // How much of the file was valid
+    std::size_t applied = 0;      // Records re-applied
+    std::size_t skipped = 0;      // At or before afterSequence, naming an unknown account,
+                                  // or a status change the target cannot hold
+    std::size_t mismatches = 0;   // Re-applied, but the balance differs from balanceAfter
+};
+
+namespace journal {
+
+/**
+ * Replay target backed by an AccountStore
+ */
+class StoreReplayTarget {
+private:
+    AccountStore &store;
+
+public:
+    explicit StoreReplayTarget(AccountStore &accounts) : store(accounts) {}
+
+    std::optional<AccountRef> find(AccountId id) {
+        return store.find(id);
+    }
+
+    bool open(AccountId id, AccountType type, InterestRate rate, Money balance) {
+        return store.open(id, std::string(), balance, type, rate).has_value();
+    }
+};
+
+/**
+ * Replay target backed by a map of BankAccount
+ */
+class BankAccountReplayTarget {
+private:
+    std::unordered_map<AccountId, BankAccount> &accounts;
+
+public:
+    explicit BankAccountReplayTarget(std::unordered_map<AccountId, BankAccount> &map)
+        : accounts(map) {}
+
+    BankAccount *find(AccountId id) {
+        auto it = accounts.find(id);
+        return it == accounts.end() ? nullptr : &it->second;
+    }
+
+    bool open(AccountId id, AccountType type, InterestRate rate, Money balance) {
+        return accounts.try_emplace(id, id, std::string_view(), balance, type, rate).second;
+    }
+};
+
+/**
+ * Re-applies one record to a replay target
+ *
+ * @param target StoreReplayTarget or BankAccountReplayTarget
+ * @param record The record
+ * @param names Holder names being reassembled from their chunks
+ * @param stats Updated with the outcome
+ */
+template <class Target>
+void replayRecord(Target &target, const JournalRecord &record,
+                  std::unordered_map<AccountId, std::string> &names, ReplayStats &stats) {
+    AccountId id = AccountId::fromPacked(record.account);
+    Money amount = Money::fromMinorUnits(record.amount);
+
+    if (record.op == JournalOp::Open) {
+        bool opened = target.open(id, static_cast<AccountType>(record.accountType),
+                                  InterestRate::fromBasisPoints(static_cast<std::int32_t>(record.counterparty)),
+                                  amount);
+        ++(opened ? stats.applied : stats.skipped);
+        return;
+    }
+
+    auto account = target.find(id);
+    if (!account) {
+        ++stats.skipped;
+        return;
+    }
+
+    Money balance;
+    switch (record.op) {
+    case JournalOp::Deposit:
+        balance = account->deposit(amount).balance;
+        break;
+    case JournalOp::Withdraw:
+        balance = account->withdraw(amount).balance;
+        break;
+    case JournalOp::Transfer: {
+        auto to = target.find(AccountId::fromPacked(record.counterparty));
+        if (!to) {
+            ++stats.skipped;
+            return;
+        }
+        balance = account->transfer(*to, amount).balance;
+        break;
+    }
+    case JournalOp::Interest:
+        // Re-credit the journaled amount instead of recomputing it, so the
+        // result does not depend on the rounding mode used at the time
+        if constexpr (requires { account->creditInterest(amount); }) {
+            balance = account->creditInterest(amount).balance;   // Even if credits are blocked
+        } else {
+            balance = account->deposit(amount).balance;
+        }
+        break;
+    case JournalOp::RateChange:
+        account->setInterestRate(InterestRate::fromBasisPoints(static_cast<std::int32_t>(record.amount)));
+        balance = account->getBalance();
+        break;
+    case JournalOp::HolderName: {
+        std::string &name = names[id];
+        if (record.chunk == 0) {
+            name.clear();
+        }
+        appendNameChunk(name, record);
+        if (record.chunk + 1 >= record.accountType) {
+            account->setAccountHolder(std::move(name));
+            names.erase(id);
+        }
+        ++stats.applied;
+        return;   // Name records carry no balance
+    }
+    case JournalOp::StatusChange: {
+        std::optional<AccountStatus> status = account_status::fromBits(static_cast<std::uint64_t>(record.amount));
+        if constexpr (requires { account->setStatus(AccountStatus::Active); }) {
+            if (status) {
+                account->setStatus(*status);
+                balance = account->getBalance();
+                break;
+            }
+        }
+        ++stats.skipped;   // Unknown status bits, or a BankAccount (it keeps no status)
+        return;
+    }
+    case JournalOp::Open:
+        break;
+    }
+
+    ++stats.applied;
+    stats.mismatches += static_cast<std::size_t>(balance.getMinorUnits() != record.balanceAfter);
+}
+
+template <class Target>
+ReplayStats replayInto(const std::string &path, Target &target, std::uint64_t afterSequence) {
+    ReplayStats stats;
+    std::unordered_map<AccountId, std::string> names;
+    stats.scan = readJournal(path, [&](const JournalRecord &record) {
+        if (record.sequence <= afterSequence) {
+            ++stats.skipped;
+            return;
+        }
+        replayRecord(target, record, names, stats);
+    });
+    return stats;
+}
+
+} // namespace journal
+
+/**
+ * Rebuilds AccountStore state from a journal
+ * The store's record sink is detached while replaying, so replay does not
+ * journal the records it re-applies.
+ *
+ * @param path The journal file
+ * @param store Accounts to replay onto (empty, or restored from a snapshot)
+ * @param afterSequence Skip records up to and including this sequence
+ * @return What was applied and whether every balance matched
+ */
+inline ReplayStats replayJournal(const std::string &path, AccountStore &store,
+                                 std::uint64_t afterSequence = 0) {
+    RecordSink *sink = store.getRecordSink();
+    store.setRecordSink(nullptr);
+    journal::StoreReplayTarget target(store);
+    ReplayStats stats = journal::replayInto(path, target, afterSequence);
+    store.setRecordSink(sink);
+    return stats;
+}
+
+/**
+ * Rebuilds BankAccount state from a journal
+ * Accounts that are opened by the journal are created silent (no observer).
+ *
+ * @param path The journal file
+ * @param accounts Accounts by number; new ones are added
+ * @param afterSequence Skip records up to and including this sequence
+ * @return What was applied and whether every balance matched
+ */
+inline ReplayStats replayJournal(const std::string &path,
+                                 std::unordered_map<AccountId, BankAccount> &accounts,
+                                 std::uint64_t afterSequence = 0) {
+    journal::BankAccountReplayTarget target(accounts);
+    return journal::replayInto(path, target, afterSequence);
+}
+
+#endif // JOURNAL_HPP
@@ -0,0 +1,229 @@
+#ifndef JOURNAL_RECORD_HPP
+#define JOURNAL_RECORD_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "account_id.hpp"
+#include "account_status.hpp"
+#include "account_type.hpp"
+#include "money.hpp"
+
+/**
+ * ============================================================================
+ * JOURNAL RECORDS: the durable form of one account mutation
+ * ============================================================================
+ *
+ * Every successful mutation (open, deposit, withdraw, transfer, interest,
+ * rate change, holder change, status change) can be described by one
+ * fixed-size 48-byte JournalRecord. Records are what the journal writes to
+ * disk and what replay reads back to rebuild account state.
+ *
+ * Producers (BankAccount via JournalingObserver, AccountStore, the batch
+ * engines) hand records to a RecordSink; the sink decides what happens to
+ * them (a JournalWriter appends them to a file).
+ * ============================================================================
+ */
+
+/**
+ * Kind of mutation a record describes
+ */
+enum class JournalOp : std::uint8_t {
+    Open = 1,       // amount = opening balance, accountType, counterparty = rate (bp)
+    Deposit = 2,    // amount = deposited cents
+    Withdraw = 3,   // amount = withdrawn cents
+    Transfer = 4,   // amount = cents moved from account to counterparty
+    Interest = 5,   // amount = interest credited
+    RateChange = 6, // amount = new rate in basis points
+    HolderName = 7, // 24-byte chunk of the holder name (chunk = index,
+                    // accountType = number of chunks)
+    StatusChange = 8 // amount = new AccountStatus bits
+};
+
+/**
+ * One journal entry (48 bytes, trivially copyable, written as-is)
+ *
+ * balanceAfter is the balance of `account` after the mutation; replay uses it
+ * to verify that the rebuilt state matches what was journaled.
+ */
+struct JournalRecord {
+    std::uint64_t sequence = 0;      // Assigned by the sink, strictly increasing
+    std::uint64_t account = 0;       // Packed AccountId the mutation applies to
+    JournalOp op = JournalOp::Open;
+    std::uint8_t accountType = 0;    // AccountType (Open), chunk count (HolderName)
+    std::uint16_t chunk = 0;         // Chunk index (HolderName only)
+    std::uint32_t checksum = 0;      // FNV-1a over all other bytes
+    std::int64_t amount = 0;         // See JournalOp
+    std::int64_t balanceAfter = 0;   // Balance of account after the mutation
+    std::uint64_t counterparty = 0;  // Packed AccountId (Transfer), rate (Open)
+};
+
+static_assert(sizeof(JournalRecord) == 48, "JournalRecord is an on-disk format");
+static_assert(std::is_trivially_copyable_v<JournalRecord>);
+
+namespace journal {
+
+// Bytes of holder name carried by one HolderName record
+constexpr std::size_t kNameChunkBytes = 24;
+
+// Longest holder name a journal can carry (the chunk count is one byte)
+constexpr std::size_t kMaxJournaledName = 255 * kNameChunkBytes;
+
+/**
+ * @return FNV-1a checksum of the record with its checksum field zeroed
+ */
+inline std::uint32_t computeChecksum(const JournalRecord &record) {
+    JournalRecord copy = record;
+    copy.checksum = 0;
+    unsigned char bytes[sizeof(JournalRecord)];
+    std::memcpy(bytes, &copy, sizeof bytes);
+
+    std::uint32_t hash = 2166136261u;
+    for (unsigned char byte : bytes) {
+        hash = (hash ^ byte) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Seals a record before it is written: fills in sequence and checksum
+ */
+inline void seal(JournalRecord &record, std::uint64_t sequence) {
+    record.sequence = sequence;
+    record.checksum = computeChecksum(record);
+}
+
+/**
+ * @return true if the record's checksum matches its contents
+ */
+inline bool isIntact(const JournalRecord &record) {
+    return record.checksum == computeChecksum(record);
+}
+
+inline JournalRecord makeRecord(JournalOp op, AccountId account, Money amount, Money balanceAfter) {
+    JournalRecord record;
+    record.op = op;
+    record.account = account.getPacked();
+    record.amount = amount.getMinorUnits();
+    record.balanceAfter = balanceAfter.getMinorUnits();
+    return record;
+}
+
+inline JournalRecord makeOpen(AccountId account, AccountType type, InterestRate rate, Money balance) {
+    JournalRecord record = makeRecord(JournalOp::Open, account, balance, balance);
+    record.accountType = static_cast<std::uint8_t>(type);
+    record.counterparty = static_cast<std::uint64_t>(rate.getBasisPoints());
+    return record;
+}
+
+inline JournalRecord makeTransfer(AccountId from, AccountId to, Money amount, Money fromBalanceAfter) {
+    JournalRecord record = makeRecord(JournalOp::Transfer, from, amount, fromBalanceAfter);
+    record.counterparty = to.getPacked();
+    return record;
+}
+
+inline JournalRecord makeRateChange(AccountId account, InterestRate rate, Money balance) {
+    JournalRecord record;
+    record.op = JournalOp::RateChange;
+    record.account = account.getPacked();
+    record.amount = rate.getBasisPoints();
+    record.balanceAfter = balance.getMinorUnits();
+    return record;
+}
+
+inline JournalRecord makeStatusChange(AccountId account, AccountStatus status, Money balance) {
+    JournalRecord record;
+    record.op = JournalOp::StatusChange;
+    record.account = account.getPacked();
+    record.amount = static_cast<std::int64_t>(status);
+    record.balanceAfter = balance.getMinorUnits();
+    return record;
+}
+
+/**
+ * @return Number of HolderName records needed for a name (at least 1)
+ */
+inline std::uint16_t nameChunkCount(std::string_view name) {
+    std::size_t length = std::min(name.size(), kMaxJournaledName);
+    std::size_t chunks = (length + kNameChunkBytes - 1) / kNameChunkBytes;
+    return static_cast<std::uint16_t>(chunks == 0 ? 1 : chunks);
+}
+
+/**
+ * Builds the HolderName record for one chunk of a name
+ *
+ * @param account The account
+ * @param name The full holder name
+ * @param chunk Which 24-byte chunk to encode
+ */
+inline JournalRecord makeNameChunk(AccountId account, std::string_view name, std::uint16_t chunk) {
+    char text[kNameChunkBytes] = {};
+    std::size_t offset = static_cast<std::size_t>(chunk) * kNameChunkBytes;
+    if (offset < name.size()) {
+        name.copy(text, kNameChunkBytes, offset);
+    }
+
+    JournalRecord record;
+    record.op = JournalOp::HolderName;
+    record.account = account.getPacked();
+    record.accountType = static_cast<std::uint8_t>(nameChunkCount(name));
+    record.chunk = chunk;
+    // The name travels in the amount/balanceAfter/counterparty fields
+    std::memcpy(&record.amount, text, 8);
+    std::memcpy(&record.balanceAfter, text + 8, 8);
+    std::memcpy(&record.counterparty, text + 16, 8);
+    return record;
+}
+
+/**
+ * Appends the text carried by a HolderName record to a name being rebuilt
+ */
+template <class String>
+void appendNameChunk(String &name, const JournalRecord &record) {
+    char text[kNameChunkBytes];
+    std::memcpy(text, &record.amount, 8);
+    std::memcpy(text + 8, &record.balanceAfter, 8);
+    std::memcpy(text + 16, &record.counterparty, 8);
+    std::size_t length = 0;
+    while (length < kNameChunkBytes && text[length] != '\0') {
+        ++length;
+    }
+    name.append(text, length);
+}
+
+} // namespace journal
+
+// ============================================================================
+// INTERFACE: RecordSink
+// ============================================================================
+/**
+ * Destination for journal records (a journal file, a replication stream...)
+ * append may be called from several threads; implementations synchronise.
+ */
+class RecordSink {
+public:
+    virtual ~RecordSink() = default;
+
+    /**
+     * @param record The record to take (sequence and checksum are assigned
+     *               by the sink)
+     * @return The sequence number given to the record
+     */
+    virtual std::uint64_t append(const JournalRecord &record) = 0;
+
+    /**
+     * Appends the HolderName records describing a name
+     */
+    void appendHolderName(AccountId account, std::string_view name) {
+        std::uint16_t chunks = journal::nameChunkCount(name);
+        for (std::uint16_t chunk = 0; chunk < chunks; ++chunk) {
+            append(journal::makeNameChunk(account, name, chunk));
+        }
+    }
+};
+
+#endif // JOURNAL_RECORD_HPP
@@ -0,0 +1,353 @@
+#ifndef MONEY_HPP
+#define MONEY_HPP
+
+#include <compare>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * ============================================================================
+ * FIXED-POINT MONEY TYPES
+ * ============================================================================
+ *
+ * Money is stored as a whole number of minor units (cents) in a 64-bit
+ * integer, and interest rates as a whole number of basis points (1/100 of a
+ * percent). All arithmetic is exact integer arithmetic, so sums never drift
+ * the way repeated double additions do, and every operation is constexpr.
+ *
+ * The only place where rounding can happen is when a rate is applied to an
+ * amount; the caller chooses how that rounding is done with RoundingMode.
+ *
+ * NOTE: the intermediate product in computeInterest uses the 128-bit integer
+ * extension provided by GCC and Clang.
+ * ============================================================================
+ */
+
+// 128-bit intermediate for products of an amount and a rate
+__extension__ typedef __int128 WideInt;
+
+// ============================================================================
+// ROUNDING
+// ============================================================================
+/**
+ * How a fractional number of minor units is turned into a whole one
+ */
+enum class RoundingMode {
+    HalfEven,    // Ties go to the even neighbour (banker's rounding)
+    HalfUp,      // Ties go away from zero
+    TowardZero,  // Drop the fraction (truncate)
+    Floor,       // Round toward negative infinity
+    Ceiling      // Round toward positive infinity
+};
+
+/**
+ * Divides with the requested rounding instead of C++'s truncation
+ *
+ * @param numerator The value to divide
+ * @param denominator The divisor (must be positive)
+ * @param mode How to round a non-zero remainder
+ * @return The rounded quotient
+ */
+constexpr std::int64_t divideRounded(WideInt numerator, std::int64_t denominator,
+                                     RoundingMode mode) {
+    WideInt quotient = numerator / denominator;
+    WideInt remainder = numerator % denominator;
+    if (remainder == 0) {
+        return static_cast<std::int64_t>(quotient);
+    }
+
+    const int sign = numerator < 0 ? -1 : 1;
+    const WideInt twiceRemainder = 2 * (remainder < 0 ? -remainder : remainder);
+
+    switch (mode) {
+    case RoundingMode::TowardZero:
+        break;
+    case RoundingMode::Floor:
+        if (sign < 0) {
+            quotient -= 1;
+        }
+        break;
+    case RoundingMode::Ceiling:
+        if (sign > 0) {
+            quotient += 1;
+        }
+        break;
+    case RoundingMode::HalfUp:
+        if (twiceRemainder >= denominator) {
+            quotient += sign;
+        }
+        break;
+    case RoundingMode::HalfEven:
+        if (twiceRemainder > denominator ||
+            (twiceRemainder == denominator && (quotient & 1) != 0)) {
+            quotient += sign;
+        }
+        break;
+    }
+    return static_cast<std::int64_t>(quotient);
+}
+
+/**
+ * Branch-free 64-bit version of divideRounded for bulk loops
+ * The rounding mode is a template argument so the mode check disappears at
+ * compile time, and the body is plain integer arithmetic with no branches.
+ * The caller must know that numerator fits in 64 bits.
+ *
+ * @param numerator The value to divide
+ * @param denominator The divisor (must be positive)
+ * @return The rounded quotient
+ */
+template <RoundingMode Mode>
+constexpr std::int64_t divideRoundedNarrow(std::int64_t numerator, std::int64_t denominator) {
+    const std::int64_t quotient = numerator / denominator;
+    const std::int64_t remainder = numerator - quotient * denominator;
+    const std::int64_t sign = (numerator >> 63) | 1;
+    const std::int64_t twiceRemainder = 2 * (remainder < 0 ? -remainder : remainder);
+
+    std::int64_t adjust = 0;
+    if constexpr (Mode == RoundingMode::HalfEven) {
+        adjust = sign * static_cast<std::int64_t>((twiceRemainder > denominator) |
+                                                  ((twiceRemainder == denominator) & (quotient & 1)));
+    } else if constexpr (Mode == RoundingMode::HalfUp) {
+        adjust = sign * static_cast<std::int64_t>(twiceRemainder >= denominator);
+    } else if constexpr (Mode == RoundingMode::Floor) {
+        adjust = -static_cast<std::int64_t>(remainder < 0);
+    } else if constexpr (Mode == RoundingMode::Ceiling) {
+        adjust = static_cast<std::int64_t>(remainder > 0);
+    }
+    return quotient + adjust;
+}
+
+// ============================================================================
+// CLASS DEFINITION: Money
+// ============================================================================
+/**
+ * An amount of money held as an integer count of minor units (cents)
+ */
+class Money {
+private:
+    std::int64_t minorUnits;   // Amount in cents
+
+    constexpr explicit Money(std::int64_t units) : minorUnits(units) {}
+
+public:
+    static constexpr std::int64_t kMinorPerMajor = 100;   // Cents per dollar
+
+    /**
+     * Creates a zero amount
+     */
+    constexpr Money() : minorUnits(0) {}
+
+    /**
+     * @param units Amount in cents
+     * @return The amount
+     */
+    static constexpr Money fromMinorUnits(std::int64_t units) {
+        return Money(units);
+    }
+
+    /**
+     * @param units Amount in whole dollars
+     * @return The amount
+     */
+    static constexpr Money fromMajorUnits(std::int64_t units) {
+        return Money(units * kMinorPerMajor);
+    }
+
+    /**
+     * Converts a floating-point dollar amount, rounding half away from zero
+     * Intended for literals and user input, not for arithmetic.
+     *
+     * @param amount Amount in dollars
+     * @return The nearest whole number of cents
+     */
+    static constexpr Money fromDouble(double amount) {
+        double scaled = amount * kMinorPerMajor;
+        return Money(static_cast<std::int64_t>(scaled < 0 ? scaled - 0.5 : scaled + 0.5));
+    }
+
+    /**
+     * @return Amount in cents
+     */
+    constexpr std::int64_t getMinorUnits() const {
+        return minorUnits;
+    }
+
+    /**
+     * @return Amount in dollars as a double (for display or export only)
+     */
+    constexpr double toDouble() const {
+        return static_cast<double>(minorUnits) / kMinorPerMajor;
+    }
+
+    constexpr bool isPositive() const { return minorUnits > 0; }
+    constexpr bool isNegative() const { return minorUnits < 0; }
+    constexpr bool isZero() const { return minorUnits == 0; }
+
+    constexpr Money operator-() const { return Money(-minorUnits); }
+    constexpr Money operator+(Money other) const { return Money(minorUnits + other.minorUnits); }
+    constexpr Money operator-(Money other) const { return Money(minorUnits - other.minorUnits); }
+    constexpr Money operator*(std::int64_t factor) const { return Money(minorUnits * factor); }
+
+    constexpr Money &operator+=(Money other) {
+        minorUnits += other.minorUnits;
+        return *this;
+    }
+
+    constexpr Money &operator-=(Money other) {
+        minorUnits -= other.minorUnits;
+        return *this;
+    }
+
+    constexpr auto operator<=>(const Money &) const = default;
+};
+
+/**
+ * Prints the amount as dollars with exactly two decimals (e.g. "-12.05")
+ * The output does not depend on the stream's fixed/precision settings.
+ */
+inline std::ostream &operator<<(std::ostream &out, Money amount) {
+    std::int64_t units = amount.getMinorUnits();
+    std::uint64_t magnitude = units < 0 ? 0 - static_cast<std::uint64_t>(units)
+                                        : static_cast<std::uint64_t>(units);
+    std::uint64_t cents = magnitude % Money::kMinorPerMajor;
+
+    if (units < 0) {
+        out << '-';
+    }
+    out << magnitude / Money::kMinorPerMajor << '.'
+        << static_cast<char>('0' + cents / 10) << static_cast<char>('0' + cents % 10);
+    return out;
+}
+
+// ============================================================================
+// CLASS DEFINITION: InterestRate
+// ============================================================================
+/**
+ * A percentage rate held as an integer count of basis points (0.01%)
+ */
+class InterestRate {
+private:
+    std::int32_t basisPoints;   // Rate in hundredths of a percent
+
+    constexpr explicit InterestRate(std::int32_t points) : basisPoints(points) {}
+
+public:
+    static constexpr std::int32_t kBasisPointsPerPercent = 100;
+    static constexpr std::int32_t kBasisPointsPerUnit = 100 * kBasisPointsPerPercent;
+
+    /**
+     * Creates a 0% rate
+     */
+    constexpr InterestRate() : basisPoints(0) {}
+
+    /**
+     * @param points Rate in basis points (350 = 3.50%)
+     * @return The rate
+     */
+    static constexpr InterestRate fromBasisPoints(std::int32_t points) {
+        return InterestRate(points);
+    }
+
+    /**
+     * Converts a percentage, rounding to the nearest basis point
+     *
+     * @param percent Rate in percent (3.5 = 3.50%)
+     * @return The rate
+     */
+    static constexpr InterestRate fromPercent(double percent) {
+        double scaled = percent * kBasisPointsPerPercent;
+        return InterestRate(static_cast<std::int32_t>(scaled < 0 ? scaled - 0.5 : scaled + 0.5));
+    }
+
+    /**
+     * @return Rate in basis points
+     */
+    constexpr std::int32_t getBasisPoints() const {
+        return basisPoints;
+    }
+
+    /**
+     * @return Rate in percent as a double (for display or export only)
+     */
+    constexpr double toPercent() const {
+        return static_cast<double>(basisPoints) / kBasisPointsPerPercent;
+    }
+
+    constexpr auto operator<=>(const InterestRate &) const = default;
+};
+
+/**
+ * Prints the rate in percent with exactly two decimals (e.g. "3.50")
+ */
+inline std::ostream &operator<<(std::ostream &out, InterestRate rate) {
+    std::int32_t points = rate.getBasisPoints();
+    std::uint32_t magnitude = points < 0 ? 0u - static_cast<std::uint32_t>(points)
+                                         : static_cast<std::uint32_t>(points);
+    std::uint32_t fraction = magnitude % InterestRate::kBasisPointsPerPercent;
+
+    if (points < 0) {
+        out << '-';
+    }
+    out << magnitude / InterestRate::kBasisPointsPerPercent << '.'
+        << static_cast<char>('0' + fraction / 10) << static_cast<char>('0' + fraction % 10);
+    return out;
+}
+
+/**
+ * Computes amount * rate, rounded to whole cents
+ *
+ * @param amount The principal
+ * @param rate The rate to apply
+ * @param mode How to round the fractional cent
+ * @return The interest for one period
+ */
+constexpr Money computeInterest(Money amount, InterestRate rate,
+                                RoundingMode mode = RoundingMode::HalfEven) {
+    WideInt product = static_cast<WideInt>(amount.getMinorUnits()) * rate.getBasisPoints();
+    return Money::fromMinorUnits(divideRounded(product, InterestRate::kBasisPointsPerUnit, mode));
+}
+
+// ============================================================================
+// LITERALS
+// ============================================================================
+/**
+ * 5000_usd, 12.34_usd and 3.5_pct, for readable constants in code
+ */
+namespace money_literals {
+
+constexpr Money operator""_usd(unsigned long long dollars) {
+    return Money::fromMajorUnits(static_cast<std::int64_t>(dollars));
+}
+
+constexpr Money operator""_usd(long double dollars) {
+    return Money::fromDouble(static_cast<double>(dollars));
+}
+
+constexpr InterestRate operator""_pct(unsigned long long percent) {
+    return InterestRate::fromBasisPoints(
+        static_cast<std::int32_t>(percent) * InterestRate::kBasisPointsPerPercent);
+}
+
+constexpr InterestRate operator""_pct(long double percent) {
+    return InterestRate::fromPercent(static_cast<double>(percent));
+}
+
+} // namespace money_literals
+
+// Compile-time checks of the rounding rules
+static_assert(divideRounded(25, 10, RoundingMode::HalfEven) == 2);
+static_assert(divideRounded(35, 10, RoundingMode::HalfEven) == 4);
+static_assert(divideRounded(-25, 10, RoundingMode::HalfUp) == -3);
+static_assert(divideRounded(-21, 10, RoundingMode::Floor) == -3);
+static_assert(divideRounded(21, 10, RoundingMode::Ceiling) == 3);
+static_assert(computeInterest(Money::fromMajorUnits(4000), InterestRate::fromPercent(4.5))
+              == Money::fromMajorUnits(180));
+static_assert(divideRoundedNarrow<RoundingMode::HalfEven>(-25, 10) == -2);
+static_assert(divideRoundedNarrow<RoundingMode::HalfEven>(-35, 10) == -4);
+static_assert(divideRoundedNarrow<RoundingMode::HalfUp>(25, 10) == 3);
+static_assert(divideRoundedNarrow<RoundingMode::Floor>(-21, 10) == -3);
+static_assert(divideRoundedNarrow<RoundingMode::Ceiling>(-21, 10) == -2);
+static_assert(divideRoundedNarrow<RoundingMode::TowardZero>(-29, 10) == -2);
+
+#endif // MONEY_HPP
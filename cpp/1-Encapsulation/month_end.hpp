@@ -0,0 +1,106 @@
+#ifndef MONTH_END_HPP
+#define MONTH_END_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "account_store.hpp"
+#include "interest_engine.hpp"
+#include "money.hpp"
+#include "transaction.hpp"
+#include "work_stealing.hpp"
+
+/**
+ * ============================================================================
+ * MONTH-END RUN: interest, validation and statements over a whole store
+ * ============================================================================
+ *
+ * runMonthEnd cuts the store into chunks of consecutive slots and hands
+ * them to a WorkStealingScheduler. Every chunk:
+ * 1. accrues one period of interest (InterestEngine::applyRange)
+ * 2. validates every account: balance not negative, rate within the
+ *    allowed range, holder name not empty
+ * 3. calls the statement callback, if one is given, for every account
+ *
+ * Statements dominate the cost and vary a lot per account, which is why
+ * the chunks are scheduled with stealing instead of split evenly.
+ *
+ * Nothing else may write to the store while the run is in progress. The
+ * statement callback is called from all workers at once; it may read any
+ * account but must not modify the store. With a RecordSink attached, the
+ * sink must be thread-safe (JournalWriter is).
+ * ============================================================================
+ */
+
+/**
+ * Configuration for runMonthEnd
+ */
+struct MonthEndOptions {
+    std::size_t chunkAccounts = 4096;                          // Slots per scheduled chunk
+    RoundingMode rounding = RoundingMode::HalfEven;            // Interest rounding
+    std::function<void(AccountRef account, std::size_t worker)> statement;   // Optional, per account
+};
+
+/**
+ * Outcome of runMonthEnd
+ */
+struct MonthEndReport {
+    InterestTotals interest;          // Interest credited over the store
+    std::size_t invalidAccounts = 0;  // Accounts that failed validation
+    std::size_t statements = 0;       // Statement callbacks made
+    SchedulerStats schedule;          // Per-worker utilization and steals
+};
+
+/**
+ * Runs the month-end job over every account of a store
+ *
+ * @param scheduler Workers to run on
+ * @param store The accounts
+ * @param options Chunk size, rounding and statement callback
+ * @return Totals and scheduling statistics
+ */
+inline MonthEndReport runMonthEnd(WorkStealingScheduler &scheduler, AccountStore &store,
+                                  const MonthEndOptions &options = {}) {
+    // Per-worker totals, padded so workers never share a cache line
+    struct alignas(64) Partial {
+        InterestTotals interest;
+        std::size_t invalid = 0;
+        std::size_t statements = 0;
+    };
+    std::vector<Partial> partials(scheduler.getWorkerCount());
+    const InterestEngine engine(options.rounding);
+
+    MonthEndReport report;
+    report.schedule = scheduler.parallelFor(
+        0, store.size(), options.chunkAccounts, [&](std::size_t begin, std::size_t end, std::size_t worker) {
+            Partial &partial = partials[worker];
+            InterestTotals accrued = engine.applyRange(store, begin, end);
+            partial.interest.interest += accrued.interest;
+            partial.interest.accountsCredited += accrued.accountsCredited;
+
+            for (std::size_t slot = begin; slot < end; ++slot) {
+                AccountRef account = store.at(static_cast<AccountSlot>(slot));
+                bool valid = !account.getBalance().isNegative() &&
+                             account_rules::isValidRate(account.getInterestRate()) &&
+                             !account.getAccountHolder().empty();
+                partial.invalid += !valid;
+                if (options.statement) {
+                    options.statement(account, worker);
+                    ++partial.statements;
+                }
+            }
+        });
+
+    for (const Partial &partial : partials) {
+        report.interest.interest += partial.interest.interest;
+        report.interest.accountsCredited += partial.interest.accountsCredited;
+        report.invalidAccounts += partial.invalid;
+        report.statements += partial.statements;
+    }
+    return report;
+}
+
+#endif // MONTH_END_HPP
@@ -0,0 +1,518 @@
+#ifndef OPERATION_METRICS_HPP
+#define OPERATION_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "transaction.hpp"
+
+#if defined(BANK_ENABLE_METRICS)
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#endif
+
+/**
+ * ============================================================================
+ * OPERATION METRICS: outcome counters and latency histograms
+ * ============================================================================
+ *
+ * Every public mutator of BankAccount, AccountRef and ConcurrentAccount
+ * counts its calls by outcome (so InvalidAmount and InsufficientFunds
+ * rejects are visible per operation) and records how long it took in a
+ * latency histogram. collect() merges every thread's numbers into a
+ * MetricsSnapshot, which can be queried (getCount, valueAtQuantile) or
+ * written out as Prometheus text for a /metrics endpoint.
+ *
+ * COMPILED OUT BY DEFAULT:
+ * Metrics are only recorded when BANK_ENABLE_METRICS is defined (for the
+ * whole program - every translation unit must agree). Without it,
+ * OperationTimer is an empty type whose calls do nothing, so the mutators
+ * compile to exactly the code they had before: no clock reads, no
+ * counters, no thread_local. collect() then returns an empty snapshot.
+ *
+ * COST WHEN ENABLED:
+ * - each thread records into its own ThreadMetrics block, so there is no
+ *   sharing and no atomic read-modify-write; every counter has a single
+ *   writer and is bumped with a relaxed load + store
+ * - the time is two steady_clock reads around the operation (observer
+ *   callbacks are not included); those dominate: a silent deposit goes
+ *   from ~2 ns to ~70 ns where a clock read costs ~30 ns
+ * - histograms are log-linear (HDR style): 16 linear sub-buckets per power
+ *   of two, so any recorded value is within 6.25% of its bucket, from 1 ns
+ *   up to ~68 s, in a fixed 4.3 KiB per operation
+ * Blocks of threads that exit are folded into a retired total, so nothing
+ * is lost when worker threads come and go.
+ *
+ * The batch paths (BatchPoster, TransferBatch, InterestEngine) are not
+ * timed per element; they already return per-batch reports.
+ * ============================================================================
+ */
+
+namespace metrics {
+
+#if defined(BANK_ENABLE_METRICS)
+inline constexpr bool kEnabled = true;
+#else
+inline constexpr bool kEnabled = false;
+#endif
+
+/**
+ * The instrumented operations
+ */
+enum class Operation : std::uint8_t {
+    Deposit,
+    Withdraw,
+    Transfer,
+    ApplyInterest,
+    SetInterestRate,
+    SetAccountHolder
+};
+
+inline constexpr std::size_t kOperationCount = 6;
+inline constexpr std::size_t kStatusCount = 8;   // Values of TransactionStatus
+
+/**
+ * @return The Prometheus label value for an operation
+ */
+constexpr std::string_view toString(Operation op) {
+    constexpr std::string_view kNames[kOperationCount] = {
+        "deposit", "withdraw", "transfer", "apply_interest", "set_interest_rate", "set_account_holder"};
+    return kNames[static_cast<std::size_t>(op)];
+}
+
+/**
+ * @return The Prometheus label value for an outcome
+ */
+constexpr std::string_view toString(TransactionStatus status) {
+    constexpr std::string_view kNames[kStatusCount] = {
+        "success", "invalid_amount", "insufficient_funds", "invalid_rate",
+        "invalid_holder_name", "batch_aborted", "account_frozen", "account_not_found"};
+    return kNames[static_cast<std::size_t>(status)];
+}
+
+/**
+ * @return true if the operation can end with this status (always exported)
+ */
+constexpr bool canReport(Operation op, TransactionStatus status) {
+    switch (op) {
+    case Operation::Deposit:
+        return status == TransactionStatus::Success || status == TransactionStatus::InvalidAmount ||
+               status == TransactionStatus::AccountFrozen;
+    case Operation::Withdraw:
+    case Operation::Transfer:
+        return status == TransactionStatus::Success || status == TransactionStatus::InvalidAmount ||
+               status == TransactionStatus::InsufficientFunds || status == TransactionStatus::AccountFrozen;
+    case Operation::ApplyInterest:
+        return status == TransactionStatus::Success;
+    case Operation::SetInterestRate:
+        return status == TransactionStatus::Success || status == TransactionStatus::InvalidRate;
+    case Operation::SetAccountHolder:
+        return status == TransactionStatus::Success || status == TransactionStatus::InvalidHolderName;
+    }
+    return false;
+}
+
+// ============================================================================
+// HISTOGRAM BUCKETING (log-linear, HDR style)
+// ============================================================================
+namespace histogram_layout {
+
+inline constexpr unsigned kSubBucketBits = 4;
+inline constexpr std::uint64_t kSubBuckets = 1u << kSubBucketBits;   // Per power of two
+inline constexpr unsigned kMaxExponent = 35;                          // Top range [2^35, 2^36) ns
+inline constexpr std::size_t kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+/**
+ * @param nanos A recorded value (values past the top range go in the last bucket)
+ * @return Its bucket: values below 16 have one bucket each, then every power
+ *         of two is split into 16 equal sub-buckets
+ */
+constexpr std::size_t bucketIndex(std::uint64_t nanos) {
+    if (nanos < kSubBuckets) {
+        return static_cast<std::size_t>(nanos);
+    }
+    unsigned exponent = static_cast<unsigned>(std::bit_width(nanos)) - 1;
+    if (exponent > kMaxExponent) {
+        return kBucketCount - 1;
+    }
+    std::uint64_t sub = (nanos >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return static_cast<std::size_t>((exponent - kSubBucketBits + 1) * kSubBuckets + sub);
+}
+
+/**
+ * @return The smallest value that falls in bucket index
+ */
+constexpr std::uint64_t bucketLowerBound(std::size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    std::uint64_t group = index / kSubBuckets;   // 1 = [16, 32), 2 = [32, 64), ...
+    std::uint64_t sub = index % kSubBuckets;
+    return (kSubBuckets + sub) << (group - 1);
+}
+
+/**
+ * @return One past the largest value that falls in bucket index
+ */
+constexpr std::uint64_t bucketUpperBound(std::size_t index) {
+    return bucketLowerBound(index + 1);
+}
+
+static_assert(bucketIndex(15) == 15 && bucketIndex(16) == 16 && bucketIndex(31) == 31 && bucketIndex(32) == 32);
+static_assert(bucketLowerBound(bucketIndex(1'000'000)) <= 1'000'000 && bucketUpperBound(bucketIndex(1'000'000)) > 1'000'000);
+static_assert(bucketIndex((std::uint64_t(1) << (kMaxExponent + 1)) - 1) == kBucketCount - 1);
+
+} // namespace histogram_layout
+
+// ============================================================================
+// CLASS DEFINITION: HistogramSnapshot
+// ============================================================================
+/**
+ * Merged latency histogram of one operation (plain values, not shared)
+ */
+class HistogramSnapshot {
+private:
+    std::array<std::uint64_t, histogram_layout::kBucketCount> buckets{};
+    std::uint64_t count = 0;       // Values recorded
+    std::uint64_t sumNanos = 0;    // Their total
+
+public:
+    void add(std::size_t bucket, std::uint64_t n) {
+        buckets[bucket] += n;
+        count += n;
+    }
+
+    void addSum(std::uint64_t nanos) { sumNanos += nanos; }
+
+    void merge(const HistogramSnapshot &other) {
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            buckets[i] += other.buckets[i];
+        }
+        count += other.count;
+        sumNanos += other.sumNanos;
+    }
+
+    std::uint64_t getCount() const { return count; }
+    std::uint64_t getSumNanos() const { return sumNanos; }
+    std::uint64_t getBucket(std::size_t bucket) const { return buckets[bucket]; }
+
+    /**
+     * @return Mean latency in nanoseconds (0 if nothing was recorded)
+     */
+    double getMeanNanos() const {
+        return count ? static_cast<double>(sumNanos) / static_cast<double>(count) : 0.0;
+    }
+
+    /**
+     * @param quantile In [0, 1], e.g. 0.99 for p99
+     * @return Upper edge of the bucket holding that rank, in nanoseconds
+     *         (within 6.25% above the true value; 0 if nothing was recorded)
+     */
+    std::uint64_t valueAtQuantile(double quantile) const {
+        if (count == 0) {
+            return 0;
+        }
+        quantile = quantile < 0.0 ? 0.0 : quantile > 1.0 ? 1.0 : quantile;
+        std::uint64_t rank = static_cast<std::uint64_t>(quantile * static_cast<double>(count - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                return histogram_layout::bucketUpperBound(i) - 1;
+            }
+        }
+        return histogram_layout::bucketUpperBound(buckets.size() - 1) - 1;
+    }
+};
+
+// ============================================================================
+// CLASS DEFINITION: MetricsSnapshot
+// ============================================================================
+/**
+ * Every counter and histogram at one moment, summed over all threads
+ */
+class MetricsSnapshot {
+private:
+    std::array<std::array<std::uint64_t, kStatusCount>, kOperationCount> counts{};
+    std::array<HistogramSnapshot, kOperationCount> latencies;
+
+    static void writeSeconds(std::ostream &out, std::uint64_t nanos) {
+        char text[32];
+        auto written = std::to_chars(text, text + sizeof(text), static_cast<double>(nanos) * 1e-9);
+        out.write(text, written.ptr - text);
+    }
+
+public:
+    // Histogram boundaries exported to Prometheus: 16 ns, 64 ns, ... ~17 s
+    static constexpr unsigned kFirstExportBits = 4;
+    static constexpr unsigned kLastExportBits = 34;
+
+    void addCount(Operation op, TransactionStatus status, std::uint64_t n) {
+        counts[static_cast<std::size_t>(op)][static_cast<std::size_t>(status)] += n;
+    }
+
+    HistogramSnapshot &latency(Operation op) { return latencies[static_cast<std::size_t>(op)]; }
+
+    void merge(const MetricsSnapshot &other) {
+        for (std::size_t op = 0; op < kOperationCount; ++op) {
+            for (std::size_t status = 0; status < kStatusCount; ++status) {
+                counts[op][status] += other.counts[op][status];
+            }
+            latencies[op].merge(other.latencies[op]);
+        }
+    }
+
+    /**
+     * @return Calls of op that ended with status
+     */
+    std::uint64_t getCount(Operation op, TransactionStatus status) const {
+        return counts[static_cast<std::size_t>(op)][static_cast<std::size_t>(status)];
+    }
+
+    /**
+     * @return All calls of op, whatever their outcome
+     */
+    std::uint64_t getCount(Operation op) const {
+        std::uint64_t total = 0;
+        for (std::uint64_t n : counts[static_cast<std::size_t>(op)]) {
+            total += n;
+        }
+        return total;
+    }
+
+    const HistogramSnapshot &getLatency(Operation op) const { return latencies[static_cast<std::size_t>(op)]; }
+
+    /**
+     * Writes the snapshot in the Prometheus text exposition format
+     * - bank_account_operations_total{operation,status}: counter
+     * - bank_account_operation_duration_seconds{operation}: histogram
+     *
+     * @param out Destination stream
+     */
+    void writePrometheus(std::ostream &out) const {
+        out << "# HELP bank_account_operations_total Account operations by outcome.\n"
+               "# TYPE bank_account_operations_total counter\n";
+        for (std::size_t op = 0; op < kOperationCount; ++op) {
+            for (std::size_t status = 0; status < kStatusCount; ++status) {
+                auto operation = static_cast<Operation>(op);
+                auto outcome = static_cast<TransactionStatus>(status);
+                if (canReport(operation, outcome) || counts[op][status]) {
+                    out << "bank_account_operations_total{operation=\"" << toString(operation)
+                        << "\",status=\"" << toString(outcome) << "\"} " << counts[op][status] << '\n';
+                }
+            }
+        }
+
+        out << "# HELP bank_account_operation_duration_seconds Time spent in account operations.\n"
+               "# TYPE bank_account_operation_duration_seconds histogram\n";
+        for (std::size_t op = 0; op < kOperationCount; ++op) {
+            const HistogramSnapshot &histogram = latencies[op];
+            std::string_view name = toString(static_cast<Operation>(op));
+            std::size_t bucket = 0;
+            std::uint64_t cumulative = 0;
+            for (unsigned bits = kFirstExportBits; bits <= kLastExportBits; bits += 2) {
+                const std::uint64_t bound = std::uint64_t(1) << bits;
+                while (bucket < histogram_layout::kBucketCount &&
+                       histogram_layout::bucketUpperBound(bucket) <= bound) {
+                    cumulative += histogram.getBucket(bucket++);
+                }
+                out << "bank_account_operation_duration_seconds_bucket{operation=\"" << name << "\",le=\"";
+                writeSeconds(out, bound);
+                out << "\"} " << cumulative << '\n';
+            }
+            out << "bank_account_operation_duration_seconds_bucket{operation=\"" << name << "\",le=\"+Inf\"} "
+                << histogram.getCount() << '\n';
+            out << "bank_account_operation_duration_seconds_sum{operation=\"" << name << "\"} ";
+            writeSeconds(out, histogram.getSumNanos());
+            out << "\nbank_account_operation_duration_seconds_count{operation=\"" << name << "\"} "
+                << histogram.getCount() << '\n';
+        }
+    }
+};
+
+#if defined(BANK_ENABLE_METRICS)
+// ============================================================================
+// PER-THREAD RECORDING (BANK_ENABLE_METRICS only)
+// ============================================================================
+/**
+ * One thread's counters and histograms
+ * Each field has a single writer (the owning thread); collect() reads them
+ * concurrently, so they are atomics used with relaxed ordering only.
+ */
+class ThreadMetrics {
+private:
+    struct Histogram {
+        std::array<std::atomic<std::uint64_t>, histogram_layout::kBucketCount> buckets{};
+        std::atomic<std::uint64_t> sumNanos{0};
+    };
+
+    std::array<std::array<std::atomic<std::uint64_t>, kStatusCount>, kOperationCount> counts{};
+    std::array<Histogram, kOperationCount> latencies;
+
+    static void bump(std::atomic<std::uint64_t> &counter, std::uint64_t n = 1) {
+        // Single writer: a plain load + store, no locked read-modify-write
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+public:
+    void record(Operation op, TransactionStatus status, std::uint64_t nanos) {
+        bump(counts[static_cast<std::size_t>(op)][static_cast<std::size_t>(status)]);
+        Histogram &histogram = latencies[static_cast<std::size_t>(op)];
+        bump(histogram.buckets[histogram_layout::bucketIndex(nanos)]);
+        bump(histogram.sumNanos, nanos);
+    }
+
+    /**
+     * Adds this thread's numbers to a snapshot (safe while the thread records)
+     */
+    void addTo(MetricsSnapshot &snapshot) const {
+        for (std::size_t op = 0; op < kOperationCount; ++op) {
+            auto operation = static_cast<Operation>(op);
+            for (std::size_t status = 0; status < kStatusCount; ++status) {
+                snapshot.addCount(operation, static_cast<TransactionStatus>(status),
+                                  counts[op][status].load(std::memory_order_relaxed));
+            }
+            HistogramSnapshot &histogram = snapshot.latency(operation);
+            for (std::size_t bucket = 0; bucket < histogram_layout::kBucketCount; ++bucket) {
+                if (std::uint64_t n = latencies[op].buckets[bucket].load(std::memory_order_relaxed)) {
+                    histogram.add(bucket, n);
+                }
+            }
+            histogram.addSum(latencies[op].sumNanos.load(std::memory_order_relaxed));
+        }
+    }
+};
+
+/**
+ * Every live thread's block, plus the totals of threads that have exited
+ */
+class MetricsRegistry {
+private:
+    std::mutex mutex;
+    std::vector<const ThreadMetrics *> live;
+    MetricsSnapshot retired;
+
+public:
+    static MetricsRegistry &instance() {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    void attach(const ThreadMetrics *block) {
+        std::lock_guard<std::mutex> lock(mutex);
+        live.push_back(block);
+    }
+
+    /**
+     * Folds an exiting thread's numbers into the retired totals
+     */
+    void detach(const ThreadMetrics *block) {
+        std::lock_guard<std::mutex> lock(mutex);
+        block->addTo(retired);
+        live.erase(std::find(live.begin(), live.end(), block));
+    }
+
+    MetricsSnapshot collect() {
+        std::lock_guard<std::mutex> lock(mutex);
+        MetricsSnapshot snapshot = retired;
+        for (const ThreadMetrics *block : live) {
+            block->addTo(snapshot);
+        }
+        return snapshot;
+    }
+};
+
+/**
+ * @return The calling thread's block, registered on first use
+ */
+inline ThreadMetrics &threadMetrics() {
+    struct Owner {
+        std::unique_ptr<ThreadMetrics> block = std::make_unique<ThreadMetrics>();
+        Owner() { MetricsRegistry::instance().attach(block.get()); }
+        ~Owner() { MetricsRegistry::instance().detach(block.get()); }
+    };
+    thread_local Owner owner;
+    return *owner.block;
+}
+
+/**
+ * Times one operation and records it with its outcome
+ *
+ * Construct at the start of the mutator and pass its result (or status)
+ * through finish() on the way out:
+ *     metrics::OperationTimer timer(metrics::Operation::Deposit);
+ *     ...
+ *     return timer.finish(TransactionResult{...});
+ */
+class OperationTimer {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Operation op;
+    Clock::time_point start;
+
+public:
+    explicit OperationTimer(Operation operation) : op(operation), start(Clock::now()) {}
+
+    TransactionStatus finish(TransactionStatus status) const {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        threadMetrics().record(op, status, static_cast<std::uint64_t>(elapsed));
+        return status;
+    }
+
+    TransactionResult finish(const TransactionResult &result) const {
+        finish(result.status);
+        return result;
+    }
+};
+
+/**
+ * @return Every thread's counters and histograms, merged
+ */
+inline MetricsSnapshot collect() {
+    return MetricsRegistry::instance().collect();
+}
+
+#else
+// ============================================================================
+// DISABLED: no clock, no counters, nothing registered
+// ============================================================================
+class OperationTimer {
+public:
+    explicit constexpr OperationTimer(Operation) {}
+    constexpr TransactionStatus finish(TransactionStatus status) const { return status; }
+    constexpr TransactionResult finish(const TransactionResult &result) const { return result; }
+};
+
+inline MetricsSnapshot collect() {
+    return MetricsSnapshot();
+}
+#endif
+
+/**
+ * @return The current metrics in Prometheus text format (a /metrics body)
+ */
+inline std::string prometheusText() {
+#if defined(BANK_ENABLE_METRICS)
+    std::ostringstream out;
+    collect().writePrometheus(out);
+    return out.str();
+#else
+    return std::string();
+#endif
+}
+
+} // namespace metrics
+
+#endif // OPERATION_METRICS_HPP
@@ -0,0 +1,910 @@
+#ifndef REPLICATION_HPP
+#define REPLICATION_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "account_store.hpp"
+#include "batch_posting.hpp"
+#include "journal.hpp"
+#include "journal_record.hpp"
+#include "statement_renderer.hpp"
+#include "store_versions.hpp"
+
+/**
+ * ============================================================================
+ * REPLICATION: shipping the mutation stream to read-only followers
+ * ============================================================================
+ *
+ * The primary executes deposit/withdraw/transfer; followers hold a copy of
+ * its accounts and answer balance and account-info queries, so read load
+ * (and a warm standby for failover) comes off the primary.
+ *
+ * PRIMARY: ReplicationLog is a RecordSink. Attach it to the primary's
+ * AccountStore (setRecordSink) and it receives exactly the records a
+ * journal would. It can forward every record to a JournalWriter first and
+ * reuse the journal's sequence numbers, so "applied up to sequence N"
+ * means the same thing on disk and on every follower. Records are cut into
+ * BATCHES of up to maxBatchRecords, or when the oldest pending record is
+ * maxDelay old when a follower fetches, or on flush(). The newest
+ * retainedBatches batches are kept for followers to fetch.
+ *
+ * SEQUENCES: a batch holds consecutive sequences. When the journal's
+ * numbering skips (a journal shared with another store numbers that
+ * store's records too), the log cuts the batch and the next one names the
+ * last sequence before it (previousSequence), so a follower can tell a
+ * skip the log announced from records it really missed.
+ *
+ * ENCODING: a batch stores its first sequence once; every record after it
+ * has the next one. The packed account number is a zigzag varint delta
+ * from the previous record's (postings from one batch of accounts give
+ * one or two bytes), amounts and balances are zigzag varints, and a
+ * holder name chunk keeps only its used bytes. A typical posting takes
+ * 8-12 bytes instead of the 48 of a JournalRecord. Fields a kind of
+ * record does not use must be zero, as the journal::make* builders leave
+ * them. writeFrame/readFrame put a batch on the wire as a 40-byte header
+ * plus payload, with an FNV-1a checksum over the payload.
+ *
+ * FOLLOWER: ReplicationFollower owns an AccountStore and applies batches
+ * in sequence order. Runs of Deposit, Withdraw and Interest records become
+ * one BatchPoster call (the SIMD posting path); Open, Transfer, RateChange,
+ * HolderName and StatusChange records are re-applied as journal replay
+ * does. Every balance the records left behind is checked, and differences
+ * are counted as mismatches. publish() makes what was applied visible to
+ * readers as a StoreVersions version, so queries on any number of threads
+ * never wait for the applying thread.
+ *
+ * LAG: ReplicationLog::lagOf(sequence) reports how many records a
+ * follower that has published `sequence` is behind, and how long ago the
+ * oldest record it is missing was appended.
+ *
+ * A follower starts from an empty store and must see the stream from the
+ * primary's first record; one that falls behind the retained batches
+ * (fetch returns Evicted) has to be rebuilt.
+ * ============================================================================
+ */
+
+/**
+ * How a ReplicationLog cuts and keeps batches
+ */
+struct ReplicationPolicy {
+    std::size_t maxBatchRecords = 256;                  // Cut a batch at this many records
+    std::chrono::microseconds maxDelay{1000};           // ... or when fetch finds one this old
+    std::size_t retainedBatches = 4096;                 // Batches kept for followers
+};
+
+/**
+ * A run of consecutive records, encoded
+ */
+struct ReplicationBatch {
+    std::uint64_t firstSequence = 0;    // Sequence of the first record
+    std::uint64_t previousSequence = 0; // Last sequence in the stream before this batch (0 = none)
+    std::uint32_t recordCount = 0;      // Records in the payload
+    std::uint32_t checksum = 0;         // FNV-1a over the payload
+    std::int64_t createdNanos = 0;      // When the first record was appended (system clock)
+    std::vector<std::uint8_t> payload;  // Encoded records
+
+    /**
+     * @return Sequence of the last record in the batch
+     */
+    std::uint64_t lastSequence() const {
+        return firstSequence + recordCount - 1;
+    }
+};
+
+/**
+ * How far behind the primary a follower is
+ */
+struct ReplicationLag {
+    std::uint64_t records = 0;          // Sequences appended but not yet published
+    std::chrono::nanoseconds age{0};    // Time since the oldest of them was appended
+};
+
+/**
+ * Outcome of ReplicationLog::fetch
+ */
+enum class FetchStatus {
+    Ok,         // Every batch after the sequence was returned (possibly none)
+    Evicted     // Records right after the sequence are no longer retained
+};
+
+/**
+ * Outcome of readFrame
+ */
+enum class FrameStatus {
+    Ok,
+    Incomplete,   // The bytes end before the frame does
+    Corrupt       // Bad magic, or the payload fails its checksum
+};
+
+/**
+ * Outcome of ReplicationFollower::apply
+ */
+enum class ReplicationApplyStatus {
+    Applied,      // Every new record of the batch was applied
+    Duplicate,    // Every record of the batch was already applied
+    Gap,          // Records between the applied sequence and the batch are missing
+    Corrupt       // The payload fails its checksum or does not decode
+};
+
+/**
+ * Outcome of ReplicationFollower::catchUp
+ */
+enum class CatchUpStatus {
+    Ok,           // Everything the log had was applied
+    Evicted,      // Records the follower needs are no longer retained
+    Gap,          // A batch did not follow on from the applied sequence
+    Corrupt       // A batch failed its checksum or did not decode
+};
+
+namespace replication {
+
+// First bytes of every frame
+constexpr char kFrameMagic[4] = {'B', 'R', 'P', '2'};
+
+/**
+ * Fixed-size frame header in front of every payload on the wire
+ */
+struct FrameHeader {
+    char magic[4];
+    std::uint32_t recordCount;
+    std::uint64_t firstSequence;
+    std::uint64_t previousSequence;
+    std::int64_t createdNanos;
+    std::uint32_t payloadBytes;
+    std::uint32_t checksum;
+};
+
+static_assert(sizeof(FrameHeader) == 40, "FrameHeader is a wire format");
+
+/**
+ * @return FNV-1a checksum of an encoded payload
+ */
+inline std::uint32_t payloadChecksum(std::span<const std::uint8_t> bytes) {
+    std::uint32_t hash = 2166136261u;
+    for (std::uint8_t byte : bytes) {
+        hash = (hash ^ byte) * 16777619u;
+    }
+    return hash;
+}
+
+inline std::uint64_t zigzag(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t unzigzag(std::uint64_t value) {
+    return static_cast<std::int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+inline void putVarint(std::vector<std::uint8_t> &out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+/**
+ * Reads one varint, advancing cursor
+ * @return false if the bytes end first or it is longer than 10 bytes
+ */
+inline bool getVarint(const std::uint8_t *&cursor, const std::uint8_t *end, std::uint64_t &value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 70 && cursor != end; shift += 7) {
+        std::uint8_t byte = *cursor++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Appends one record to a payload
+ *
+ * @param out The payload
+ * @param record The record (its sequence is implied by its position)
+ * @param previousAccount Packed account of the previous record (updated)
+ */
+inline void encodeRecord(std::vector<std::uint8_t> &out, const JournalRecord &record,
+                         std::uint64_t &previousAccount) {
+    out.push_back(static_cast<std::uint8_t>(record.op));
+    putVarint(out, zigzag(static_cast<std::int64_t>(record.account - previousAccount)));
+    previousAccount = record.account;
+
+    if (record.op == JournalOp::HolderName) {
+        unsigned char text[journal::kNameChunkBytes];
+        std::memcpy(text, &record.amount, 8);
+        std::memcpy(text + 8, &record.balanceAfter, 8);
+        std::memcpy(text + 16, &record.counterparty, 8);
+        std::size_t length = journal::kNameChunkBytes;
+        while (length > 0 && text[length - 1] == 0) {
+            --length;
+        }
+        out.push_back(record.accountType);
+        putVarint(out, record.chunk);
+        out.push_back(static_cast<std::uint8_t>(length));
+        out.insert(out.end(), text, text + length);
+        return;
+    }
+
+    putVarint(out, zigzag(record.amount));
+    putVarint(out, zigzag(record.balanceAfter));
+    if (record.op == JournalOp::Open) {
+        out.push_back(record.accountType);
+        putVarint(out, record.counterparty);
+    } else if (record.op == JournalOp::Transfer) {
+        putVarint(out, zigzag(static_cast<std::int64_t>(record.counterparty - record.account)));
+    }
+}
+
+/**
+ * Decodes every record of a batch and numbers each with its sequence
+ * The checksum is left zero: a sink the records are handed to seals them.
+ *
+ * @param batch The batch
+ * @param records Receives the records (overwritten)
+ * @return false if the payload fails its checksum or does not decode
+ */
+inline bool decodeBatch(const ReplicationBatch &batch, std::vector<JournalRecord> &records) {
+    records.clear();
+    if (payloadChecksum(batch.payload) != batch.checksum) {
+        return false;
+    }
+    const std::uint8_t *cursor = batch.payload.data();
+    const std::uint8_t *end = cursor + batch.payload.size();
+    std::uint64_t previousAccount = 0;
+    records.reserve(batch.recordCount);
+
+    for (std::uint32_t i = 0; i < batch.recordCount; ++i) {
+        std::uint64_t delta = 0;
+        if (cursor == end || *cursor < static_cast<std::uint8_t>(JournalOp::Open) ||
+            *cursor > static_cast<std::uint8_t>(JournalOp::StatusChange)) {
+            return false;
+        }
+        JournalRecord record;
+        record.op = static_cast<JournalOp>(*cursor++);
+        if (!getVarint(cursor, end, delta)) {
+            return false;
+        }
+        record.account = previousAccount + static_cast<std::uint64_t>(unzigzag(delta));
+        previousAccount = record.account;
+
+        if (record.op == JournalOp::HolderName) {
+            std::uint64_t chunk = 0;
+            if (cursor == end) {
+                return false;
+            }
+            record.accountType = *cursor++;
+            if (!getVarint(cursor, end, chunk) || chunk > 0xFFFF || cursor == end) {
+                return false;
+            }
+            record.chunk = static_cast<std::uint16_t>(chunk);
+            std::size_t length = *cursor++;
+            if (length > journal::kNameChunkBytes || static_cast<std::size_t>(end - cursor) < length) {
+                return false;
+            }
+            unsigned char text[journal::kNameChunkBytes] = {};
+            std::memcpy(text, cursor, length);
+            cursor += length;
+            std::memcpy(&record.amount, text, 8);
+            std::memcpy(&record.balanceAfter, text + 8, 8);
+            std::memcpy(&record.counterparty, text + 16, 8);
+        } else {
+            std::uint64_t amount = 0;
+            std::uint64_t balance = 0;
+            if (!getVarint(cursor, end, amount) || !getVarint(cursor, end, balance)) {
+                return false;
+            }
+            record.amount = unzigzag(amount);
+            record.balanceAfter = unzigzag(balance);
+            if (record.op == JournalOp::Open) {
+                if (cursor == end) {
+                    return false;
+                }
+                record.accountType = *cursor++;
+                if (!getVarint(cursor, end, record.counterparty)) {
+                    return false;
+                }
+            } else if (record.op == JournalOp::Transfer) {
+                if (!getVarint(cursor, end, delta)) {
+                    return false;
+                }
+                record.counterparty = record.account + static_cast<std::uint64_t>(unzigzag(delta));
+            }
+        }
+        record.sequence = batch.firstSequence + i;
+        records.push_back(record);
+    }
+    return cursor == end;
+}
+
+/**
+ * Appends a batch to a byte stream as one frame (header + payload)
+ */
+inline void writeFrame(const ReplicationBatch &batch, std::vector<std::uint8_t> &out) {
+    FrameHeader header;
+    std::memcpy(header.magic, kFrameMagic, sizeof header.magic);
+    header.recordCount = batch.recordCount;
+    header.firstSequence = batch.firstSequence;
+    header.previousSequence = batch.previousSequence;
+    header.createdNanos = batch.createdNanos;
+    header.payloadBytes = static_cast<std::uint32_t>(batch.payload.size());
+    header.checksum = batch.checksum;
+
+    const std::uint8_t *bytes = reinterpret_cast<const std::uint8_t *>(&header);
+    out.insert(out.end(), bytes, bytes + sizeof header);
+    out.insert(out.end(), batch.payload.begin(), batch.payload.end());
+}
+
+/**
+ * Reads the frame at the start of a byte stream
+ *
+ * @param bytes Received bytes
+ * @param batch Receives the batch (Ok only)
+ * @param consumed Receives the frame's size in bytes (Ok only)
+ * @return Ok, Incomplete (wait for more bytes) or Corrupt
+ */
+inline FrameStatus readFrame(std::span<const std::uint8_t> bytes, ReplicationBatch &batch,
+                             std::size_t &consumed) {
+    FrameHeader header;
+    if (bytes.size() < sizeof header) {
+        return FrameStatus::Incomplete;
+    }
+    std::memcpy(&header, bytes.data(), sizeof header);
+    if (std::memcmp(header.magic, kFrameMagic, sizeof header.magic) != 0) {
+        return FrameStatus::Corrupt;
+    }
+    if (bytes.size() - sizeof header < header.payloadBytes) {
+        return FrameStatus::Incomplete;
+    }
+    std::span<const std::uint8_t> payload = bytes.subspan(sizeof header, header.payloadBytes);
+    if (payloadChecksum(payload) != header.checksum) {
+        return FrameStatus::Corrupt;
+    }
+    batch.firstSequence = header.firstSequence;
+    batch.previousSequence = header.previousSequence;
+    batch.recordCount = header.recordCount;
+    batch.checksum = header.checksum;
+    batch.createdNanos = header.createdNanos;
+    batch.payload.assign(payload.begin(), payload.end());
+    consumed = sizeof header + header.payloadBytes;
+    return FrameStatus::Ok;
+}
+
+/**
+ * @return Nanoseconds since the epoch on the system clock (comparable
+ *         across nodes, unlike steady_clock)
+ */
+inline std::int64_t wallClockNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace replication
+
+// ============================================================================
+// CLASS DEFINITION: ReplicationLog (primary side)
+// ============================================================================
+/**
+ * RecordSink that encodes records into batches for followers to fetch
+ * append, fetch and lagOf are thread-safe.
+ */
+class ReplicationLog : public RecordSink {
+private:
+    ReplicationPolicy policy;
+    RecordSink *next;                        // Journal that numbers the records (or nullptr)
+
+    mutable std::mutex mutex;
+    ReplicationBatch pending;                // Records not yet cut into a batch
+    std::uint64_t previousAccount = 0;       // Delta base of the pending payload
+    std::deque<std::shared_ptr<const ReplicationBatch>> retained;   // Oldest first
+    std::uint64_t lastSequence = 0;          // Sequence of the last record appended
+    std::uint64_t records = 0;               // Records appended (ever)
+    std::uint64_t payloadBytes = 0;          // Encoded bytes of every cut batch (ever)
+
+    /**
+     * Moves the pending records into a retained batch (mutex held)
+     */
+    void cutLocked() {
+        if (pending.recordCount == 0) {
+            return;
+        }
+        pending.checksum = replication::payloadChecksum(pending.payload);
+        payloadBytes += pending.payload.size();
+        retained.push_back(std::make_shared<const ReplicationBatch>(std::move(pending)));
+        while (retained.size() > policy.retainedBatches) {
+            retained.pop_front();
+        }
+        pending = ReplicationBatch();
+        previousAccount = 0;
+    }
+
+    /**
+     * @return The sequence a follower must have applied to use the oldest
+     *         batch still available (lastSequence if there is none)
+     */
+    std::uint64_t oldestPreviousLocked() const {
+        if (!retained.empty()) {
+            return retained.front()->previousSequence;
+        }
+        return pending.recordCount > 0 ? pending.previousSequence : lastSequence;
+    }
+
+public:
+    /**
+     * @param batching When batches are cut and how many are kept
+     * @param journal Optional sink that sees every record first; its
+     *                sequence numbers are used for the stream
+     */
+    explicit ReplicationLog(ReplicationPolicy batching = ReplicationPolicy(), RecordSink *journal = nullptr)
+        : policy(batching), next(journal) {
+        if (policy.maxBatchRecords == 0) {
+            policy.maxBatchRecords = 1;
+        }
+        if (policy.retainedBatches == 0) {
+            policy.retainedBatches = 1;
+        }
+    }
+
+    /**
+     * Numbers a record (or lets the journal number it) and adds it to the
+     * pending batch
+     *
+     * @param record The record
+     * @return Its sequence number
+     */
+    std::uint64_t append(const JournalRecord &record) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Forwarding under the lock keeps the stream in journal order
+        std::uint64_t sequence = next ? next->append(record) : lastSequence + 1;
+        if (pending.recordCount > 0 && sequence != lastSequence + 1) {
+            cutLocked();   // Batches hold consecutive sequences only
+        }
+        if (pending.recordCount == 0) {
+            pending.firstSequence = sequence;
+            pending.previousSequence = lastSequence;
+            pending.createdNanos = replication::wallClockNanos();
+        }
+        replication::encodeRecord(pending.payload, record, previousAccount);
+        ++pending.recordCount;
+        lastSequence = sequence;
+        ++records;
+        if (pending.recordCount >= policy.maxBatchRecords) {
+            cutLocked();
+        }
+        return sequence;
+    }
+
+    /**
+     * Cuts the pending records into a batch now
+     */
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex);
+        cutLocked();
+    }
+
+    /**
+     * Collects every retained batch holding records after a sequence
+     * Cuts the pending batch first if it is older than maxDelay.
+     *
+     * @param afterSequence Last sequence the caller has applied
+     * @param out Receives the batches, oldest first (appended to)
+     * @param maxBatches Stop after this many
+     * @return Ok, or Evicted if the caller can no longer catch up
+     */
+    FetchStatus fetch(std::uint64_t afterSequence, std::vector<std::shared_ptr<const ReplicationBatch>> &out,
+                      std::size_t maxBatches = 64) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.recordCount > 0 &&
+            replication::wallClockNanos() - pending.createdNanos >=
+                std::chrono::duration_cast<std::chrono::nanoseconds>(policy.maxDelay).count()) {
+            cutLocked();
+        }
+        if (afterSequence < lastSequence && afterSequence < oldestPreviousLocked()) {
+            return FetchStatus::Evicted;
+        }
+        auto first = std::partition_point(retained.begin(), retained.end(), [&](const auto &batch) {
+            return batch->lastSequence() <= afterSequence;
+        });
+        for (auto it = first; it != retained.end() && maxBatches > 0; ++it, --maxBatches) {
+            out.push_back(*it);
+        }
+        return FetchStatus::Ok;
+    }
+
+    /**
+     * @param publishedSequence Last sequence a follower has published
+     * @return How far that follower is behind this log
+     */
+    ReplicationLag lagOf(std::uint64_t publishedSequence) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        ReplicationLag lag;
+        if (publishedSequence >= lastSequence) {
+            return lag;
+        }
+        lag.records = lastSequence - publishedSequence;
+
+        // The batch holding the first missing record tells when it was appended
+        std::int64_t appended = pending.createdNanos;
+        auto it = std::partition_point(retained.begin(), retained.end(), [&](const auto &batch) {
+            return batch->lastSequence() <= publishedSequence;
+        });
+        if (it != retained.end()) {
+            appended = (*it)->createdNanos;
+        }
+        lag.age = std::chrono::nanoseconds(std::max<std::int64_t>(0, replication::wallClockNanos() - appended));
+        return lag;
+    }
+
+    /**
+     * @return Sequence of the last record appended (0 = none)
+     */
+    std::uint64_t getLastSequence() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lastSequence;
+    }
+
+    /**
+     * @return Records appended so far
+     */
+    std::uint64_t getRecordCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return records;
+    }
+
+    /**
+     * @return Encoded payload bytes of every batch cut so far (compare with
+     *         sizeof(JournalRecord) per record for the compression ratio)
+     */
+    std::uint64_t getPayloadBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return payloadBytes;
+    }
+};
+
+// ============================================================================
+// CLASS DEFINITION: ReplicaAccount
+// ============================================================================
+/**
+ * One account as a follower's published version shows it
+ * Has the BankAccount getters, so StatementRenderer can format it.
+ */
+class ReplicaAccount {
+private:
+    AccountId accountNumber;
+    std::string accountHolder;
+    AccountType accountType;
+    Money balance;
+    InterestRate interestRate;
+
+public:
+    ReplicaAccount(AccountId accNum, std::string holder, AccountType type, Money current, InterestRate rate)
+        : accountNumber(accNum), accountHolder(std::move(holder)), accountType(type), balance(current),
+          interestRate(rate) {}
+
+    AccountId getAccountNumber() const { return accountNumber; }
+    std::string_view getAccountHolder() const { return accountHolder; }
+    AccountType getAccountType() const { return accountType; }
+    Money getBalance() const { return balance; }
+    InterestRate getInterestRate() const { return interestRate; }
+
+    /**
+     * Shows the same block as BankAccount::displayAccountInfo
+     */
+    void displayAccountInfo(std::ostream &out = std::cout) const {
+        StatementRenderer renderer(StatementLayout::Card, 0);
+        renderer.append(*this);
+        renderer.writeTo(out);
+    }
+};
+
+/**
+ * What a follower has applied so far
+ */
+struct ReplicationStats {
+    std::uint64_t batches = 0;      // Batches applied (fully or in part)
+    std::uint64_t records = 0;      // Records applied
+    std::uint64_t posted = 0;       // ... of which through BatchPoster
+    std::uint64_t rejected = 0;     // Postings BatchPoster refused (follower diverged)
+    std::uint64_t skipped = 0;      // Records naming an account the follower does not have
+    std::uint64_t mismatches = 0;   // Balances that differ from what the primary journaled
+};
+
+// ============================================================================
+// CLASS DEFINITION: ReplicationFollower
+// ============================================================================
+/**
+ * Read-only copy of a primary's accounts, kept current by applying batches
+ *
+ * apply, catchUp and publish run on one replication thread; acquire,
+ * lookup, getBalance and getPublishedSequence may be called from any
+ * thread.
+ */
+class ReplicationFollower {
+private:
+    struct DirectoryEntry {
+        AccountSlot slot;
+        std::string holder;
+    };
+
+    AccountStore store;                      // Written only by the replication thread
+    StoreVersions versions{store};           // What readers see
+    BatchPoster poster;
+
+    mutable std::shared_mutex directoryMutex;
+    std::unordered_map<AccountId, DirectoryEntry> directory;   // Account number -> slot, name
+
+    std::uint64_t appliedSequence = 0;                     // Last record applied to the store
+    std::atomic<std::uint64_t> publishedSequence{0};       // Last record readers can see
+    ReplicationStats stats;
+    ReplayStats replayed;                                  // Records applied one by one
+
+    // Scratch reused by every batch
+    std::vector<JournalRecord> decoded;
+    std::vector<AccountSlot> slots;
+    std::vector<std::int64_t> amounts;
+    std::vector<std::int64_t> balancesAfter;     // Balance each posting left on the primary
+    std::vector<std::uint32_t> checkedInRun;     // Per slot: last run its balance was checked in
+    std::uint32_t run = 0;
+    std::unordered_map<AccountId, std::string> names;        // Names being reassembled
+    PostingReport report;
+
+    /**
+     * Posts the collected run of postings and checks the balances it left
+     */
+    void postRun() {
+        if (slots.empty()) {
+            return;
+        }
+        poster.post(store, slots, amounts, report);
+        stats.posted += report.applied;
+        stats.rejected += report.invalid + report.insufficientFunds + report.frozen;
+
+        // The last posting to each account says what its balance must be now
+        if (++run == 0) {
+            std::fill(checkedInRun.begin(), checkedInRun.end(), 0);
+            run = 1;
+        }
+        checkedInRun.resize(store.size(), 0);
+        for (std::size_t i = slots.size(); i-- > 0;) {
+            if (checkedInRun[slots[i]] != run) {
+                checkedInRun[slots[i]] = run;
+                stats.mismatches +=
+                    static_cast<std::uint64_t>(store.at(slots[i]).getBalance().getMinorUnits() != balancesAfter[i]);
+            }
+        }
+        slots.clear();
+        amounts.clear();
+        balancesAfter.clear();
+    }
+
+    /**
+     * Re-applies a record that is not a posting, keeping the directory current
+     */
+    void replay(const JournalRecord &record) {
+        const std::size_t before = store.size();
+        journal::StoreReplayTarget target(store);
+        journal::replayRecord(target, record, names, replayed);
+
+        AccountId id = AccountId::fromPacked(record.account);
+        if (store.size() != before) {
+            std::unique_lock<std::shared_mutex> lock(directoryMutex);
+            directory.insert_or_assign(id, DirectoryEntry{static_cast<AccountSlot>(before), std::string()});
+        } else if (record.op == JournalOp::HolderName && record.chunk + 1 >= record.accountType) {
+            std::optional<AccountRef> account = store.find(id);
+            if (account) {
+                std::string holder(account->getAccountHolder());
+                std::unique_lock<std::shared_mutex> lock(directoryMutex);
+                directory[id] = DirectoryEntry{account->getSlot(), std::move(holder)};
+            }
+        }
+    }
+
+public:
+    explicit ReplicationFollower(PostingKernel kernel = PostingKernel::Auto) : poster(kernel) {}
+
+    ReplicationFollower(const ReplicationFollower &) = delete;
+    ReplicationFollower &operator=(const ReplicationFollower &) = delete;
+
+    // ========================================================================
+    // REPLICATION THREAD
+    // ========================================================================
+    /**
+     * Applies the records of a batch that come after the applied sequence
+     * Readers do not see them until publish().
+     *
+     * @param batch The next batch from the primary
+     * A batch may start past appliedSequence + 1 when the log announced the
+     * skip (previousSequence at or before the applied sequence).
+     *
+     * @return Applied, Duplicate, Gap or Corrupt (nothing is applied unless Applied)
+     */
+    ReplicationApplyStatus apply(const ReplicationBatch &batch) {
+        if (batch.recordCount == 0 || batch.lastSequence() <= appliedSequence) {
+            return ReplicationApplyStatus::Duplicate;
+        }
+        if (batch.firstSequence > appliedSequence + 1 && batch.previousSequence > appliedSequence) {
+            return ReplicationApplyStatus::Gap;
+        }
+        if (!replication::decodeBatch(batch, decoded)) {
+            return ReplicationApplyStatus::Corrupt;
+        }
+
+        std::uint64_t fresh = 0;
+        for (const JournalRecord &record : decoded) {
+            if (record.sequence <= appliedSequence) {
+                continue;
+            }
+            ++fresh;
+            const bool posting = record.op == JournalOp::Deposit || record.op == JournalOp::Withdraw ||
+                                 record.op == JournalOp::Interest;
+            if (!posting) {
+                postRun();   // Keep the records in order
+                replay(record);
+                continue;
+            }
+            std::optional<AccountRef> account = store.find(AccountId::fromPacked(record.account));
+            if (!account) {
+                ++stats.skipped;
+                continue;
+            }
+            if (store.getRestrictedCount() != 0 && account->getStatus() != AccountStatus::Active) {
+                postRun();        // Interest reaches blocked accounts; the posting kernels
+                replay(record);   // would refuse it
+                continue;
+            }
+            slots.push_back(account->getSlot());
+            amounts.push_back(record.op == JournalOp::Withdraw ? -record.amount : record.amount);
+            balancesAfter.push_back(record.balanceAfter);
+        }
+        postRun();
+
+        stats.batches += 1;
+        stats.records += fresh;
+        appliedSequence = batch.lastSequence();
+        return ReplicationApplyStatus::Applied;
+    }
+
+    /**
+     * Makes every applied record visible to readers
+     * @return The published sequence
+     */
+    std::uint64_t publish() {
+        if (publishedSequence.load(std::memory_order_relaxed) != appliedSequence) {
+            versions.publish();
+            publishedSequence.store(appliedSequence, std::memory_order_release);
+        }
+        return appliedSequence;
+    }
+
+    /**
+     * Fetches and applies everything the log has after the applied
+     * sequence, then publishes once
+     *
+     * Stops at the first batch that cannot be applied; what was applied
+     * before it is still published.
+     *
+     * @param log The primary's log (in the same process)
+     * @return Ok, Evicted (the follower must be rebuilt), or Gap / Corrupt
+     *         (the stream is broken; fetching again returns the same batch)
+     */
+    CatchUpStatus catchUp(ReplicationLog &log) {
+        std::vector<std::shared_ptr<const ReplicationBatch>> batches;
+        for (;;) {
+            batches.clear();
+            if (log.fetch(appliedSequence, batches) == FetchStatus::Evicted) {
+                publish();
+                return CatchUpStatus::Evicted;
+            }
+            if (batches.empty()) {
+                break;
+            }
+            for (const auto &batch : batches) {
+                ReplicationApplyStatus status = apply(*batch);
+                if (status == ReplicationApplyStatus::Gap || status == ReplicationApplyStatus::Corrupt) {
+                    publish();
+                    return status == ReplicationApplyStatus::Gap ? CatchUpStatus::Gap : CatchUpStatus::Corrupt;
+                }
+            }
+        }
+        publish();
+        return CatchUpStatus::Ok;
+    }
+
+    /**
+     * @return Last sequence applied to the store (replication thread)
+     */
+    std::uint64_t getAppliedSequence() const { return appliedSequence; }
+
+    /**
+     * @return Counts of what has been applied (replication thread)
+     */
+    ReplicationStats getStats() const {
+        ReplicationStats total = stats;
+        total.skipped = stats.skipped + replayed.skipped;
+        total.mismatches = stats.mismatches + replayed.mismatches;
+        return total;
+    }
+
+    // ========================================================================
+    // READERS (any thread)
+    // ========================================================================
+    /**
+     * @return Last sequence readers can see
+     */
+    std::uint64_t getPublishedSequence() const {
+        return publishedSequence.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Pins the newest published version (see StoreVersions::acquire)
+     * @return A view, or nullopt if too many views are alive
+     */
+    std::optional<StoreView> acquire() {
+        return versions.acquire();
+    }
+
+    /**
+     * Looks an account up in a view
+     * The holder name is the newest one applied, which may be newer than
+     * the view.
+     *
+     * @param view A view from acquire()
+     * @param accNum The account number
+     * @return The account, or nullopt if the view does not have it
+     */
+    std::optional<ReplicaAccount> lookup(const StoreView &view, AccountId accNum) const {
+        std::shared_lock<std::shared_mutex> lock(directoryMutex);
+        auto it = directory.find(accNum);
+        if (it == directory.end() || it->second.slot >= view.size()) {
+            return std::nullopt;
+        }
+        AccountSlot slot = it->second.slot;
+        return ReplicaAccount(accNum, it->second.holder, view.getAccountType(slot), view.getBalance(slot),
+                              view.getInterestRate(slot));
+    }
+
+    /**
+     * @param accNum The account number
+     * @return Its balance in the newest published version, or nullopt if
+     *         the account is not there (or no view could be pinned)
+     */
+    std::optional<Money> getBalance(AccountId accNum) {
+        std::optional<StoreView> view = acquire();
+        if (!view) {
+            return std::nullopt;
+        }
+        std::optional<ReplicaAccount> account = lookup(*view, accNum);
+        if (!account) {
+            return std::nullopt;
+        }
+        return account->getBalance();
+    }
+
+    /**
+     * @param log The primary's log
+     * @return How far the published state is behind it
+     */
+    ReplicationLag lag(const ReplicationLog &log) const {
+        return log.lagOf(getPublishedSequence());
+    }
+};
+
+#endif // REPLICATION_HPP
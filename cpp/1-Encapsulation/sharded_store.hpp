@@ -0,0 +1,538 @@
+#ifndef SHARDED_STORE_HPP
+#define SHARDED_STORE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "account_id.hpp"
+#include "account_prefilter.hpp"
+#include "account_status.hpp"
+#include "account_store.hpp"
+#include "account_type.hpp"
+#include "money.hpp"
+#include "transaction.hpp"
+
+/**
+ * ============================================================================
+ * SHARDED ACCOUNT STORE: shared-nothing partitions with one worker each
+ * ============================================================================
+ *
+ * ShardedAccountStore splits accounts over N AccountStore shards by a hash
+ * of the account number. Every shard has its own worker thread (pinned to
+ * a CPU where the platform allows it), and only that worker ever touches
+ * the shard's columns. Workers share no data, take no lock on an account
+ * and never bounce an account's cache line between cores.
+ *
+ * Clients talk to a shard by sending a message to its mailbox. Each call
+ * returns a std::future that completes when the owning worker has run the
+ * operation. Messages from one client thread to one shard run in the order
+ * they were sent.
+ *
+ * CROSS-SHARD TRANSFERS (two-phase reserve/commit):
+ * 1. RESERVE (source shard): the amount is checked against the balance
+ *    minus funds already reserved, and held
+ * 2. CREDIT (destination shard): the destination is credited, or the
+ *    transfer is refused if the account does not exist
+ * 3. COMMIT / ABORT (source shard): the hold is turned into a withdrawal,
+ *    or released
+ * While a hold is open, other withdrawals see only the unreserved funds,
+ * so the source can never be overdrawn. The future completes at step 3.
+ * A transfer between two accounts of the same shard runs in one step.
+ *
+ * No shard is ever blocked by a transfer: each phase is one message.
+ * A sum taken while transfers are in flight may count money on both sides
+ * (credited but not yet committed); drain() first for an exact total.
+ *
+ * Unknown accounts are reported as InvalidAmount, as in BatchPoster.
+ *
+ * STATUS AND PREFILTER:
+ * setStatus blocks debits and/or credits of an account (AccountFrozen). A
+ * cross-shard transfer checks the source at RESERVE and the destination
+ * at CREDIT; a hold that was granted is committed even if the source is
+ * frozen before COMMIT arrives, since the money has already been
+ * credited. With an AccountPrefilter attached (setPrefilter), requests
+ * naming an account it knows is missing or blocked complete at once with
+ * AccountNotFound or AccountFrozen, without locking any mailbox.
+ * ============================================================================
+ */
+
+/**
+ * Configuration for ShardedAccountStore
+ */
+struct ShardedStoreOptions {
+    std::size_t shards = 0;    // Number of shards (0 = one per hardware thread)
+    bool pinWorkers = true;    // Pin worker i to CPU i (modulo the CPU count)
+};
+
+// ============================================================================
+// CLASS DEFINITION: ShardedAccountStore
+// ============================================================================
+class ShardedAccountStore {
+private:
+    enum class MessageKind : std::uint8_t {
+        Open,
+        Deposit,
+        Withdraw,
+        Balance,
+        TransferReserve,   // Source shard: check and hold the funds
+        TransferCredit,    // Destination shard: credit or refuse
+        TransferCommit,    // Source shard: turn the hold into a withdrawal
+        TransferAbort,     // Source shard: release the hold
+        Run,               // Run a function on the worker
+        Stop
+    };
+
+    struct Message {
+        MessageKind kind = MessageKind::Stop;
+        AccountId account;                 // Account the message is about
+        AccountId other;                   // Transfer destination
+        Money amount;
+        std::uint64_t transferId = 0;      // Cross-shard transfer the phase belongs to
+        std::size_t replyShard = 0;        // Source shard of a cross-shard transfer
+        TransactionStatus refusal = TransactionStatus::InvalidAmount;   // TransferAbort: why
+        std::promise<TransactionResult> *reply = nullptr;   // Completed when the operation ends
+        // Open only
+        std::string holder;
+        AccountType type = AccountType::Savings;
+        InterestRate rate;
+        std::promise<bool> *opened = nullptr;
+        // Run only
+        std::function<void(AccountStore &)> task;
+        std::promise<void> *ran = nullptr;
+    };
+
+    // Source-side state of a cross-shard transfer between RESERVE and COMMIT
+    struct PendingTransfer {
+        AccountSlot from;
+        Money amount;
+        std::promise<TransactionResult> *reply;
+    };
+
+    struct alignas(64) Shard {
+        // Mailbox - the only state other threads touch
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::vector<Message> inbox;
+
+        // Worker-only state
+        AccountStore store;
+        std::unordered_map<AccountSlot, std::int64_t> reserved;        // Held cents per account
+        std::unordered_map<std::uint64_t, PendingTransfer> transfers;  // Open holds by transfer id
+        std::thread worker;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<std::uint64_t> nextTransferId{1};
+    std::atomic<std::size_t> outstanding{0};   // Client operations not yet completed
+    std::atomic<AccountPrefilter *> prefilter{nullptr};   // Screens requests before they are sent
+
+    std::size_t shardOf(AccountId id) const {
+        // Fibonacci hashing, so consecutive account numbers spread over shards
+        return static_cast<std::size_t>(((id.getPacked() * 0x9E3779B97F4A7C15ull) >> 32) % shards.size());
+    }
+
+    void post(std::size_t shard, Message message) {
+        Shard &target = *shards[shard];
+        {
+            std::lock_guard<std::mutex> lock(target.mutex);
+            target.inbox.push_back(std::move(message));
+        }
+        target.ready.notify_one();
+    }
+
+    void complete(std::promise<TransactionResult> *reply, TransactionResult result) {
+        reply->set_value(result);
+        delete reply;
+        outstanding.fetch_sub(1, std::memory_order_release);
+    }
+
+    /**
+     * @return Funds of an account not held by an open transfer
+     */
+    static Money available(Shard &shard, AccountRef account) {
+        auto it = shard.reserved.find(account.getSlot());
+        std::int64_t held = it == shard.reserved.end() ? 0 : it->second;
+        return account.getBalance() - Money::fromMinorUnits(held);
+    }
+
+    static void release(Shard &shard, AccountSlot slot, Money amount) {
+        auto it = shard.reserved.find(slot);
+        it->second -= amount.getMinorUnits();
+        if (it->second == 0) {
+            shard.reserved.erase(it);
+        }
+    }
+
+    void handle(std::size_t self, Shard &shard, Message &message) {
+        const TransactionResult unknown{TransactionStatus::InvalidAmount, message.amount, Money()};
+        switch (message.kind) {
+        case MessageKind::Open:
+            message.opened->set_value(shard.store
+                                          .open(message.account, std::move(message.holder), message.amount,
+                                                message.type, message.rate)
+                                          .has_value());
+            delete message.opened;
+            outstanding.fetch_sub(1, std::memory_order_release);
+            break;
+        case MessageKind::Deposit: {
+            std::optional<AccountRef> account = shard.store.find(message.account);
+            complete(message.reply, account ? account->deposit(message.amount) : unknown);
+            break;
+        }
+        case MessageKind::Withdraw: {
+            std::optional<AccountRef> account = shard.store.find(message.account);
+            if (!account) {
+                complete(message.reply, unknown);
+                break;
+            }
+            Money free = available(shard, *account);
+            TransactionStatus status = account_rules::checkDebit(free, message.amount);
+            complete(message.reply, status == TransactionStatus::Success
+                                        ? account->withdraw(message.amount)
+                                        : TransactionResult{status, message.amount, free});
+            break;
+        }
+        case MessageKind::Balance: {
+            std::optional<AccountRef> account = shard.store.find(message.account);
+            complete(message.reply, account ? TransactionResult{TransactionStatus::Success, Money(),
+                                                                account->getBalance()}
+                                            : unknown);
+            break;
+        }
+        case MessageKind::TransferReserve: {
+            std::optional<AccountRef> from = shard.store.find(message.account);
+            if (!from) {
+                complete(message.reply, unknown);
+                break;
+            }
+            Money free = available(shard, *from);
+            TransactionStatus status = account_status::blocksDebits(from->getStatus())
+                                           ? TransactionStatus::AccountFrozen
+                                           : account_rules::checkDebit(free, message.amount);
+            if (status != TransactionStatus::Success) {
+                complete(message.reply, {status, message.amount, free});
+                break;
+            }
+            std::size_t destination = shardOf(message.other);
+            if (destination == self) {
+                std::optional<AccountRef> to = shard.store.find(message.other);
+                complete(message.reply, to ? from->transfer(*to, message.amount)
+                                           : TransactionResult{TransactionStatus::InvalidAmount,
+                                                               message.amount, from->getBalance()});
+                break;
+            }
+            shard.reserved[from->getSlot()] += message.amount.getMinorUnits();
+            shard.transfers.emplace(message.transferId,
+                                    PendingTransfer{from->getSlot(), message.amount, message.reply});
+            Message credit;
+            credit.kind = MessageKind::TransferCredit;
+            credit.account = message.other;
+            credit.amount = message.amount;
+            credit.transferId = message.transferId;
+            credit.replyShard = self;
+            post(destination, std::move(credit));
+            break;
+        }
+        case MessageKind::TransferCredit: {
+            std::optional<AccountRef> to = shard.store.find(message.account);
+            TransactionResult credited = to ? to->deposit(message.amount) : unknown;
+            Message answer;
+            answer.kind = credited ? MessageKind::TransferCommit : MessageKind::TransferAbort;
+            answer.transferId = message.transferId;
+            answer.refusal = credited.status;
+            post(message.replyShard, std::move(answer));
+            break;
+        }
+        case MessageKind::TransferCommit:
+        case MessageKind::TransferAbort: {
+            auto it = shard.transfers.find(message.transferId);
+            PendingTransfer pending = it->second;
+            shard.transfers.erase(it);
+            release(shard, pending.from, pending.amount);
+            AccountRef from = shard.store.at(pending.from);
+            if (message.kind == MessageKind::TransferCommit) {
+                TransactionResult debited = from.withdrawHeld(pending.amount);   // Covered by the hold
+                complete(pending.reply, debited);
+            } else {
+                complete(pending.reply, {message.refusal, pending.amount, from.getBalance()});
+            }
+            break;
+        }
+        case MessageKind::Run:
+            message.task(shard.store);
+            message.ran->set_value();
+            delete message.ran;
+            break;
+        case MessageKind::Stop:
+            break;
+        }
+    }
+
+    void runWorker(std::size_t self) {
+        Shard &shard = *shards[self];
+        std::vector<Message> batch;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(shard.mutex);
+                shard.ready.wait(lock, [&] { return !shard.inbox.empty(); });
+                batch.swap(shard.inbox);
+            }
+            for (Message &message : batch) {
+                if (message.kind == MessageKind::Stop) {
+                    return;
+                }
+                handle(self, shard, message);
+            }
+            batch.clear();
+        }
+    }
+
+    static void pin(std::thread &worker, std::size_t cpu) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(static_cast<int>(cpu), &set);
+        pthread_setaffinity_np(worker.native_handle(), sizeof(set), &set);   // Best effort
+#else
+        (void)worker;
+        (void)cpu;
+#endif
+    }
+
+    /**
+     * @return What the attached prefilter says about a request (Success =
+     *         send it; also when no prefilter is attached)
+     */
+    TransactionStatus screen(MessageKind kind, AccountId account, AccountId other) const {
+        const AccountPrefilter *filter = prefilter.load(std::memory_order_acquire);
+        if (!filter) {
+            return TransactionStatus::Success;
+        }
+        switch (kind) {
+        case MessageKind::Deposit:
+            return filter->screenDeposit(account);
+        case MessageKind::Withdraw:
+            return filter->screenWithdraw(account);
+        case MessageKind::TransferReserve:
+            return filter->screenTransfer(account, other);
+        default:
+            return filter->mayExist(account) ? TransactionStatus::Success : TransactionStatus::AccountNotFound;
+        }
+    }
+
+    std::future<TransactionResult> send(MessageKind kind, AccountId account, AccountId other, Money amount) {
+        TransactionStatus screened = screen(kind, account, other);
+        if (screened != TransactionStatus::Success) {
+            std::promise<TransactionResult> refused;
+            refused.set_value({screened, amount, Money()});
+            return refused.get_future();
+        }
+        auto *reply = new std::promise<TransactionResult>();
+        std::future<TransactionResult> result = reply->get_future();
+        Message message;
+        message.kind = kind;
+        message.account = account;
+        message.other = other;
+        message.amount = amount;
+        message.reply = reply;
+        if (kind == MessageKind::TransferReserve) {
+            message.transferId = nextTransferId.fetch_add(1, std::memory_order_relaxed);
+        }
+        outstanding.fetch_add(1, std::memory_order_relaxed);
+        post(shardOf(account), std::move(message));
+        return result;
+    }
+
+public:
+    /**
+     * Starts one worker per shard
+     * @param options Shard count and CPU pinning
+     */
+    explicit ShardedAccountStore(ShardedStoreOptions options = {}) {
+        std::size_t count = options.shards;
+        if (count == 0) {
+            count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        const std::size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+        shards.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            shards.push_back(std::make_unique<Shard>());
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            shards[i]->worker = std::thread([this, i] { runWorker(i); });
+            if (options.pinWorkers) {
+                pin(shards[i]->worker, i % cpus);
+            }
+        }
+    }
+
+    ShardedAccountStore(const ShardedAccountStore &) = delete;
+    ShardedAccountStore &operator=(const ShardedAccountStore &) = delete;
+
+    /**
+     * Waits for every outstanding operation, then stops the workers
+     */
+    ~ShardedAccountStore() {
+        drain();
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            post(i, Message());
+        }
+        for (std::unique_ptr<Shard> &shard : shards) {
+            shard->worker.join();
+        }
+    }
+
+    /**
+     * Opens an account on its shard
+     * @return Future holding false if the number is invalid or already taken
+     */
+    std::future<bool> open(AccountId accNum, std::string holder, Money initialBalance,
+                           AccountType type = AccountType::Savings,
+                           InterestRate rate = InterestRate::fromBasisPoints(0)) {
+        auto *opened = new std::promise<bool>();
+        std::future<bool> result = opened->get_future();
+        Message message;
+        message.kind = MessageKind::Open;
+        message.account = accNum;
+        message.amount = initialBalance;
+        message.holder = std::move(holder);
+        message.type = type;
+        message.rate = rate;
+        message.opened = opened;
+        outstanding.fetch_add(1, std::memory_order_relaxed);
+        post(shardOf(accNum), std::move(message));
+        return result;
+    }
+
+    std::future<TransactionResult> deposit(AccountId account, Money amount) {
+        return send(MessageKind::Deposit, account, account, amount);
+    }
+
+    std::future<TransactionResult> withdraw(AccountId account, Money amount) {
+        return send(MessageKind::Withdraw, account, account, amount);
+    }
+
+    /**
+     * Moves money between two accounts, two-phase if they live on different shards
+     * @return Future holding the result; balance is the source's balance afterwards
+     */
+    std::future<TransactionResult> transfer(AccountId from, AccountId to, Money amount) {
+        return send(MessageKind::TransferReserve, from, to, amount);
+    }
+
+    /**
+     * @return Future holding the balance (in result.balance)
+     */
+    std::future<TransactionResult> balanceOf(AccountId account) {
+        return send(MessageKind::Balance, account, account, Money());
+    }
+
+    /**
+     * Runs a function on a shard's worker and waits for it
+     * The function may read or modify that shard's store freely.
+     *
+     * @param shard Shard index
+     * @param task Function given the shard's store
+     */
+    void runOn(std::size_t shard, std::function<void(AccountStore &)> task) {
+        std::promise<void> *ran = new std::promise<void>();
+        std::future<void> done = ran->get_future();
+        Message message;
+        message.kind = MessageKind::Run;
+        message.task = std::move(task);
+        message.ran = ran;
+        post(shard, std::move(message));
+        done.wait();
+    }
+
+    /**
+     * Changes which money movements an account accepts
+     *
+     * @param account The account
+     * @param status Its new status
+     * @return false if the account does not exist
+     */
+    bool setStatus(AccountId account, AccountStatus status) {
+        bool found = false;
+        runOn(shardOf(account), [&](AccountStore &store) {
+            std::optional<AccountRef> ref = store.find(account);
+            if (ref) {
+                ref->setStatus(status);
+                found = true;
+            }
+        });
+        return found;
+    }
+
+    /**
+     * Attaches (or detaches, with nullptr) a prefilter shared by every shard
+     * Each shard records its accounts in it before requests are screened.
+     *
+     * @param filter The prefilter; must outlive its attachment
+     */
+    void setPrefilter(AccountPrefilter *filter) {
+        prefilter.store(nullptr, std::memory_order_release);
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            runOn(i, [filter](AccountStore &store) { store.setPrefilter(filter); });
+        }
+        prefilter.store(filter, std::memory_order_release);
+    }
+
+    /**
+     * Waits until every operation sent so far has completed
+     */
+    void drain() const {
+        while (outstanding.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @return Sum of all balances (exact only when no transfer is in flight)
+     */
+    Money totalBalance() {
+        Money total;
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            runOn(i, [&total](AccountStore &store) { total += store.totalBalance(); });
+        }
+        return total;
+    }
+
+    /**
+     * @return Number of accounts over all shards
+     */
+    std::size_t size() {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            runOn(i, [&count](AccountStore &store) { count += store.size(); });
+        }
+        return count;
+    }
+
+    std::size_t getShardCount() const { return shards.size(); }
+
+    /**
+     * @return Index of the shard that owns an account
+     */
+    std::size_t getShardOf(AccountId account) const { return shardOf(account); }
+};
+
+#endif // SHARDED_STORE_HPP
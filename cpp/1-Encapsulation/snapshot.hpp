@@ -0,0 +1,573 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "account_store.hpp"
+#include "journal.hpp"
+
+/**
+ * ============================================================================
+ * MEMORY-MAPPED SNAPSHOTS
+ * ============================================================================
+ *
+ * Rebuilding a large store account by account (or by replaying its whole
+ * journal) takes minutes. A snapshot stores the AccountStore columns
+ * exactly as they sit in memory, so restoring one is an mmap and a few
+ * pointer assignments: no parsing, no per-account allocation, and pages
+ * are only read from disk when something touches them.
+ *
+ * FILE LAYOUT (native byte order, every section 64-byte aligned):
+ *   SnapshotHeader          magic "BANKSNP1", version, counts, offsets,
+ *                           running totals (version 2)
+ *   balances                int64[count]   cents
+ *   rates                   int32[count]   basis points
+ *   types                   uint8[count]   AccountType
+ *   accountNumbers          uint64[count]  packed AccountId
+ *   holderOffsets           uint64[count + 1]
+ *   holderText              name i = text[offsets[i], offsets[i + 1])
+ *   statuses                uint8[count]   AccountStatus (version 3)
+ *
+ * A snapshot is written to "<path>.tmp", synced, then renamed over <path>,
+ * so a crash mid-write leaves the previous snapshot intact. The header
+ * records the journal sequence the snapshot includes; recovery restores the
+ * snapshot and replays only the journal records after it.
+ *
+ * Opening a snapshot checks that every section fits the file and that the
+ * bytes later used as indexes are in range: account types, status bytes,
+ * and holder offsets (rising, ending at the text size). That is one pass
+ * over those sections; balances and account numbers are not read.
+ * ============================================================================
+ */
+
+/**
+ * Outcome of a snapshot operation
+ */
+enum class SnapshotStatus {
+    Ok,
+    CannotOpen,    // The file does not exist or cannot be read/mapped
+    CannotWrite,   // Writing, syncing or renaming failed
+    BadHeader,     // Not a snapshot, or an incompatible version / byte order
+    Truncated,     // A section lies outside the file
+    Corrupt        // A type, status or holder offset is out of range
+};
+
+/**
+ * First 128 bytes of every snapshot file
+ */
+struct SnapshotHeader {
+    static constexpr std::uint32_t kByteOrderMark = 0x01020304;
+
+    char magic[8] = {'B', 'A', 'N', 'K', 'S', 'N', 'P', '1'};
+    std::uint32_t version = 3;
+    std::uint32_t byteOrder = kByteOrderMark;    // Reads differently on the other endianness
+    std::uint64_t fileSize = 0;                  // Total bytes, to detect truncation
+    std::uint64_t accountCount = 0;
+    std::uint64_t journalSequence = 0;           // Last journal record reflected in the columns
+    std::uint64_t balancesOffset = 0;
+    std::uint64_t ratesOffset = 0;
+    std::uint64_t typesOffset = 0;
+    std::uint64_t accountNumbersOffset = 0;
+    std::uint64_t holderOffsetsOffset = 0;
+    std::uint64_t holderTextOffset = 0;
+    std::uint64_t holderTextBytes = 0;
+    // Running totals at snapshot time (version 2; zero in version 1 files)
+    std::int64_t typeTotals[kAccountTypeCount] = {};   // Cents per AccountType
+    std::uint64_t zeroBalanceAccounts = 0;
+    std::int64_t periodInterest = 0;                   // Cents credited in the open period
+
+    bool hasValidIdentity() const {
+        SnapshotHeader expected;
+        return std::memcmp(magic, expected.magic, sizeof magic) == 0 &&
+               version >= 1 && version <= expected.version && byteOrder == kByteOrderMark;
+    }
+};
+
+static_assert(sizeof(SnapshotHeader) == 128 && kAccountTypeCount == 2,
+              "the header has room for two per-type totals");
+static_assert(sizeof(AccountType) == 1 && sizeof(AccountStatus) == 1 && sizeof(AccountId) == 8,
+              "snapshot sections assume these column widths");
+
+namespace snapshot_layout {
+
+constexpr std::uint64_t kSectionAlignment = 64;
+
+constexpr std::uint64_t alignUp(std::uint64_t offset) {
+    return (offset + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+/**
+ * @return Offset of the status section (version 3; it follows the names,
+ *         so the header needs no field for it)
+ */
+constexpr std::uint64_t statusesOffset(const SnapshotHeader &header) {
+    return alignUp(header.holderTextOffset + header.holderTextBytes);
+}
+
+/**
+ * Computes where each section goes for a given account count and name size
+ */
+inline SnapshotHeader plan(std::uint64_t count, std::uint64_t textBytes, std::uint64_t journalSequence,
+                           std::uint32_t version = SnapshotHeader().version) {
+    SnapshotHeader header;
+    header.version = version;
+    header.accountCount = count;
+    header.journalSequence = journalSequence;
+    header.holderTextBytes = textBytes;
+    std::uint64_t offset = alignUp(sizeof(SnapshotHeader));
+    header.balancesOffset = offset;
+    offset = alignUp(offset + count * sizeof(std::int64_t));
+    header.ratesOffset = offset;
+    offset = alignUp(offset + count * sizeof(std::int32_t));
+    header.typesOffset = offset;
+    offset = alignUp(offset + count * sizeof(AccountType));
+    header.accountNumbersOffset = offset;
+    offset = alignUp(offset + count * sizeof(AccountId));
+    header.holderOffsetsOffset = offset;
+    offset = alignUp(offset + (count + 1) * sizeof(std::uint64_t));
+    header.holderTextOffset = offset;
+    header.fileSize = offset + textBytes;
+    if (version >= 3) {
+        header.fileSize = statusesOffset(header) + count * sizeof(AccountStatus);
+    }
+    return header;
+}
+
+} // namespace snapshot_layout
+
+// ============================================================================
+// CLASS DEFINITION: SnapshotWriter
+// ============================================================================
+/**
+ * Writes an AccountStore to a snapshot file
+ */
+class SnapshotWriter {
+private:
+    static constexpr std::size_t kBufferBytes = 1 << 20;
+
+    int fd = -1;
+    std::uint64_t written = 0;        // Bytes written so far (file offset)
+    std::vector<char> buffer;         // Small pieces are coalesced here
+    bool failed = false;
+
+    void writeRaw(const char *cursor, std::size_t bytes) {
+        while (bytes > 0 && !failed) {
+            ssize_t n = ::write(fd, cursor, bytes);
+            if (n < 0) {
+                failed = errno != EINTR;
+                continue;
+            }
+            cursor += n;
+            bytes -= static_cast<std::size_t>(n);
+        }
+    }
+
+    void flushBuffer() {
+        writeRaw(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+
+    void put(const void *data, std::size_t bytes) {
+        const char *bytesIn = static_cast<const char *>(data);
+        if (buffer.size() + bytes > kBufferBytes) {
+            flushBuffer();
+        }
+        if (bytes >= kBufferBytes) {
+            writeRaw(bytesIn, bytes);   // Large columns go straight to the file
+        } else {
+            buffer.insert(buffer.end(), bytesIn, bytesIn + bytes);
+        }
+        written += bytes;
+    }
+
+    void padTo(std::uint64_t offset) {
+        static const char zeros[snapshot_layout::kSectionAlignment] = {};
+        while (written < offset) {
+            std::uint64_t gap = offset - written;
+            put(zeros, static_cast<std::size_t>(gap < sizeof zeros ? gap : sizeof zeros));
+        }
+    }
+
+    SnapshotStatus writeFile(const AccountStore &store, std::uint64_t journalSequence) {
+        const std::size_t count = store.size();
+        std::uint64_t textBytes = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            textBytes += store.holders[i].size();
+        }
+        SnapshotHeader header = snapshot_layout::plan(count, textBytes, journalSequence);
+        StoreTotals totals = store.totals();
+        for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+            header.typeTotals[t] = totals.byType[t].getMinorUnits();
+        }
+        header.zeroBalanceAccounts = totals.zeroBalanceAccounts;
+        header.periodInterest = totals.interestThisPeriod.getMinorUnits();
+        buffer.reserve(kBufferBytes);
+
+        put(&header, sizeof header);
+        padTo(header.balancesOffset);
+        put(store.balances.data(), count * sizeof(std::int64_t));
+        padTo(header.ratesOffset);
+        put(store.rates.data(), count * sizeof(std::int32_t));
+        padTo(header.typesOffset);
+        put(store.types.data(), count * sizeof(AccountType));
+        padTo(header.accountNumbersOffset);
+        put(store.accountNumbers.data(), count * sizeof(AccountId));
+
+        padTo(header.holderOffsetsOffset);
+        std::uint64_t textOffset = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            put(&textOffset, sizeof textOffset);
+            textOffset += store.holders[i].size();
+        }
+        put(&textOffset, sizeof textOffset);
+
+        padTo(header.holderTextOffset);
+        for (std::size_t i = 0; i < count; ++i) {
+            std::string_view name = store.holders[i];
+            put(name.data(), name.size());
+        }
+        padTo(snapshot_layout::statusesOffset(header));
+        put(store.statuses.data(), count * sizeof(AccountStatus));
+        flushBuffer();
+
+        if (failed || written != header.fileSize || ::fdatasync(fd) != 0) {
+            return SnapshotStatus::CannotWrite;
+        }
+        return SnapshotStatus::Ok;
+    }
+
+public:
+    /**
+     * Writes a snapshot atomically (temp file + rename)
+     * A lazily accruing store is settled first, so the file holds every
+     * elapsed period. With a journal attached the settlement is journaled
+     * too, after any sequence read earlier: call store.settleInterest()
+     * before reading journalSequence (settling twice costs one scan).
+     *
+     * @param store The accounts to save
+     * @param path Destination file (replaced only once the new one is complete)
+     * @param journalSequence Last journal record already reflected in the store
+     * @return Ok or CannotWrite
+     */
+    static SnapshotStatus write(AccountStore &store, const std::string &path,
+                                std::uint64_t journalSequence = 0) {
+        store.settleInterest();
+        std::string temp = path + ".tmp";
+        SnapshotWriter writer;
+        writer.fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (writer.fd < 0) {
+            return SnapshotStatus::CannotWrite;
+        }
+        SnapshotStatus status = writer.writeFile(store, journalSequence);
+        ::close(writer.fd);
+        if (status != SnapshotStatus::Ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+            ::unlink(temp.c_str());
+            return SnapshotStatus::CannotWrite;
+        }
+
+        // Make the rename itself durable
+        std::string::size_type slash = path.rfind('/');
+        std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+        int dirFd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            ::fsync(dirFd);
+            ::close(dirFd);
+        }
+        return SnapshotStatus::Ok;
+    }
+};
+
+// ============================================================================
+// CLASS DEFINITION: MappedSnapshot
+// ============================================================================
+/**
+ * A snapshot file mapped into memory
+ * The columns can be read in place through the accessors, or handed to an
+ * AccountStore with restoreInto. The mapping is private: changes made
+ * through a restored store never reach the file.
+ */
+class MappedSnapshot {
+private:
+    /**
+     * Owns the mapping; shared by every column that views it
+     */
+    struct Mapping {
+        void *base = MAP_FAILED;
+        std::size_t length = 0;
+
+        ~Mapping() {
+            if (base != MAP_FAILED) {
+                ::munmap(base, length);
+            }
+        }
+    };
+
+    std::shared_ptr<Mapping> mapping;
+    const SnapshotHeader *header = nullptr;
+
+    template <class T>
+    T *section(std::uint64_t offset) const {
+        return reinterpret_cast<T *>(static_cast<char *>(mapping->base) + offset);
+    }
+
+    /**
+     * @return true if every section lies inside the file
+     */
+    static bool sectionsFit(const SnapshotHeader &h, std::uint64_t fileSize) {
+        if (h.accountCount >= fileSize || h.holderTextBytes >= fileSize) {
+            return false;   // Also keeps plan's arithmetic from wrapping
+        }
+        SnapshotHeader expected = snapshot_layout::plan(h.accountCount, h.holderTextBytes,
+                                                        h.journalSequence, h.version);
+        return h.fileSize == fileSize && expected.fileSize == fileSize &&
+               h.balancesOffset == expected.balancesOffset && h.ratesOffset == expected.ratesOffset &&
+               h.typesOffset == expected.typesOffset &&
+               h.accountNumbersOffset == expected.accountNumbersOffset &&
+               h.holderOffsetsOffset == expected.holderOffsetsOffset &&
+               h.holderTextOffset == expected.holderTextOffset;
+    }
+
+    /**
+     * @return true if every byte used as an index (type, status, holder
+     *         offset) is in range; the sections are known to fit
+     */
+    static bool contentsValid(const SnapshotHeader &h, const char *base) {
+        const std::uint64_t count = h.accountCount;
+        const auto *types = reinterpret_cast<const std::uint8_t *>(base + h.typesOffset);
+        for (std::uint64_t i = 0; i < count; ++i) {
+            if (types[i] >= kAccountTypeCount) {
+                return false;
+            }
+        }
+        const auto *offsets = reinterpret_cast<const std::uint64_t *>(base + h.holderOffsetsOffset);
+        if (offsets[0] != 0 || offsets[count] != h.holderTextBytes) {
+            return false;
+        }
+        for (std::uint64_t i = 0; i < count; ++i) {
+            if (offsets[i + 1] < offsets[i]) {
+                return false;
+            }
+        }
+        if (h.version >= 3) {
+            const auto *statuses = reinterpret_cast<const std::uint8_t *>(base + snapshot_layout::statusesOffset(h));
+            for (std::uint64_t i = 0; i < count; ++i) {
+                if (!account_status::fromBits(statuses[i])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+public:
+    /**
+     * Maps a snapshot file
+     *
+     * @param path The snapshot
+     * @return Ok, CannotOpen, BadHeader, Truncated or Corrupt
+     */
+    SnapshotStatus open(const std::string &path) {
+        mapping.reset();
+        header = nullptr;
+
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return SnapshotStatus::CannotOpen;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            return SnapshotStatus::CannotOpen;
+        }
+        std::uint64_t fileSize = static_cast<std::uint64_t>(info.st_size);
+        if (fileSize < sizeof(SnapshotHeader)) {
+            ::close(fd);
+            return SnapshotStatus::BadHeader;
+        }
+
+        auto mapped = std::make_shared<Mapping>();
+        mapped->length = static_cast<std::size_t>(fileSize);
+        // Private and writable: a restored store may modify its columns in place
+        mapped->base = ::mmap(nullptr, mapped->length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped->base == MAP_FAILED) {
+            return SnapshotStatus::CannotOpen;
+        }
+
+        const SnapshotHeader *candidate = static_cast<const SnapshotHeader *>(mapped->base);
+        if (!candidate->hasValidIdentity()) {
+            return SnapshotStatus::BadHeader;
+        }
+        if (!sectionsFit(*candidate, fileSize)) {
+            return SnapshotStatus::Truncated;
+        }
+        if (!contentsValid(*candidate, static_cast<const char *>(mapped->base))) {
+            return SnapshotStatus::Corrupt;
+        }
+        mapping = std::move(mapped);
+        header = candidate;
+        return SnapshotStatus::Ok;
+    }
+
+    bool isOpen() const { return header != nullptr; }
+
+    std::size_t size() const { return isOpen() ? static_cast<std::size_t>(header->accountCount) : 0; }
+
+    /**
+     * @return The last journal sequence included in the snapshot
+     */
+    std::uint64_t getJournalSequence() const { return isOpen() ? header->journalSequence : 0; }
+
+    // ========================================================================
+    // IN-PLACE COLUMN ACCESS
+    // ========================================================================
+    std::span<const std::int64_t> balanceColumn() const {
+        return {section<const std::int64_t>(header->balancesOffset), size()};
+    }
+
+    std::span<const std::int32_t> rateColumn() const {
+        return {section<const std::int32_t>(header->ratesOffset), size()};
+    }
+
+    std::span<const AccountType> typeColumn() const {
+        return {section<const AccountType>(header->typesOffset), size()};
+    }
+
+    std::span<const AccountId> accountNumberColumn() const {
+        return {section<const AccountId>(header->accountNumbersOffset), size()};
+    }
+
+    /**
+     * @return The statuses (empty for version 1 and 2 files: every account is Active)
+     */
+    std::span<const AccountStatus> statusColumn() const {
+        if (!isOpen() || header->version < 3) {
+            return {};
+        }
+        return {section<const AccountStatus>(snapshot_layout::statusesOffset(*header)), size()};
+    }
+
+    /**
+     * @param slot Index of the account (must be < size())
+     * @return Its holder name, viewed in the mapping
+     */
+    std::string_view getAccountHolder(std::size_t slot) const {
+        const std::uint64_t *offsets = section<const std::uint64_t>(header->holderOffsetsOffset);
+        return std::string_view(section<const char>(header->holderTextOffset) + offsets[slot],
+                                static_cast<std::size_t>(offsets[slot + 1] - offsets[slot]));
+    }
+
+    /**
+     * Makes a store use the snapshot's columns in place (replaces its contents)
+     * Nothing is copied, the running totals come from the header, and the
+     * account-number index is only rebuilt when the store is first
+     * searched (version 1 files need one scan for the totals). The only
+     * pass here is over the one-byte status column, to count blocked
+     * accounts (and to fill the store's prefilter, if it has one); open
+     * has already checked every value used as an index.
+     * The store keeps the mapping alive, so this MappedSnapshot may be
+     * destroyed afterwards. A lazily accruing store treats every restored
+     * account as accrued through its current accrual period (snapshots are
+     * written settled). As with AccountStore::clear, no lookup through
+     * the store's lookupIndex() may run meanwhile: the old index is freed.
+     *
+     * @param store The store to restore
+     */
+    void restoreInto(AccountStore &store) const {
+        if (!isOpen()) {
+            return;
+        }
+        std::size_t count = size();
+        store.balances.adopt(section<std::int64_t>(header->balancesOffset), count, mapping);
+        store.rates.adopt(section<std::int32_t>(header->ratesOffset), count, mapping);
+        store.types.adopt(section<AccountType>(header->typesOffset), count, mapping);
+        store.accountNumbers.adopt(section<AccountId>(header->accountNumbersOffset), count, mapping);
+        store.holders.adopt(section<const std::uint64_t>(header->holderOffsetsOffset),
+                            section<const char>(header->holderTextOffset), count, mapping);
+        if (header->version >= 3) {
+            store.statuses.adopt(section<AccountStatus>(snapshot_layout::statusesOffset(*header)), count,
+                                 mapping);
+        } else {
+            store.statuses.clear();
+            store.statuses.resize(count, AccountStatus::Active);
+        }
+        store.recomputeStatuses();   // Also refills an attached prefilter
+        // Rows are indexed lazily, on the first find or open
+        store.index.clear();
+        store.index.reclaimRetired();   // No slot of the old index is valid any more
+        store.indexedSlots = 0;
+        store.markAllChanged();
+        if (store.lazyAccrual) {
+            store.lastAccrual.clear();
+            store.lastAccrual.resize(count, store.accrualPeriod);
+        }
+
+        if (header->version >= 2) {
+            StoreTotals totals;
+            for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+                totals.byType[t] = Money::fromMinorUnits(header->typeTotals[t]);
+            }
+            totals.accounts = count;
+            totals.zeroBalanceAccounts = static_cast<std::size_t>(header->zeroBalanceAccounts);
+            totals.interestThisPeriod = Money::fromMinorUnits(header->periodInterest);
+            store.aggregates.reset(totals);
+        } else {
+            store.recomputeAggregates();   // Version 1 files carry no totals
+        }
+    }
+};
+
+// ============================================================================
+// RECOVERY: snapshot + journal
+// ============================================================================
+/**
+ * Outcome of recoverStore
+ */
+struct RecoveryStats {
+    SnapshotStatus snapshot = SnapshotStatus::Ok;   // CannotOpen = started from an empty store
+    std::uint64_t snapshotSequence = 0;             // Journal sequence the snapshot included
+    ReplayStats journal;                            // Records replayed on top of it
+};
+
+/**
+ * Restores a store from its latest snapshot, then replays the journal
+ * records written after that snapshot
+ *
+ * @param snapshotPath Snapshot file (a missing file means "start empty")
+ * @param journalPath Journal file
+ * @param store The store to rebuild (its contents are replaced; left
+ *              untouched if the snapshot exists but is damaged)
+ * @return What was restored and replayed
+ */
+inline RecoveryStats recoverStore(const std::string &snapshotPath, const std::string &journalPath,
+                                  AccountStore &store) {
+    RecoveryStats stats;
+    MappedSnapshot snapshot;
+    stats.snapshot = snapshot.open(snapshotPath);
+    if (stats.snapshot == SnapshotStatus::Ok) {
+        snapshot.restoreInto(store);
+        stats.snapshotSequence = snapshot.getJournalSequence();
+    } else if (stats.snapshot == SnapshotStatus::CannotOpen) {
+        store.clear();   // The whole journal is replayed onto nothing
+    } else {
+        return stats;   // A damaged snapshot is not silently ignored
+    }
+    stats.journal = replayJournal(journalPath, store, stats.snapshotSequence);
+    return stats;
+}
+
+#endif // SNAPSHOT_HPP
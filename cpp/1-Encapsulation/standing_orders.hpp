@@ -0,0 +1,515 @@
+#ifndef STANDING_ORDERS_HPP
+#define STANDING_ORDERS_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "account_store.hpp"
+#include "money.hpp"
+#include "transaction.hpp"
+#include "transfer_batch.hpp"
+
+/**
+ * ============================================================================
+ * STANDING ORDERS: recurring transfers and interest on a timer wheel
+ * ============================================================================
+ *
+ * A standing order moves a fixed amount between two accounts of one
+ * AccountStore every `period` ticks (rent, salary), or applies one period
+ * of interest to an account. A tick is whatever unit the caller advances
+ * time in (a minute, a day). Orders fire when advanceTo passes their tick.
+ *
+ * TIMER WHEEL:
+ * Orders sit in a hierarchical timer wheel of kLevels levels with kSlots
+ * slots each. Level 0 has one slot per tick for the next 256 ticks; level
+ * L holds orders due 256^L to 256^(L+1) ticks ahead, one slot per block of
+ * 256^L ticks. When time reaches the start of a block, that block's slot
+ * one level up is CASCADED: its orders move down to finer slots. Orders
+ * due more than 2^32 ticks ahead wait in an overflow list that is
+ * re-examined every 2^32 ticks. So:
+ * - schedule and cancel are O(1): an order is a node of an intrusive
+ *   doubly linked list in a pool, and its slot follows from its due tick
+ * - firing a tick costs only the orders due on it (each order cascades at
+ *   most kLevels times before it fires), never a scan or sort of the
+ *   rest; empty ticks are skipped 256 at a time with an occupancy bitmap
+ *
+ * FIRING:
+ * The orders due on one tick fire together. Interest orders are applied
+ * first (AccountRef::applyInterest, on the balance before the tick's
+ * payments). Then every transfer order of the tick becomes a leg of one
+ * TransferBatch. A batch is all-or-nothing, but standing orders are
+ * independent, so when the batch is rejected the legs that caused it
+ * (InsufficientFunds, InvalidAmount) are reported as failed and the rest
+ * are executed again, until one execution succeeds. Every order debiting
+ * an account the tick would overdraw bounces, not just the last one. A
+ * retry is needed again only when a bounced payment leaves its payee
+ * short for a payment of its own.
+ *
+ * A recurring order is rescheduled period ticks after the tick it was due
+ * on, whether or not it bounced; a one-off order is removed after firing.
+ * The store must outlive the scheduler. Not thread-safe, like the store.
+ * ============================================================================
+ */
+
+/**
+ * What a standing order does when it fires
+ */
+enum class StandingOrderKind : std::uint8_t {
+    Transfer,   // Move amount from one account to another
+    Interest    // Apply one period of interest to an account
+};
+
+/**
+ * Handle to a scheduled order
+ * Stays unique after the order is gone: a stale handle never cancels a
+ * newer order that reuses the same pool entry.
+ */
+struct StandingOrderId {
+    std::uint32_t index = 0;        // Entry in the scheduler's pool
+    std::uint32_t generation = 0;   // Which use of that entry
+
+    bool operator==(const StandingOrderId &) const = default;
+};
+
+/**
+ * A transfer order that bounced
+ */
+struct StandingOrderFailure {
+    StandingOrderId order;
+    std::uint64_t tick = 0;                                      // Tick it was due on
+    TransactionStatus status = TransactionStatus::InsufficientFunds;
+};
+
+/**
+ * What one advanceTo call fired
+ */
+struct StandingOrderReport {
+    std::size_t fired = 0;               // Orders due in the advanced ticks
+    std::size_t transfers = 0;           // Transfer orders executed
+    std::size_t interestPostings = 0;    // Interest orders applied
+    std::size_t batches = 0;             // TransferBatch executions (retries included)
+    Money transferred;                   // Sum of the executed transfers
+    Money interest;                      // Sum of the interest applied
+    std::vector<StandingOrderFailure> failures;   // Transfers that bounced
+};
+
+// ============================================================================
+// CLASS DEFINITION: StandingOrderScheduler
+// ============================================================================
+class StandingOrderScheduler {
+public:
+    static constexpr unsigned kLevels = 4;
+    static constexpr unsigned kSlotBits = 8;
+    static constexpr std::size_t kSlots = std::size_t{1} << kSlotBits;
+
+private:
+    static constexpr std::uint32_t kNil = ~std::uint32_t{0};
+    static constexpr std::uint16_t kOverflowBucket = kLevels * kSlots;
+    static constexpr std::uint16_t kNoBucket = kOverflowBucket + 1;   // Free, or firing
+    static constexpr std::uint64_t kSlotMask = kSlots - 1;
+
+    // One pool entry (48 bytes)
+    struct Order {
+        std::uint64_t due = 0;            // Tick the order fires on next
+        std::int64_t cents = 0;           // Transfer amount
+        AccountSlot from = 0;             // Debited account (Transfer), the account (Interest)
+        AccountSlot to = 0;               // Credited account (Transfer)
+        std::uint32_t period = 0;         // Ticks between firings (0 = fires once)
+        std::uint32_t generation = 0;     // Bumped every time the entry is freed
+        std::uint32_t prev = kNil;        // Neighbours in the bucket list
+        std::uint32_t next = kNil;        // ... (next free entry while free)
+        std::uint16_t bucket = kNoBucket; // level * kSlots + slot, overflow, or none
+        StandingOrderKind kind = StandingOrderKind::Transfer;
+        std::uint8_t rounding = 0;        // RoundingMode (Interest)
+    };
+
+    AccountStore *store;                                   // Accounts the orders refer to
+    std::vector<Order> orders;                             // Pool
+    std::uint32_t freeList = kNil;                         // First free pool entry
+    std::size_t live = 0;                                  // Scheduled orders
+    std::array<std::uint32_t, kLevels * kSlots + 1> heads; // First order of each bucket
+    std::array<std::uint64_t, kSlots / 64> levelZeroUsed{}; // Bit s = level 0 slot s not empty
+    std::uint64_t nextTick;                                // First tick not fired yet
+
+    // Scratch reused by every tick
+    std::vector<std::uint32_t> firing;                     // Orders due on the tick
+    std::vector<std::uint32_t> legOrders;                  // Order of each batch leg
+    std::vector<std::uint32_t> retryOrders;
+    TransferBatch batch;
+    TransferBatchResult batchResult;
+
+    // ========================================================================
+    // WHEEL
+    // ========================================================================
+    /**
+     * @return Bucket an order due on `due` belongs in, relative to nextTick
+     */
+    std::uint16_t bucketFor(std::uint64_t due) const {
+        std::uint64_t delta = due > nextTick ? due - nextTick : 0;
+        due = std::max(due, nextTick);   // Overdue orders fire on the next tick
+        for (unsigned level = 0; level < kLevels; ++level) {
+            if (delta < (std::uint64_t{1} << (kSlotBits * (level + 1)))) {
+                return static_cast<std::uint16_t>(level * kSlots + ((due >> (kSlotBits * level)) & kSlotMask));
+            }
+        }
+        return kOverflowBucket;
+    }
+
+    void link(std::uint32_t index) {
+        Order &order = orders[index];
+        order.bucket = bucketFor(order.due);
+        order.prev = kNil;
+        order.next = heads[order.bucket];
+        if (order.next != kNil) {
+            orders[order.next].prev = index;
+        }
+        heads[order.bucket] = index;
+        if (order.bucket < kSlots) {
+            levelZeroUsed[order.bucket / 64] |= std::uint64_t{1} << (order.bucket % 64);
+        }
+    }
+
+    void unlink(std::uint32_t index) {
+        Order &order = orders[index];
+        if (order.prev != kNil) {
+            orders[order.prev].next = order.next;
+        } else {
+            heads[order.bucket] = order.next;
+            if (order.next == kNil && order.bucket < kSlots) {
+                levelZeroUsed[order.bucket / 64] &= ~(std::uint64_t{1} << (order.bucket % 64));
+            }
+        }
+        if (order.next != kNil) {
+            orders[order.next].prev = order.prev;
+        }
+        order.bucket = kNoBucket;
+    }
+
+    /**
+     * Re-places every order of a bucket relative to nextTick
+     */
+    void cascade(std::uint16_t bucket) {
+        std::uint32_t index = heads[bucket];
+        heads[bucket] = kNil;
+        while (index != kNil) {
+            std::uint32_t following = orders[index].next;
+            link(index);
+            index = following;
+        }
+    }
+
+    /**
+     * Cascades the blocks that start at nextTick (coarsest level first, so
+     * orders moving down land in buckets that are cascaded next)
+     */
+    void cascadeAt() {
+        if ((nextTick & 0xFFFFFFFFu) == 0) {
+            cascade(kOverflowBucket);
+        }
+        for (unsigned level = kLevels - 1; level > 0; --level) {
+            if ((nextTick & ((std::uint64_t{1} << (kSlotBits * level)) - 1)) == 0) {
+                cascade(static_cast<std::uint16_t>(level * kSlots + ((nextTick >> (kSlotBits * level)) & kSlotMask)));
+            }
+        }
+    }
+
+    /**
+     * @return First tick in [nextTick, end of its 256-tick block) with a
+     *         non-empty level 0 slot, or the start of the next block
+     */
+    std::uint64_t nextEvent() const {
+        std::uint64_t blockStart = nextTick & ~kSlotMask;
+        for (std::size_t word = (nextTick & kSlotMask) / 64; word < levelZeroUsed.size(); ++word) {
+            std::uint64_t bits = levelZeroUsed[word];
+            if (word == (nextTick & kSlotMask) / 64) {
+                bits &= ~std::uint64_t{0} << (nextTick % 64);
+            }
+            if (bits != 0) {
+                return blockStart + word * 64 + static_cast<std::uint64_t>(std::countr_zero(bits));
+            }
+        }
+        return blockStart + kSlots;
+    }
+
+    // ========================================================================
+    // POOL
+    // ========================================================================
+    std::uint32_t allocate() {
+        if (freeList != kNil) {
+            std::uint32_t index = freeList;
+            freeList = orders[index].next;
+            return index;
+        }
+        orders.emplace_back();
+        return static_cast<std::uint32_t>(orders.size() - 1);
+    }
+
+    void release(std::uint32_t index) {
+        Order &order = orders[index];
+        ++order.generation;
+        order.bucket = kNoBucket;
+        order.next = freeList;
+        freeList = index;
+        --live;
+    }
+
+    StandingOrderId schedule(const Order &fields) {
+        std::uint32_t index = allocate();
+        std::uint32_t generation = orders[index].generation;
+        orders[index] = fields;
+        orders[index].generation = generation;
+        link(index);
+        ++live;
+        return StandingOrderId{index, generation};
+    }
+
+    // ========================================================================
+    // FIRING
+    // ========================================================================
+    /**
+     * Executes the legs in the batch, dropping the ones that bounce until
+     * the rest go through (legOrders holds the order of each leg)
+     */
+    void executeTransfers(std::uint64_t tick, StandingOrderReport &report) {
+        while (!batch.empty()) {
+            batch.execute(batchResult);
+            ++report.batches;
+            if (batchResult.ok()) {
+                report.transfers += batch.size();
+                report.transferred += batchResult.grossAmount;
+                return;
+            }
+            // Keep only the legs that were rolled back for someone else's failure
+            retryOrders.clear();
+            for (std::size_t leg = 0; leg < legOrders.size(); ++leg) {
+                std::uint32_t index = legOrders[leg];
+                if (batchResult.legStatus[leg] == TransactionStatus::BatchAborted) {
+                    retryOrders.push_back(index);
+                } else {
+                    report.failures.push_back(StandingOrderFailure{
+                        StandingOrderId{index, orders[index].generation}, tick, batchResult.legStatus[leg]});
+                }
+            }
+            batch.clear();
+            legOrders.swap(retryOrders);
+            for (std::uint32_t index : legOrders) {
+                batch.add(orders[index].from, orders[index].to, Money::fromMinorUnits(orders[index].cents));
+            }
+        }
+    }
+
+    /**
+     * Fires every order in level 0 slot of nextTick
+     */
+    void fireTick(StandingOrderReport &report) {
+        const std::uint64_t tick = nextTick;
+        const std::uint16_t bucket = static_cast<std::uint16_t>(tick & kSlotMask);
+        firing.clear();
+        while (heads[bucket] != kNil) {
+            std::uint32_t index = heads[bucket];
+            assert(orders[index].due <= tick);
+            unlink(index);
+            firing.push_back(index);
+        }
+        report.fired += firing.size();
+
+        batch.clear();
+        legOrders.clear();
+        for (std::uint32_t index : firing) {
+            const Order &order = orders[index];
+            if (order.kind == StandingOrderKind::Interest) {
+                TransactionResult result = store->at(order.from).applyInterest(static_cast<RoundingMode>(order.rounding));
+                report.interest += result.amount;
+                ++report.interestPostings;
+            } else {
+                batch.add(order.from, order.to, Money::fromMinorUnits(order.cents));
+                legOrders.push_back(index);
+            }
+        }
+        executeTransfers(tick, report);
+
+        nextTick = tick + 1;   // Rescheduled orders are placed relative to the next tick
+        for (std::uint32_t index : firing) {
+            Order &order = orders[index];
+            if (order.period == 0) {
+                release(index);
+            } else {
+                order.due = tick + order.period;
+                link(index);
+            }
+        }
+    }
+
+public:
+    /**
+     * @param target Store the orders' accounts belong to
+     * @param startTick First tick that will fire
+     */
+    explicit StandingOrderScheduler(AccountStore &target, std::uint64_t startTick = 0)
+        : store(&target), nextTick(startTick), batch(target) {
+        heads.fill(kNil);
+    }
+
+    StandingOrderScheduler(const StandingOrderScheduler &) = delete;
+    StandingOrderScheduler &operator=(const StandingOrderScheduler &) = delete;
+
+    /**
+     * @param count Number of orders to make room for
+     */
+    void reserve(std::size_t count) {
+        orders.reserve(count);
+    }
+
+    // ========================================================================
+    // SCHEDULING (O(1))
+    // ========================================================================
+    /**
+     * Schedules a transfer
+     *
+     * @param from Slot of the account to debit
+     * @param to Slot of the account to credit
+     * @param amount Amount moved every time the order fires
+     * @param firstTick Tick it fires on first (a past tick fires on the next one)
+     * @param period Ticks between firings; 0 = fires once
+     * @return Handle to the order, or nullopt if the amount is not positive,
+     *         a slot does not exist or both slots are the same account
+     */
+    std::optional<StandingOrderId> scheduleTransfer(AccountSlot from, AccountSlot to, Money amount,
+                                                    std::uint64_t firstTick, std::uint32_t period = 0) {
+        if (!account_rules::isValidAmount(amount) || from >= store->size() || to >= store->size() ||
+            from == to) {
+            return std::nullopt;
+        }
+        Order order;
+        order.due = firstTick;
+        order.cents = amount.getMinorUnits();
+        order.from = from;
+        order.to = to;
+        order.period = period;
+        order.kind = StandingOrderKind::Transfer;
+        return schedule(order);
+    }
+
+    std::optional<StandingOrderId> scheduleTransfer(AccountRef from, AccountRef to, Money amount,
+                                                    std::uint64_t firstTick, std::uint32_t period = 0) {
+        return scheduleTransfer(from.getSlot(), to.getSlot(), amount, firstTick, period);
+    }
+
+    /**
+     * Schedules interest postings for one account
+     *
+     * @param account Slot of the account
+     * @param firstTick Tick of the first posting
+     * @param period Ticks between postings; 0 = posts once
+     * @param mode How to round the fractional cent
+     * @return Handle to the order, or nullopt if the slot does not exist
+     */
+    std::optional<StandingOrderId> scheduleInterest(AccountSlot account, std::uint64_t firstTick,
+                                                    std::uint32_t period,
+                                                    RoundingMode mode = RoundingMode::HalfEven) {
+        if (account >= store->size()) {
+            return std::nullopt;
+        }
+        Order order;
+        order.due = firstTick;
+        order.from = account;
+        order.period = period;
+        order.kind = StandingOrderKind::Interest;
+        order.rounding = static_cast<std::uint8_t>(mode);
+        return schedule(order);
+    }
+
+    /**
+     * Removes an order
+     * @return true if it was scheduled (false for a stale or unknown handle)
+     */
+    bool cancel(StandingOrderId id) {
+        if (!isScheduled(id)) {
+            return false;
+        }
+        unlink(id.index);
+        release(id.index);
+        return true;
+    }
+
+    // ========================================================================
+    // TIME
+    // ========================================================================
+    /**
+     * Fires every order due on the ticks up to and including `tick`, tick
+     * by tick
+     *
+     * @param tick Last tick to fire (nothing happens if it was fired already)
+     * @param report Receives what fired (overwritten)
+     */
+    void advanceTo(std::uint64_t tick, StandingOrderReport &report) {
+        report = StandingOrderReport();
+        while (nextTick <= tick) {
+            if (live == 0) {
+                nextTick = tick + 1;   // Nothing can fire; no bucket needs cascading
+                return;
+            }
+            if ((nextTick & kSlotMask) == 0) {
+                cascadeAt();
+            }
+            std::uint64_t event = nextEvent();
+            if (event != nextTick) {
+                // Skip the empty ticks, to a due slot or the next block start
+                nextTick = std::min(event, tick + 1);
+                continue;
+            }
+            fireTick(report);
+        }
+    }
+
+    /**
+     * Fires every order due up to and including `tick`
+     * @return What fired
+     */
+    StandingOrderReport advanceTo(std::uint64_t tick) {
+        StandingOrderReport report;
+        advanceTo(tick, report);
+        return report;
+    }
+
+    // ========================================================================
+    // GETTERS
+    // ========================================================================
+    /**
+     * @return First tick that has not fired yet
+     */
+    std::uint64_t getNextTick() const { return nextTick; }
+
+    /**
+     * @return Number of scheduled orders
+     */
+    std::size_t size() const { return live; }
+
+    bool empty() const { return live == 0; }
+
+    /**
+     * @return true if the handle names an order that is still scheduled
+     */
+    bool isScheduled(StandingOrderId id) const {
+        return id.index < orders.size() && orders[id.index].generation == id.generation &&
+               orders[id.index].bucket != kNoBucket;
+    }
+
+    /**
+     * @return Tick the order fires on next, or nullopt if it is not scheduled
+     */
+    std::optional<std::uint64_t> getNextDue(StandingOrderId id) const {
+        if (!isScheduled(id)) {
+            return std::nullopt;
+        }
+        return std::max(orders[id.index].due, nextTick);
+    }
+};
+
+#endif // STANDING_ORDERS_HPP
@@ -0,0 +1,442 @@
+#ifndef STATEMENT_RENDERER_HPP
+#define STATEMENT_RENDERER_HPP
+
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include <unistd.h>
+
+#include "account_id.hpp"
+#include "account_type.hpp"
+#include "money.hpp"
+
+/**
+ * ============================================================================
+ * STATEMENT RENDERER: many accounts, one buffer, one write
+ * ============================================================================
+ *
+ * Printing accounts through iostreams costs a formatted insertion per field,
+ * a flush per std::endl, and manipulators (setw, left) that stay set on the
+ * stream afterwards. StatementRenderer formats rows straight into a reusable
+ * buffer instead:
+ * - numbers go through std::to_chars (no locale, no stream state)
+ * - nothing is written until writeTo, which hands the whole buffer to the
+ *   destination in one write call
+ * - the buffer keeps its capacity, so a renderer reused for every batch of
+ *   a statement run stops allocating after the first batch
+ *
+ * LAYOUTS:
+ * - Csv:        header line, then one comma-separated row per account
+ *               (holder names quoted when needed, RFC 4180)
+ * - Json:       one array of objects; balance and rate are JSON numbers
+ * - FixedWidth: aligned columns for terminals and line printers
+ * - Card:       the multi-line block BankAccount::displayAccountInfo shows
+ *
+ * USAGE: append accounts (anything with the BankAccount getters, so both
+ * BankAccount and AccountRef work), writeTo whenever shouldFlush() says the
+ * batch is big enough, then finish() and a last writeTo. writeStatements
+ * does all of that for a whole store.
+ * ============================================================================
+ */
+
+/**
+ * Output format of a StatementRenderer
+ */
+enum class StatementLayout {
+    Csv,
+    Json,
+    FixedWidth,
+    Card
+};
+
+/**
+ * The fields of one statement row
+ */
+struct StatementRow {
+    AccountId accountNumber;
+    std::string_view holder;
+    AccountType type = AccountType::Savings;
+    Money balance;
+    InterestRate rate;
+};
+
+// ============================================================================
+// CLASS DEFINITION: StatementRenderer
+// ============================================================================
+class StatementRenderer {
+public:
+    static constexpr std::size_t kDefaultFlushBytes = 1 << 20;
+
+private:
+    // FixedWidth column widths (characters)
+    static constexpr std::size_t kNumberWidth = 12;
+    static constexpr std::size_t kHolderWidth = 25;
+    static constexpr std::size_t kTypeWidth = 10;
+    static constexpr std::size_t kBalanceWidth = 16;
+    static constexpr std::size_t kRateWidth = 8;
+
+    // Card layout, matching displayAccountInfo
+    static constexpr std::size_t kCardRuleWidth = 60;
+    static constexpr std::size_t kCardLabelWidth = 25;
+
+    StatementLayout layout;
+    std::size_t flushBytes;        // shouldFlush threshold
+    std::string buffer;            // Formatted, not yet written output
+    std::size_t rows = 0;          // Rows appended since the last finish()
+    bool finished = false;         // finish() called; the next row starts a new document
+
+    void appendInteger(std::uint64_t value) {
+        char digits[20];
+        auto [end, error] = std::to_chars(digits, digits + sizeof digits, value);
+        (void)error;
+        buffer.append(digits, end);
+    }
+
+    /**
+     * Appends a fixed-point value with two decimals ("-12.05")
+     */
+    void appendHundredths(std::int64_t value) {
+        std::uint64_t magnitude = value < 0 ? 0 - static_cast<std::uint64_t>(value)
+                                            : static_cast<std::uint64_t>(value);
+        if (value < 0) {
+            buffer.push_back('-');
+        }
+        appendInteger(magnitude / 100);
+        buffer.push_back('.');
+        buffer.push_back(static_cast<char>('0' + magnitude % 100 / 10));
+        buffer.push_back(static_cast<char>('0' + magnitude % 10));
+    }
+
+    void appendMoney(Money amount) {
+        appendHundredths(amount.getMinorUnits());
+    }
+
+    void appendRate(InterestRate rate) {
+        static_assert(InterestRate::kBasisPointsPerPercent == 100);
+        appendHundredths(rate.getBasisPoints());
+    }
+
+    void appendPadding(std::size_t count) {
+        buffer.append(count, ' ');
+    }
+
+    /**
+     * Appends text left-aligned in a field, cut so that at least one space
+     * separates it from the next column (UTF-8 aware: counts code points
+     * and never cuts one in half)
+     */
+    void appendLeft(std::string_view text, std::size_t width) {
+        const std::size_t limit = width - 1;
+        std::size_t characters = 0;
+        std::size_t bytes = 0;
+        for (; bytes < text.size(); ++bytes) {
+            bool startsCharacter = (static_cast<unsigned char>(text[bytes]) & 0xC0) != 0x80;
+            if (startsCharacter && characters++ == limit) {
+                --characters;
+                break;
+            }
+        }
+        buffer.append(text.substr(0, bytes));
+        appendPadding(width - characters);
+    }
+
+    /**
+     * Appends a number right-aligned in a field (formatted by the caller
+     * into the end of the buffer; this moves it into place)
+     */
+    template <class Format>
+    void appendRight(std::size_t width, Format format) {
+        std::size_t start = buffer.size();
+        format();
+        std::size_t length = buffer.size() - start;
+        if (length < width) {
+            buffer.insert(start, width - length, ' ');
+        }
+    }
+
+    void appendCsvField(std::string_view text) {
+        if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+            buffer.append(text);
+            return;
+        }
+        buffer.push_back('"');
+        for (char c : text) {
+            if (c == '"') {
+                buffer.push_back('"');
+            }
+            buffer.push_back(c);
+        }
+        buffer.push_back('"');
+    }
+
+    void appendJsonString(std::string_view text) {
+        static constexpr char kHex[] = "0123456789abcdef";
+        buffer.push_back('"');
+        for (char c : text) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                buffer.push_back('\\');
+                buffer.push_back(c);
+            } else if (byte < 0x20) {
+                buffer.append("\\u00");
+                buffer.push_back(kHex[byte >> 4]);
+                buffer.push_back(kHex[byte & 0xF]);
+            } else {
+                buffer.push_back(c);
+            }
+        }
+        buffer.push_back('"');
+    }
+
+    void appendCardLine(std::string_view label) {
+        buffer.append(label);
+        appendPadding(kCardLabelWidth - label.size());
+    }
+
+    /**
+     * Writes what goes before the first row (column headers, '[')
+     */
+    void appendPrologue() {
+        switch (layout) {
+        case StatementLayout::Csv:
+            buffer.append("account_number,holder,type,balance,interest_rate\n");
+            break;
+        case StatementLayout::Json:
+            buffer.append("[\n");
+            break;
+        case StatementLayout::FixedWidth:
+            appendLeft("ACCOUNT", kNumberWidth);
+            appendLeft("HOLDER", kHolderWidth);
+            appendLeft("TYPE", kTypeWidth);
+            appendRight(kBalanceWidth, [this] { buffer.append("BALANCE"); });
+            appendRight(kRateWidth, [this] { buffer.append("RATE%"); });
+            buffer.push_back('\n');
+            break;
+        case StatementLayout::Card:
+            break;
+        }
+    }
+
+public:
+    /**
+     * @param format The output layout
+     * @param flushAt Buffer size at which shouldFlush() turns true
+     */
+    explicit StatementRenderer(StatementLayout format = StatementLayout::FixedWidth,
+                               std::size_t flushAt = kDefaultFlushBytes)
+        : layout(format), flushBytes(flushAt) {
+        buffer.reserve(flushAt < kDefaultFlushBytes ? flushAt : kDefaultFlushBytes);
+    }
+
+    StatementLayout getLayout() const { return layout; }
+
+    /**
+     * Formats one row
+     * @param row The fields to render
+     */
+    void appendRow(const StatementRow &row) {
+        if (finished) {
+            finished = false;
+            rows = 0;
+        }
+        if (rows++ == 0) {
+            appendPrologue();
+        }
+
+        switch (layout) {
+        case StatementLayout::Csv:
+            buffer.append(row.accountNumber.text().view());
+            buffer.push_back(',');
+            appendCsvField(row.holder);
+            buffer.push_back(',');
+            buffer.append(toString(row.type));
+            buffer.push_back(',');
+            appendMoney(row.balance);
+            buffer.push_back(',');
+            appendRate(row.rate);
+            buffer.push_back('\n');
+            break;
+
+        case StatementLayout::Json:
+            if (rows > 1) {
+                buffer.append(",\n");
+            }
+            buffer.append("{\"account\":\"");
+            buffer.append(row.accountNumber.text().view());
+            buffer.append("\",\"holder\":");
+            appendJsonString(row.holder);
+            buffer.append(",\"type\":\"");
+            buffer.append(toString(row.type));
+            buffer.append("\",\"balance\":");
+            appendMoney(row.balance);
+            buffer.append(",\"rate\":");
+            appendRate(row.rate);
+            buffer.push_back('}');
+            break;
+
+        case StatementLayout::FixedWidth:
+            appendLeft(row.accountNumber.text().view(), kNumberWidth);
+            appendLeft(row.holder, kHolderWidth);
+            appendLeft(toString(row.type), kTypeWidth);
+            appendRight(kBalanceWidth, [&] { appendMoney(row.balance); });
+            appendRight(kRateWidth, [&] { appendRate(row.rate); });
+            buffer.push_back('\n');
+            break;
+
+        case StatementLayout::Card:
+            buffer.push_back('\n');
+            buffer.append(kCardRuleWidth, '=');
+            buffer.append("\nACCOUNT INFORMATION\n");
+            buffer.append(kCardRuleWidth, '=');
+            buffer.push_back('\n');
+            appendCardLine("Account Number:");
+            buffer.append(row.accountNumber.text().view());
+            buffer.push_back('\n');
+            appendCardLine("Account Holder:");
+            buffer.append(row.holder);
+            buffer.push_back('\n');
+            appendCardLine("Account Type:");
+            buffer.append(toString(row.type));
+            buffer.push_back('\n');
+            appendCardLine("Balance:");
+            buffer.push_back('$');
+            appendMoney(row.balance);
+            buffer.push_back('\n');
+            appendCardLine("Interest Rate:");
+            appendRate(row.rate);
+            buffer.append("%\n");
+            buffer.append(kCardRuleWidth, '=');
+            buffer.append("\n\n");
+            break;
+        }
+    }
+
+    /**
+     * Formats one account
+     * @param account A BankAccount, AccountRef or anything with the same getters
+     */
+    template <class Account>
+    void append(const Account &account) {
+        appendRow(StatementRow{account.getAccountNumber(), account.getAccountHolder(),
+                               account.getAccountType(), account.getBalance(),
+                               account.getInterestRate()});
+    }
+
+    /**
+     * Closes the document (the JSON array, or an empty one / a bare CSV
+     * header if no row was appended); the next row starts a new document
+     */
+    void finish() {
+        if (finished) {
+            return;
+        }
+        if (rows == 0) {
+            appendPrologue();
+        }
+        if (layout == StatementLayout::Json) {
+            buffer.append(rows == 0 ? "]\n" : "\n]\n");
+        }
+        finished = true;
+    }
+
+    /**
+     * @return true once the buffered output reached the flush threshold
+     */
+    bool shouldFlush() const {
+        return buffer.size() >= flushBytes;
+    }
+
+    /**
+     * @return The formatted output not written yet
+     */
+    std::string_view view() const {
+        return buffer;
+    }
+
+    /**
+     * @return Rows appended to the current document
+     */
+    std::size_t getRowCount() const {
+        return rows;
+    }
+
+    /**
+     * Drops the buffered output (keeps the capacity)
+     */
+    void clear() {
+        buffer.clear();
+    }
+
+    /**
+     * Writes the buffered output to a file descriptor in one write call
+     * (more only if the kernel accepts part of it) and empties the buffer
+     *
+     * @param fd Destination descriptor
+     * @return false if the write failed; the buffer is emptied either way
+     */
+    bool writeTo(int fd) {
+        const char *cursor = buffer.data();
+        std::size_t left = buffer.size();
+        bool ok = true;
+        while (left > 0) {
+            ssize_t n = ::write(fd, cursor, left);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ok = false;
+                break;
+            }
+            cursor += n;
+            left -= static_cast<std::size_t>(n);
+        }
+        buffer.clear();
+        return ok;
+    }
+
+    /**
+     * Writes the buffered output to a stream with one unformatted write
+     * (no flush, no change to the stream's formatting state) and empties
+     * the buffer
+     *
+     * @param out Destination stream
+     * @return false if the stream failed
+     */
+    bool writeTo(std::ostream &out) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+        return static_cast<bool>(out);
+    }
+};
+
+/**
+ * Renders a statement for every account of a store, writing in batches
+ *
+ * @param store An AccountStore (anything with size() and at(slot))
+ * @param layout Output layout
+ * @param fd Destination descriptor
+ * @param flushBytes Batch size in bytes
+ * @return false if a write failed
+ */
+template <class Store>
+bool writeStatements(Store &store, StatementLayout layout, int fd,
+                     std::size_t flushBytes = StatementRenderer::kDefaultFlushBytes) {
+    StatementRenderer renderer(layout, flushBytes);
+    bool ok = true;
+    for (std::size_t slot = 0; slot < store.size(); ++slot) {
+        renderer.append(store.at(static_cast<std::uint32_t>(slot)));
+        if (renderer.shouldFlush()) {
+            ok &= renderer.writeTo(fd);
+        }
+    }
+    renderer.finish();
+    ok &= renderer.writeTo(fd);
+    return ok;
+}
+
+#endif // STATEMENT_RENDERER_HPP
@@ -0,0 +1,226 @@
+#ifndef STORE_AGGREGATES_HPP
+#define STORE_AGGREGATES_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "account_type.hpp"
+#include "money.hpp"
+
+/**
+ * ============================================================================
+ * STORE AGGREGATES: running totals kept up to date by every mutation
+ * ============================================================================
+ *
+ * Answering "how much money is held, per account type?" by summing the
+ * balance column costs a full scan. AccountStore instead keeps running
+ * totals and adjusts them in every mutator, so reading them costs a few
+ * loads no matter how many accounts there are:
+ * - balance per AccountType (the overall total is their sum)
+ * - number of accounts, and of accounts with a zero balance
+ * - interest credited in the current period (until closeInterestPeriod)
+ *
+ * STRIPES: the counters are split into kStripes cache-line sized stripes.
+ * A thread always updates the same stripe (picked round-robin the first
+ * time it touches any store), so workers accruing disjoint ranges of one
+ * store at the same time (runMonthEnd) never fight over a cache line.
+ * Every update is a relaxed atomic add; a read combines the stripes.
+ *
+ * Reads may run on any thread while the store is being written. Each value
+ * is exact once the writers are idle; a read in the middle of a transfer
+ * between accounts of different types may see one side of it.
+ * ============================================================================
+ */
+
+/**
+ * The aggregates of one store at one moment
+ */
+struct StoreTotals {
+    std::array<Money, kAccountTypeCount> byType{};   // Balance held per AccountType
+    std::size_t accounts = 0;                        // Accounts in the store
+    std::size_t zeroBalanceAccounts = 0;             // Accounts whose balance is exactly zero
+    Money interestThisPeriod;                        // Interest credited since the period opened
+
+    /**
+     * @return Total money held in the store
+     */
+    Money total() const {
+        Money sum;
+        for (Money part : byType) {
+            sum += part;
+        }
+        return sum;
+    }
+
+    /**
+     * @return Money held in accounts of one type
+     */
+    Money of(AccountType type) const {
+        return byType[static_cast<std::size_t>(type)];
+    }
+};
+
+// ============================================================================
+// CLASS DEFINITION: StoreAggregates
+// ============================================================================
+class StoreAggregates {
+public:
+    static constexpr std::size_t kStripes = 16;
+
+private:
+    struct alignas(64) Stripe {
+        std::array<std::atomic<std::int64_t>, kAccountTypeCount> byType{};   // Cents
+        std::atomic<std::int64_t> accounts{0};
+        std::atomic<std::int64_t> zeroBalance{0};
+        std::atomic<std::int64_t> interest{0};                              // Cents, this period
+    };
+
+    std::array<Stripe, kStripes> stripes;
+
+    /**
+     * @return This thread's stripe index (the same for every store)
+     */
+    static std::size_t stripeIndex() {
+        static std::atomic<std::size_t> nextStripe{0};
+        thread_local const std::size_t mine = nextStripe.fetch_add(1, std::memory_order_relaxed) % kStripes;
+        return mine;
+    }
+
+    Stripe &mine() { return stripes[stripeIndex()]; }
+
+    static void add(std::atomic<std::int64_t> &counter, std::int64_t delta) {
+        counter.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+public:
+    StoreAggregates() = default;
+    StoreAggregates(const StoreAggregates &) = delete;
+    StoreAggregates &operator=(const StoreAggregates &) = delete;
+
+    /**
+     * Records a balance change of one account
+     *
+     * @param type The account's type
+     * @param before Balance in cents before the change
+     * @param after Balance in cents after the change
+     */
+    void onBalanceChange(AccountType type, std::int64_t before, std::int64_t after) {
+        Stripe &stripe = mine();
+        add(stripe.byType[static_cast<std::size_t>(type)], after - before);
+        if ((before == 0) != (after == 0)) {
+            add(stripe.zeroBalance, after == 0 ? 1 : -1);
+        }
+    }
+
+    /**
+     * Records a new account
+     */
+    void onOpen(AccountType type, std::int64_t balance) {
+        Stripe &stripe = mine();
+        add(stripe.accounts, 1);
+        add(stripe.byType[static_cast<std::size_t>(type)], balance);
+        if (balance == 0) {
+            add(stripe.zeroBalance, 1);
+        }
+    }
+
+    /**
+     * Records interest credited to one account (interest never moves a
+     * balance to or from zero)
+     */
+    void onInterest(AccountType type, std::int64_t interest) {
+        Stripe &stripe = mine();
+        add(stripe.byType[static_cast<std::size_t>(type)], interest);
+        add(stripe.interest, interest);
+    }
+
+    /**
+     * Records the outcome of a batch in one go
+     *
+     * @param typeDeltas Net balance change, in cents, per AccountType
+     * @param zeroDelta Change in the number of zero-balance accounts
+     * @param interest Interest credited by the batch, in cents
+     */
+    void onBatch(const std::array<std::int64_t, kAccountTypeCount> &typeDeltas, std::int64_t zeroDelta,
+                 std::int64_t interest = 0) {
+        Stripe &stripe = mine();
+        for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+            if (typeDeltas[t] != 0) {
+                add(stripe.byType[t], typeDeltas[t]);
+            }
+        }
+        if (zeroDelta != 0) {
+            add(stripe.zeroBalance, zeroDelta);
+        }
+        if (interest != 0) {
+            add(stripe.interest, interest);
+        }
+    }
+
+    /**
+     * Combines the stripes (safe to call from any thread at any time)
+     * @return The current totals
+     */
+    StoreTotals read() const {
+        std::array<std::int64_t, kAccountTypeCount> byType{};
+        std::int64_t accounts = 0;
+        std::int64_t zeroBalance = 0;
+        std::int64_t interest = 0;
+        for (const Stripe &stripe : stripes) {
+            for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+                byType[t] += stripe.byType[t].load(std::memory_order_relaxed);
+            }
+            accounts += stripe.accounts.load(std::memory_order_relaxed);
+            zeroBalance += stripe.zeroBalance.load(std::memory_order_relaxed);
+            interest += stripe.interest.load(std::memory_order_relaxed);
+        }
+        StoreTotals totals;
+        for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+            totals.byType[t] = Money::fromMinorUnits(byType[t]);
+        }
+        totals.accounts = static_cast<std::size_t>(accounts);
+        totals.zeroBalanceAccounts = static_cast<std::size_t>(zeroBalance);
+        totals.interestThisPeriod = Money::fromMinorUnits(interest);
+        return totals;
+    }
+
+    /**
+     * Starts a new interest period (writer only)
+     * @return Interest credited during the period that just ended
+     */
+    Money closeInterestPeriod() {
+        std::int64_t interest = 0;
+        for (const Stripe &stripe : stripes) {
+            interest += stripe.interest.load(std::memory_order_relaxed);
+        }
+        // Subtracting keeps any add racing with the close
+        add(mine().interest, -interest);
+        return Money::fromMinorUnits(interest);
+    }
+
+    /**
+     * Replaces every counter (writer only, no concurrent updates)
+     * @param totals The new values
+     */
+    void reset(const StoreTotals &totals = StoreTotals()) {
+        for (Stripe &stripe : stripes) {
+            for (std::atomic<std::int64_t> &counter : stripe.byType) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+            stripe.accounts.store(0, std::memory_order_relaxed);
+            stripe.zeroBalance.store(0, std::memory_order_relaxed);
+            stripe.interest.store(0, std::memory_order_relaxed);
+        }
+        Stripe &first = stripes[0];
+        for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+            first.byType[t].store(totals.byType[t].getMinorUnits(), std::memory_order_relaxed);
+        }
+        first.accounts.store(static_cast<std::int64_t>(totals.accounts), std::memory_order_relaxed);
+        first.zeroBalance.store(static_cast<std::int64_t>(totals.zeroBalanceAccounts), std::memory_order_relaxed);
+        first.interest.store(totals.interestThisPeriod.getMinorUnits(), std::memory_order_relaxed);
+    }
+};
+
+#endif // STORE_AGGREGATES_HPP
@@ -0,0 +1,269 @@
+#ifndef STORE_COLUMN_HPP
+#define STORE_COLUMN_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * ============================================================================
+ * STORE COLUMNS: contiguous arrays that can live in a mapped snapshot
+ * ============================================================================
+ *
+ * AccountStore keeps each field in its own column. A column normally owns
+ * heap memory and grows like std::vector, but it can also ADOPT a region of
+ * a memory-mapped snapshot file (see snapshot.hpp). An adopted column is
+ * used in place: nothing is parsed or copied when the store is restored,
+ * pages are faulted in on first touch, and writes go to private
+ * copy-on-write pages, never back to the file. The first append past the
+ * adopted size moves the column to the heap.
+ *
+ * HolderColumn does the same for the cold holder-name table: names from a
+ * snapshot are string_views into the mapping; only names added or changed
+ * after the restore are heap strings.
+ * ============================================================================
+ */
+
+// ============================================================================
+// CLASS DEFINITION: Column
+// ============================================================================
+template <class T>
+class Column {
+    static_assert(std::is_trivially_copyable_v<T>, "columns are copied and mapped as raw bytes");
+
+private:
+    // Cache-line aligned, so SIMD kernels never split a load at the start
+    static constexpr std::align_val_t kAlignment{64};
+
+    T *items = nullptr;                    // First element (heap or mapping)
+    std::size_t count = 0;                 // Elements in use
+    std::size_t capacity = 0;              // Elements that fit without moving
+    std::shared_ptr<void> mapping;         // Keeps an adopted mapping alive (nullptr = heap)
+
+    void release() {
+        if (!mapping && items) {
+            ::operator delete(items, kAlignment);
+        }
+        mapping.reset();
+        items = nullptr;
+        capacity = 0;
+    }
+
+    /**
+     * Moves the elements to a heap block of at least minCapacity elements
+     */
+    void moveToHeap(std::size_t minCapacity) {
+        std::size_t target = std::max<std::size_t>({minCapacity, capacity * 2, 16});
+        T *fresh = static_cast<T *>(::operator new(target * sizeof(T), kAlignment));
+        if (count > 0) {
+            std::memcpy(fresh, items, count * sizeof(T));
+        }
+        std::size_t used = count;
+        release();
+        items = fresh;
+        count = used;
+        capacity = target;
+    }
+
+public:
+    Column() = default;
+
+    ~Column() { release(); }
+
+    // Copies always own their memory
+    Column(const Column &other) {
+        if (other.count > 0) {
+            items = static_cast<T *>(::operator new(other.count * sizeof(T), kAlignment));
+            std::memcpy(items, other.items, other.count * sizeof(T));
+            count = other.count;
+            capacity = other.count;
+        }
+    }
+
+    Column &operator=(const Column &other) {
+        if (this != &other) {
+            Column copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    Column(Column &&other) noexcept
+        : items(std::exchange(other.items, nullptr)),
+          count(std::exchange(other.count, 0)),
+          capacity(std::exchange(other.capacity, 0)),
+          mapping(std::move(other.mapping)) {}
+
+    Column &operator=(Column &&other) noexcept {
+        if (this != &other) {
+            release();
+            items = std::exchange(other.items, nullptr);
+            count = std::exchange(other.count, 0);
+            capacity = std::exchange(other.capacity, 0);
+            mapping = std::move(other.mapping);
+        }
+        return *this;
+    }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    T *data() { return items; }
+    const T *data() const { return items; }
+
+    T &operator[](std::size_t i) { return items[i]; }
+    const T &operator[](std::size_t i) const { return items[i]; }
+
+    T &back() { return items[count - 1]; }
+
+    T *begin() { return items; }
+    T *end() { return items + count; }
+    const T *begin() const { return items; }
+    const T *end() const { return items + count; }
+
+    operator std::span<T>() { return {items, count}; }
+    operator std::span<const T>() const { return {items, count}; }
+
+    /**
+     * @return true if the column is viewing a mapped snapshot
+     */
+    bool isMapped() const { return mapping != nullptr; }
+
+    void reserve(std::size_t wanted) {
+        if (wanted > capacity) {
+            moveToHeap(wanted);
+        }
+    }
+
+    void push_back(const T &value) {
+        if (count == capacity) {
+            T copy = value;   // value may live in this column
+            moveToHeap(count + 1);
+            items[count++] = copy;
+            return;
+        }
+        items[count++] = value;
+    }
+
+    /**
+     * Grows or shrinks to n elements; new ones are set to fill
+     */
+    void resize(std::size_t n, const T &fill = T()) {
+        reserve(n);
+        for (std::size_t i = count; i < n; ++i) {
+            items[i] = fill;
+        }
+        count = n;
+    }
+
+    void clear() {
+        release();
+        count = 0;
+    }
+
+    /**
+     * Views n elements of a mapped region in place (replaces the contents)
+     *
+     * @param mapped First element inside the mapping (privately writable)
+     * @param n Number of elements
+     * @param owner Keeps the mapping alive as long as the column uses it
+     */
+    void adopt(T *mapped, std::size_t n, std::shared_ptr<void> owner) {
+        release();
+        items = mapped;
+        count = n;
+        capacity = n;
+        mapping = std::move(owner);
+    }
+};
+
+// ============================================================================
+// CLASS DEFINITION: HolderColumn
+// ============================================================================
+/**
+ * Holder name for every slot
+ * Slots [0, baseCount) come from a mapped snapshot (offset table + text);
+ * later slots and renamed ones are heap strings.
+ */
+class HolderColumn {
+private:
+    const std::uint64_t *baseOffsets = nullptr;   // baseCount + 1 offsets into baseText
+    const char *baseText = nullptr;               // Concatenated snapshot names
+    std::size_t baseCount = 0;                    // Names provided by the snapshot
+    std::shared_ptr<void> mapping;                // Keeps the snapshot alive
+
+    std::vector<std::string> added;                        // Slots >= baseCount
+    std::unordered_map<std::size_t, std::string> renamed;  // Snapshot slots changed since
+
+public:
+    std::size_t size() const { return baseCount + added.size(); }
+
+    void reserve(std::size_t wanted) {
+        if (wanted > baseCount) {
+            added.reserve(wanted - baseCount);
+        }
+    }
+
+    void push_back(std::string name) {
+        added.push_back(std::move(name));
+    }
+
+    /**
+     * @return The holder name of a slot (valid until that slot changes or
+     *         another name is added)
+     */
+    std::string_view operator[](std::size_t slot) const {
+        if (slot >= baseCount) {
+            return added[slot - baseCount];
+        }
+        if (!renamed.empty()) {
+            auto it = renamed.find(slot);
+            if (it != renamed.end()) {
+                return it->second;
+            }
+        }
+        return std::string_view(baseText + baseOffsets[slot],
+                                static_cast<std::size_t>(baseOffsets[slot + 1] - baseOffsets[slot]));
+    }
+
+    void set(std::size_t slot, std::string name) {
+        if (slot >= baseCount) {
+            added[slot - baseCount] = std::move(name);
+        } else {
+            renamed[slot] = std::move(name);
+        }
+    }
+
+    void clear() {
+        *this = HolderColumn();
+    }
+
+    /**
+     * Views the names of a mapped snapshot (replaces the contents)
+     *
+     * @param offsets count + 1 byte offsets; name i is text[offsets[i], offsets[i + 1])
+     * @param text The concatenated names
+     * @param count Number of names
+     * @param owner Keeps the mapping alive
+     */
+    void adopt(const std::uint64_t *offsets, const char *text, std::size_t count,
+               std::shared_ptr<void> owner) {
+        clear();
+        baseOffsets = offsets;
+        baseText = text;
+        baseCount = count;
+        mapping = std::move(owner);
+    }
+};
+
+#endif // STORE_COLUMN_HPP
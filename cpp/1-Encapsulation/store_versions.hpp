@@ -0,0 +1,410 @@
+#ifndef STORE_VERSIONS_HPP
+#define STORE_VERSIONS_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "account_id.hpp"
+#include "account_store.hpp"
+#include "account_type.hpp"
+#include "money.hpp"
+#include "store_aggregates.hpp"
+
+/**
+ * ============================================================================
+ * STORE VERSIONS: point-in-time copies that readers scan while posting runs
+ * ============================================================================
+ *
+ * AccountStore has one writer. A report that reads every balance from
+ * another thread would race with it, and stopping the writer for the
+ * length of the scan stalls posting. StoreVersions keeps immutable
+ * VERSIONS of the hot columns (balance, rate, type, account number)
+ * instead:
+ * - publish() runs on the writer, between operations, and makes the
+ *   store's current state the newest version. Versions are split into
+ *   pages of kVersionPageAccounts accounts; only pages the store flagged
+ *   as changed since the previous version are copied, the others are
+ *   shared with it. Publishing after a batch that touched 1% of a large
+ *   store copies about 1% of it.
+ * - acquire() runs on any thread and returns a StoreView of the newest
+ *   version. A view never changes and never blocks the writer: readers
+ *   scan plain arrays at full speed while the store keeps mutating.
+ *
+ * RECLAMATION (epoch based):
+ * A page replaced by publish() is still visible to views of older
+ * versions. Each acquire() pins the current epoch in a reader slot and
+ * each publish() retires the pages it replaced at the epoch it ends. A
+ * retired page is reused once every pinned reader is newer than it; the
+ * writer checks this at each publish() (or reclaim()). Readers take no
+ * locks and write only their own slot; a view held for a long time only
+ * delays reuse of the pages retired after it was acquired.
+ *
+ * A lazily accruing store is settled by publish(), so versions always
+ * include every elapsed interest period. Holder names are not versioned.
+ *
+ * One StoreVersions per store: publish() clears the store's change flags.
+ * Every StoreView must be released before its StoreVersions is destroyed.
+ * ============================================================================
+ */
+
+class StoreVersions;
+
+/**
+ * One page of a version: the hot columns of kVersionPageAccounts slots
+ */
+struct VersionPage {
+    std::int64_t balances[kVersionPageAccounts];
+    std::int32_t rates[kVersionPageAccounts];
+    AccountId accountNumbers[kVersionPageAccounts];
+    AccountType types[kVersionPageAccounts];
+};
+
+/**
+ * The spans of one page of a StoreView (trimmed to the accounts it holds)
+ */
+struct VersionPageView {
+    std::span<const std::int64_t> balances;
+    std::span<const std::int32_t> rates;
+    std::span<const AccountId> accountNumbers;
+    std::span<const AccountType> types;
+};
+
+// ============================================================================
+// CLASS DEFINITION: StoreView
+// ============================================================================
+/**
+ * Read handle on one published version
+ * Move-only; releasing it (destruction) unpins its reader slot. All reads
+ * are of immutable memory, so a view may be scanned from any one thread
+ * while the store is being written.
+ */
+class StoreView {
+public:
+    struct Version {
+        std::uint64_t number = 0;                // 1 for the first published version
+        std::size_t accounts = 0;                // Slots [0, accounts) are in the version
+        StoreTotals totals;                      // store.totals() when it was published
+        std::vector<VersionPage *> pages;        // Never written once published
+    };
+
+private:
+    friend class StoreVersions;
+
+    StoreVersions *owner = nullptr;   // nullptr once moved from
+    std::size_t reader = 0;           // Pinned reader slot
+    const Version *version = nullptr;
+
+    StoreView(StoreVersions &versions, std::size_t slot, const Version *pinned)
+        : owner(&versions), reader(slot), version(pinned) {}
+
+    void release();
+
+public:
+    StoreView(const StoreView &) = delete;
+    StoreView &operator=(const StoreView &) = delete;
+
+    StoreView(StoreView &&other) noexcept
+        : owner(std::exchange(other.owner, nullptr)), reader(other.reader), version(other.version) {}
+
+    StoreView &operator=(StoreView &&other) noexcept {
+        if (this != &other) {
+            release();
+            owner = std::exchange(other.owner, nullptr);
+            reader = other.reader;
+            version = other.version;
+        }
+        return *this;
+    }
+
+    ~StoreView() { release(); }
+
+    // ========================================================================
+    // GETTERS
+    // ========================================================================
+    std::uint64_t getVersion() const { return version->number; }
+    std::size_t size() const { return version->accounts; }
+    const StoreTotals &getTotals() const { return version->totals; }
+
+    Money getBalance(AccountSlot slot) const {
+        return Money::fromMinorUnits(
+            version->pages[slot >> kVersionPageShift]->balances[slot % kVersionPageAccounts]);
+    }
+
+    InterestRate getInterestRate(AccountSlot slot) const {
+        return InterestRate::fromBasisPoints(
+            version->pages[slot >> kVersionPageShift]->rates[slot % kVersionPageAccounts]);
+    }
+
+    AccountId getAccountNumber(AccountSlot slot) const {
+        return version->pages[slot >> kVersionPageShift]->accountNumbers[slot % kVersionPageAccounts];
+    }
+
+    AccountType getAccountType(AccountSlot slot) const {
+        return version->pages[slot >> kVersionPageShift]->types[slot % kVersionPageAccounts];
+    }
+
+    // ========================================================================
+    // SCANS (one contiguous span per page)
+    // ========================================================================
+    std::size_t pageCount() const { return version->pages.size(); }
+
+    /**
+     * @param page Page index (< pageCount()); holds slots from page * kVersionPageAccounts
+     * @return The page's columns, trimmed to the accounts of the version
+     */
+    VersionPageView getPage(std::size_t page) const {
+        const VersionPage *p = version->pages[page];
+        std::size_t used = std::min(kVersionPageAccounts, version->accounts - page * kVersionPageAccounts);
+        return VersionPageView{{p->balances, used}, {p->rates, used}, {p->accountNumbers, used},
+                               {p->types, used}};
+    }
+
+    /**
+     * Sums every balance of the version (one pass over its pages)
+     * @return Total money held at the version's point in time
+     */
+    Money totalBalance() const {
+        std::int64_t total = 0;
+        for (std::size_t page = 0; page < pageCount(); ++page) {
+            for (std::int64_t cents : getPage(page).balances) {
+                total += cents;
+            }
+        }
+        return Money::fromMinorUnits(total);
+    }
+};
+
+// ============================================================================
+// CLASS DEFINITION: StoreVersions
+// ============================================================================
+class StoreVersions {
+public:
+    static constexpr std::size_t kMaxReaders = 64;   // Views alive at the same time
+
+private:
+    friend class StoreView;
+
+    using Version = StoreView::Version;
+
+    // A reader's pinned epoch (0 = slot free), one cache line per reader
+    struct alignas(64) ReaderSlot {
+        std::atomic<std::uint64_t> pinned{0};
+    };
+
+    // Pages (and the version table) a publish replaced, freed after epoch
+    struct Retired {
+        std::uint64_t epoch;
+        const Version *version;
+        std::vector<VersionPage *> pages;
+    };
+
+    AccountStore *store;
+    std::atomic<const Version *> current{nullptr};
+    std::atomic<std::uint64_t> epoch{1};
+    std::array<ReaderSlot, kMaxReaders> readers;
+
+    // Writer-only state
+    std::deque<Retired> retired;       // Oldest epoch first
+    std::vector<VersionPage *> spare;  // Reclaimed pages, reused before allocating
+
+    VersionPage *takePage() {
+        if (spare.empty()) {
+            return new VersionPage;
+        }
+        VersionPage *page = spare.back();
+        spare.pop_back();
+        return page;
+    }
+
+    /**
+     * Copies one page of the store's hot columns
+     */
+    VersionPage *copyPage(std::size_t page) {
+        VersionPage *copy = takePage();
+        std::size_t first = page * kVersionPageAccounts;
+        std::size_t used = std::min(kVersionPageAccounts, store->balances.size() - first);
+        std::memcpy(copy->balances, store->balances.data() + first, used * sizeof(std::int64_t));
+        std::memcpy(copy->rates, store->rates.data() + first, used * sizeof(std::int32_t));
+        std::memcpy(copy->accountNumbers, store->accountNumbers.data() + first, used * sizeof(AccountId));
+        std::memcpy(copy->types, store->types.data() + first, used * sizeof(AccountType));
+        return copy;
+    }
+
+    /**
+     * @return Flag of one page, cleared (writer thread only)
+     */
+    bool takeChanged(std::size_t page) {
+        if (page >= store->changedPages.size()) {
+            return true;
+        }
+        std::atomic_ref<std::uint8_t> flag(store->changedPages[page]);
+        return flag.exchange(0, std::memory_order_relaxed) != 0;
+    }
+
+public:
+    /**
+     * Publishes the store's current state as the first version
+     * @param owner The store to version; must outlive this object
+     */
+    explicit StoreVersions(AccountStore &owner) : store(&owner) {
+        publish();
+    }
+
+    StoreVersions(const StoreVersions &) = delete;
+    StoreVersions &operator=(const StoreVersions &) = delete;
+
+    ~StoreVersions() {
+        for (const ReaderSlot &slot : readers) {
+            assert(slot.pinned.load(std::memory_order_relaxed) == 0 &&
+                   "a StoreView outlived its StoreVersions");
+            (void)slot;
+        }
+        const Version *last = current.load(std::memory_order_relaxed);
+        for (const VersionPage *page : last->pages) {
+            delete page;
+        }
+        delete last;
+        for (Retired &entry : retired) {
+            delete entry.version;
+            for (VersionPage *page : entry.pages) {
+                delete page;
+            }
+        }
+        for (VersionPage *page : spare) {
+            delete page;
+        }
+    }
+
+    // ========================================================================
+    // WRITER SIDE (the store's thread)
+    // ========================================================================
+    /**
+     * Makes the store's current state the newest version
+     * Copies the pages changed since the previous version and shares the
+     * rest; settles a lazily accruing store first.
+     *
+     * @return The new version's number
+     */
+    std::uint64_t publish() {
+        store->settleInterest();
+        const Version *previous = current.load(std::memory_order_relaxed);
+        const std::size_t accounts = store->size();
+        const std::size_t pageCount = (accounts + kVersionPageAccounts - 1) >> kVersionPageShift;
+
+        auto *next = new Version;
+        next->number = previous ? previous->number + 1 : 1;
+        next->accounts = accounts;
+        next->totals = store->totals();
+        next->pages.resize(pageCount);
+
+        std::vector<VersionPage *> replaced;
+        const std::size_t previousPages = previous ? previous->pages.size() : 0;
+        for (std::size_t page = 0; page < pageCount; ++page) {
+            bool changed = takeChanged(page) || page >= previousPages;
+            if (!changed) {
+                next->pages[page] = previous->pages[page];
+                continue;
+            }
+            next->pages[page] = copyPage(page);
+            if (page < previousPages) {
+                replaced.push_back(previous->pages[page]);
+            }
+        }
+        for (std::size_t page = pageCount; page < previousPages; ++page) {
+            replaced.push_back(previous->pages[page]);   // Store shrank (restore)
+        }
+
+        current.store(next, std::memory_order_seq_cst);
+        if (previous) {
+            // Readers pinned at this epoch or earlier may still see previous
+            std::uint64_t retiredAt = epoch.fetch_add(1, std::memory_order_seq_cst);
+            retired.push_back(Retired{retiredAt, previous, std::move(replaced)});
+        }
+        reclaim();
+        return next->number;
+    }
+
+    /**
+     * Reuses every retired page no reader can see any more
+     * @return Number of pages reclaimed
+     */
+    std::size_t reclaim() {
+        std::uint64_t oldestPinned = std::numeric_limits<std::uint64_t>::max();
+        for (const ReaderSlot &slot : readers) {
+            std::uint64_t pinned = slot.pinned.load(std::memory_order_seq_cst);
+            if (pinned != 0) {
+                oldestPinned = std::min(oldestPinned, pinned);
+            }
+        }
+        std::size_t reclaimed = 0;
+        while (!retired.empty() && retired.front().epoch < oldestPinned) {
+            Retired &entry = retired.front();
+            delete entry.version;
+            reclaimed += entry.pages.size();
+            spare.insert(spare.end(), entry.pages.begin(), entry.pages.end());
+            retired.pop_front();
+        }
+        return reclaimed;
+    }
+
+    /**
+     * @return Pages replaced by publish() that readers may still see
+     */
+    std::size_t getRetiredPages() const {
+        std::size_t pages = 0;
+        for (const Retired &entry : retired) {
+            pages += entry.pages.size();
+        }
+        return pages;
+    }
+
+    // ========================================================================
+    // READER SIDE (any thread)
+    // ========================================================================
+    /**
+     * Pins the newest version
+     * @return A view of it, or nullopt if kMaxReaders views are already alive
+     */
+    std::optional<StoreView> acquire() {
+        for (std::size_t i = 0; i < kMaxReaders; ++i) {
+            std::atomic<std::uint64_t> &pinned = readers[i].pinned;
+            if (pinned.load(std::memory_order_relaxed) != 0) {
+                continue;
+            }
+            std::uint64_t idle = 0;
+            if (pinned.compare_exchange_strong(idle, epoch.load(std::memory_order_seq_cst),
+                                               std::memory_order_seq_cst)) {
+                // Any version retired at or after the pinned epoch stays alive
+                return StoreView(*this, i, current.load(std::memory_order_seq_cst));
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @return Number of the newest version
+     */
+    std::uint64_t getPublishedVersion() const {
+        return current.load(std::memory_order_acquire)->number;
+    }
+};
+
+inline void StoreView::release() {
+    if (owner) {
+        owner->readers[reader].pinned.store(0, std::memory_order_release);
+        owner = nullptr;
+    }
+}
+
+#endif // STORE_VERSIONS_HPP
@@ -0,0 +1,338 @@
+#ifndef STRIPED_ACCOUNT_HPP
+#define STRIPED_ACCOUNT_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "account_id.hpp"
+#include "account_type.hpp"
+#include "cache_line.hpp"
+#include "money.hpp"
+#include "operation_metrics.hpp"
+#include "transaction.hpp"
+
+/**
+ * ============================================================================
+ * StripedAccount: a hot account that many threads credit at once
+ * ============================================================================
+ *
+ * A merchant account receiving most of the payments is one atomic balance
+ * in a ConcurrentAccount, so every deposit from every core serializes on a
+ * single cache line. StripedAccount splits incoming money over kStripes
+ * cache-line sized CREDIT stripes:
+ * - deposit adds to the calling thread's stripe (picked round-robin the
+ *   first time the thread deposits anywhere), so up to kStripes threads
+ *   credit the account without touching each other's lines
+ * - withdraw takes money from a separate SPENDABLE balance with a CAS
+ *   loop. When that is short it first folds every stripe into it, so a
+ *   withdrawal is refused only if the whole balance is short: the account
+ *   can never be overdrawn
+ * - getBalance adds spendable and stripes; applyInterest folds first and
+ *   pays interest on the whole balance
+ *
+ * Folds are rare (only when spendable runs out) and are counted by a
+ * sequence word: readers retry while one is in flight, so they never count
+ * folded money twice or not at all. Deposits and withdrawals never wait
+ * for readers.
+ *
+ * OVERFLOW:
+ * A deposit the balance cannot hold (past INT64_MAX cents) is refused
+ * with InvalidAmount, as in every other account. A stripe holds at most
+ * kStripeLimit, and the stripes are open only while spendable is at most
+ * kOpenSpendableLimit, so a deposit that fits its own stripe always fits
+ * the balance. Any other deposit folds under the sequence word and is
+ * checked against the exact balance. A fold closes the stripes while it
+ * runs (a deposit arriving then waits for it, as folds are rare) and
+ * leaves them closed while spendable is over its limit.
+ *
+ * Reading the balance touches every stripe, so deposit reports only its
+ * status; call getBalance when the total is needed. The total is exact
+ * once the writers are idle. While they run it is a value consistent with
+ * some order of the operations in flight.
+ * ============================================================================
+ */
+class StripedAccount {
+public:
+    static constexpr std::size_t kStripes = 16;
+
+private:
+    struct alignas(kCacheLineSize) Stripe {
+        std::atomic<std::int64_t> credits{0};   // Cents deposited through this stripe, not yet folded
+    };
+
+    static constexpr std::int64_t kMaxCents = std::numeric_limits<std::int64_t>::max();
+    static constexpr std::int64_t kStripeLimit = kMaxCents / 2 / kStripes;   // Most cents one stripe holds
+    // Spendable up to this leaves room for every stripe to fill up
+    static constexpr std::int64_t kOpenSpendableLimit =
+        kMaxCents - static_cast<std::int64_t>(kStripes) * kStripeLimit;
+    static constexpr std::int64_t kClosed = std::numeric_limits<std::int64_t>::min();   // Stripe takes no deposits
+
+    const AccountId accountNumber;          // Unique identifier for the account
+    const std::string accountHolder;        // Name of the account holder
+    const AccountType accountType;          // Type of account (Savings, Checking)
+    std::atomic<std::int32_t> interestRate; // Interest rate in basis points
+
+    // Written by withdraw and folds; kept off the stripes' lines
+    alignas(kCacheLineSize) std::atomic<std::int64_t> spendable;   // Cents withdrawals draw from
+    std::atomic<std::uint64_t> folds;       // Fold seqlock: odd = credits being moved
+    std::array<Stripe, kStripes> stripes;
+
+    /**
+     * @return This thread's stripe index (the same for every account)
+     */
+    static std::size_t stripeIndex() {
+        static std::atomic<std::size_t> nextStripe{0};
+        thread_local const std::size_t mine = nextStripe.fetch_add(1, std::memory_order_relaxed) % kStripes;
+        return mine;
+    }
+
+    /**
+     * Claims the fold sequence (even -> odd), waiting out another fold
+     */
+    std::uint64_t lockFolds() {
+        std::uint64_t current = folds.load(std::memory_order_relaxed);
+        for (;;) {
+            if ((current & 1) == 0 &&
+                folds.compare_exchange_weak(current, current + 1, std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+                return current + 1;
+            }
+            std::this_thread::yield();
+            current = folds.load(std::memory_order_relaxed);
+        }
+    }
+
+    void unlockFolds(std::uint64_t locked) {
+        folds.store(locked + 1, std::memory_order_release);
+    }
+
+    /**
+     * Moves every stripe's credits into spendable and closes the stripes
+     * (fold sequence held); reopenLocked opens them again
+     * @return Cents moved
+     */
+    std::int64_t foldLocked() {
+        std::int64_t moved = 0;
+        for (Stripe &stripe : stripes) {
+            std::int64_t credits = stripe.credits.exchange(kClosed, std::memory_order_acq_rel);
+            moved += credits == kClosed ? 0 : credits;
+        }
+        if (moved != 0) {
+            spendable.fetch_add(moved, std::memory_order_acq_rel);
+        }
+        return moved;
+    }
+
+    /**
+     * Opens the stripes to deposits if spendable leaves room for all of
+     * them (fold sequence held; only withdrawals change spendable meanwhile)
+     */
+    void reopenLocked() {
+        if (spendable.load(std::memory_order_acquire) <= kOpenSpendableLimit) {
+            for (Stripe &stripe : stripes) {
+                stripe.credits.store(0, std::memory_order_release);
+            }
+        }
+    }
+
+    /**
+     * Deposits into spendable after a fold, against the exact balance
+     * @return Success, or InvalidAmount if the balance cannot hold the amount
+     */
+    TransactionStatus depositFolded(std::int64_t cents) {
+        std::uint64_t locked = lockFolds();
+        foldLocked();
+        TransactionStatus status = TransactionStatus::InvalidAmount;
+        std::int64_t current = spendable.load(std::memory_order_acquire);
+        std::int64_t next;
+        while (!__builtin_add_overflow(current, cents, &next)) {
+            if (spendable.compare_exchange_weak(current, next, std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+                status = TransactionStatus::Success;
+                break;
+            }
+        }
+        reopenLocked();
+        unlockFolds(locked);
+        return status;
+    }
+
+public:
+    /**
+     * @param accNum The account number
+     * @param holder The name of account holder
+     * @param initialBalance Initial amount in the account (spendable)
+     * @param type Type of account
+     * @param rate Interest rate
+     */
+    StripedAccount(AccountId accNum, std::string holder, Money initialBalance,
+                   AccountType type = AccountType::Checking, InterestRate rate = InterestRate())
+        : accountNumber(accNum),
+          accountHolder(std::move(holder)),
+          accountType(type),
+          interestRate(rate.getBasisPoints()),
+          spendable(initialBalance.getMinorUnits()),
+          folds(0) {
+        if (initialBalance.getMinorUnits() > kOpenSpendableLimit) {
+            for (Stripe &stripe : stripes) {
+                stripe.credits.store(kClosed, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Atomics cannot be copied; an account has exactly one live balance
+    StripedAccount(const StripedAccount &) = delete;
+    StripedAccount &operator=(const StripedAccount &) = delete;
+
+    // ========================================================================
+    // GETTERS
+    // ========================================================================
+    AccountId getAccountNumber() const { return accountNumber; }
+    std::string_view getAccountHolder() const { return accountHolder; }
+    AccountType getAccountType() const { return accountType; }
+
+    InterestRate getInterestRate() const {
+        return InterestRate::fromBasisPoints(interestRate.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * Combines spendable and every stripe (retries while a fold runs)
+     * @return The balance
+     */
+    Money getBalance() const {
+        for (;;) {
+            std::uint64_t before = folds.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::int64_t total = spendable.load(std::memory_order_acquire);
+            for (const Stripe &stripe : stripes) {
+                std::int64_t credits = stripe.credits.load(std::memory_order_acquire);
+                total += credits == kClosed ? 0 : credits;
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (folds.load(std::memory_order_relaxed) == before) {
+                return Money::fromMinorUnits(total);
+            }
+        }
+    }
+
+    /**
+     * @return Folds done so far (one per applyInterest, and one per
+     *         withdraw attempt that found spendable short)
+     */
+    std::uint64_t getFoldCount() const {
+        return folds.load(std::memory_order_relaxed) / 2;
+    }
+
+    // ========================================================================
+    // MUTATORS (safe to call from any number of threads)
+    // ========================================================================
+    /**
+     * @param rate The new interest rate
+     * @return Success, or InvalidRate if the rate is outside 0-50%
+     */
+    TransactionStatus setInterestRate(InterestRate rate) {
+        metrics::OperationTimer timer(metrics::Operation::SetInterestRate);
+        if (!account_rules::isValidRate(rate)) {
+            return timer.finish(TransactionStatus::InvalidRate);
+        }
+        interestRate.store(rate.getBasisPoints(), std::memory_order_relaxed);
+        return timer.finish(TransactionStatus::Success);
+    }
+
+    /**
+     * Credits the calling thread's stripe with a CAS on that stripe alone
+     * A deposit that does not fit the stripe folds and is checked against
+     * the whole balance instead.
+     *
+     * @param amount The amount to deposit
+     * @return Success, or InvalidAmount (also when the balance cannot hold it)
+     */
+    TransactionStatus deposit(Money amount) {
+        metrics::OperationTimer timer(metrics::Operation::Deposit);
+        if (!account_rules::isValidAmount(amount)) {
+            return timer.finish(TransactionStatus::InvalidAmount);
+        }
+        const std::int64_t cents = amount.getMinorUnits();
+        std::atomic<std::int64_t> &credits = stripes[stripeIndex()].credits;
+        std::int64_t current = credits.load(std::memory_order_relaxed);
+        // An open stripe holds 0..kStripeLimit, so the subtraction cannot wrap
+        while (current != kClosed && cents <= kStripeLimit - current) {
+            if (credits.compare_exchange_weak(current, current + cents, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed)) {
+                return timer.finish(TransactionStatus::Success);
+            }
+        }
+        return timer.finish(depositFolded(cents));
+    }
+
+    /**
+     * Withdraws from spendable, folding the stripes in when it is short
+     *
+     * @param amount The amount to withdraw
+     * @return Success with the balance read just after this withdrawal,
+     *         InvalidAmount, or InsufficientFunds with the balance seen
+     */
+    TransactionResult withdraw(Money amount) {
+        metrics::OperationTimer timer(metrics::Operation::Withdraw);
+        if (!account_rules::isValidAmount(amount)) {
+            return timer.finish(TransactionResult{TransactionStatus::InvalidAmount, amount, getBalance()});
+        }
+        std::int64_t current = spendable.load(std::memory_order_acquire);
+        for (;;) {
+            if (current >= amount.getMinorUnits()) {
+                if (spendable.compare_exchange_weak(current, current - amount.getMinorUnits(),
+                                                    std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    return timer.finish(TransactionResult{TransactionStatus::Success, amount, getBalance()});
+                }
+                continue;   // current holds the newer spendable balance
+            }
+            std::uint64_t locked = lockFolds();
+            std::int64_t moved = foldLocked();
+            reopenLocked();
+            unlockFolds(locked);
+            current = spendable.load(std::memory_order_acquire);
+            if (moved == 0 && current < amount.getMinorUnits()) {
+                // Every stripe was empty at the fold: the whole balance is short
+                return timer.finish(
+                    TransactionResult{TransactionStatus::InsufficientFunds, amount, getBalance()});
+            }
+        }
+    }
+
+    /**
+     * Applies one period of interest to the whole balance
+     * Deposits that arrive while it runs count towards the next period.
+     *
+     * @param mode How to round the fractional cent
+     * @return Success, with amount set to the interest added
+     */
+    TransactionResult applyInterest(RoundingMode mode = RoundingMode::HalfEven) {
+        metrics::OperationTimer timer(metrics::Operation::ApplyInterest);
+        std::uint64_t locked = lockFolds();
+        foldLocked();
+        std::int64_t current = spendable.load(std::memory_order_acquire);
+        Money interest;
+        for (;;) {
+            interest = computeInterest(Money::fromMinorUnits(current), getInterestRate(), mode);
+            if (spendable.compare_exchange_weak(current, current + interest.getMinorUnits(),
+                                                std::memory_order_acq_rel, std::memory_order_acquire)) {
+                break;
+            }
+        }
+        reopenLocked();
+        unlockFolds(locked);
+        return timer.finish(TransactionResult{TransactionStatus::Success, interest, getBalance()});
+    }
+};
+
+#endif // STRIPED_ACCOUNT_HPP
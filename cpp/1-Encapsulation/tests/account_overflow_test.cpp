@@ -0,0 +1,132 @@
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "../bank_account.hpp"
+#include "../basic_account.hpp"
+#include "../concurrent_account.hpp"
+#include "../striped_account.hpp"
+#include "check.hpp"
+
+/**
+ * ============================================================================
+ * TEST: every account type refuses a credit its balance cannot hold
+ * ============================================================================
+ *
+ * BankAccount, BasicAccount, ConcurrentAccount and StripedAccount must all
+ * answer InvalidAmount, and keep the balance, when a deposit or incoming
+ * transfer would take it past INT64_MAX cents. A transfer to itself stays
+ * allowed at the limit. StripedAccount is also filled from many threads up
+ * to the limit: every accepted deposit must be in the final balance.
+ *
+ * BUILD:
+ *   g++ -std=c++20 -O2 -pthread account_overflow_test.cpp -o account_overflow_test
+ * RUN:
+ *   ./account_overflow_test
+ * ============================================================================
+ */
+
+namespace {
+
+constexpr std::int64_t kMax = std::numeric_limits<std::int64_t>::max();
+
+const AccountId kFirst = *AccountId::make("ACC", 1);
+const AccountId kSecond = *AccountId::make("ACC", 2);
+
+Money cents(std::int64_t value) {
+    return Money::fromMinorUnits(value);
+}
+
+void testBankAccount() {
+    BankAccount account(kFirst, "Holder", cents(100));
+    BankAccount full(kSecond, "Holder", cents(kMax));
+    CHECK(account.deposit(cents(kMax)).status == TransactionStatus::InvalidAmount);
+    CHECK(account.transfer(full, cents(1)).status == TransactionStatus::InvalidAmount);
+    CHECK(full.transfer(full, cents(5)).ok());
+    CHECK(account.deposit(cents(kMax - 100)).ok());
+    CHECK(account.getBalance() == cents(kMax));
+    CHECK(full.getBalance() == cents(kMax));
+}
+
+void testBasicAccount() {
+    SavingsAccount account(kFirst, "Holder", cents(100));
+    CheckingAccount full(kSecond, "Holder", cents(kMax));
+    CHECK(account.deposit(cents(kMax)).status == TransactionStatus::InvalidAmount);
+    CHECK(account.transfer(full, cents(1)).status == TransactionStatus::InvalidAmount);
+    CHECK(account.getBalance() == cents(100));
+    CHECK(full.getBalance() == cents(kMax));
+}
+
+void testConcurrentAccount() {
+    ConcurrentAccount account(kFirst, "Holder", cents(100));
+    ConcurrentAccount full(kSecond, "Holder", cents(kMax));
+    CHECK(account.deposit(cents(kMax)).status == TransactionStatus::InvalidAmount);
+
+    // The debit is refunded when the destination cannot take the credit
+    TransactionResult moved = transfer(account, full, cents(1));
+    CHECK(moved.status == TransactionStatus::InvalidAmount);
+    CHECK(moved.balance == cents(100));
+    CHECK(account.getBalance() == cents(100));
+    CHECK(full.getBalance() == cents(kMax));
+    CHECK(transfer(full, full, cents(5)).ok());
+    CHECK(full.deposit(cents(1)).status == TransactionStatus::InvalidAmount);
+}
+
+void testStripedAccount() {
+    StripedAccount account(kFirst, "Holder", cents(100));
+    CHECK(account.deposit(cents(kMax)) == TransactionStatus::InvalidAmount);
+    CHECK(account.getBalance() == cents(100));
+    CHECK(account.deposit(cents(kMax - 100)) == TransactionStatus::Success);
+    CHECK(account.deposit(cents(1)) == TransactionStatus::InvalidAmount);
+    CHECK(account.getBalance() == cents(kMax));
+
+    // Withdrawing from a full account opens the stripes again
+    CHECK(account.withdraw(cents(kMax - 5)).ok());
+    CHECK(account.deposit(cents(7)) == TransactionStatus::Success);
+    CHECK(account.getBalance() == cents(12));
+
+    // An account opened near the limit starts with its stripes closed
+    StripedAccount nearlyFull(kSecond, "Holder", cents(kMax - 10));
+    CHECK(nearlyFull.deposit(cents(11)) == TransactionStatus::InvalidAmount);
+    CHECK(nearlyFull.deposit(cents(10)) == TransactionStatus::Success);
+    CHECK(nearlyFull.getBalance() == cents(kMax));
+}
+
+/**
+ * Threads deposit large amounts until the balance is nearly full; the
+ * accepted ones must add up to the final balance exactly
+ */
+void testStripedFillFromThreads() {
+    StripedAccount account(kFirst, "Merchant", Money());
+    const std::int64_t amount = kMax / 4'000;
+    std::atomic<std::int64_t> accepted{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 600; ++i) {
+                if (account.deposit(cents(amount)) == TransactionStatus::Success) {
+                    accepted.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    // 4'800 attempts, room for exactly 4'000 of them
+    CHECK(accepted.load() == 4'000);
+    CHECK(account.getBalance() == cents(amount * accepted.load()));
+}
+
+} // namespace
+
+int main() {
+    testBankAccount();
+    testBasicAccount();
+    testConcurrentAccount();
+    testStripedAccount();
+    testStripedFillFromThreads();
+    return test::exitCode("account_overflow_test");
+}
@@ -0,0 +1,202 @@
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "../account_store.hpp"
+#include "../batch_posting.hpp"
+#include "check.hpp"
+
+/**
+ * ============================================================================
+ * TEST: BatchPoster kernels agree with deposit/withdraw
+ * ============================================================================
+ *
+ * Random batches (repeated slots, zero amounts, unknown slots, frozen
+ * accounts, deposits that would overflow a balance) are posted three ways:
+ * with the Scalar kernel, with the Simd kernel (AVX2 or NEON when the CPU
+ * has one), and one posting at a time through AccountRef. All three must
+ * leave the same balances, totals and rejections.
+ *
+ * BUILD:
+ *   g++ -std=c++20 -O2 -pthread batch_posting_test.cpp -o batch_posting_test
+ * RUN:
+ *   ./batch_posting_test
+ * ============================================================================
+ */
+
+namespace {
+
+constexpr std::int64_t kMax = std::numeric_limits<std::int64_t>::max();
+constexpr std::int64_t kMin = std::numeric_limits<std::int64_t>::min();
+
+/**
+ * SplitMix64: small, seedable, the same sequence everywhere
+ */
+struct Random {
+    std::uint64_t state;
+
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    std::uint64_t below(std::uint64_t bound) { return next() % bound; }
+};
+
+void openAccounts(AccountStore &store, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        // A few accounts start close to the largest balance a store can hold
+        Money opening = i % 5 == 4 ? Money::fromMinorUnits(kMax - 1'000) : Money::fromMinorUnits(100 * i);
+        store.open(*AccountId::make("ACC", i + 1), "Holder", opening,
+                   i % 2 ? AccountType::Checking : AccountType::Savings);
+    }
+    store.at(2).setStatus(AccountStatus::Frozen);
+    store.at(3).setStatus(AccountStatus::DebitsBlocked);
+    store.at(6).setStatus(AccountStatus::CreditsBlocked);
+}
+
+std::int64_t randomAmount(Random &random) {
+    switch (random.below(10)) {
+    case 0:
+        return 0;
+    case 1:
+        return kMax;
+    case 2:
+        return kMin;
+    case 3:
+        return 1 + static_cast<std::int64_t>(random.below(2'000));
+    case 4:
+        return -1 - static_cast<std::int64_t>(random.below(2'000));
+    default:
+        return static_cast<std::int64_t>(random.below(20'000)) - 10'000;
+    }
+}
+
+/**
+ * Posts one amount the way an application would, without BatchPoster
+ */
+TransactionStatus postOne(AccountStore &store, AccountSlot slot, std::int64_t cents) {
+    if (slot >= store.size() || cents == 0) {
+        return TransactionStatus::InvalidAmount;
+    }
+    AccountRef account = store.at(slot);
+    if (cents == kMin) {
+        // No balance covers it; withdraw cannot be asked for -INT64_MIN
+        return account_status::blocksDebits(account.getStatus()) ? TransactionStatus::AccountFrozen
+                                                                 : TransactionStatus::InsufficientFunds;
+    }
+    return cents > 0 ? account.deposit(Money::fromMinorUnits(cents)).status
+                     : account.withdraw(Money::fromMinorUnits(-cents)).status;
+}
+
+bool sameState(AccountStore &a, AccountStore &b) {
+    for (AccountSlot slot = 0; slot < a.size(); ++slot) {
+        if (a.at(slot).getBalance() != b.at(slot).getBalance()) {
+            return false;
+        }
+    }
+    StoreTotals x = a.totals();
+    StoreTotals y = b.totals();
+    for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+        if (x.byType[t] != y.byType[t]) {
+            return false;
+        }
+    }
+    return x.zeroBalanceAccounts == y.zeroBalanceAccounts;
+}
+
+bool sameReport(const PostingReport &a, const PostingReport &b) {
+    return a.rejectMask == b.rejectMask && a.applied == b.applied && a.invalid == b.invalid &&
+           a.insufficientFunds == b.insufficientFunds && a.frozen == b.frozen && a.netPosted == b.netPosted;
+}
+
+void testOverflowingDeposit() {
+    for (PostingKernel kernel : {PostingKernel::Scalar, PostingKernel::Simd}) {
+        AccountStore store;
+        for (std::size_t i = 0; i < 4; ++i) {
+            store.open(*AccountId::make("ACC", i + 1), "Holder", Money::fromMinorUnits(100));
+        }
+        const std::vector<AccountSlot> slots = {0, 1, 2, 3};
+        const std::vector<std::int64_t> amounts = {kMax, 5, kMax - 100, 7};
+        PostingReport report = BatchPoster(kernel).post(store, slots, amounts);
+        CHECK(report.applied == 3);
+        CHECK(report.invalid == 1);
+        CHECK(report.isRejected(0));
+        CHECK(store.at(0).getBalance() == Money::fromMinorUnits(100));
+        CHECK(store.at(2).getBalance() == Money::fromMinorUnits(kMax));
+    }
+
+    AccountStore store;
+    AccountRef account = *store.open(*AccountId::make("ACC", 1), "Holder", Money::fromMinorUnits(100));
+    AccountRef other = *store.open(*AccountId::make("ACC", 2), "Holder", Money::fromMinorUnits(kMax));
+    CHECK(account.deposit(Money::fromMinorUnits(kMax)).status == TransactionStatus::InvalidAmount);
+    CHECK(account.creditInterest(Money::fromMinorUnits(kMax)).status == TransactionStatus::InvalidAmount);
+    CHECK(account.transfer(other, Money::fromMinorUnits(1)).status == TransactionStatus::InvalidAmount);
+    CHECK(account.getBalance() == Money::fromMinorUnits(100));
+    CHECK(other.getBalance() == Money::fromMinorUnits(kMax));
+}
+
+void testKernelsAgree() {
+    constexpr std::size_t kAccounts = 24;
+    Random random{2024};
+    AccountStore scalarStore;
+    AccountStore simdStore;
+    AccountStore oneByOne;
+    openAccounts(scalarStore, kAccounts);
+    openAccounts(simdStore, kAccounts);
+    openAccounts(oneByOne, kAccounts);
+    const BatchPoster scalar(PostingKernel::Scalar);
+    const BatchPoster simd(PostingKernel::Simd);
+
+    for (int round = 0; round < 400; ++round) {
+        const std::size_t count = random.below(70);
+        std::vector<AccountSlot> slots(count);
+        std::vector<std::int64_t> amounts(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            // Some unknown slots, and few enough accounts that SIMD steps collide
+            slots[i] = static_cast<AccountSlot>(random.below(kAccounts + 2));
+            amounts[i] = randomAmount(random);
+        }
+
+        PostingReport fromScalar = scalar.post(scalarStore, slots, amounts);
+        PostingReport fromSimd = simd.post(simdStore, slots, amounts);
+        CHECK(sameReport(fromScalar, fromSimd));
+
+        PostingReport expected;
+        std::int64_t net = 0;   // Wraps like the kernels' sum
+        expected.rejectMask.assign((count + 63) / 64, 0);
+        for (std::size_t i = 0; i < count; ++i) {
+            switch (postOne(oneByOne, slots[i], amounts[i])) {
+            case TransactionStatus::Success:
+                ++expected.applied;
+                net = posting_kernels::wrappingAdd(net, amounts[i]);
+                continue;
+            case TransactionStatus::InsufficientFunds:
+                ++expected.insufficientFunds;
+                break;
+            case TransactionStatus::AccountFrozen:
+                ++expected.frozen;
+                break;
+            default:
+                ++expected.invalid;
+                break;
+            }
+            expected.rejectMask[i / 64] |= std::uint64_t{1} << (i % 64);
+        }
+        expected.netPosted = Money::fromMinorUnits(net);
+        CHECK(sameReport(fromScalar, expected));
+        CHECK(sameState(scalarStore, simdStore));
+        CHECK(sameState(scalarStore, oneByOne));
+    }
+}
+
+} // namespace
+
+int main() {
+    testOverflowingDeposit();
+    testKernelsAgree();
+    return test::exitCode("batch_posting_test");
+}
@@ -0,0 +1,50 @@
+#ifndef TESTS_CHECK_HPP
+#define TESTS_CHECK_HPP
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+/**
+ * ============================================================================
+ * TEST SUPPORT: minimal checks for the standalone test programs
+ * ============================================================================
+ *
+ * Each test in this directory is one program: CHECK prints every failed
+ * condition with its line, and main returns test::exitCode() so a script
+ * (or CI) sees a non-zero status when anything failed.
+ * ============================================================================
+ */
+
+namespace test {
+
+inline int failures = 0;
+
+inline void check(bool condition, const char *expression, const char *file, int line) {
+    if (!condition) {
+        std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expression);
+        ++failures;
+    }
+}
+
+/**
+ * @return A path in the temporary directory unique to this process
+ */
+inline std::string tempPath(const std::string &name) {
+    return "/tmp/bank_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+/**
+ * Prints the summary line
+ * @return Exit status for main
+ */
+inline int exitCode(const char *suite) {
+    std::printf("%s: %s\n", suite, failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace test
+
+#define CHECK(condition) ::test::check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+
+#endif // TESTS_CHECK_HPP
@@ -0,0 +1,169 @@
+#include <cstdio>
+#include <optional>
+#include <string>
+
+#include "../account_store.hpp"
+#include "../journal.hpp"
+#include "check.hpp"
+
+/**
+ * ============================================================================
+ * TEST: transfers between two stores replay from either journal
+ * ============================================================================
+ *
+ * Two stores, each with its own journal, move money back and forth. Each
+ * journal replayed alone must rebuild its own store, and one journal
+ * shared by both stores must rebuild both in a single store. A transfer
+ * from an account to itself must neither create nor destroy money.
+ *
+ * BUILD:
+ *   g++ -std=c++20 -O2 -pthread cross_store_transfer_test.cpp -o cross_store_transfer_test
+ * RUN:
+ *   ./cross_store_transfer_test
+ * ============================================================================
+ */
+
+namespace {
+
+constexpr std::size_t kAccounts = 6;
+
+void openAccounts(AccountStore &store, const char *prefix) {
+    for (std::size_t i = 0; i < kAccounts; ++i) {
+        store.open(*AccountId::make(prefix, i + 1), "Holder", Money::fromMajorUnits(100));
+    }
+}
+
+void moveMoney(AccountStore &east, AccountStore &west) {
+    for (std::uint32_t i = 0; i < 60; ++i) {
+        AccountRef a = east.at(i % kAccounts);
+        AccountRef b = west.at((i * 5 + 1) % kAccounts);
+        CHECK(a.transfer(b, Money::fromMinorUnits(1'00 + i)).ok());
+        if (i % 3 == 0) {
+            CHECK(b.transfer(a, Money::fromMinorUnits(2'50)).ok());
+        }
+        if (i % 4 == 0) {
+            // Within one store a transfer stays a single record
+            CHECK(a.transfer(east.at((i + 1) % kAccounts), Money::fromMinorUnits(75)).ok());
+        }
+        if (i % 7 == 0) {
+            CHECK(b.transfer(b, Money::fromMinorUnits(40'00)).ok());
+        }
+    }
+}
+
+bool sameBalances(AccountStore &original, AccountStore &replayed) {
+    for (AccountSlot slot = 0; slot < original.size(); ++slot) {
+        AccountRef account = original.at(slot);
+        std::optional<AccountRef> copy = replayed.find(account.getAccountNumber());
+        if (!copy || copy->getBalance() != account.getBalance()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testSeparateJournals() {
+    const std::string eastPath = test::tempPath("east.journal");
+    const std::string westPath = test::tempPath("west.journal");
+    std::remove(eastPath.c_str());
+    std::remove(westPath.c_str());
+    AccountStore east;
+    AccountStore west;
+    {
+        JournalWriter eastJournal(eastPath);
+        JournalWriter westJournal(westPath);
+        east.setRecordSink(&eastJournal);
+        west.setRecordSink(&westJournal);
+        openAccounts(east, "EST");
+        openAccounts(west, "WST");
+        moveMoney(east, west);
+        east.setRecordSink(nullptr);
+        west.setRecordSink(nullptr);
+    }
+
+    AccountStore eastReplayed;
+    ReplayStats stats = replayJournal(eastPath, eastReplayed);
+    CHECK(stats.mismatches == 0);
+    CHECK(stats.skipped == 0);
+    CHECK(sameBalances(east, eastReplayed));
+    CHECK(eastReplayed.totalBalance() == east.totalBalance());
+
+    AccountStore westReplayed;
+    stats = replayJournal(westPath, westReplayed);
+    CHECK(stats.mismatches == 0);
+    CHECK(stats.skipped == 0);
+    CHECK(sameBalances(west, westReplayed));
+    CHECK(westReplayed.totalBalance() == west.totalBalance());
+
+    std::remove(eastPath.c_str());
+    std::remove(westPath.c_str());
+}
+
+void testSharedJournal() {
+    const std::string path = test::tempPath("shared.journal");
+    std::remove(path.c_str());
+    AccountStore east;
+    AccountStore west;
+    {
+        JournalWriter journal(path);
+        east.setRecordSink(&journal);
+        west.setRecordSink(&journal);
+        openAccounts(east, "EST");
+        openAccounts(west, "WST");
+        moveMoney(east, west);
+        east.setRecordSink(nullptr);
+        west.setRecordSink(nullptr);
+    }
+
+    AccountStore both;
+    ReplayStats stats = replayJournal(path, both);
+    CHECK(stats.mismatches == 0);
+    CHECK(stats.skipped == 0);
+    CHECK(both.size() == 2 * kAccounts);
+    CHECK(sameBalances(east, both));
+    CHECK(sameBalances(west, both));
+    std::remove(path.c_str());
+}
+
+void testSelfTransfer() {
+    const std::string path = test::tempPath("self.journal");
+    std::remove(path.c_str());
+    AccountStore store;
+    {
+        JournalWriter journal(path);
+        store.setRecordSink(&journal);
+        openAccounts(store, "SLF");
+        AccountRef account = store.at(0);
+        const Money total = store.totals().total();
+
+        TransactionResult result = account.transfer(account, Money::fromMajorUnits(40));
+        CHECK(result.ok());
+        CHECK(result.balance == Money::fromMajorUnits(100));
+        CHECK(account.getBalance() == Money::fromMajorUnits(100));
+        CHECK(store.totals().total() == total);
+
+        // The rules still apply to the debit side
+        CHECK(account.transfer(account, Money::fromMajorUnits(101)).status == TransactionStatus::InsufficientFunds);
+        CHECK(account.transfer(account, Money()).status == TransactionStatus::InvalidAmount);
+        account.setStatus(AccountStatus::DebitsBlocked);
+        CHECK(account.transfer(account, Money::fromMajorUnits(1)).status == TransactionStatus::AccountFrozen);
+        account.setStatus(AccountStatus::Active);
+        CHECK(account.getBalance() == Money::fromMajorUnits(100));
+        store.setRecordSink(nullptr);
+    }
+
+    AccountStore replayed;
+    ReplayStats stats = replayJournal(path, replayed);
+    CHECK(stats.mismatches == 0);
+    CHECK(sameBalances(store, replayed));
+    std::remove(path.c_str());
+}
+
+} // namespace
+
+int main() {
+    testSeparateJournals();
+    testSharedJournal();
+    testSelfTransfer();
+    return test::exitCode("cross_store_transfer_test");
+}
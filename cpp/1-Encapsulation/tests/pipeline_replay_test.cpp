@@ -0,0 +1,129 @@
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../account_store.hpp"
+#include "../async_pipeline.hpp"
+#include "../journal.hpp"
+#include "check.hpp"
+
+/**
+ * ============================================================================
+ * TEST: AccountPipeline journals replay to the same balances
+ * ============================================================================
+ *
+ * Runs deposits, withdrawals and transfers through the pipeline on a store
+ * that accrues interest lazily, so the interest settled inside a pass must
+ * reach the journal along with the operations, then replays the journal
+ * onto an empty store and compares.
+ *
+ * BUILD:
+ *   g++ -std=c++20 -O2 -pthread pipeline_replay_test.cpp -o pipeline_replay_test
+ * RUN:
+ *   ./pipeline_replay_test
+ * ============================================================================
+ */
+
+namespace {
+
+PipelineTask pay(AsyncAccount from, AsyncAccount to, Money deposit, Money transfer, Money withdraw) {
+    co_await from.deposit(deposit);
+    co_await from.transfer(to, transfer);
+    co_await to.withdraw(withdraw);
+}
+
+/**
+ * One missed period at 5% on $1000.00, settled by the pipeline's deposit
+ */
+void testMissedPeriodIsJournaled() {
+    const std::string path = test::tempPath("pipeline_missed.journal");
+    std::remove(path.c_str());
+    Money expected;
+    {
+        JournalWriter journal(path);
+        CHECK(journal.ok());
+        AccountStore store;
+        store.setLazyAccrual(true);
+        store.setRecordSink(&journal);
+        AccountRef account = *store.open(*AccountId::make("ACC", 1), "Lazy Holder", Money::fromMajorUnits(1000),
+                                         AccountType::Savings, InterestRate::fromBasisPoints(500));
+        store.advanceAccrualPeriod();
+
+        AccountPipeline pipeline(store);
+        pipeline.setDurableJournal(&journal);
+        TransactionResult result{};
+        auto client = [](AsyncAccount target, TransactionResult &out) -> PipelineTask {
+            out = co_await target.deposit(Money::fromMajorUnits(1));
+        };
+        PipelineTask task = client(AsyncAccount(pipeline, account), result);
+        pipeline.runUntilIdle();
+        CHECK(task.done());
+        CHECK(result.ok());
+        CHECK(result.balance == Money::fromMinorUnits(105100));
+        expected = account.getBalance();
+    }
+
+    AccountStore replayed;
+    ReplayStats stats = replayJournal(path, replayed);
+    CHECK(stats.scan.status == JournalReadStatus::Ok);
+    CHECK(stats.mismatches == 0);
+    CHECK(stats.applied == 4);   // Open, HolderName, Interest, Deposit
+    std::optional<AccountRef> account = replayed.find(*AccountId::make("ACC", 1));
+    CHECK(account && account->getBalance() == expected);
+    std::remove(path.c_str());
+}
+
+/**
+ * Many clients over several passes and accrual periods
+ */
+void testMixedPassesReplay() {
+    const std::string path = test::tempPath("pipeline_mixed.journal");
+    std::remove(path.c_str());
+    constexpr std::size_t kAccounts = 64;
+    Money expectedTotal;
+    {
+        JournalWriter journal(path);
+        AccountStore store;
+        store.setLazyAccrual(true);
+        store.setRecordSink(&journal);
+        for (std::size_t i = 0; i < kAccounts; ++i) {
+            store.open(*AccountId::make("ACC", i + 1), "Holder", Money::fromMajorUnits(100 + i),
+                       i % 2 ? AccountType::Checking : AccountType::Savings,
+                       InterestRate::fromBasisPoints(static_cast<std::int32_t>(i % 7) * 10));
+        }
+        PipelineOptions options;
+        options.maxBatch = 8;
+        AccountPipeline pipeline(store, options);
+        for (std::uint32_t period = 0; period < 5; ++period) {
+            std::vector<PipelineTask> tasks;
+            for (std::size_t i = 0; i < kAccounts; ++i) {
+                AsyncAccount from(pipeline, store.at(static_cast<AccountSlot>(i)));
+                AsyncAccount to(pipeline, store.at(static_cast<AccountSlot>((i * 7 + 3) % kAccounts)));
+                tasks.push_back(pay(from, to, Money::fromMinorUnits(1'23 + i), Money::fromMinorUnits(40'00),
+                                    Money::fromMinorUnits(static_cast<std::int64_t>(i) * 5'00)));
+            }
+            pipeline.runUntilIdle();
+            store.advanceAccrualPeriod();
+        }
+        store.settleInterest();
+        expectedTotal = store.totalBalance();
+    }
+
+    AccountStore replayed;
+    ReplayStats stats = replayJournal(path, replayed);
+    CHECK(stats.scan.status == JournalReadStatus::Ok);
+    CHECK(stats.mismatches == 0);
+    CHECK(stats.skipped == 0);
+    CHECK(replayed.size() == kAccounts);
+    CHECK(replayed.totalBalance() == expectedTotal);
+    std::remove(path.c_str());
+}
+
+} // namespace
+
+int main() {
+    testMissedPeriodIsJournaled();
+    testMixedPassesReplay();
+    return test::exitCode("pipeline_replay_test");
+}
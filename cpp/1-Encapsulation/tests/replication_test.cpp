@@ -0,0 +1,166 @@
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../account_store.hpp"
+#include "../journal.hpp"
+#include "../replication.hpp"
+#include "check.hpp"
+
+/**
+ * ============================================================================
+ * TEST: ReplicationFollower over skipping and broken streams
+ * ============================================================================
+ *
+ * - a journal shared by two stores numbers both; the log attached to one
+ *   of them produces batches whose sequences skip, which the follower
+ *   must accept because the log announces them
+ * - a batch that really follows missing records is a Gap, and catchUp
+ *   stops with that status instead of fetching the same batch forever
+ * - frames round-trip previousSequence
+ *
+ * BUILD:
+ *   g++ -std=c++20 -O2 -pthread replication_test.cpp -o replication_test
+ * RUN:
+ *   ./replication_test
+ * ============================================================================
+ */
+
+namespace {
+
+void openAccounts(AccountStore &store, const char *prefix, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        store.open(*AccountId::make(prefix, i + 1), "Holder", Money::fromMajorUnits(100),
+                   AccountType::Savings, InterestRate::fromBasisPoints(25));
+    }
+}
+
+void testSharedJournalSkips() {
+    const std::string path = test::tempPath("replication_shared.journal");
+    std::remove(path.c_str());
+    {
+        JournalWriter journal(path);
+        ReplicationPolicy policy;
+        policy.maxBatchRecords = 4;
+        ReplicationLog log(policy, &journal);
+
+        AccountStore primary;
+        AccountStore other;   // Shares the journal, not replicated
+        primary.setRecordSink(&log);
+        other.setRecordSink(&journal);
+        openAccounts(primary, "PRI", 8);
+        openAccounts(other, "OTH", 8);
+        for (std::uint32_t i = 0; i < 200; ++i) {
+            AccountRef a = primary.at(i % 8);
+            a.deposit(Money::fromMinorUnits(100 + i));
+            if (i % 3 == 0) {
+                other.at(i % 8).withdraw(Money::fromMinorUnits(7));
+            }
+            if (i % 5 == 0) {
+                a.transfer(primary.at((i + 3) % 8), Money::fromMinorUnits(50));
+            }
+            if (i % 7 == 0) {
+                a.applyInterest();
+            }
+        }
+        log.flush();
+
+        ReplicationFollower follower;
+        CHECK(follower.catchUp(log) == CatchUpStatus::Ok);
+        CHECK(follower.getAppliedSequence() == log.getLastSequence());
+        ReplicationStats stats = follower.getStats();
+        CHECK(stats.mismatches == 0);
+        CHECK(stats.skipped == 0);
+        CHECK(stats.records == log.getRecordCount());
+        for (AccountSlot slot = 0; slot < 8; ++slot) {
+            AccountRef account = primary.at(slot);
+            CHECK(follower.getBalance(account.getAccountNumber()) == account.getBalance());
+        }
+
+        // The same batches through the wire format
+        std::vector<std::shared_ptr<const ReplicationBatch>> batches;
+        CHECK(log.fetch(0, batches, 1'000'000) == FetchStatus::Ok);
+        std::vector<std::uint8_t> wire;
+        for (const auto &batch : batches) {
+            replication::writeFrame(*batch, wire);
+        }
+        ReplicationFollower remote;
+        std::span<const std::uint8_t> rest(wire);
+        bool skipped = false;
+        while (!rest.empty()) {
+            ReplicationBatch batch;
+            std::size_t consumed = 0;
+            CHECK(replication::readFrame(rest, batch, consumed) == FrameStatus::Ok);
+            skipped = skipped || batch.firstSequence != batch.previousSequence + 1;
+            CHECK(remote.apply(batch) == ReplicationApplyStatus::Applied);
+            rest = rest.subspan(consumed);
+        }
+        CHECK(skipped);
+        CHECK(remote.getAppliedSequence() == log.getLastSequence());
+    }
+    std::remove(path.c_str());
+}
+
+void testMissingBatchIsGap() {
+    ReplicationPolicy policy;
+    policy.maxBatchRecords = 2;
+    ReplicationLog log(policy);
+    AccountStore primary;
+    primary.setRecordSink(&log);
+    openAccounts(primary, "ACC", 4);
+    primary.at(0).deposit(Money::fromMajorUnits(1));
+    log.flush();
+
+    std::vector<std::shared_ptr<const ReplicationBatch>> batches;
+    CHECK(log.fetch(0, batches, 1'000'000) == FetchStatus::Ok);
+    CHECK(batches.size() >= 3);
+
+    ReplicationFollower follower;
+    CHECK(follower.apply(*batches[0]) == ReplicationApplyStatus::Applied);
+    CHECK(follower.apply(*batches[2]) == ReplicationApplyStatus::Gap);
+    CHECK(follower.apply(*batches[0]) == ReplicationApplyStatus::Duplicate);
+    CHECK(follower.apply(*batches[1]) == ReplicationApplyStatus::Applied);
+
+    // A batch claiming records the follower never saw stops catchUp
+    ReplicationBatch forged = *batches[2];
+    forged.firstSequence += 100;
+    forged.previousSequence += 100;
+    ReplicationFollower stuck;
+    CHECK(stuck.apply(forged) == ReplicationApplyStatus::Gap);
+    CHECK(stuck.getAppliedSequence() == 0);
+
+    ReplicationFollower fresh;
+    CHECK(fresh.catchUp(log) == CatchUpStatus::Ok);
+    CHECK(fresh.getBalance(*AccountId::make("ACC", 1)) == Money::fromMajorUnits(101));
+}
+
+/**
+ * A follower that sees a corrupt batch from the log stops instead of looping
+ */
+void testCatchUpStopsOnCorruptBatch() {
+    ReplicationPolicy policy;
+    policy.maxBatchRecords = 2;
+    ReplicationLog log(policy);
+    ReplicationFollower follower;
+    CHECK(follower.catchUp(log) == CatchUpStatus::Ok);
+
+    // Records that decode to an unknown op: the log encodes whatever it is given
+    JournalRecord bad = journal::makeRecord(JournalOp::Deposit, *AccountId::make("ACC", 1), Money::fromMinorUnits(1),
+                                            Money::fromMinorUnits(1));
+    bad.op = static_cast<JournalOp>(200);
+    log.append(bad);
+    log.flush();
+    CHECK(follower.catchUp(log) == CatchUpStatus::Corrupt);
+    CHECK(follower.getAppliedSequence() == 0);
+}
+
+} // namespace
+
+int main() {
+    testSharedJournalSkips();
+    testMissingBatchIsGap();
+    testCatchUpStopsOnCorruptBatch();
+    return test::exitCode("replication_test");
+}
@@ -0,0 +1,217 @@
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+
+#include "../account_store.hpp"
+#include "../journal.hpp"
+#include "../snapshot.hpp"
+#include "check.hpp"
+
+/**
+ * ============================================================================
+ * TEST: snapshot + journal recovery, and damaged snapshots
+ * ============================================================================
+ *
+ * - round trip: write a snapshot, keep journaling, recover, and compare
+ *   every balance, status, name and the running totals with the original
+ * - a missing snapshot replays the journal onto an emptied store
+ * - a snapshot of the right size with an out-of-range type, status or
+ *   holder offset (or an absurd account count) is refused, and the store
+ *   is left alone
+ *
+ * BUILD:
+ *   g++ -std=c++20 -O2 -pthread snapshot_recovery_test.cpp -o snapshot_recovery_test
+ * RUN:
+ *   ./snapshot_recovery_test
+ * ============================================================================
+ */
+
+namespace {
+
+constexpr std::size_t kAccounts = 300;
+
+void openAccounts(AccountStore &store) {
+    for (std::size_t i = 0; i < kAccounts; ++i) {
+        store.open(*AccountId::make("ACC", i + 1), "Holder " + std::to_string(i), Money::fromMajorUnits(50 + i),
+                   i % 3 ? AccountType::Checking : AccountType::Savings,
+                   InterestRate::fromBasisPoints(static_cast<std::int32_t>(i % 5) * 7));
+    }
+}
+
+void mutate(AccountStore &store, std::uint32_t round) {
+    for (std::uint32_t i = 0; i < kAccounts; ++i) {
+        AccountRef account = store.at(i);
+        account.deposit(Money::fromMinorUnits(1 + (i * 31 + round) % 997));
+        if ((i + round) % 4 == 0) {
+            account.withdraw(Money::fromMinorUnits(2'50));
+        }
+        if ((i + round) % 6 == 0) {
+            account.transfer(store.at((i * 13 + round) % kAccounts), Money::fromMinorUnits(10'00));
+        }
+        if ((i + round) % 11 == 0) {
+            account.applyInterest();
+        }
+    }
+    store.at(round % kAccounts).setStatus(round % 2 ? AccountStatus::Frozen : AccountStatus::DebitsBlocked);
+    store.at((round + 1) % kAccounts).setAccountHolder("Renamed " + std::to_string(round));
+    store.closeInterestPeriod();
+}
+
+bool sameAccounts(AccountStore &a, AccountStore &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (AccountSlot slot = 0; slot < a.size(); ++slot) {
+        AccountRef left = a.at(slot);
+        std::optional<AccountRef> right = b.find(left.getAccountNumber());
+        if (!right || right->getBalance() != left.getBalance() || right->getStatus() != left.getStatus() ||
+            right->getAccountHolder() != left.getAccountHolder() ||
+            right->getAccountType() != left.getAccountType() ||
+            right->getInterestRate() != left.getInterestRate()) {
+            return false;
+        }
+    }
+    StoreTotals x = a.totals();
+    StoreTotals y = b.totals();
+    for (std::size_t t = 0; t < kAccountTypeCount; ++t) {
+        if (x.byType[t] != y.byType[t]) {
+            return false;
+        }
+    }
+    return x.accounts == y.accounts && x.zeroBalanceAccounts == y.zeroBalanceAccounts &&
+           a.totalBalance() == b.totalBalance() && a.getRestrictedCount() == b.getRestrictedCount();
+}
+
+void testRoundTrip(bool lazy) {
+    const std::string snapshotPath = test::tempPath("recovery.snap");
+    const std::string journalPath = test::tempPath("recovery.journal");
+    std::remove(snapshotPath.c_str());
+    std::remove(journalPath.c_str());
+
+    AccountStore original;
+    {
+        JournalWriter journal(journalPath);
+        CHECK(journal.ok());
+        original.setRecordSink(&journal);
+        original.setLazyAccrual(lazy);
+        openAccounts(original);
+        for (std::uint32_t round = 0; round < 3; ++round) {
+            mutate(original, round);
+            original.advanceAccrualPeriod();
+        }
+        original.settleInterest();
+        CHECK(SnapshotWriter::write(original, snapshotPath, journal.getLastSequence()) == SnapshotStatus::Ok);
+        for (std::uint32_t round = 3; round < 6; ++round) {
+            mutate(original, round);
+            original.advanceAccrualPeriod();
+        }
+        original.settleInterest();
+        original.setRecordSink(nullptr);
+    }
+
+    AccountStore recovered;
+    RecoveryStats stats = recoverStore(snapshotPath, journalPath, recovered);
+    CHECK(stats.snapshot == SnapshotStatus::Ok);
+    CHECK(stats.snapshotSequence > 0);
+    CHECK(stats.journal.mismatches == 0);
+    CHECK(stats.journal.applied > 0);
+    CHECK(sameAccounts(original, recovered));
+
+    // Without the snapshot the journal alone gets to the same place, even
+    // onto a store that already holds accounts
+    std::remove(snapshotPath.c_str());
+    AccountStore stale;
+    stale.open(*AccountId::make("OLD", 1), "Stale", Money::fromMajorUnits(1'000'000));
+    stale.open(*AccountId::make("ACC", 1), "Stale", Money::fromMajorUnits(1));
+    stats = recoverStore(snapshotPath, journalPath, stale);
+    CHECK(stats.snapshot == SnapshotStatus::CannotOpen);
+    CHECK(stats.journal.mismatches == 0);
+    CHECK(!stale.find(*AccountId::make("OLD", 1)));
+    CHECK(sameAccounts(original, stale));
+
+    std::remove(journalPath.c_str());
+}
+
+/**
+ * Overwrites bytes of a file in place
+ */
+void patch(const std::string &path, std::uint64_t offset, const void *bytes, std::size_t size) {
+    std::FILE *file = std::fopen(path.c_str(), "r+b");
+    CHECK(file != nullptr);
+    if (file) {
+        std::fseek(file, static_cast<long>(offset), SEEK_SET);
+        std::fwrite(bytes, 1, size, file);
+        std::fclose(file);
+    }
+}
+
+void testDamagedSnapshots() {
+    const std::string path = test::tempPath("damaged.snap");
+    AccountStore source;
+    openAccounts(source);
+    source.at(3).setStatus(AccountStatus::Frozen);
+
+    auto openStatus = [&] {
+        MappedSnapshot snapshot;
+        return snapshot.open(path);
+    };
+    // Writes an intact snapshot and returns its header
+    auto fresh = [&] {
+        CHECK(SnapshotWriter::write(source, path) == SnapshotStatus::Ok);
+        CHECK(openStatus() == SnapshotStatus::Ok);
+        SnapshotHeader header;
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        CHECK(file && std::fread(&header, sizeof header, 1, file) == 1);
+        if (file) {
+            std::fclose(file);
+        }
+        return header;
+    };
+
+    SnapshotHeader header = fresh();
+    const std::uint8_t badType = 7;
+    patch(path, header.typesOffset + kAccounts - 1, &badType, 1);
+    CHECK(openStatus() == SnapshotStatus::Corrupt);
+
+    header = fresh();
+    const std::uint8_t badStatus = 0x40;
+    patch(path, snapshot_layout::statusesOffset(header) + 5, &badStatus, 1);
+    CHECK(openStatus() == SnapshotStatus::Corrupt);
+
+    header = fresh();
+    const std::uint64_t pastText = header.holderTextBytes + 4096;
+    patch(path, header.holderOffsetsOffset + 10 * sizeof(std::uint64_t), &pastText, sizeof pastText);
+    CHECK(openStatus() == SnapshotStatus::Corrupt);
+
+    header = fresh();
+    const std::uint64_t backwards = 0;
+    patch(path, header.holderOffsetsOffset + 20 * sizeof(std::uint64_t), &backwards, sizeof backwards);
+    CHECK(openStatus() == SnapshotStatus::Corrupt);
+
+    header = fresh();
+    SnapshotHeader huge = header;
+    huge.accountCount = ~std::uint64_t{0} / 8;
+    patch(path, 0, &huge, sizeof huge);
+    CHECK(openStatus() == SnapshotStatus::Truncated);
+
+    // recoverStore refuses the damaged file and leaves the store alone
+    header = fresh();
+    patch(path, header.typesOffset, &badType, 1);
+    AccountStore untouched;
+    untouched.open(*AccountId::make("KEP", 1), "Kept", Money::fromMajorUnits(5));
+    RecoveryStats stats = recoverStore(path, test::tempPath("none.journal"), untouched);
+    CHECK(stats.snapshot == SnapshotStatus::Corrupt);
+    CHECK(untouched.size() == 1 && untouched.find(*AccountId::make("KEP", 1)));
+
+    std::remove(path.c_str());
+}
+
+} // namespace
+
+int main() {
+    testRoundTrip(false);
+    testRoundTrip(true);
+    testDamagedSnapshots();
+    return test::exitCode("snapshot_recovery_test");
+}
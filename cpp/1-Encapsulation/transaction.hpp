@@ -0,0 +1,100 @@
+#ifndef TRANSACTION_HPP
+#define TRANSACTION_HPP
+
+#include "money.hpp"
+
+/**
+ * ============================================================================
+ * TRANSACTION RESULTS AND VALIDATION RULES
+ * ============================================================================
+ *
+ * Shared by every account representation (BankAccount objects, AccountStore
+ * rows, ...) so they all report outcomes the same way and enforce the same
+ * business rules.
+ * ============================================================================
+ */
+
+// ============================================================================
+// TRANSACTION RESULTS
+// ============================================================================
+/**
+ * Outcome of an account operation
+ * Mutators report what happened through this code instead of printing it,
+ * so callers (and observers) decide whether anything is shown at all.
+ */
+enum class TransactionStatus {
+    Success,            // Operation was applied
+    InvalidAmount,      // Amount was zero or negative, or more than the balance can hold
+    InsufficientFunds,  // Withdrawal/transfer would overdraw the account
+    InvalidRate,        // Interest rate outside the allowed 0-50% range
+    InvalidHolderName,  // Account holder name was empty
+    BatchAborted,       // Valid on its own, but another part of its batch failed
+    AccountFrozen,      // The account's status blocks this direction of money movement
+    AccountNotFound     // No account has this number (reported by AccountPrefilter)
+};
+
+/**
+ * Typed result returned by the balance-changing methods
+ *
+ * amount  - the amount requested (or the interest added by applyInterest)
+ * balance - the balance after the operation; when the operation is rejected
+ *           the balance is unchanged, so this is the amount that was available
+ */
+struct TransactionResult {
+    TransactionStatus status;
+    Money amount;
+    Money balance;
+
+    constexpr bool ok() const {
+        return status == TransactionStatus::Success;
+    }
+
+    constexpr explicit operator bool() const {
+        return ok();
+    }
+};
+
+// ============================================================================
+// VALIDATION RULES
+// ============================================================================
+namespace account_rules {
+
+constexpr InterestRate kMinInterestRate = InterestRate::fromBasisPoints(0);
+constexpr InterestRate kMaxInterestRate = InterestRate::fromBasisPoints(5000);   // 50%
+
+/**
+ * @param amount The amount to validate
+ * @return true if amount is valid (positive), false otherwise
+ */
+constexpr bool isValidAmount(Money amount) {
+    return amount.isPositive();
+}
+
+/**
+ * @param rate The rate to validate
+ * @return true if the rate is within 0-50%
+ */
+constexpr bool isValidRate(InterestRate rate) {
+    return rate >= kMinInterestRate && rate <= kMaxInterestRate;
+}
+
+/**
+ * Checks whether amount may be taken out of an account (no overdraft)
+ *
+ * @param balance The balance available
+ * @param amount The amount to take out
+ * @return Success, InvalidAmount or InsufficientFunds
+ */
+constexpr TransactionStatus checkDebit(Money balance, Money amount) {
+    if (!isValidAmount(amount)) {
+        return TransactionStatus::InvalidAmount;
+    }
+    if (amount > balance) {
+        return TransactionStatus::InsufficientFunds;
+    }
+    return TransactionStatus::Success;
+}
+
+} // namespace account_rules
+
+#endif // TRANSACTION_HPP
@@ -0,0 +1,285 @@
+#ifndef TRANSFER_BATCH_HPP
+#define TRANSFER_BATCH_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "account_store.hpp"
+#include "journal_record.hpp"
+#include "money.hpp"
+#include "transaction.hpp"
+
+/**
+ * ============================================================================
+ * TRANSFER BATCH: many transfers settled as one all-or-nothing unit
+ * ============================================================================
+ *
+ * A leg is (from slot, to slot, amount). TransferBatch collects legs against
+ * one AccountStore and executes them together:
+ * 1. every leg is checked on its own (positive amount, both slots exist,
+ *    neither end's status blocks the leg)
+ * 2. the legs are NETTED: each leg becomes a debit and a credit
+ *    (slot, delta) pair, the pairs are sorted by slot and summed, so an
+ *    account touched by a hundred legs ends up as a single net delta
+ * 3. every net position is validated once (no overdraft, no overflow)
+ * 4. only if every leg and every position passed are the net deltas added
+ *    to the balance column, in one pass in slot order
+ *
+ * If anything fails, no balance changes. Each leg then reports why:
+ * - InvalidAmount for a leg that is malformed itself
+ * - AccountFrozen for a leg out of an account that blocks debits, or into
+ *   one that blocks credits
+ * - InsufficientFunds for a leg debiting an account whose net position
+ *   would go negative
+ * - BatchAborted for a leg that was fine but was rolled back with the rest
+ *
+ * Because positions are netted, an account may send out more than it holds
+ * as long as the same batch pays enough into it (settlement semantics).
+ * Replaying the legs one at a time with transfer() can therefore reject
+ * legs that the batch accepts, so the journal records what really happened
+ * to each account: one Withdraw record per net debit, followed by one
+ * Deposit record per net credit, carrying the final balances.
+ * ============================================================================
+ */
+
+/**
+ * Outcome of a TransferBatch::execute call
+ */
+struct TransferBatchResult {
+    TransactionStatus status = TransactionStatus::Success;   // Success or the first failure found
+    std::vector<TransactionStatus> legStatus;                // One entry per leg, in add order
+    std::size_t accountsTouched = 0;                         // Accounts with a non-zero net delta
+    Money grossAmount;                                       // Sum of all leg amounts
+
+    constexpr bool ok() const {
+        return status == TransactionStatus::Success;
+    }
+
+    constexpr explicit operator bool() const {
+        return ok();
+    }
+};
+
+// ============================================================================
+// CLASS DEFINITION: TransferBatch
+// ============================================================================
+class TransferBatch {
+private:
+    struct Leg {
+        AccountSlot from;
+        AccountSlot to;
+        std::int64_t cents;
+    };
+
+    // One side of a leg; after netting, one entry per account
+    struct Delta {
+        std::int64_t cents;
+        AccountSlot slot;
+        TransactionStatus verdict;   // Outcome of validating the net position
+    };
+
+    AccountStore *store;         // Accounts the legs refer to
+    std::vector<Leg> legs;       // Legs in add order
+    std::vector<Delta> deltas;   // Scratch space for netting, reused between runs
+
+    /**
+     * @return The netted position of slot (deltas must be netted already)
+     */
+    const Delta &positionOf(AccountSlot slot) const {
+        return *std::lower_bound(deltas.begin(), deltas.end(), slot,
+                                 [](const Delta &d, AccountSlot s) { return d.slot < s; });
+    }
+
+    /**
+     * Journals the netted movements: debits first, so every Withdraw
+     * replays against a balance that covers it, then credits
+     */
+    void journalPositions() const {
+        for (int pass = 0; pass < 2; ++pass) {
+            for (const Delta &d : deltas) {
+                if (d.cents == 0 || (d.cents < 0) != (pass == 0)) {
+                    continue;
+                }
+                store->recordSink->append(journal::makeRecord(
+                    d.cents < 0 ? JournalOp::Withdraw : JournalOp::Deposit,
+                    store->accountNumbers[d.slot],
+                    Money::fromMinorUnits(d.cents < 0 ? -d.cents : d.cents),
+                    Money::fromMinorUnits(store->balances[d.slot])));
+            }
+        }
+    }
+
+public:
+    /**
+     * @param target The store every leg of this batch belongs to
+     */
+    explicit TransferBatch(AccountStore &target) : store(&target) {}
+
+    /**
+     * @param legCount Number of legs to make room for
+     */
+    void reserve(std::size_t legCount) {
+        legs.reserve(legCount);
+        deltas.reserve(legCount * 2);
+    }
+
+    /**
+     * Adds a leg (nothing is checked or applied until execute)
+     *
+     * @param from Slot of the account to debit
+     * @param to Slot of the account to credit
+     * @param amount Amount to move
+     * @return Index of the leg in the batch
+     */
+    std::size_t add(AccountSlot from, AccountSlot to, Money amount) {
+        legs.push_back({from, to, amount.getMinorUnits()});
+        return legs.size() - 1;
+    }
+
+    /**
+     * @param from Account to debit (must belong to this batch's store)
+     * @param to Account to credit (must belong to this batch's store)
+     * @param amount Amount to move
+     * @return Index of the leg in the batch
+     */
+    std::size_t add(AccountRef from, AccountRef to, Money amount) {
+        return add(from.getSlot(), to.getSlot(), amount);
+    }
+
+    /**
+     * @return Number of legs in the batch
+     */
+    std::size_t size() const { return legs.size(); }
+
+    bool empty() const { return legs.empty(); }
+
+    /**
+     * Removes every leg so the batch can be reused
+     */
+    void clear() { legs.clear(); }
+
+    /**
+     * Validates and applies every leg, or none of them
+     * The legs stay in the batch; call clear() before reusing it.
+     *
+     * @param result Receives the overall and per-leg outcome (overwritten)
+     */
+    void execute(TransferBatchResult &result) {
+        const std::size_t accountCount = store->size();
+        result.status = TransactionStatus::Success;
+        result.legStatus.assign(legs.size(), TransactionStatus::Success);
+        result.accountsTouched = 0;
+        result.grossAmount = Money();
+
+        // 1. Each leg on its own; bad legs take no part in netting
+        deltas.clear();
+        std::int64_t gross = 0;
+        for (std::size_t i = 0; i < legs.size(); ++i) {
+            const Leg &leg = legs[i];
+            std::int64_t grossAfter;
+            if (!account_rules::isValidAmount(Money::fromMinorUnits(leg.cents)) ||
+                leg.from >= accountCount || leg.to >= accountCount ||
+                __builtin_add_overflow(gross, leg.cents, &grossAfter)) {
+                result.legStatus[i] = TransactionStatus::InvalidAmount;
+                result.status = TransactionStatus::InvalidAmount;
+                continue;
+            }
+            if (store->blocksDebits(leg.from) || store->blocksCredits(leg.to)) {
+                result.legStatus[i] = TransactionStatus::AccountFrozen;
+                result.status = TransactionStatus::AccountFrozen;
+                continue;
+            }
+            gross = grossAfter;
+            deltas.push_back({-leg.cents, leg.from, TransactionStatus::Success});
+            deltas.push_back({leg.cents, leg.to, TransactionStatus::Success});
+        }
+        result.grossAmount = Money::fromMinorUnits(gross);
+
+        // 2. Net per account: sort by slot, then fold equal slots together
+        std::sort(deltas.begin(), deltas.end(),
+                  [](const Delta &a, const Delta &b) { return a.slot < b.slot; });
+        std::size_t positions = 0;
+        bool positionFailed = false;
+        for (std::size_t i = 0; i < deltas.size();) {
+            Delta net{0, deltas[i].slot, TransactionStatus::Success};
+            bool overflow = false;
+            for (; i < deltas.size() && deltas[i].slot == net.slot; ++i) {
+                overflow |= __builtin_add_overflow(net.cents, deltas[i].cents, &net.cents);
+            }
+            // 3. Validate the net position once (against a settled balance)
+            store->settle(net.slot);
+            std::int64_t after;
+            overflow |= __builtin_add_overflow(store->balances[net.slot], net.cents, &after);
+            if (overflow) {
+                net.verdict = TransactionStatus::InvalidAmount;
+            } else if (after < 0) {
+                net.verdict = TransactionStatus::InsufficientFunds;
+            }
+            positionFailed |= net.verdict != TransactionStatus::Success;
+            deltas[positions++] = net;
+        }
+        deltas.resize(positions);
+
+        if (positionFailed) {
+            // Blame the legs that debit an overdrawn account or touch an
+            // overflowing one
+            for (std::size_t i = 0; i < legs.size(); ++i) {
+                if (result.legStatus[i] != TransactionStatus::Success) {
+                    continue;
+                }
+                const TransactionStatus from = positionOf(legs[i].from).verdict;
+                const TransactionStatus to = positionOf(legs[i].to).verdict;
+                if (from == TransactionStatus::InvalidAmount || to == TransactionStatus::InvalidAmount) {
+                    result.legStatus[i] = TransactionStatus::InvalidAmount;
+                } else if (from == TransactionStatus::InsufficientFunds) {
+                    result.legStatus[i] = TransactionStatus::InsufficientFunds;
+                }
+            }
+        }
+
+        if (result.status != TransactionStatus::Success || positionFailed) {
+            // Nothing is applied; innocent legs are rolled back with the rest
+            result.status = TransactionStatus::BatchAborted;
+            for (TransactionStatus &status : result.legStatus) {
+                if (status == TransactionStatus::Success) {
+                    status = TransactionStatus::BatchAborted;
+                } else if (result.status == TransactionStatus::BatchAborted) {
+                    result.status = status;   // First failing leg gives the batch its reason
+                }
+            }
+            return;
+        }
+
+        // 4. Apply: one write per account, in slot order
+        std::int64_t *balances = store->balances.data();
+        std::array<std::int64_t, kAccountTypeCount> byType{};
+        std::int64_t zeroDelta = 0;
+        for (const Delta &d : deltas) {
+            const std::int64_t before = balances[d.slot];
+            balances[d.slot] = before + d.cents;
+            store->markChanged(d.slot);
+            byType[static_cast<std::size_t>(store->types[d.slot])] += d.cents;
+            zeroDelta += static_cast<std::int64_t>(before + d.cents == 0) - static_cast<std::int64_t>(before == 0);
+            result.accountsTouched += d.cents != 0;
+        }
+        store->aggregates.onBatch(byType, zeroDelta);
+        if (store->recordSink) {
+            journalPositions();
+        }
+    }
+
+    /**
+     * Validates and applies every leg, or none of them
+     * @return The overall and per-leg outcome
+     */
+    TransferBatchResult execute() {
+        TransferBatchResult result;
+        execute(result);
+        return result;
+    }
+};
+
+#endif // TRANSFER_BATCH_HPP
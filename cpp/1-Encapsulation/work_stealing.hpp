@@ -0,0 +1,314 @@
+#ifndef WORK_STEALING_HPP
+#define WORK_STEALING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * ============================================================================
+ * WORK-STEALING SCHEDULER: chunked jobs over a fixed pool of workers
+ * ============================================================================
+ *
+ * A job is "run chunk c for every c in [0, chunkCount)". The chunks are
+ * first split evenly: worker w owns one contiguous range. Each worker takes
+ * chunks from the FRONT of its own range. A worker whose range is empty
+ * picks a victim and steals the BACK HALF of the victim's remaining range,
+ * then carries on with that. Cheap chunks therefore never leave a worker
+ * idle while another one is still working through expensive ones.
+ *
+ * A range is two 32-bit chunk indices packed into one atomic word, so both
+ * taking a chunk and stealing half a range are a single compare-and-swap.
+ * Ranges only ever shrink or split, so a worker that finds every range
+ * empty knows no work is left to steal and stops.
+ *
+ * Each run returns per-worker statistics: chunks run, successful steals,
+ * time spent inside chunks and utilization (that time divided by the
+ * run's wall-clock time). setStealing(false) turns the same scheduler into
+ * static partitioning, for comparison.
+ *
+ * A scheduler runs one job at a time; run() blocks until the job is done.
+ * ============================================================================
+ */
+
+/**
+ * What one worker did during a run
+ */
+struct WorkerStats {
+    std::uint64_t chunks = 0;           // Chunks executed
+    std::uint64_t steals = 0;           // Ranges stolen from other workers
+    std::uint64_t failedSteals = 0;     // Steal attempts that lost a race
+    std::chrono::nanoseconds busy{0};   // Time spent inside chunks
+    double utilization = 0.0;           // busy / wall time of the run
+};
+
+/**
+ * What a whole run did
+ */
+struct SchedulerStats {
+    std::vector<WorkerStats> workers;
+    std::chrono::nanoseconds wall{0};   // From run start to the last chunk finishing
+
+    /**
+     * @return Mean utilization over all workers (1.0 = nobody was ever idle)
+     */
+    double averageUtilization() const {
+        if (workers.empty()) {
+            return 0.0;
+        }
+        double sum = 0.0;
+        for (const WorkerStats &w : workers) {
+            sum += w.utilization;
+        }
+        return sum / static_cast<double>(workers.size());
+    }
+
+    /**
+     * @return Lowest utilization of any worker (the idle tail shows up here)
+     */
+    double minUtilization() const {
+        double lowest = workers.empty() ? 0.0 : 1.0;
+        for (const WorkerStats &w : workers) {
+            lowest = std::min(lowest, w.utilization);
+        }
+        return lowest;
+    }
+};
+
+// ============================================================================
+// CLASS DEFINITION: WorkStealingScheduler
+// ============================================================================
+class WorkStealingScheduler {
+public:
+    using ChunkFunction = std::function<void(std::size_t chunk, std::size_t worker)>;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct alignas(64) Worker {
+        std::atomic<std::uint64_t> range{0};   // (first << 32) | end of the chunks still owned
+        WorkerStats stats;
+        std::uint32_t seed = 0;                // Victim selection
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    bool stealing = true;
+
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable finished;
+    std::uint64_t generation = 0;          // Incremented per run
+    std::size_t running = 0;               // Workers still inside the current run
+    bool stopping = false;
+    const ChunkFunction *job = nullptr;
+
+    static std::uint64_t pack(std::uint32_t first, std::uint32_t end) {
+        return (static_cast<std::uint64_t>(first) << 32) | end;
+    }
+
+    static std::uint32_t firstOf(std::uint64_t range) { return static_cast<std::uint32_t>(range >> 32); }
+
+    static std::uint32_t endOf(std::uint64_t range) { return static_cast<std::uint32_t>(range); }
+
+    /**
+     * Takes the next chunk from the front of a worker's own range
+     * @return false if the range is empty
+     */
+    static bool takeLocal(Worker &self, std::uint32_t &chunk) {
+        std::uint64_t range = self.range.load(std::memory_order_acquire);
+        for (;;) {
+            std::uint32_t first = firstOf(range);
+            std::uint32_t end = endOf(range);
+            if (first >= end) {
+                return false;
+            }
+            if (self.range.compare_exchange_weak(range, pack(first + 1, end), std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+                chunk = first;
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Moves the back half of some other worker's range into self's range
+     * @return false if every other range was empty
+     */
+    bool steal(std::size_t selfIndex) {
+        Worker &self = *workers[selfIndex];
+        const std::size_t count = workers.size();
+        self.seed = self.seed * 1664525u + 1013904223u;
+        const std::size_t startAt = self.seed % count;
+        for (std::size_t k = 0; k < count; ++k) {
+            std::size_t victimIndex = (startAt + k) % count;
+            if (victimIndex == selfIndex) {
+                continue;
+            }
+            Worker &victim = *workers[victimIndex];
+            std::uint64_t range = victim.range.load(std::memory_order_acquire);
+            for (;;) {
+                std::uint32_t first = firstOf(range);
+                std::uint32_t end = endOf(range);
+                if (first >= end) {
+                    break;
+                }
+                std::uint32_t middle = first + (end - first) / 2;   // A single chunk is taken whole
+                if (victim.range.compare_exchange_weak(range, pack(first, middle), std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+                    self.range.store(pack(middle, end), std::memory_order_release);
+                    ++self.stats.steals;
+                    return true;
+                }
+                ++self.stats.failedSteals;
+            }
+        }
+        return false;
+    }
+
+    void work(std::size_t selfIndex) {
+        Worker &self = *workers[selfIndex];
+        std::uint32_t chunk;
+        for (;;) {
+            while (takeLocal(self, chunk)) {
+                Clock::time_point before = Clock::now();
+                (*job)(chunk, selfIndex);
+                self.stats.busy += Clock::now() - before;
+                ++self.stats.chunks;
+            }
+            if (!stealing || !steal(selfIndex)) {
+                break;
+            }
+        }
+    }
+
+    void runWorker(std::size_t selfIndex) {
+        std::uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            work(selfIndex);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--running == 0) {
+                    finished.notify_one();
+                }
+            }
+        }
+    }
+
+public:
+    /**
+     * Starts the worker threads
+     * @param workerCount Number of workers (0 = one per hardware thread)
+     */
+    explicit WorkStealingScheduler(std::size_t workerCount = 0) {
+        if (workerCount == 0) {
+            workerCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        workers.reserve(workerCount);
+        for (std::size_t i = 0; i < workerCount; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+            workers.back()->seed = static_cast<std::uint32_t>(i * 2654435761u + 1);
+        }
+        for (std::size_t i = 0; i < workerCount; ++i) {
+            workers[i]->thread = std::thread([this, i] { runWorker(i); });
+        }
+    }
+
+    WorkStealingScheduler(const WorkStealingScheduler &) = delete;
+    WorkStealingScheduler &operator=(const WorkStealingScheduler &) = delete;
+
+    ~WorkStealingScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start.notify_all();
+        for (std::unique_ptr<Worker> &worker : workers) {
+            worker->thread.join();
+        }
+    }
+
+    std::size_t getWorkerCount() const { return workers.size(); }
+
+    /**
+     * @param enabled false = static partitioning (each worker runs only its own range)
+     */
+    void setStealing(bool enabled) { stealing = enabled; }
+
+    bool isStealing() const { return stealing; }
+
+    /**
+     * Runs fn(chunk, worker) for every chunk in [0, chunkCount) and waits
+     *
+     * @param chunkCount Number of chunks (below 2^32)
+     * @param fn Called once per chunk, concurrently from all workers
+     * @return Statistics of this run
+     */
+    SchedulerStats run(std::size_t chunkCount, const ChunkFunction &fn) {
+        const std::size_t count = workers.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            auto first = static_cast<std::uint32_t>(chunkCount * i / count);
+            auto end = static_cast<std::uint32_t>(chunkCount * (i + 1) / count);
+            workers[i]->range.store(pack(first, end), std::memory_order_relaxed);
+            workers[i]->stats = WorkerStats();
+        }
+
+        Clock::time_point runStart = Clock::now();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job = &fn;
+            running = count;
+            ++generation;
+            start.notify_all();
+            finished.wait(lock, [&] { return running == 0; });
+            job = nullptr;
+        }
+
+        SchedulerStats stats;
+        stats.wall = Clock::now() - runStart;
+        for (std::unique_ptr<Worker> &worker : workers) {
+            WorkerStats w = worker->stats;
+            w.utilization = stats.wall.count() > 0
+                                ? static_cast<double>(w.busy.count()) / static_cast<double>(stats.wall.count())
+                                : 0.0;
+            stats.workers.push_back(w);
+        }
+        return stats;
+    }
+
+    /**
+     * Splits [begin, end) into chunks of at most grain items and runs
+     * fn(chunkBegin, chunkEnd, worker) for each of them
+     *
+     * @return Statistics of this run
+     */
+    template <class Function>
+    SchedulerStats parallelFor(std::size_t begin, std::size_t end, std::size_t grain, Function &&fn) {
+        grain = std::max<std::size_t>(grain, 1);
+        const std::size_t total = end > begin ? end - begin : 0;
+        const std::size_t chunks = (total + grain - 1) / grain;
+        ChunkFunction chunkFn = [&](std::size_t chunk, std::size_t worker) {
+            std::size_t first = begin + chunk * grain;
+            fn(first, std::min(first + grain, end), worker);
+        };
+        return run(chunks, chunkFn);
+    }
+};
+
+#endif // WORK_STEALING_HPP